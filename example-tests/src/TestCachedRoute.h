@@ -0,0 +1,126 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Poco/Exception.h"
+#include "Poco/Thread.h"
+#include "Poco/URI.h"
+
+#include "ofTypes.h"
+#include "ofUtils.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerRouteHandler.h"
+
+using std::map;
+using std::string;
+
+using Poco::URI;
+
+// Counts the requests that reached a cached route, by path.
+class TestCachedRouteCounter {
+public:
+    int add(const string& path) {
+        ofScopedLock lock(mutex);
+        return ++calls[path];
+    }
+    
+    int get(const string& path) const {
+        ofScopedLock lock(mutex);
+        map<string, int>::const_iterator iter = calls.find(path);
+        return iter != calls.end() ? (*iter).second : 0;
+    }
+    
+protected:
+    mutable ofMutex mutex;
+    map<string, int> calls;
+    
+};
+
+// Answers with its path and how many times it has been called, so a test
+// can tell a computed response from a stored one.  /slow takes a while,
+// /flaky takes a while and fails the first time.
+class TestCachedRouteHandler : public ofxHTTPServerRouteHandler {
+public:
+    TestCachedRouteHandler(TestCachedRouteCounter& _counter) : counter(_counter) { }
+    
+    virtual ~TestCachedRouteHandler() { }
+    
+    void handleExchange(ofxHTTPServerExchange& exchange) {
+        string path = URI(exchange.request.getURI()).getPath();
+        
+        int call = counter.add(path);
+        
+        if(path == "/slow" || path == "/flaky") {
+            Poco::Thread::sleep(300);
+        }
+        
+        if(path == "/flaky" && call == 1) {
+            throw Poco::IllegalStateException("Failed the first time.");
+        }
+        
+        string body = path + " " + ofToString(call);
+        
+        exchange.response.setContentType("text/plain");
+        exchange.response.sendBuffer(body.data(), body.size());
+    }
+    
+protected:
+    TestCachedRouteCounter& counter;
+    
+};
+
+//------------------------------------------------------------------------------
+class TestCachedRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofPtr<TestCachedRoute> Ptr;
+    
+    TestCachedRoute() { }
+    
+    virtual ~TestCachedRoute() { }
+    
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        return true;
+    }
+    
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        return new TestCachedRouteHandler(counter);
+    }
+    
+    int getNumCalls(const string& path) const {
+        return counter.get(path);
+    }
+    
+    static Ptr Instance() {
+        return Ptr(new TestCachedRoute());
+    }
+    
+protected:
+    TestCachedRouteCounter counter;
+    
+};
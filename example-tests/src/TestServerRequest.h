@@ -0,0 +1,83 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/SocketAddress.h"
+
+#include "ofxHTTPServerBufferedResponse.h"
+
+using std::istream;
+using std::istringstream;
+using std::string;
+
+using Poco::Net::HTTPServerParams;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+using Poco::Net::SocketAddress;
+
+// A request made up by a test, so authenticators and limiters can be
+// checked without a connection.  Its response is kept in memory.
+class TestServerRequest : public HTTPServerRequest {
+public:
+    TestServerRequest(const string& method,
+                      const string& uri,
+                      const string& clientHost = "127.0.0.1") :
+    body(""),
+    client(clientHost, 50000),
+    server("127.0.0.1", 8080),
+    params(new HTTPServerParams())
+    {
+        setMethod(method);
+        setURI(uri);
+    }
+    
+    virtual ~TestServerRequest() { }
+    
+    istream& stream() { return body; }
+    bool expectContinue() const { return false; }
+    bool secure() const { return false; }
+    
+    const SocketAddress& clientAddress() const { return client; }
+    const SocketAddress& serverAddress() const { return server; }
+    const HTTPServerParams& serverParams() const { return *params; }
+    
+    HTTPServerResponse& response() const { return bufferedResponse; }
+    
+    ofxHTTPServerBufferedResponse& getBufferedResponse() { return bufferedResponse; }
+    
+protected:
+    istringstream body;
+    SocketAddress client;
+    SocketAddress server;
+    HTTPServerParams::Ptr params;
+    
+    mutable ofxHTTPServerBufferedResponse bufferedResponse;
+    
+};
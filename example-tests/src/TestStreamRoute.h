@@ -0,0 +1,112 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "Poco/Exception.h"
+#include "Poco/URI.h"
+#include "Poco/Net/NameValueCollection.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPBufferPool.h"
+#include "ofxHTTPServerRouteHandler.h"
+#include "ofxHTTPServerStreamWriter.h"
+
+using std::string;
+
+using Poco::URI;
+using Poco::Net::NameValueCollection;
+
+// Streams "hello", "world!" and a trailer, so the framing on the wire can
+// be checked.  At /stream-fail the handler throws once the stream is
+// finished, which must not add anything to the response.
+class TestStreamRouteHandler : public ofxHTTPServerRouteHandler {
+public:
+    TestStreamRouteHandler(ofxHTTPBufferPool& _pool, bool _bFailAfterFinish) :
+    pool(_pool),
+    bFailAfterFinish(_bFailAfterFinish)
+    { }
+    
+    virtual ~TestStreamRouteHandler() { }
+    
+    void handleExchange(ofxHTTPServerExchange& exchange) {
+        ofxHTTPServerStreamWriter::Settings settings;
+        settings.trailerNames.push_back("X-Checksum");
+        
+        ofxHTTPServerStreamWriter writer(exchange, pool, settings);
+        writer.write("hello");
+        writer.flush();
+        writer.write("world!");
+        
+        NameValueCollection trailers;
+        trailers.set("X-Checksum", "42");
+        writer.finish(trailers);
+        
+        if(bFailAfterFinish) {
+            throw Poco::IllegalStateException("Failed after the stream was finished.");
+        }
+    }
+    
+protected:
+    ofxHTTPBufferPool& pool;
+    bool bFailAfterFinish;
+    
+};
+
+//------------------------------------------------------------------------------
+class TestStreamRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofPtr<TestStreamRoute> Ptr;
+    
+    TestStreamRoute() : pool(ofxHTTPBufferPool::Instance(4096)) { }
+    
+    virtual ~TestStreamRoute() { }
+    
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        string path = getPath(request);
+        return path == "/stream" || path == "/stream-fail";
+    }
+    
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        return new TestStreamRouteHandler(*pool, getPath(request) == "/stream-fail");
+    }
+    
+    static Ptr Instance() {
+        return Ptr(new TestStreamRoute());
+    }
+    
+protected:
+    static string getPath(const HTTPServerRequest& request) {
+        try {
+            return URI(request.getURI()).getPath();
+        } catch(const Poco::SyntaxException&) {
+            return "";
+        }
+    }
+    
+    ofxHTTPBufferPool::Ptr pool;
+    
+};
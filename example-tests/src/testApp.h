@@ -0,0 +1,258 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Poco/HMACEngine.h"
+#include "Poco/Runnable.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Net/StreamSocket.h"
+
+#include "ofBaseApp.h"
+#include "ofGraphics.h"
+#include "ofAppRunner.h"
+#include "ofLog.h"
+#include "ofUtils.h"
+
+#include "ofxHTTPMultipartParser.h"
+#include "ofxHTTPPasswordHash.h"
+#include "ofxHTTPResumableUploadStore.h"
+#include "ofxHTTPServer.h"
+#include "ofxHTTPServerBearerAuthenticator.h"
+#include "ofxHTTPServerCachedRoute.h"
+#include "ofxHTTPServerDigestAuthenticator.h"
+#include "ofxHTTPServerJWTVerifier.h"
+#include "ofxHTTPServerRateLimiter.h"
+#include "ofxHTTPServerResponseCache.h"
+#include "ofxHTTPServerResumableUploadRoute.h"
+#include "ofxHTTPServerScheduler.h"
+#include "ofxHTTPSHA256Engine.h"
+#include "ofxHTTPTimerWheel.h"
+
+#include "TestCachedRoute.h"
+#include "TestServerRequest.h"
+#include "TestStreamRoute.h"
+
+using std::string;
+using std::vector;
+
+using Poco::Net::HTTPClientSession;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::SocketAddress;
+using Poco::Net::StreamSocket;
+
+// Records the timers a wheel fires, in order.
+class TestTimerListener : public ofxBaseHTTPTimerListener {
+public:
+    void timerExpired(unsigned long long timerId) {
+        fired.push_back(timerId);
+    }
+    
+    bool hasFired(unsigned long long timerId) const {
+        for(size_t i = 0; i < fired.size(); ++i) {
+            if(fired[i] == timerId) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    vector<unsigned long long> fired;
+};
+
+// Records the parts a multipart parser passes to its listener.
+class TestMultipartListener : public ofxBaseHTTPMultipartListener {
+public:
+    TestMultipartListener() : numEnded(0) { }
+    
+    bool onPartBegin(const MessageHeader& header) {
+        dispositions.push_back(header.get("Content-Disposition", ""));
+        bodies.push_back("");
+        return true;
+    }
+    
+    bool onPartData(const char* data, size_t length) {
+        bodies.back().append(data, length);
+        return true;
+    }
+    
+    bool onPartEnd() {
+        ++numEnded;
+        return true;
+    }
+    
+    vector<string> dispositions;
+    vector<string> bodies;
+    size_t numEnded;
+};
+
+// Waits for a scheduler to admit it, like a scheduled request on a server
+// thread, and records when it got to run.
+class TestScheduledRequest : public Poco::Runnable {
+public:
+    TestScheduledRequest(ofxHTTPServerScheduler& _scheduler,
+                         const string& _name,
+                         int _priority,
+                         const Timespan& _deadline,
+                         vector<string>& _order,
+                         ofMutex& _orderMutex) :
+    scheduler(_scheduler),
+    name(_name),
+    priority(_priority),
+    deadline(_deadline),
+    order(_order),
+    orderMutex(_orderMutex),
+    admission(ofxHTTPServerScheduler::EXPIRED)
+    { }
+    
+    void run() {
+        admission = scheduler.admit(priority, Timestamp() + deadline);
+        
+        if(admission == ofxHTTPServerScheduler::ADMITTED) {
+            {
+                ofScopedLock lock(orderMutex);
+                order.push_back(name);
+            }
+            scheduler.release();
+        }
+    }
+    
+    ofxHTTPServerScheduler& scheduler;
+    string name;
+    int priority;
+    Timespan deadline;
+    vector<string>& order;
+    ofMutex& orderMutex;
+    ofxHTTPServerScheduler::Admission admission;
+};
+
+// Sends a GET through a cached route, as a server thread would, and
+// records what came back.
+class TestCachedRequest : public Poco::Runnable {
+public:
+    TestCachedRequest(ofxBaseHTTPServerRoute::Ptr _route, const string& _uri) :
+    route(_route),
+    uri(_uri),
+    status(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR),
+    bFailed(false)
+    { }
+    
+    void run() {
+        Timestamp start;
+        
+        TestServerRequest request(HTTPRequest::HTTP_GET, uri);
+        request.set("Host", "example.com");
+        
+        // deleting the handler is what wakes the requests waiting on it
+        HTTPRequestHandler* handler = route->createRequestHandler(request);
+        try {
+            handler->handleRequest(request, request.response());
+            status = request.getBufferedResponse().getStatus();
+            body = request.getBufferedResponse().getBody();
+        } catch(const Poco::Exception&) {
+            bFailed = true;
+        }
+        delete handler;
+        
+        elapsed = start.elapsed();
+    }
+    
+    ofxBaseHTTPServerRoute::Ptr route;
+    string uri;
+    HTTPResponse::HTTPStatus status;
+    string body;
+    bool bFailed;
+    Timespan elapsed;
+};
+
+// Checks the protocol handlers against known vectors and against the
+// behaviour their specifications require.  The results are logged and
+// drawn; any failure is also logged as an error.
+class testApp : public ofBaseApp {
+
+public:
+    void setup();
+    void draw();
+    void exit();
+    
+    void testTimerWheel();
+    void testSHA256();
+    void testMultipartParser();
+    void testResumableUploads();
+    void testPasswordHash();
+    void testDigestAuthentication();
+    void testJWT();
+    void testRateLimiter();
+    void testScheduler();
+    void testStreamWriter();
+    void testVirtualHosts();
+    void testResponseCache();
+    
+    void check(bool bPassed, const string& name);
+    
+    // finishes a cache miss with a 200 response
+    static void cacheResponse(ofxHTTPServerResponseCache& cache,
+                              const string& key,
+                              const HTTPServerRequest& request,
+                              const string& body,
+                              const string& headerName = "",
+                              const string& headerValue = "");
+    
+    static string sha256(const string& text);
+    
+    // feeds a message to a parser chunkSize bytes at a time, returns
+    // whether it reached the close delimiter
+    static bool parseMultipart(const string& boundary,
+                               const string& message,
+                               size_t chunkSize,
+                               TestMultipartListener& listener);
+    static string toHex(const string& bytes);
+    
+    // sends a request to the test server and reads the whole response
+    string sendRequest(HTTPRequest& request, const string& body, HTTPResponse& response);
+    
+    // sends raw request bytes and returns the raw response, up to the
+    // server closing the connection
+    string sendRawRequest(const string& request);
+    
+    enum {
+        TEST_PORT = 8998
+    };
+    
+    ofxHTTPServer server;
+    ofxHTTPServerResumableUploadRoute::Ptr uploadRoute;
+    
+    int numPassed;
+    int numFailed;
+    vector<string> failures;
+
+};
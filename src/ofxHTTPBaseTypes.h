@@ -25,8 +25,11 @@
 #pragma once
 
 #include <set>
+#include <string>
+#include <vector>
 
 #include "Poco/RegularExpression.h"
+#include "Poco/Timestamp.h"
 #include "Poco/Net/HTTPBasicCredentials.h"
 #include "Poco/Net/HTTPRequestHandler.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
@@ -34,12 +37,15 @@
 #include "Poco/Net/HTTPServerRequest.h"
 #include "Poco/Net/NetException.h"
 
+#include "ofxHTTPServerBodyLimits.h"
 #include "ofxHTTPServerExchange.h"
 #include "ofxHTTPConstants.h"
 #include "ofxHTTPCredentials.h"
 #include "ofxHTTPResponseStream.h"
 
 using std::set;
+using std::string;
+using std::vector;
 
 using Poco::RegularExpression;
 using Poco::Net::HTTPBasicCredentials;
@@ -58,6 +64,12 @@ public:
     
     virtual bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) = 0;
     
+    // called after canHandleRequest, while only the headers have arrived.
+    // Routes override this to turn away bodies they would reject anyway.
+    virtual ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        return ofxHTTPServerBodyLimits();
+    }
+    
 };
 
 typedef ofPtr<ofxBaseHTTPServerRoute> ofxBaseHTTPServerRoutePtr;
@@ -100,7 +112,7 @@ public:
                     return UNAUTHORIZED;
                 }
             } else if(HTTPCredentials::hasDigestCredentials(request)) {
-                ofLogWarning("ofxBaseHTTPServerBasicAuthenticationManager::authenticate") << "HTTPServerResponse does not currently support DIGEST Auththentication";
+                ofLogWarning("ofxBaseHTTPServerBasicAuthenticationManager::authenticate") << "Digest credentials are handled by ofxHTTPServerDigestAuthenticator.";
                 return UNAUTHORIZED;
             } else {
                 string scheme;
@@ -139,6 +151,31 @@ protected:
     }
 };
 
+// What a bearer token verifier learned from a token.
+struct ofxHTTPServerTokenInfo {
+    ofxHTTPServerTokenInfo() : bExpires(false), bNotBefore(false) { }
+    
+    string subject;
+    string claims; // as the verifier found them, e.g. a JWT payload
+    
+    bool bExpires;
+    Poco::Timestamp expires;
+    bool bNotBefore;
+    Poco::Timestamp notBefore;
+};
+
+// Checks a bearer token's integrity.  The time limits it reports are
+// enforced by the caller, which allows for clock skew.
+class ofxBaseHTTPServerTokenVerifier {
+public:
+    typedef ofPtr<ofxBaseHTTPServerTokenVerifier> Ptr;
+    
+    ofxBaseHTTPServerTokenVerifier() { }
+    virtual ~ofxBaseHTTPServerTokenVerifier() { }
+    
+    virtual bool verify(const string& token, ofxHTTPServerTokenInfo& info) = 0;
+};
+
 class ofxBaseHTTPServerSessionManager {
 public:
     ofxBaseHTTPServerSessionManager() { }
@@ -146,6 +183,38 @@ public:
     virtual bool update(HTTPServerRequest& request, HTTPServerResponse& response) = 0;
 };
 
+// Keeps session data across restarts.  Session managers report every
+// change with put() and remove() and periodically replace the whole
+// store with compact().  Implementations must be thread safe.
+class ofxBaseHTTPServerSessionStore {
+public:
+    typedef ofPtr<ofxBaseHTTPServerSessionStore> Ptr;
+    
+    struct Record {
+        string key;
+        string data;
+        Poco::Timestamp expires;
+    };
+    
+    ofxBaseHTTPServerSessionStore() { }
+    virtual ~ofxBaseHTTPServerSessionStore() { }
+    
+    // the sessions that were live when the store was last written
+    virtual bool load(vector<Record>& records) = 0;
+    
+    virtual void put(const string& key, const string& data, const Poco::Timestamp& expires) = 0;
+    virtual void remove(const string& key) = 0;
+    
+    // makes everything written so far survive a restart of the process
+    virtual void flush() = 0;
+    
+    // compaction runs while sessions keep changing.  Changes made after
+    // beginCompaction() are kept on top of the records given to compact().
+    virtual bool needsCompaction() = 0;
+    virtual void beginCompaction() = 0;
+    virtual void compact(const vector<Record>& records) = 0;
+};
+
 class ofxBaseHTTPResponseStreamConsumer {
 public:
     ofxBaseHTTPResponseStreamConsumer() { }
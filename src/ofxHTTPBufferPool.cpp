@@ -0,0 +1,126 @@
+#include "ofxHTTPBufferPool.h"
+
+#include <cstdlib>
+
+#include "Poco/Exception.h"
+
+#ifdef TARGET_WIN32
+#include <malloc.h>
+#endif
+
+//------------------------------------------------------------------------------
+ofxHTTPBufferPool::ScopedBuffer::ScopedBuffer(ofxHTTPBufferPool& _pool) :
+pool(_pool),
+buffer(_pool.acquire())
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPBufferPool::ScopedBuffer::~ScopedBuffer() {
+    pool.release(buffer);
+}
+
+//------------------------------------------------------------------------------
+char* ofxHTTPBufferPool::ScopedBuffer::data() {
+    return buffer;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPBufferPool::ScopedBuffer::size() const {
+    return pool.getBufferSize();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPBufferPool::ofxHTTPBufferPool(size_t _bufferSize,
+                                     size_t _maxFreeBuffers,
+                                     size_t _alignment) :
+bufferSize(_bufferSize),
+maxFreeBuffers(_maxFreeBuffers),
+alignment(_alignment)
+{
+    // the alignment must be a power of two and a multiple of sizeof(void*)
+    if(alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        alignment = sizeof(void*);
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPBufferPool::~ofxHTTPBufferPool() {
+    ofScopedLock lock(mutex);
+    vector<char*>::iterator iter = freeBuffers.begin();
+    while(iter != freeBuffers.end()) {
+        deallocate(*iter);
+        ++iter;
+    }
+    freeBuffers.clear();
+}
+
+//------------------------------------------------------------------------------
+char* ofxHTTPBufferPool::acquire() {
+    {
+        ofScopedLock lock(mutex);
+        if(!freeBuffers.empty()) {
+            char* buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+            return buffer;
+        }
+    }
+    return allocate();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPBufferPool::release(char* buffer) {
+    if(buffer == NULL) return;
+
+    {
+        ofScopedLock lock(mutex);
+        if(freeBuffers.size() < maxFreeBuffers) {
+            freeBuffers.push_back(buffer);
+            return;
+        }
+    }
+
+    deallocate(buffer);
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPBufferPool::getBufferSize() const {
+    return bufferSize;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPBufferPool::getNumFreeBuffers() const {
+    ofScopedLock lock(mutex);
+    return freeBuffers.size();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPBufferPool::Ptr ofxHTTPBufferPool::Instance(size_t bufferSize,
+                                                   size_t maxFreeBuffers,
+                                                   size_t alignment) {
+    return Ptr(new ofxHTTPBufferPool(bufferSize, maxFreeBuffers, alignment));
+}
+
+//------------------------------------------------------------------------------
+char* ofxHTTPBufferPool::allocate() const {
+    void* buffer = NULL;
+#ifdef TARGET_WIN32
+    buffer = _aligned_malloc(bufferSize, alignment);
+#else
+    if(posix_memalign(&buffer, alignment, bufferSize) != 0) {
+        buffer = NULL;
+    }
+#endif
+    if(buffer == NULL) {
+        throw Poco::OutOfMemoryException("ofxHTTPBufferPool::allocate");
+    }
+    return static_cast<char*>(buffer);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPBufferPool::deallocate(char* buffer) const {
+#ifdef TARGET_WIN32
+    _aligned_free(buffer);
+#else
+    free(buffer);
+#endif
+}
@@ -0,0 +1,85 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <vector>
+
+#include "ofTypes.h"
+
+using std::vector;
+
+// A pool of equally sized, aligned buffers.  Request handlers that stream
+// large bodies borrow their buffers here instead of allocating per request.
+// The alignment allows the buffers to be used for direct I/O.
+class ofxHTTPBufferPool {
+public:
+    typedef ofPtr<ofxHTTPBufferPool> Ptr;
+
+    class ScopedBuffer {
+    public:
+        ScopedBuffer(ofxHTTPBufferPool& _pool);
+        ~ScopedBuffer();
+
+        char*  data();
+        size_t size() const;
+
+    private:
+        ScopedBuffer(const ScopedBuffer&);
+        ScopedBuffer& operator = (const ScopedBuffer&);
+
+        ofxHTTPBufferPool& pool;
+        char* buffer;
+    };
+
+    ofxHTTPBufferPool(size_t _bufferSize,
+                      size_t _maxFreeBuffers = 16,
+                      size_t _alignment = 4096);
+
+    virtual ~ofxHTTPBufferPool();
+
+    // will throw Poco::OutOfMemoryException
+    char* acquire();
+    void  release(char* buffer);
+
+    size_t getBufferSize() const;
+    size_t getNumFreeBuffers() const;
+
+    static Ptr Instance(size_t bufferSize,
+                        size_t maxFreeBuffers = 16,
+                        size_t alignment = 4096);
+
+protected:
+    char* allocate() const;
+    void  deallocate(char* buffer) const;
+
+    size_t bufferSize;
+    size_t maxFreeBuffers;
+    size_t alignment;
+
+    vector<char*> freeBuffers;
+
+    mutable ofMutex mutex;
+
+};
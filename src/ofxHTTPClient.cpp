@@ -41,11 +41,19 @@ ofxHTTPResponseStream* ofxHTTPClient::openResponseStream(const ofxHTTPBaseReques
                 // psession will be deleted if proxy is redirected
                 if (!pSession) {
                     
-                    pSession = new HTTPClientSession(uri.getHost(), uri.getPort());
-                    
-                    ofLogVerbose("ofxHTTPClient::open") << "New session created - host: " << pSession->getHost() << " port: " << pSession->getPort();
+                    if(sessionSettings.hasUnixSocketPath()) {
+                        // local services talk over a unix socket, proxies don't apply.
+                        string unixSocketPath = sessionSettings.getUnixSocketPath();
+                        pSession = new HTTPClientSession(ofxUnixSocket::connect(unixSocketPath));
+                        
+                        ofLogVerbose("ofxHTTPClient::open") << "New session created - unix socket: " << unixSocketPath;
+                    } else {
+                        pSession = new HTTPClientSession(uri.getHost(), uri.getPort());
+                        
+                        ofLogVerbose("ofxHTTPClient::open") << "New session created - host: " << pSession->getHost() << " port: " << pSession->getPort();
+                    }
                     
-                    if(sessionSettings.isProxyEnabled()) {
+                    if(sessionSettings.isProxyEnabled() && !sessionSettings.hasUnixSocketPath()) {
                         if(redirectedProxyUri.empty()) {
                             ofLogVerbose("ofxHTTPClient::open") << "Using proxy " << sessionSettings.getProxyHost() << " @ " << sessionSettings.getProxyPort();
 
@@ -80,6 +88,11 @@ ofxHTTPResponseStream* ofxHTTPClient::openResponseStream(const ofxHTTPBaseReques
                 
                 HTTPRequest pRequest(request.getMethod(), path, request.getVersion());
                 
+                if(sessionSettings.hasUnixSocketPath()) {
+                    // the session has no host of its own to send
+                    pRequest.setHost(uri.getHost(), uri.getPort());
+                }
+                
                 // apply defaults from the session first
                 if(sessionSettings.hasDefaultHeaders()) {
                     ofLogVerbose("ofxHTTPClient::open") << "Writing default headers:";
@@ -40,6 +40,7 @@
 
 #include "ofxHTTPSessionSettings.h"
 #include "ofxHTTPStreamUtils.h"
+#include "ofxUnixSocket.h"
 
 using Poco::IOException;
 using Poco::NoThreadAvailableException;
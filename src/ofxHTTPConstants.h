@@ -25,6 +25,7 @@
 #pragma once
 
 //#define SSL_ENABLED 1// comment or uncomment depending on if you have ssl libs included
+//#define IO_URING_ENABLED 1 // uncomment to write files through io_uring (Linux 5.6+, link liburing)
 
 enum ofxHTTPAuthType {
     BASIC,
@@ -0,0 +1,382 @@
+#include "ofxHTTPFileSink.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+
+#include "Poco/AutoPtr.h"
+#include "Poco/SingletonHolder.h"
+
+#include "ofUtils.h"
+
+#ifdef TARGET_WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef IO_URING_ENABLED
+#include "ofxHTTPIOUringFileSink.h"
+#endif
+
+namespace {
+
+    //--------------------------------------------------------------------------
+    int openFile(const string& path, bool bAppend) {
+#ifdef TARGET_WIN32
+        return ::_open(path.c_str(), _O_WRONLY | _O_CREAT | (bAppend ? 0 : _O_TRUNC) | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        return ::open(path.c_str(), O_WRONLY | O_CREAT | (bAppend ? 0 : O_TRUNC), 0644);
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    long long fileSize(int fd) {
+#ifdef TARGET_WIN32
+        return ::_lseeki64(fd, 0, SEEK_END);
+#else
+        return ::lseek(fd, 0, SEEK_END);
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    void closeFile(int fd) {
+#ifdef TARGET_WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    bool syncFile(int fd) {
+#ifdef TARGET_WIN32
+        return ::_commit(fd) == 0;
+#else
+        return ::fsync(fd) == 0;
+#endif
+    }
+
+#ifdef TARGET_WIN32
+    ofMutex seekMutex; // there is no pwrite
+#endif
+
+    //--------------------------------------------------------------------------
+    bool writeAt(int fd, const char* buffer, size_t length, unsigned long long offset) {
+        while(length > 0) {
+#ifdef TARGET_WIN32
+            int result;
+            {
+                ofScopedLock lock(seekMutex);
+                ::_lseeki64(fd, offset, SEEK_SET);
+                result = ::_write(fd, buffer, static_cast<unsigned int>(length));
+            }
+#else
+            ssize_t result = ::pwrite(fd, buffer, length, static_cast<off_t>(offset));
+            if(result < 0 && errno == EINTR) {
+                continue;
+            }
+#endif
+            if(result <= 0) {
+                return false;
+            }
+            buffer += result;
+            length -= result;
+            offset += result;
+        }
+        return true;
+    }
+
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPFileSink::Settings::Settings() {
+    numBuffers   = 4;
+    bSyncOnClose = false;
+    bUseIOUring  = true;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPFileSink::ofxHTTPFileSink(ofxHTTPBufferPool& _pool, const Settings& _settings) :
+pool(_pool),
+settings(_settings),
+startOffset(0),
+numBytesQueued(0)
+{
+    if(settings.numBuffers < 1) {
+        settings.numBuffers = 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPFileSink::~ofxHTTPFileSink() {
+    releaseBuffers();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPFileSink::hasError() const {
+    ofScopedLock lock(mutex);
+    return !error.empty();
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPFileSink::getError() const {
+    ofScopedLock lock(mutex);
+    return error;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPFileSink::getBufferSize() const {
+    return pool.getBufferSize();
+}
+
+//------------------------------------------------------------------------------
+unsigned long long ofxHTTPFileSink::getNumBytesQueued() const {
+    ofScopedLock lock(mutex);
+    return numBytesQueued;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPFileSink::Ptr ofxHTTPFileSink::Instance(ofxHTTPBufferPool& pool, const Settings& settings) {
+#ifdef IO_URING_ENABLED
+    if(settings.bUseIOUring) {
+        Ptr sink(new ofxHTTPIOUringFileSink(pool, settings));
+        if(static_cast<ofxHTTPIOUringFileSink*>(sink.get())->isAvailable()) {
+            return sink;
+        }
+    }
+#endif
+    return Ptr(new ofxHTTPThreadedFileSink(pool, settings));
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPFileSink::acquireBuffers() {
+    // called with the mutex held
+    while(buffers.size() < settings.numBuffers) {
+        char* buffer = pool.acquire();
+        buffers.push_back(buffer);
+        freeBuffers.push_back(buffer);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPFileSink::releaseBuffers() {
+    // called with the mutex held, once no writes are pending
+    vector<char*>::iterator iter = buffers.begin();
+    while(iter != buffers.end()) {
+        pool.release(*iter);
+        ++iter;
+    }
+    buffers.clear();
+    freeBuffers.clear();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPFileSink::setError(const string& _error) {
+    // called with the mutex held, the first error wins
+    if(error.empty()) {
+        error = _error;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPThreadedFileSink::ofxHTTPThreadedFileSink(ofxHTTPBufferPool& _pool, const Settings& _settings) :
+ofxHTTPFileSink(_pool, _settings),
+fd(-1),
+numPendingWrites(0)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPThreadedFileSink::~ofxHTTPThreadedFileSink() {
+    if(isOpen()) {
+        close();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPThreadedFileSink::open(const string& path, bool bAppend) {
+    ofScopedLock lock(mutex);
+
+    if(fd >= 0) {
+        setError("Sink is already open.");
+        return false;
+    }
+
+    fd = openFile(path, bAppend);
+
+    if(fd < 0) {
+        setError("Unable to open " + path + ": " + strerror(errno));
+        return false;
+    }
+
+    long long size = bAppend ? fileSize(fd) : 0;
+
+    if(size < 0) {
+        setError("Unable to seek " + path + ": " + strerror(errno));
+        closeFile(fd);
+        fd = -1;
+        return false;
+    }
+
+    error = "";
+    startOffset    = static_cast<unsigned long long>(size);
+    numBytesQueued = 0;
+    acquireBuffers();
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+char* ofxHTTPThreadedFileSink::getBuffer() {
+    ofScopedLock lock(mutex);
+
+    if(fd < 0) {
+        return NULL;
+    }
+
+    while(freeBuffers.empty()) {
+        condition.wait(mutex);
+    }
+
+    char* buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPThreadedFileSink::write(char* buffer, size_t length) {
+    ofScopedLock lock(mutex);
+
+    if(length == 0 || fd < 0 || !error.empty()) {
+        freeBuffers.push_back(buffer);
+        condition.broadcast();
+        return length == 0 && error.empty();
+    }
+
+    ++numPendingWrites;
+
+    submit(buffer, length, startOffset + numBytesQueued);
+
+    numBytesQueued += length;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPThreadedFileSink::returnBuffer(char* buffer) {
+    ofScopedLock lock(mutex);
+    freeBuffers.push_back(buffer);
+    condition.broadcast();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPThreadedFileSink::close() {
+    ofScopedLock lock(mutex);
+
+    if(fd < 0) {
+        return false;
+    }
+
+    while(numPendingWrites > 0) {
+        condition.wait(mutex);
+    }
+
+    if(settings.bSyncOnClose && error.empty()) {
+        ++numPendingWrites;
+        submit(NULL, 0, 0);
+        while(numPendingWrites > 0) {
+            condition.wait(mutex);
+        }
+    }
+
+    closeFile(fd);
+    fd = -1;
+
+    releaseBuffers();
+
+    return error.empty();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPThreadedFileSink::isOpen() const {
+    ofScopedLock lock(mutex);
+    return fd >= 0;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPThreadedFileSink::writeCompleted(char* buffer, bool bSuccess, const string& _error) {
+    ofScopedLock lock(mutex);
+
+    if(!bSuccess) {
+        setError(_error);
+    }
+
+    if(buffer != NULL) {
+        freeBuffers.push_back(buffer);
+    }
+
+    --numPendingWrites;
+    condition.broadcast();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPThreadedFileSink::submit(char* buffer, size_t length, unsigned long long offset) {
+    ofxHTTPFileWriterPool::defaultPool().enqueue(new ofxHTTPFileWriterPool::WriteNotification(this,
+                                                                                              fd,
+                                                                                              buffer,
+                                                                                              length,
+                                                                                              offset,
+                                                                                              buffer == NULL));
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPFileWriterPool::ofxHTTPFileWriterPool(int numThreads) {
+    for(int i = 0; i < numThreads; ++i) {
+        Thread* thread = new Thread("ofxHTTPFileWriterPool " + ofToString(i));
+        thread->start(*this);
+        threads.push_back(thread);
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPFileWriterPool::~ofxHTTPFileWriterPool() {
+    // one stop notification per thread
+    for(size_t i = 0; i < threads.size(); ++i) {
+        queue.enqueueNotification(new WriteNotification(NULL, -1, NULL, 0, 0, false));
+    }
+
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+        delete threads[i];
+    }
+
+    threads.clear();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPFileWriterPool::enqueue(WriteNotification* notification) {
+    queue.enqueueNotification(notification);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPFileWriterPool::run() {
+    while(true) {
+        Poco::AutoPtr<Notification> notification(queue.waitDequeueNotification());
+
+        WriteNotification* job = dynamic_cast<WriteNotification*>(notification.get());
+
+        if(job == NULL || job->sink == NULL) {
+            break;
+        }
+
+        bool bSuccess = job->bSync ? syncFile(job->fd) : writeAt(job->fd, job->buffer, job->length, job->offset);
+
+        job->sink->writeCompleted(job->buffer, bSuccess, bSuccess ? "" : strerror(errno));
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPFileWriterPool& ofxHTTPFileWriterPool::defaultPool() {
+    static Poco::SingletonHolder<ofxHTTPFileWriterPool> holder;
+    return *holder.get();
+}
@@ -0,0 +1,195 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Poco/Condition.h"
+#include "Poco/Notification.h"
+#include "Poco/NotificationQueue.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPBufferPool.h"
+#include "ofxHTTPConstants.h"
+
+using std::string;
+using std::vector;
+
+using Poco::Condition;
+using Poco::Notification;
+using Poco::NotificationQueue;
+using Poco::Runnable;
+using Poco::Thread;
+
+// A file that is written asynchronously from a small set of buffers.
+// The caller fills a buffer from getBuffer() and passes it to write(),
+// which queues it and returns immediately.  getBuffer() only blocks when
+// every buffer is still being written, which keeps network reads and disk
+// writes overlapped while bounding memory use.
+//
+//     ofxHTTPFileSink::Ptr sink = ofxHTTPFileSink::Instance(pool);
+//     sink->open(path);
+//     char* buffer = sink->getBuffer();
+//     ... fill up to sink->getBufferSize() bytes ...
+//     sink->write(buffer, numBytes);
+//     ...
+//     bool bSuccess = sink->close();
+//
+// With IO_URING_ENABLED defined, Instance() returns a sink backed by
+// io_uring where the kernel supports it, and the threaded sink otherwise.
+class ofxHTTPFileSink {
+public:
+    struct Settings;
+
+    typedef ofPtr<ofxHTTPFileSink> Ptr;
+
+    ofxHTTPFileSink(ofxHTTPBufferPool& _pool, const Settings& _settings);
+    virtual ~ofxHTTPFileSink();
+
+    // creates or truncates path.  With bAppend, existing content is kept
+    // and writes continue from the end of the file.
+    virtual bool open(const string& path, bool bAppend = false) = 0;
+
+    // blocks while all buffers are being written.  Returns NULL if the
+    // sink is not open.
+    virtual char* getBuffer() = 0;
+
+    // queues length bytes of a buffer from getBuffer() at the end of the
+    // file.  The buffer belongs to the sink again.  Returns false once any
+    // write has failed.
+    virtual bool write(char* buffer, size_t length) = 0;
+
+    // gives back a buffer from getBuffer() that won't be written
+    virtual void returnBuffer(char* buffer) = 0;
+
+    // waits for all queued writes, syncs if requested and closes the file.
+    // Returns false if any write failed.
+    virtual bool close() = 0;
+
+    virtual bool isOpen() const = 0;
+
+    bool   hasError() const;
+    string getError() const;
+
+    size_t getBufferSize() const;
+    unsigned long long getNumBytesQueued() const;
+
+    struct Settings {
+        size_t numBuffers;   // buffers in flight per file
+        bool   bSyncOnClose; // fsync before close() returns
+        bool   bUseIOUring;  // only with IO_URING_ENABLED
+
+        Settings();
+    };
+
+    static Ptr Instance(ofxHTTPBufferPool& pool, const Settings& settings = Settings());
+
+protected:
+    // called with the mutex held
+    virtual void acquireBuffers();
+    virtual void releaseBuffers();
+    void setError(const string& _error);
+
+    ofxHTTPBufferPool& pool;
+    Settings settings;
+
+    vector<char*> buffers;     // all of the buffers we hold
+    vector<char*> freeBuffers; // the ones not being filled or written
+
+    unsigned long long startOffset;    // the file size when opened for append
+    unsigned long long numBytesQueued; // since open, startOffset + this is the next write
+
+    mutable ofMutex mutex;
+    string error;
+
+};
+
+// Writes with pwrite() on a shared pool of writer threads.
+class ofxHTTPThreadedFileSink : public ofxHTTPFileSink {
+public:
+    ofxHTTPThreadedFileSink(ofxHTTPBufferPool& _pool, const Settings& _settings = Settings());
+    virtual ~ofxHTTPThreadedFileSink();
+
+    bool  open(const string& path, bool bAppend = false);
+    char* getBuffer();
+    bool  write(char* buffer, size_t length);
+    void  returnBuffer(char* buffer);
+    bool  close();
+    bool  isOpen() const;
+
+    // called by the writer threads
+    void writeCompleted(char* buffer, bool bSuccess, const string& _error);
+
+protected:
+    // queues a write of buffer at offset, or a sync if buffer is NULL, to
+    // be reported to writeCompleted().  Called with the mutex held.
+    virtual void submit(char* buffer, size_t length, unsigned long long offset);
+
+    int fd;
+    int numPendingWrites;
+    Condition condition;
+
+};
+
+// The writer threads shared by all threaded sinks.
+class ofxHTTPFileWriterPool : public Runnable {
+public:
+    class WriteNotification : public Notification {
+    public:
+        WriteNotification(ofxHTTPThreadedFileSink* _sink,
+                          int _fd,
+                          char* _buffer,
+                          size_t _length,
+                          unsigned long long _offset,
+                          bool _bSync) :
+        sink(_sink), fd(_fd), buffer(_buffer), length(_length), offset(_offset), bSync(_bSync)
+        { }
+
+        ofxHTTPThreadedFileSink* sink;
+        int fd;
+        char* buffer;  // NULL for a sync
+        size_t length;
+        unsigned long long offset;
+        bool bSync;
+    };
+
+    ofxHTTPFileWriterPool(int numThreads = 4);
+    virtual ~ofxHTTPFileWriterPool();
+
+    void enqueue(WriteNotification* notification);
+
+    void run();
+
+    static ofxHTTPFileWriterPool& defaultPool();
+
+protected:
+    NotificationQueue queue;
+    vector<Thread*> threads;
+
+};
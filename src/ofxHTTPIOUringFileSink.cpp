@@ -0,0 +1,332 @@
+#include "ofxHTTPIOUringFileSink.h"
+
+#ifdef IO_URING_ENABLED
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "Poco/SingletonHolder.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPUtils.h"
+
+namespace {
+
+    // the rings live as long as the process, one per buffer size
+    struct RingRegistry {
+        ofMutex mutex;
+        map<size_t, ofPtr<ofxHTTPIOUringFileSink::Ring> > rings;
+    };
+
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPIOUringFileSink::ofxHTTPIOUringFileSink(ofxHTTPBufferPool& _pool, const Settings& _settings) :
+ofxHTTPThreadedFileSink(_pool, _settings),
+ring(Ring::forBufferSize(_pool.getBufferSize()))
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPIOUringFileSink::~ofxHTTPIOUringFileSink() {
+    // closed here, so our buffers go back to where they came from
+    if(isOpen()) {
+        close();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPIOUringFileSink::isAvailable() const {
+    return ring != NULL && ring->isAvailable();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPIOUringFileSink::acquireBuffers() {
+    // called with the mutex held
+    while(buffers.size() < settings.numBuffers) {
+        char* buffer = ring->lendBuffer();
+        if(buffer != NULL) {
+            registeredBuffers.push_back(buffer);
+        } else {
+            buffer = pool.acquire();
+        }
+        buffers.push_back(buffer);
+        freeBuffers.push_back(buffer);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPIOUringFileSink::releaseBuffers() {
+    // called with the mutex held, once no writes are pending
+    vector<char*>::iterator iter = buffers.begin();
+    while(iter != buffers.end()) {
+        if(std::find(registeredBuffers.begin(), registeredBuffers.end(), *iter) != registeredBuffers.end()) {
+            ring->returnBuffer(*iter);
+        } else {
+            pool.release(*iter);
+        }
+        ++iter;
+    }
+    buffers.clear();
+    freeBuffers.clear();
+    registeredBuffers.clear();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPIOUringFileSink::submit(char* buffer, size_t length, unsigned long long offset) {
+    // called with the mutex held
+    if(!ring->submit(this, fd, buffer, length, offset)) {
+        setError("Unable to queue a write on the io_uring.");
+        if(buffer != NULL) {
+            freeBuffers.push_back(buffer);
+        }
+        --numPendingWrites;
+        condition.broadcast();
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPIOUringFileSink::Ring::Settings::Settings() {
+    queueDepth           = 256;
+    numRegisteredBuffers = 16;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPIOUringFileSink::Ring::Ring(size_t _bufferSize, const Settings& _settings) :
+bufferSize(_bufferSize),
+settings(_settings),
+bAvailable(false),
+bRegistered(false),
+registeredPool(_bufferSize, _settings.numRegisteredBuffers),
+numInFlight(0),
+bRunning(true)
+{
+    bAvailable = io_uring_queue_init(settings.queueDepth, &ring, 0) == 0;
+
+    if(!bAvailable) {
+        return;
+    }
+
+    for(size_t i = 0; i < settings.numRegisteredBuffers; ++i) {
+        char* buffer = registeredPool.acquire();
+
+        struct iovec iov;
+        iov.iov_base = buffer;
+        iov.iov_len  = bufferSize;
+        iovecs.push_back(iov);
+
+        indices[buffer] = static_cast<int>(i);
+        freeRegisteredBuffers.push_back(buffer);
+    }
+
+    // registered once for the life of the ring.  Fixed buffers are an
+    // optimization, plain writes work without them.
+    bRegistered = !iovecs.empty() && io_uring_register_buffers(&ring, &iovecs[0], static_cast<unsigned>(iovecs.size())) == 0;
+
+    thread.setName("ofxHTTPIOUringFileSink");
+    thread.start(*this);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPIOUringFileSink::Ring::~Ring() {
+    if(bAvailable) {
+        {
+            ofScopedLock lock(mutex);
+            bRunning = false;
+            condition.broadcast();
+
+            // a request-less nop wakes the completion thread
+            struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+            if(sqe != NULL) {
+                io_uring_prep_nop(sqe);
+                io_uring_sqe_set_data(sqe, NULL);
+                io_uring_submit(&ring);
+            }
+        }
+
+        thread.join();
+
+        if(bRegistered) {
+            io_uring_unregister_buffers(&ring);
+        }
+
+        io_uring_queue_exit(&ring);
+    }
+
+    for(size_t i = 0; i < iovecs.size(); ++i) {
+        registeredPool.release(static_cast<char*>(iovecs[i].iov_base));
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPIOUringFileSink::Ring::isAvailable() const {
+    return bAvailable;
+}
+
+//------------------------------------------------------------------------------
+char* ofxHTTPIOUringFileSink::Ring::lendBuffer() {
+    ofScopedLock lock(mutex);
+
+    if(!bRegistered || freeRegisteredBuffers.empty()) {
+        return NULL;
+    }
+
+    char* buffer = freeRegisteredBuffers.back();
+    freeRegisteredBuffers.pop_back();
+    return buffer;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPIOUringFileSink::Ring::returnBuffer(char* buffer) {
+    ofScopedLock lock(mutex);
+    freeRegisteredBuffers.push_back(buffer);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPIOUringFileSink::Ring::submit(ofxHTTPThreadedFileSink* sink,
+                                         int fd,
+                                         char* buffer,
+                                         size_t length,
+                                         unsigned long long offset) {
+    ofScopedLock lock(mutex);
+
+    // completions are only queued for as many requests as the ring holds
+    while(bRunning && numInFlight >= settings.queueDepth) {
+        condition.wait(mutex);
+    }
+
+    if(!bAvailable || !bRunning) {
+        return false;
+    }
+
+    map<char*, int>::iterator index = indices.find(buffer);
+
+    Request* request = new Request();
+    request->sink    = sink;
+    request->fd      = fd;
+    request->buffer  = buffer;
+    request->index   = bRegistered && index != indices.end() ? (*index).second : -1;
+    request->written = 0;
+    request->length  = length;
+    request->offset  = offset;
+
+    if(!prepare(request)) {
+        delete request;
+        return false;
+    }
+
+    ++numInFlight;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPIOUringFileSink::Ring::prepare(Request* request) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+
+    if(sqe == NULL) {
+        return false;
+    }
+
+    if(request->buffer == NULL) {
+        io_uring_prep_fsync(sqe, request->fd, 0);
+    } else {
+        char*    data   = request->buffer + request->written;
+        unsigned length = static_cast<unsigned>(request->length - request->written);
+        __u64    offset = request->offset + request->written;
+
+        if(request->index >= 0) {
+            io_uring_prep_write_fixed(sqe, request->fd, data, length, offset, request->index);
+        } else {
+            io_uring_prep_write(sqe, request->fd, data, length, offset);
+        }
+    }
+
+    io_uring_sqe_set_data(sqe, request);
+
+    return io_uring_submit(&ring) >= 0;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPIOUringFileSink::Ring::run() {
+    while(true) {
+        struct io_uring_cqe* cqe = NULL;
+
+        int result = io_uring_wait_cqe(&ring, &cqe);
+
+        if(result == -EINTR || result == -EAGAIN) {
+            continue;
+        }
+
+        if(result < 0) {
+            ofLogError("ofxHTTPIOUringFileSink::Ring::run") << "io_uring wait failed: " << strerror(-result);
+            break;
+        }
+
+        Request* request = static_cast<Request*>(io_uring_cqe_get_data(cqe));
+        int res = cqe->res;
+
+        io_uring_cqe_seen(&ring, cqe);
+
+        if(request == NULL) {
+            ofScopedLock lock(mutex);
+            if(!bRunning) {
+                break;
+            }
+            continue;
+        }
+
+        string error;
+
+        if(res < 0) {
+            error = string("Unable to write: ") + strerror(-res);
+        } else if(request->buffer != NULL) {
+            if(res == 0) {
+                error = "Unable to write: no progress.";
+            } else {
+                request->written += res;
+
+                if(request->written < request->length) {
+                    // a short write, queue the rest in the same slot
+                    ofScopedLock lock(mutex);
+                    if(prepare(request)) {
+                        continue;
+                    }
+                    error = "Unable to queue the rest of a short write.";
+                }
+            }
+        }
+
+        {
+            ofScopedLock lock(mutex);
+            --numInFlight;
+            condition.broadcast();
+        }
+
+        // the slot is free before the sink, which may be waiting in
+        // submit() with its own mutex held, is called
+        request->sink->writeCompleted(request->buffer, error.empty(), error);
+
+        delete request;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofPtr<ofxHTTPIOUringFileSink::Ring> ofxHTTPIOUringFileSink::Ring::forBufferSize(size_t bufferSize) {
+    static Poco::SingletonHolder<RingRegistry> holder;
+
+    RingRegistry& registry = *holder.get();
+
+    ofScopedLock lock(registry.mutex);
+
+    ofPtr<Ring>& ring = registry.rings[bufferSize];
+
+    if(ring == NULL) {
+        ring = ofPtr<Ring>(new Ring(bufferSize));
+    }
+
+    return ring;
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "ofxHTTPConstants.h"
+
+#ifdef IO_URING_ENABLED
+
+#include <map>
+#include <sys/uio.h>
+
+#include <liburing.h>
+
+#include "Poco/Condition.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+
+#include "ofxHTTPFileSink.h"
+
+using std::map;
+
+// Writes through a long-lived io_uring shared by all io_uring sinks with
+// the same buffer size.  The ring and a fixed set of its buffers are
+// registered with the kernel once, when the first such sink is created,
+// so sinks that get a registered buffer write with IORING_OP_WRITE_FIXED
+// and no file pays for setting up a ring or pinning pages.  Sinks work
+// like the threaded sink, only the writes go to the ring, whose thread
+// reports completions.  Requires liburing and Linux 5.6+.
+class ofxHTTPIOUringFileSink : public ofxHTTPThreadedFileSink {
+public:
+    class Ring;
+
+    ofxHTTPIOUringFileSink(ofxHTTPBufferPool& _pool, const Settings& _settings = Settings());
+    virtual ~ofxHTTPIOUringFileSink();
+
+    // false if the ring could not be created, e.g. on older kernels
+    bool isAvailable() const;
+
+protected:
+    void acquireBuffers();
+    void releaseBuffers();
+    void submit(char* buffer, size_t length, unsigned long long offset);
+
+    ofPtr<Ring> ring;
+
+    vector<char*> registeredBuffers; // lent by the ring, the rest come from the pool
+
+};
+
+// The ring behind ofxHTTPIOUringFileSink, one per buffer size.
+class ofxHTTPIOUringFileSink::Ring : public Poco::Runnable {
+public:
+    struct Settings {
+        unsigned queueDepth;
+        size_t numRegisteredBuffers;
+
+        Settings();
+    };
+
+    Ring(size_t _bufferSize, const Settings& _settings = Settings());
+    virtual ~Ring();
+
+    bool isAvailable() const;
+
+    // a registered buffer, or NULL if all of them are lent out
+    char* lendBuffer();
+    void  returnBuffer(char* buffer);
+
+    // returns false if the write could not be queued, otherwise the sink
+    // hears about it through writeCompleted()
+    bool submit(ofxHTTPThreadedFileSink* sink,
+                int fd,
+                char* buffer,
+                size_t length,
+                unsigned long long offset);
+
+    // the completion thread
+    void run();
+
+    static ofPtr<Ring> forBufferSize(size_t bufferSize);
+
+protected:
+    struct Request {
+        ofxHTTPThreadedFileSink* sink;
+        int fd;
+        char* buffer;  // NULL for a sync
+        int index;     // of a registered buffer, or -1
+        size_t written;
+        size_t length;
+        unsigned long long offset;
+    };
+
+    // called with the mutex held
+    bool prepare(Request* request);
+
+    size_t bufferSize;
+    Settings settings;
+
+    struct io_uring ring;
+    bool bAvailable;
+    bool bRegistered;
+
+    ofxHTTPBufferPool registeredPool;
+    vector<struct iovec> iovecs;
+    map<char*, int> indices;
+    vector<char*> freeRegisteredBuffers;
+
+    unsigned numInFlight;
+    bool bRunning;
+
+    ofMutex mutex;
+    Poco::Condition condition;
+    Poco::Thread thread;
+
+};
+
+#endif
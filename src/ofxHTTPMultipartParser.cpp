@@ -0,0 +1,207 @@
+#include "ofxHTTPMultipartParser.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "Poco/Exception.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPMultipartParser::ofxHTTPMultipartParser(const string& boundary, ofxBaseHTTPMultipartListener& _listener) :
+listener(_listener),
+state(PREAMBLE),
+dashBoundary("--" + boundary),
+delimiter("\r\n--" + boundary)
+{
+    if(boundary.empty() || boundary.size() > MAX_BOUNDARY_LENGTH) {
+        fail("Invalid multipart boundary.");
+    }
+
+    buildSkipTable(dashBoundary, dashBoundarySkip);
+    buildSkipTable(delimiter, delimiterSkip);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPMultipartParser::~ofxHTTPMultipartParser() { }
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPMultipartParser::parse(const char* data, size_t length, bool bEndOfStream) {
+    size_t position = 0;
+
+    while(state != DONE && state != FAILED) {
+        const char* current   = data + position;
+        size_t      available = length - position;
+
+        if(state == PREAMBLE) {
+            // the first boundary may come without a leading CRLF
+            size_t match = find(dashBoundary, dashBoundarySkip, current, available);
+            if(match == string::npos) {
+                // the preamble is ignored, keep only a possible partial match
+                if(available >= dashBoundary.size()) {
+                    position += available - (dashBoundary.size() - 1);
+                }
+                break;
+            }
+            position += match + dashBoundary.size();
+            state = BOUNDARY;
+        } else if(state == BOUNDARY) {
+            // either "--" for the close delimiter, or transport padding and CRLF
+            if(available >= 2 && current[0] == '-' && current[1] == '-') {
+                position += 2;
+                state = DONE;
+                break;
+            }
+
+            const char* lineEnd = NULL;
+            for(size_t i = 0; i + 1 < available; ++i) {
+                if(current[i] == '\r' && current[i + 1] == '\n') {
+                    lineEnd = current + i;
+                    break;
+                } else if(current[i] != ' ' && current[i] != '\t') {
+                    fail("Malformed multipart boundary line.");
+                    return position;
+                }
+            }
+
+            if(lineEnd == NULL) {
+                if(available > 256) fail("Malformed multipart boundary line.");
+                break;
+            }
+
+            position += (lineEnd - current) + 2;
+            state = HEADERS;
+        } else if(state == HEADERS) {
+            size_t headerLength = string::npos;
+
+            if(available >= 2 && current[0] == '\r' && current[1] == '\n') {
+                headerLength = 2; // a part without headers
+            } else {
+                static const string HEADER_END("\r\n\r\n");
+                const char* end = std::search(current, current + available, HEADER_END.begin(), HEADER_END.end());
+                if(end != current + available) {
+                    headerLength = (end - current) + HEADER_END.size();
+                }
+            }
+
+            if(headerLength == string::npos) {
+                break; // wait for the rest of the header block
+            }
+
+            MessageHeader header;
+
+            try {
+                std::istringstream headerStream(string(current, headerLength));
+                header.read(headerStream);
+            } catch(const Poco::Exception& exc) {
+                fail("Malformed multipart header: " + exc.displayText());
+                return position;
+            }
+
+            position += headerLength;
+            state = BODY;
+
+            if(!listener.onPartBegin(header)) {
+                fail("Part rejected.");
+                return position;
+            }
+        } else if(state == BODY) {
+            size_t match = find(delimiter, delimiterSkip, current, available);
+
+            if(match == string::npos) {
+                // everything but a possible partial delimiter is body
+                if(available >= delimiter.size()) {
+                    size_t safe = available - (delimiter.size() - 1);
+                    position += safe;
+                    if(!listener.onPartData(current, safe)) {
+                        fail("Part data rejected.");
+                    }
+                }
+                break;
+            }
+
+            position += match + delimiter.size();
+
+            if(match > 0 && !listener.onPartData(current, match)) {
+                fail("Part data rejected.");
+                return position;
+            }
+
+            state = BOUNDARY;
+
+            if(!listener.onPartEnd()) {
+                fail("Part rejected.");
+                return position;
+            }
+        }
+    }
+
+    if(bEndOfStream && state != DONE && state != FAILED) {
+        fail("Unexpected end of multipart stream.");
+    }
+
+    // the epilogue, if any, is ignored
+    if(state == DONE) {
+        position = length;
+    }
+
+    return position;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPMultipartParser::State ofxHTTPMultipartParser::getState() const {
+    return state;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPMultipartParser::isDone() const {
+    return state == DONE;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPMultipartParser::hasError() const {
+    return state == FAILED;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPMultipartParser::getError() const {
+    return error;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPMultipartParser::find(const string& pattern, const size_t* skip, const char* data, size_t length) const {
+    size_t patternLength = pattern.size();
+
+    if(patternLength == 0 || length < patternLength) {
+        return string::npos;
+    }
+
+    const char* p    = pattern.data();
+    size_t      last = patternLength - 1;
+    size_t      i    = 0;
+
+    while(i <= length - patternLength) {
+        size_t j = last;
+        while(data[i + j] == p[j]) {
+            if(j == 0) return i;
+            --j;
+        }
+        i += skip[static_cast<unsigned char>(data[i + last])];
+    }
+
+    return string::npos;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPMultipartParser::buildSkipTable(const string& pattern, size_t* skip) const {
+    for(size_t i = 0; i < 256; ++i) {
+        skip[i] = pattern.size();
+    }
+    for(size_t i = 0; i + 1 < pattern.size(); ++i) {
+        skip[static_cast<unsigned char>(pattern[i])] = pattern.size() - 1 - i;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPMultipartParser::fail(const string& _error) {
+    state = FAILED;
+    error = _error;
+}
@@ -0,0 +1,106 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "Poco/Net/MessageHeader.h"
+
+using std::string;
+
+using Poco::Net::MessageHeader;
+
+class ofxBaseHTTPMultipartListener {
+public:
+    ofxBaseHTTPMultipartListener() { }
+    virtual ~ofxBaseHTTPMultipartListener() { }
+
+    // returning false from any callback stops the parser
+    virtual bool onPartBegin(const MessageHeader& header) = 0;
+    virtual bool onPartData(const char* data, size_t length) = 0;
+    virtual bool onPartEnd() = 0;
+};
+
+// An incremental multipart (RFC 2046) parser.  The caller feeds it whatever
+// it has read so far; part bodies are passed to the listener straight from
+// the caller's buffer, so nothing but the header blocks is ever copied.
+//
+//     size_t fill = 0;
+//     while(!parser.isDone()) {
+//         fill += read(buffer + fill, size - fill);
+//         size_t consumed = parser.parse(buffer, fill, bEndOfStream);
+//         memmove(buffer, buffer + consumed, fill - consumed);
+//         fill -= consumed;
+//     }
+//
+// Bytes that are not consumed (a possible partial delimiter, or an
+// incomplete header block) must be passed again at the front of the next
+// call.  A header block must fit in the caller's buffer.
+class ofxHTTPMultipartParser {
+public:
+    enum State {
+        PREAMBLE,
+        BOUNDARY,
+        HEADERS,
+        BODY,
+        DONE,
+        FAILED
+    };
+
+    ofxHTTPMultipartParser(const string& boundary, ofxBaseHTTPMultipartListener& _listener);
+    virtual ~ofxHTTPMultipartParser();
+
+    // returns the number of bytes consumed.  If bEndOfStream is true and
+    // the final delimiter has not been seen, the parser fails.
+    size_t parse(const char* data, size_t length, bool bEndOfStream = false);
+
+    State getState() const;
+    bool  isDone() const;   // true after the final delimiter
+    bool  hasError() const; // malformed input, or a listener said stop
+    string getError() const;
+
+    enum {
+        MAX_BOUNDARY_LENGTH = 70 // RFC 2046
+    };
+
+protected:
+    // Boyer-Moore-Horspool search for the delimiter in data[0, length)
+    size_t find(const string& pattern, const size_t* skip, const char* data, size_t length) const;
+    void   buildSkipTable(const string& pattern, size_t* skip) const;
+
+    void fail(const string& _error);
+
+    ofxBaseHTTPMultipartListener& listener;
+
+    State  state;
+    string error;
+
+    string dashBoundary; // --boundary
+    string delimiter;    // \r\n--boundary
+
+    size_t dashBoundarySkip[256];
+    size_t delimiterSkip[256];
+
+};
@@ -0,0 +1,233 @@
+#include "ofxHTTPPasswordHash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Poco/DigestEngine.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/NumberParser.h"
+#include "Poco/RandomStream.h"
+#include "Poco/Types.h"
+
+#include "ofxHTTPSHA256Engine.h"
+
+using std::vector;
+
+using Poco::DigestEngine;
+
+namespace {
+
+    const string SCHEME = "pbkdf2-sha256";
+
+    //--------------------------------------------------------------------------
+    string toHex(const string& bytes) {
+        static const char* digits = "0123456789abcdef";
+        string hex;
+        hex.reserve(bytes.size() * 2);
+        for(size_t i = 0; i < bytes.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(bytes[i]);
+            hex += digits[c >> 4];
+            hex += digits[c & 0x0F];
+        }
+        return hex;
+    }
+
+    //--------------------------------------------------------------------------
+    int hexValue(char c) {
+        if(c >= '0' && c <= '9') return c - '0';
+        if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    //--------------------------------------------------------------------------
+    bool fromHex(const string& hex, string& bytes) {
+        if(hex.empty() || hex.size() % 2 != 0) {
+            return false;
+        }
+        bytes.resize(hex.size() / 2);
+        for(size_t i = 0; i < bytes.size(); ++i) {
+            int high = hexValue(hex[i * 2]);
+            int low  = hexValue(hex[i * 2 + 1]);
+            if(high < 0 || low < 0) {
+                return false;
+            }
+            bytes[i] = static_cast<char>((high << 4) | low);
+        }
+        return true;
+    }
+
+    // HMAC-SHA256 with the padded keys hashed once, since PBKDF2 runs
+    // the same key through it many thousands of times.
+    class HMACSHA256 {
+    public:
+        HMACSHA256(const string& key) {
+            unsigned char block[ofxHTTPSHA256Engine::BLOCK_SIZE];
+            memset(block, 0, sizeof(block));
+
+            if(key.size() > ofxHTTPSHA256Engine::BLOCK_SIZE) {
+                ofxHTTPSHA256Engine engine;
+                engine.update(key.data(), key.size());
+                const DigestEngine::Digest& digest = engine.digest();
+                std::copy(digest.begin(), digest.end(), block);
+            } else {
+                std::copy(key.begin(), key.end(), block);
+            }
+
+            for(size_t i = 0; i < sizeof(block); ++i) {
+                innerPad[i] = block[i] ^ 0x36;
+                outerPad[i] = block[i] ^ 0x5C;
+            }
+        }
+
+        void compute(const unsigned char* data, size_t length, unsigned char* result) {
+            inner.update(innerPad, sizeof(innerPad));
+            inner.update(data, length);
+            const DigestEngine::Digest& innerDigest = inner.digest();
+            std::copy(innerDigest.begin(), innerDigest.end(), result);
+
+            outer.update(outerPad, sizeof(outerPad));
+            outer.update(result, ofxHTTPSHA256Engine::DIGEST_SIZE);
+            const DigestEngine::Digest& outerDigest = outer.digest();
+            std::copy(outerDigest.begin(), outerDigest.end(), result);
+        }
+
+    private:
+        unsigned char innerPad[ofxHTTPSHA256Engine::BLOCK_SIZE];
+        unsigned char outerPad[ofxHTTPSHA256Engine::BLOCK_SIZE];
+        ofxHTTPSHA256Engine inner;
+        ofxHTTPSHA256Engine outer;
+    };
+
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPPasswordHash::Settings::Settings() {
+    iterations = 100000;
+    saltLength = 16;
+    hashLength = 32;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPPasswordHash::hash(const string& password, const Settings& settings) {
+    string salt(settings.saltLength, '\0');
+    Poco::RandomInputStream random;
+    random.read(&salt[0], salt.size());
+
+    unsigned iterations = settings.iterations > 0 ? settings.iterations : 1;
+
+    return SCHEME + "$" +
+           Poco::NumberFormatter::format(iterations) + "$" +
+           toHex(salt) + "$" +
+           toHex(pbkdf2(password, salt, iterations, settings.hashLength));
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPPasswordHash::verify(const string& password, const string& encodedHash) {
+    unsigned iterations = 0;
+    string salt;
+    string expected;
+
+    if(!decode(encodedHash, iterations, salt, expected)) {
+        return false;
+    }
+
+    return constantTimeEquals(pbkdf2(password, salt, iterations, expected.size()), expected);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPPasswordHash::isValid(const string& encodedHash) {
+    unsigned iterations = 0;
+    string salt;
+    string hash;
+    return decode(encodedHash, iterations, salt, hash);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPPasswordHash::getSettings(const string& encodedHash, Settings& settings) {
+    unsigned iterations = 0;
+    string salt;
+    string hash;
+
+    if(!decode(encodedHash, iterations, salt, hash)) {
+        return false;
+    }
+
+    settings.iterations = iterations;
+    settings.saltLength = salt.size();
+    settings.hashLength = hash.size();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPPasswordHash::constantTimeEquals(const string& a, const string& b) {
+    if(a.size() != b.size()) {
+        return false;
+    }
+
+    unsigned char difference = 0;
+    for(size_t i = 0; i < a.size(); ++i) {
+        difference |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return difference == 0;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPPasswordHash::pbkdf2(const string& password,
+                                   const string& salt,
+                                   unsigned iterations,
+                                   size_t length) {
+    const size_t digestSize = ofxHTTPSHA256Engine::DIGEST_SIZE;
+
+    HMACSHA256 hmac(password);
+
+    string result;
+    result.reserve(length);
+
+    vector<unsigned char> message(salt.begin(), salt.end());
+    message.resize(salt.size() + 4);
+
+    unsigned char u[digestSize];
+    unsigned char t[digestSize];
+
+    for(Poco::UInt32 block = 1; result.size() < length; ++block) {
+        message[salt.size()    ] = static_cast<unsigned char>(block >> 24);
+        message[salt.size() + 1] = static_cast<unsigned char>(block >> 16);
+        message[salt.size() + 2] = static_cast<unsigned char>(block >> 8);
+        message[salt.size() + 3] = static_cast<unsigned char>(block);
+
+        hmac.compute(&message[0], message.size(), u);
+        std::copy(u, u + digestSize, t);
+
+        for(unsigned i = 1; i < iterations; ++i) {
+            hmac.compute(u, digestSize, u);
+            for(size_t j = 0; j < digestSize; ++j) {
+                t[j] ^= u[j];
+            }
+        }
+
+        result.append(reinterpret_cast<const char*>(t), std::min(digestSize, length - result.size()));
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPPasswordHash::decode(const string& encodedHash,
+                                 unsigned& iterations,
+                                 string& salt,
+                                 string& hash) {
+    size_t first  = encodedHash.find('$');
+    size_t second = first  == string::npos ? string::npos : encodedHash.find('$', first + 1);
+    size_t third  = second == string::npos ? string::npos : encodedHash.find('$', second + 1);
+
+    if(third == string::npos || encodedHash.substr(0, first) != SCHEME) {
+        return false;
+    }
+
+    return Poco::NumberParser::tryParseUnsigned(encodedHash.substr(first + 1, second - first - 1), iterations) &&
+           iterations > 0 &&
+           fromHex(encodedHash.substr(second + 1, third - second - 1), salt) &&
+           fromHex(encodedHash.substr(third + 1), hash);
+}
@@ -0,0 +1,77 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+using std::string;
+
+// Salted, deliberately slow password hashes for stored credentials.
+//
+// Hashes are PBKDF2-HMAC-SHA256, encoded as
+//
+//     pbkdf2-sha256$<iterations>$<salt hex>$<hash hex>
+//
+// so the cost can be raised later without invalidating existing hashes.
+//
+//     string stored = ofxHTTPPasswordHash::hash("secret");
+//     bool bValid   = ofxHTTPPasswordHash::verify("secret", stored);
+class ofxHTTPPasswordHash {
+public:
+    struct Settings {
+        unsigned iterations;
+        size_t saltLength;   // in bytes
+        size_t hashLength;   // in bytes
+
+        Settings();
+    };
+
+    static string hash(const string& password, const Settings& settings = Settings());
+
+    // false for a wrong password as well as for a malformed hash
+    static bool verify(const string& password, const string& encodedHash);
+
+    static bool isValid(const string& encodedHash);
+
+    // the settings a hash was made with, so another hash of the same
+    // cost can be made
+    static bool getSettings(const string& encodedHash, Settings& settings);
+
+    // compares in time that depends only on the lengths
+    static bool constantTimeEquals(const string& a, const string& b);
+
+    // the raw derived key
+    static string pbkdf2(const string& password,
+                         const string& salt,
+                         unsigned iterations,
+                         size_t length);
+
+protected:
+    static bool decode(const string& encodedHash,
+                       unsigned& iterations,
+                       string& salt,
+                       string& hash);
+
+};
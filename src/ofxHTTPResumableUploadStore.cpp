@@ -0,0 +1,369 @@
+#include "ofxHTTPResumableUploadStore.h"
+
+#include <cctype>
+#include <fstream>
+
+#include "Poco/DigestEngine.h"
+#include "Poco/DirectoryIterator.h"
+#include "Poco/Exception.h"
+#include "Poco/File.h"
+#include "Poco/NumberParser.h"
+#include "Poco/RandomStream.h"
+#include "Poco/Net/MessageHeader.h"
+
+#include "ofLog.h"
+#include "ofUtils.h"
+
+using Poco::Exception;
+using Poco::Net::MessageHeader;
+
+namespace {
+
+    const string DATA_EXTENSION = "bin";
+    const string INFO_EXTENSION = "info";
+
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPResumableUploadStore::Settings::Settings() {
+    folder        = "uploads/.resumable";
+    expiry        = Timespan(1, 0, 0, 0, 0); // 1 day
+    purgeInterval = Timespan(0, 0, 1, 0, 0); // 1 minute
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPResumableUploadStore::ofxHTTPResumableUploadStore(const Settings& _settings) :
+settings(_settings)
+{
+    settings.folder = ofToDataPath(settings.folder, true);
+
+    try {
+        Poco::File(settings.folder).createDirectories();
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPResumableUploadStore::ofxHTTPResumableUploadStore") << exc.displayText();
+    }
+
+    restore();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPResumableUploadStore::~ofxHTTPResumableUploadStore() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPResumableUploadStore::restore() {
+    ofScopedLock lock(mutex);
+
+    try {
+        Poco::DirectoryIterator iter(settings.folder);
+        Poco::DirectoryIterator end;
+
+        while(iter != end) {
+            Path path(iter.path());
+
+            if(path.getExtension() == INFO_EXTENSION && isValidId(path.getBaseName())) {
+                string id = path.getBaseName();
+                ofxHTTPResumableUploadInfo info;
+
+                if(readInfo(id, info) && !isExpired(info)) {
+                    uploads[id] = info;
+                } else {
+                    removeFiles(id);
+                }
+            }
+
+            ++iter;
+        }
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPResumableUploadStore::restore") << exc.displayText();
+    }
+
+    lastPurge.update();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::create(unsigned long long length, const string& metadata, ofxHTTPResumableUploadInfo& info) {
+    purgeExpired();
+
+    ofScopedLock lock(mutex);
+
+    info = ofxHTTPResumableUploadInfo();
+    info.id       = makeId();
+    info.length   = length;
+    info.metadata = metadata;
+    info.expires  = Timestamp() + settings.expiry;
+
+    try {
+        Poco::File(getDataPath(info.id)).createFile();
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPResumableUploadStore::create") << exc.displayText();
+        return false;
+    }
+
+    if(!writeInfo(info)) {
+        removeFiles(info.id);
+        return false;
+    }
+
+    uploads[info.id] = info;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::get(const string& id, ofxHTTPResumableUploadInfo& info) {
+    purgeExpired();
+
+    ofScopedLock lock(mutex);
+
+    map<string, ofxHTTPResumableUploadInfo>::iterator iter = uploads.find(id);
+
+    if(iter == uploads.end() || isExpired((*iter).second)) {
+        return false;
+    }
+
+    info = (*iter).second;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::lock(const string& id, ofxHTTPResumableUploadInfo& info) {
+    ofScopedLock lock(mutex);
+
+    map<string, ofxHTTPResumableUploadInfo>::iterator iter = uploads.find(id);
+
+    if(iter == uploads.end() || isExpired((*iter).second) || (*iter).second.bLocked) {
+        return false;
+    }
+
+    (*iter).second.bLocked = true;
+    info = (*iter).second;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPResumableUploadStore::unlock(const string& id) {
+    ofScopedLock lock(mutex);
+
+    map<string, ofxHTTPResumableUploadInfo>::iterator iter = uploads.find(id);
+
+    if(iter != uploads.end()) {
+        (*iter).second.bLocked = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::commit(const string& id, unsigned long long offset) {
+    ofScopedLock lock(mutex);
+
+    map<string, ofxHTTPResumableUploadInfo>::iterator iter = uploads.find(id);
+
+    if(iter == uploads.end()) {
+        return false;
+    }
+
+    (*iter).second.offset  = offset;
+    (*iter).second.expires = Timestamp() + settings.expiry;
+
+    return writeInfo((*iter).second);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::complete(const string& id, const string& fileName) {
+    ofScopedLock lock(mutex);
+
+    map<string, ofxHTTPResumableUploadInfo>::iterator iter = uploads.find(id);
+
+    if(iter == uploads.end()) {
+        return false;
+    }
+
+    (*iter).second.bComplete = true;
+    (*iter).second.fileName  = fileName;
+
+    return writeInfo((*iter).second);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::remove(const string& id) {
+    ofScopedLock lock(mutex);
+
+    map<string, ofxHTTPResumableUploadInfo>::iterator iter = uploads.find(id);
+
+    if(iter == uploads.end() || (*iter).second.bLocked) {
+        return false;
+    }
+
+    // a completed upload's data already lives at its file name
+    removeFiles(id);
+    uploads.erase(iter);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPResumableUploadStore::purgeExpired(bool bForce) {
+    ofScopedLock lock(mutex);
+
+    if(!bForce && !lastPurge.isElapsed(settings.purgeInterval.totalMicroseconds())) {
+        return 0;
+    }
+
+    lastPurge.update();
+
+    size_t numPurged = 0;
+
+    map<string, ofxHTTPResumableUploadInfo>::iterator iter = uploads.begin();
+
+    while(iter != uploads.end()) {
+        if(!(*iter).second.bLocked && isExpired((*iter).second)) {
+            removeFiles((*iter).first);
+            uploads.erase(iter++);
+            ++numPurged;
+        } else {
+            ++iter;
+        }
+    }
+
+    return numPurged;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPResumableUploadStore::getDataPath(const string& id) const {
+    Path path(settings.folder, id);
+    path.setExtension(DATA_EXTENSION);
+    return path.toString();
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPResumableUploadStore::getInfoPath(const string& id) const {
+    Path path(settings.folder, id);
+    path.setExtension(INFO_EXTENSION);
+    return path.toString();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::writeInfo(const ofxHTTPResumableUploadInfo& info) {
+    MessageHeader header;
+    header.set("Upload-Length",   ofToString(info.length));
+    header.set("Upload-Offset",   ofToString(info.offset));
+    header.set("Upload-Expires",  ofToString(info.expires.epochMicroseconds()));
+    header.set("Upload-Complete", info.bComplete ? "true" : "false");
+
+    if(!info.metadata.empty()) {
+        header.set("Upload-Metadata", info.metadata);
+    }
+
+    if(!info.fileName.empty()) {
+        header.set("File-Name", info.fileName);
+    }
+
+    // write and rename, so a crash never leaves a torn info file
+    string infoPath = getInfoPath(info.id);
+    string tempPath = infoPath + ".tmp";
+
+    try {
+        {
+            std::ofstream ostr(tempPath.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+            header.write(ostr);
+            ostr.flush();
+            if(!ostr) {
+                throw Poco::WriteFileException(tempPath);
+            }
+        }
+        Poco::File(tempPath).renameTo(infoPath);
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPResumableUploadStore::writeInfo") << exc.displayText();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::readInfo(const string& id, ofxHTTPResumableUploadInfo& info) {
+    try {
+        MessageHeader header;
+
+        std::ifstream istr(getInfoPath(id).c_str(), std::ios::in | std::ios::binary);
+        header.read(istr);
+
+        info = ofxHTTPResumableUploadInfo();
+        info.id        = id;
+        info.length    = Poco::NumberParser::parseUnsigned64(header.get("Upload-Length"));
+        info.offset    = Poco::NumberParser::parseUnsigned64(header.get("Upload-Offset"));
+        info.expires   = Timestamp(Poco::NumberParser::parse64(header.get("Upload-Expires")));
+        info.bComplete = header.get("Upload-Complete", "false") == "true";
+        info.metadata  = header.get("Upload-Metadata", "");
+        info.fileName  = header.get("File-Name", "");
+
+        if(!info.bComplete) {
+            Poco::File dataFile(getDataPath(id));
+
+            // chunks are written asynchronously, so anything past the last
+            // committed offset may have holes in it.  Drop it, the client
+            // will send it again.
+            if(dataFile.getSize() < info.offset) {
+                info.offset = dataFile.getSize();
+            } else if(dataFile.getSize() > info.offset) {
+                dataFile.setSize(info.offset);
+            }
+        }
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPResumableUploadStore::readInfo") << id << ": " << exc.displayText();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPResumableUploadStore::removeFiles(const string& id) {
+    string paths[2] = { getDataPath(id), getInfoPath(id) };
+
+    for(int i = 0; i < 2; ++i) {
+        try {
+            Poco::File file(paths[i]);
+            if(file.exists()) {
+                file.remove();
+            }
+        } catch(const Exception& exc) {
+            ofLogError("ofxHTTPResumableUploadStore::removeFiles") << exc.displayText();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::isExpired(const ofxHTTPResumableUploadInfo& info) const {
+    return info.expires < Timestamp();
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPResumableUploadStore::makeId() {
+    // 128 bits from the system's random source, so ids can't be guessed
+    Poco::DigestEngine::Digest bytes(16);
+    Poco::RandomInputStream random;
+    random.read(reinterpret_cast<char*>(&bytes[0]), static_cast<std::streamsize>(bytes.size()));
+    return Poco::DigestEngine::digestToHex(bytes);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPResumableUploadStore::isValidId(const string& id) {
+    if(id.size() != 32) {
+        return false;
+    }
+
+    for(size_t i = 0; i < id.size(); ++i) {
+        if(!isxdigit(static_cast<unsigned char>(id[i]))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPResumableUploadStore::Ptr ofxHTTPResumableUploadStore::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPResumableUploadStore(settings));
+}
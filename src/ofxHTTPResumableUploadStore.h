@@ -0,0 +1,135 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Poco/Path.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+
+#include "ofTypes.h"
+
+using std::map;
+using std::string;
+
+using Poco::Path;
+using Poco::Timespan;
+using Poco::Timestamp;
+
+// What the store knows about a resumable upload.
+class ofxHTTPResumableUploadInfo {
+public:
+    ofxHTTPResumableUploadInfo() :
+    length(0),
+    offset(0),
+    bComplete(false),
+    bLocked(false)
+    { }
+
+    string id;
+    unsigned long long length;   // announced by the client
+    unsigned long long offset;   // bytes committed so far
+    string metadata;             // the raw Upload-Metadata header
+    Timestamp expires;           // pushed back by every request
+    bool bComplete;
+    string fileName;             // where it was stored, once complete
+    bool bLocked;                // a PATCH is appending to it
+};
+
+// Keeps track of resumable uploads and their data.  Every upload has a
+// data file that chunks are appended to and an info file that records its
+// length, metadata and committed offset, so uploads survive a server
+// restart.  Uploads that see no requests until they expire are deleted.
+//
+// All methods are thread safe.
+class ofxHTTPResumableUploadStore {
+public:
+    struct Settings;
+
+    typedef ofPtr<ofxHTTPResumableUploadStore> Ptr;
+
+    ofxHTTPResumableUploadStore(const Settings& _settings);
+    virtual ~ofxHTTPResumableUploadStore();
+
+    // reads the info files left by a previous run
+    void restore();
+
+    // creates an upload with an empty data file
+    bool create(unsigned long long length, const string& metadata, ofxHTTPResumableUploadInfo& info);
+
+    // returns false if the upload doesn't exist or has expired
+    bool get(const string& id, ofxHTTPResumableUploadInfo& info);
+
+    // only one request may append to an upload at a time.  lock returns
+    // false if the upload doesn't exist or is already locked.
+    bool lock(const string& id, ofxHTTPResumableUploadInfo& info);
+    void unlock(const string& id);
+
+    // records the bytes that were appended and are known to be on disk
+    bool commit(const string& id, unsigned long long offset);
+
+    // records that the data file was moved to fileName
+    bool complete(const string& id, const string& fileName);
+
+    bool remove(const string& id);
+
+    // deletes uploads that have expired, at most once per purgeInterval
+    size_t purgeExpired(bool bForce = false);
+
+    string getDataPath(const string& id) const;
+
+    struct Settings {
+        string folder;            // for data and info files, relative to the data folder
+        Timespan expiry;          // how long an upload may go without requests
+        Timespan purgeInterval;
+
+        Settings();
+    };
+
+    static Ptr Instance(const Settings& settings = Settings());
+
+protected:
+    string getInfoPath(const string& id) const;
+
+    // all calls are expected to hold the mutex
+    bool writeInfo(const ofxHTTPResumableUploadInfo& info);
+    bool readInfo(const string& id, ofxHTTPResumableUploadInfo& info);
+    void removeFiles(const string& id);
+    bool isExpired(const ofxHTTPResumableUploadInfo& info) const;
+
+    static string makeId();
+    static bool isValidId(const string& id);
+
+    Settings settings;
+
+    map<string, ofxHTTPResumableUploadInfo> uploads;
+
+    Timestamp lastPurge;
+
+    mutable ofMutex mutex;
+
+};
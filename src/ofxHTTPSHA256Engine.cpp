@@ -0,0 +1,174 @@
+#include "ofxHTTPSHA256Engine.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+    const UInt32 K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    //--------------------------------------------------------------------------
+    inline UInt32 rotr(UInt32 x, int n) {
+        return (x >> n) | (x << (32 - n));
+    }
+
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPSHA256Engine::ofxHTTPSHA256Engine() {
+    reset();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPSHA256Engine::~ofxHTTPSHA256Engine() {
+    reset();
+}
+
+//------------------------------------------------------------------------------
+unsigned ofxHTTPSHA256Engine::digestLength() const {
+    return DIGEST_SIZE;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPSHA256Engine::reset() {
+    state[0] = 0x6a09e667;
+    state[1] = 0xbb67ae85;
+    state[2] = 0x3c6ef372;
+    state[3] = 0xa54ff53a;
+    state[4] = 0x510e527f;
+    state[5] = 0x9b05688c;
+    state[6] = 0x1f83d9ab;
+    state[7] = 0x5be0cd19;
+    numBytes   = 0;
+    bufferFill = 0;
+    memset(buffer, 0, sizeof(buffer));
+}
+
+//------------------------------------------------------------------------------
+const DigestEngine::Digest& ofxHTTPSHA256Engine::digest() {
+    UInt64 numBits = numBytes * 8;
+
+    // pad with a single 1 bit, zeros and the message length in bits
+    unsigned char padding[BLOCK_SIZE + 8];
+    memset(padding, 0, sizeof(padding));
+    padding[0] = 0x80;
+
+    std::size_t padLength = bufferFill < 56 ? 56 - bufferFill : 120 - bufferFill;
+    updateImpl(padding, padLength);
+
+    unsigned char length[8];
+    for(int i = 0; i < 8; ++i) {
+        length[i] = static_cast<unsigned char>(numBits >> (56 - 8 * i));
+    }
+    updateImpl(length, 8);
+
+    result.clear();
+    result.reserve(DIGEST_SIZE);
+    for(int i = 0; i < 8; ++i) {
+        result.push_back(static_cast<unsigned char>(state[i] >> 24));
+        result.push_back(static_cast<unsigned char>(state[i] >> 16));
+        result.push_back(static_cast<unsigned char>(state[i] >> 8));
+        result.push_back(static_cast<unsigned char>(state[i]));
+    }
+
+    reset();
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPSHA256Engine::updateImpl(const void* data, std::size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    numBytes += length;
+
+    if(bufferFill > 0) {
+        std::size_t numCopied = std::min(length, static_cast<std::size_t>(BLOCK_SIZE) - bufferFill);
+        memcpy(buffer + bufferFill, bytes, numCopied);
+        bufferFill += numCopied;
+        bytes      += numCopied;
+        length     -= numCopied;
+
+        if(bufferFill < BLOCK_SIZE) {
+            return;
+        }
+
+        transform(buffer);
+        bufferFill = 0;
+    }
+
+    // whole blocks straight from the caller's data
+    while(length >= BLOCK_SIZE) {
+        transform(bytes);
+        bytes  += BLOCK_SIZE;
+        length -= BLOCK_SIZE;
+    }
+
+    if(length > 0) {
+        memcpy(buffer, bytes, length);
+        bufferFill = length;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPSHA256Engine::transform(const unsigned char* block) {
+    UInt32 w[64];
+
+    for(int i = 0; i < 16; ++i) {
+        w[i] = (static_cast<UInt32>(block[i * 4])     << 24) |
+               (static_cast<UInt32>(block[i * 4 + 1]) << 16) |
+               (static_cast<UInt32>(block[i * 4 + 2]) << 8)  |
+               (static_cast<UInt32>(block[i * 4 + 3]));
+    }
+
+    for(int i = 16; i < 64; ++i) {
+        UInt32 s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        UInt32 s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19)  ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    UInt32 a = state[0];
+    UInt32 b = state[1];
+    UInt32 c = state[2];
+    UInt32 d = state[3];
+    UInt32 e = state[4];
+    UInt32 f = state[5];
+    UInt32 g = state[6];
+    UInt32 h = state[7];
+
+    for(int i = 0; i < 64; ++i) {
+        UInt32 S1    = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        UInt32 ch    = (e & f) ^ (~e & g);
+        UInt32 temp1 = h + S1 + ch + K[i] + w[i];
+        UInt32 S0    = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        UInt32 maj   = (a & b) ^ (a & c) ^ (b & c);
+        UInt32 temp2 = S0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
@@ -0,0 +1,72 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "Poco/DigestEngine.h"
+#include "Poco/Types.h"
+
+using Poco::DigestEngine;
+using Poco::UInt32;
+using Poco::UInt64;
+
+// SHA-256 as a Poco::DigestEngine, so it can be used with DigestOutputStream
+// and friends without depending on PocoCrypto / OpenSSL.
+//
+//     ofxHTTPSHA256Engine sha256;
+//     sha256.update(data, length);
+//     string hex = DigestEngine::digestToHex(sha256.digest());
+class ofxHTTPSHA256Engine : public DigestEngine {
+public:
+    enum {
+        BLOCK_SIZE  = 64,
+        DIGEST_SIZE = 32
+    };
+
+    ofxHTTPSHA256Engine();
+    virtual ~ofxHTTPSHA256Engine();
+
+    unsigned digestLength() const;
+    void reset();
+
+    // finishes the digest and resets the engine
+    const DigestEngine::Digest& digest();
+
+protected:
+    void updateImpl(const void* data, std::size_t length);
+
+private:
+    ofxHTTPSHA256Engine(const ofxHTTPSHA256Engine&);
+    ofxHTTPSHA256Engine& operator = (const ofxHTTPSHA256Engine&);
+
+    void transform(const unsigned char* block);
+
+    UInt32 state[8];
+    UInt64 numBytes;
+    unsigned char buffer[BLOCK_SIZE];
+    std::size_t bufferFill;
+
+    DigestEngine::Digest result;
+
+};
@@ -20,12 +20,24 @@ ofxHTTPServer::Settings::Settings() {
     threadIdleTime       = Timespan(10*Timespan::SECONDS);
     threadPriority       = Thread::PRIO_NORMAL;
     
+    headerTimeout        = Timespan(10*Timespan::SECONDS);
+    idleTimeout          = keepAliveTimeout;
+    minBodyRate          = 1024; // 1 KB/s
+    bodyRateInterval     = Timespan(10*Timespan::SECONDS);
+    
+    handoffPath          = ""; // empty, no handoff
+    drainTimeout         = Timespan(30*Timespan::SECONDS);
+    
 }
 
 //------------------------------------------------------------------------------
-ofxHTTPServer::ofxHTTPServer(ThreadPool& _threadPool) : threadPool(_threadPool) {
+ofxHTTPServer::ofxHTTPServer(ThreadPool& _threadPool) :
+threadPool(_threadPool),
+handoffRunnable(*this, &ofxHTTPServer::handoffServiceLoop),
+bHandoffServiceRunning(false),
+bDrained(false)
+{
     ofAddListener(ofEvents().exit,this,&ofxHTTPServer::exit);
-    server = NULL;
     bSettingsLoaded = false;
     
 #ifdef SSL_ENABLED
@@ -35,7 +47,7 @@ ofxHTTPServer::ofxHTTPServer(ThreadPool& _threadPool) : threadPool(_threadPool)
 
 //------------------------------------------------------------------------------
 ofxHTTPServer::~ofxHTTPServer() {
-    if(server != NULL) {
+    if(isRunning()) {
         stop();
     }
     ofLogVerbose("ofxHTTPServer::~ofxHTTPServer") << "Server destroyed.";
@@ -49,7 +61,7 @@ ofxHTTPServer::~ofxHTTPServer() {
 void ofxHTTPServer::exit(ofEventArgs& args) {
     ofLogVerbose("ofxHTTPServer::exit") << "Waiting for server thread cleanup.";
 
-    if(server != NULL) {
+    if(isRunning()) {
         stop();
     }
     // it is ok to unregister an item that is not currently registered
@@ -74,102 +86,400 @@ void ofxHTTPServer::start(){
         return;
     }
     
-    if(server != NULL) {
+    if(isRunning()) {
         ofLogWarning("ofxHTTPServer::start") << "Server is already running.  Call stop() to stop.";
         return;
     }
     
-    // all of these params are an attempt to make the server shut down VERY quickly.
+    ofxHTTPServerConnectionMonitor::Settings monitorSettings;
+    monitorSettings.headerTimeout    = settings.headerTimeout;
+    monitorSettings.idleTimeout      = settings.idleTimeout;
+    monitorSettings.minBodyRate      = settings.minBodyRate;
+    monitorSettings.bodyRateInterval = settings.bodyRateInterval;
     
-    string serverName = settings.name.empty() ? settings.host + ":" + ofToString(settings.port) : settings.name;
-        
-    HTTPServerParams* serverParams = new HTTPServerParams();
-    serverParams->setMaxQueued(settings.maxQueued);
-    serverParams->setMaxThreads(settings.maxThreads);
-    serverParams->setKeepAlive(settings.bKeepAlive);
-    serverParams->setMaxKeepAliveRequests(settings.maxKeepAliveRequests);
-    serverParams->setKeepAliveTimeout(settings.keepAliveTimeout);
-    serverParams->setServerName(serverName);
-    serverParams->setTimeout(settings.timeout);
-    serverParams->setThreadIdleTime(settings.threadIdleTime);
-    serverParams->setThreadPriority(settings.threadPriority);
-    serverParams->setSoftwareVersion(settings.softwareVersion);
+    connectionMonitor = ofxHTTPServerConnectionMonitor::Instance(monitorSettings);
     
-#ifdef SSL_ENABLED
-    if(true) {
-        // we use the default thread pool
-        
+    bDrained = false;
+    
+    // take over the sockets of a running instance, if there is one
+    StreamSocket handoffChannel;
+    ofxHTTPServerHandoff::Sockets inheritedSockets;
+    bool bHandoff = false;
+    
+    if(!settings.handoffPath.empty()) {
         try {
+            bHandoff = ofxHTTPServerHandoff::requestSockets(settings.handoffPath, handoffChannel, inheritedSockets);
+        } catch(const Exception& exc) {
+            ofLogError("ofxHTTPServer::start") << "Socket handoff failed, binding new sockets: " << exc.displayText();
+            inheritedSockets.clear();
+        }
+    }
+    
+    vector<ofxHTTPServerListener::Settings> listenerSettings = getListenerSettings();
+    
+    vector<ofxHTTPServerListener::Settings>::const_iterator iter = listenerSettings.begin();
+    while(iter != listenerSettings.end()) {
+        ofxHTTPServerListener::Ptr listener = ofxHTTPServerListener::Instance(*iter);
+
+        string serverName = settings.name.empty() ? listener->getName() : settings.name;
+
+        try {
+            ServerSocket serverSocket;
             
+            ofxHTTPServerHandoff::Sockets::iterator inherited = inheritedSockets.find(listener->getName());
             
-        Poco::AutoPtr<Context> context(new Context(Context::SERVER_USE,
-                                          "",
-                                          Context::VERIFY_RELAXED,
-                                          9,
-                                          true,
-                                          "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH"));
+            if(inherited != inheritedSockets.end()) {
+                serverSocket = listener->adoptServerSocket((*inherited).second);
+                inheritedSockets.erase(inherited);
+                ofLogVerbose("ofxHTTPServer::start") << "Adopted listener " << listener->toString();
+            } else {
+                serverSocket = listener->createServerSocket();
+            }
             
-
-            SecureServerSocket serverSocket(settings.port,64,context);
+            HTTPServerParams::Ptr params(createServerParams(serverName));
+            HTTPRequestHandlerFactory::Ptr routeManager(new ofxHTTPServerRouteManager(routes,rateLimiters,virtualHosts,listener));
             
-            server = new HTTPServer(new ofxHTTPServerRouteManager(routes,true),
-                                    threadPool,
-                                    serverSocket,
-                                    serverParams);
+            // held until the TCPServer takes it, so a throwing constructor
+            // doesn't leak it or the route manager.
+            TCPServerConnectionFactory::Ptr connectionFactory(new ofxHTTPServerConnectionFactory(params,
+                                                                                                 routeManager,
+                                                                                                 *connectionMonitor,
+                                                                                                 listener));
             
+            // each listener gets its own TCPServer, but they all share our
+            // thread pool, our route table and our connection deadlines.
+            servers.push_back(new TCPServer(connectionFactory,
+                                            threadPool,
+                                            serverSocket,
+                                            params));
+            serverParams.push_back(params);
+            listeners.push_back(listener);
         } catch(const Exception& exc) {
-            cout << "ERROR ERROR" << endl;
-            cout << exc.name() << " " << exc.what() << " " << exc.message() << endl;
-            
+            ofLogError("ofxHTTPServer::start") << "Unable to start listener " << listener->toString() << ": " << exc.displayText();
         }
-    } else {
-        // we use the default thread pool
-        server = new HTTPServer(new ofxHTTPServerRouteManager(routes,false),
-                                threadPool,
-                                ServerSocket(settings.port),
-                                serverParams);
-    }
-#else
-    // we use the default thread pool
-    server = new HTTPServer(new ofxHTTPServerRouteManager(routes,false),
-                            threadPool,
-                            ServerSocket(settings.port),
-                            serverParams);
-#endif
+        
+        ++iter;
+    }
+    
+    // sockets of listeners we no longer have
+    ofxHTTPServerHandoff::closeSockets(inheritedSockets);
+    
+    if(servers.empty()) {
+        ofLogError("ofxHTTPServer::start") << "No listeners could be started.";
+        connectionMonitor.reset();
+        return;
+    }
+    
+    connectionMonitor->start();
     
-    errorHandler.setName(serverName);
+    errorHandler.setName(settings.name.empty() ? listeners.front()->getName() : settings.name);
     previousErrorHandler = ErrorHandler::set(&errorHandler);
     
-    // start the http server
-    server->start();
-
+    checkThreadReservations();
+    
+    // start the http servers
+    vector<TCPServer*>::iterator serverIter = servers.begin();
+    while(serverIter != servers.end()) {
+        (*serverIter)->start();
+        ++serverIter;
+    }
+    
+    if(bHandoff) {
+        // we are accepting, so the previous instance can drain
+        try {
+            ofxHTTPServerHandoff::sendLine(handoffChannel, ofxHTTPServerHandoff::READY);
+        } catch(const Exception& exc) {
+            ofLogError("ofxHTTPServer::start") << "Unable to complete socket handoff: " << exc.displayText();
+        }
+        handoffChannel.close();
+    }
+    
+    if(!settings.handoffPath.empty()) {
+        startHandoffService(bHandoff);
+    }
 }
 
 //------------------------------------------------------------------------------
 void ofxHTTPServer::stop() {
-    if(server == NULL) {
+    if(!isRunning()) {
         ofLogWarning("ofxHTTPServer::stop") << "Server is not running.  Call start() to start.";
         return;
     }
+    
+    stopHandoffService();
 
-    server->stop();
+    vector<TCPServer*>::iterator iter = servers.begin();
+    while(iter != servers.end()) {
+        (*iter)->stop();
+        ++iter;
+    }
     
-    // TODO: with 1.4.6+ upgrade use server->stopAll(true);
-    // server->stopAll(true);
+    // connections finish their current request, and idle keep-alive
+    // connections are released by their idle deadline.
     
     // wait for all threads in the thread pool
-    ThreadPool::defaultPool().joinAll(); // we gotta wait for all of them ... ugh.
+    threadPool.joinAll(); // we gotta wait for all of them ... ugh.
     
     ErrorHandler::set(previousErrorHandler);
     
+    iter = servers.begin();
+    while(iter != servers.end()) {
+        delete *iter;
+        ++iter;
+    }
+    
+    servers.clear();
+    serverParams.clear();
+    listeners.clear();
+    
+    // no connections are left to watch
+    connectionMonitor->stop();
+
     ofLogVerbose("ofxHTTPServer::stop") << "Server successfully shut down.";
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServer::isRunning() const {
+    return !servers.empty();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::drain(const Timespan& timeout) {
+    if(!isRunning()) {
+        return;
+    }
+    
+    ofLogNotice("ofxHTTPServer::drain") << "Draining connections.";
+    
+    vector<ofxHTTPServerListener::Ptr>::iterator listenerIter = listeners.begin();
+    while(listenerIter != listeners.end()) {
+        (*listenerIter)->handOff();
+        ++listenerIter;
+    }
+    
+    // responses now carry "Connection: close"
+    vector<HTTPServerParams::Ptr>::iterator paramsIter = serverParams.begin();
+    while(paramsIter != serverParams.end()) {
+        (*paramsIter)->setKeepAlive(false);
+        ++paramsIter;
+    }
+    
+    Timestamp start;
+    
+    while(!start.isElapsed(timeout.totalMicroseconds())) {
+        int numConnections = 0;
+        
+        vector<TCPServer*>::iterator iter = servers.begin();
+        while(iter != servers.end()) {
+            numConnections += (*iter)->currentConnections() + (*iter)->queuedConnections();
+            ++iter;
+        }
+        
+        // suspended exchanges have left their connections, but their
+        // responses are still to be written
+        if(numConnections == 0 && ofxHTTPServerAsyncWriter::defaultWriter().getNumPending() == 0) {
+            break;
+        }
+        
+        Thread::sleep(100);
+    }
+    
+    ofScopedLock lock(handoffMutex);
+    bDrained = true;
+    
+    ofLogNotice("ofxHTTPServer::drain") << "Connections drained.";
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServer::isDrained() const {
+    ofScopedLock lock(handoffMutex);
+    return bDrained;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::startHandoffService(bool bTakeOver) {
+    try {
+        // the instance we took over from still listens on the path while
+        // it drains, which would otherwise keep us from replacing it.
+        Poco::File handoffFile(settings.handoffPath);
+        if(bTakeOver && !ofxUnixSocket::isAbstractPath(settings.handoffPath) && handoffFile.exists()) {
+            handoffFile.remove();
+        }
+        
+        handoffSocket = ofxUnixSocket::listen(settings.handoffPath, 1, 0600);
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServer::startHandoffService") << "Unable to listen for handoff requests: " << exc.displayText();
+        return;
+    }
+    
+    ofScopedLock lock(handoffMutex);
+    bHandoffServiceRunning = true;
+    handoffThread.setName("ofxHTTPServer handoff");
+    handoffThread.start(handoffRunnable);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::stopHandoffService() {
+    {
+        ofScopedLock lock(handoffMutex);
+        if(!bHandoffServiceRunning) {
+            return;
+        }
+        bHandoffServiceRunning = false;
+    }
     
-    delete server;
-    server = NULL;
+    handoffThread.join();
+    handoffSocket.close();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServer::isHandoffServiceRunning() const {
+    ofScopedLock lock(handoffMutex);
+    return bHandoffServiceRunning;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::checkThreadReservations() const {
+    set<const void*> counted;
+    
+    size_t numReserved = getNumReservedThreads(routes, counted);
+    
+    vector<ofxHTTPServerVirtualHost::Ptr> hosts = virtualHosts.getHosts();
+    for(size_t i = 0; i < hosts.size(); ++i) {
+        numReserved += getNumReservedThreads(hosts[i]->getRoutes(), counted);
+    }
+    
+    if(numReserved >= static_cast<size_t>(settings.maxThreads)) {
+        ofLogWarning("ofxHTTPServer::start") << "Bulkheads and schedulers can hold " << numReserved << " threads, queued requests included, but the server only has " << settings.maxThreads << ".  Other routes may find no free thread.";
+    }
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServer::getNumReservedThreads(const vector<ofxBaseHTTPServerRoute::Ptr>& routes,
+                                            set<const void*>& counted) const {
+    size_t numReserved = 0;
+    
+    vector<ofxBaseHTTPServerRoute::Ptr>::const_iterator iter = routes.begin();
+    while(iter != routes.end()) {
+        ofxBaseHTTPServerRoute::Ptr route = *iter;
+        
+        // wrapped routes may be wrapped again.  A bulkhead or scheduler
+        // shared by several routes counts once.
+        while(route != NULL) {
+            ofxHTTPServerBulkheadRoute*  bulkheadRoute  = dynamic_cast<ofxHTTPServerBulkheadRoute*>(route.get());
+            ofxHTTPServerScheduledRoute* scheduledRoute = dynamic_cast<ofxHTTPServerScheduledRoute*>(route.get());
+            
+            if(bulkheadRoute != NULL) {
+                if(counted.insert(bulkheadRoute->getBulkhead().get()).second) {
+                    numReserved += bulkheadRoute->getBulkhead()->getMaxThreads();
+                }
+                route = bulkheadRoute->getRoute();
+            } else if(scheduledRoute != NULL) {
+                if(counted.insert(scheduledRoute->getScheduler().get()).second) {
+                    numReserved += scheduledRoute->getScheduler()->getMaxThreads();
+                }
+                route = scheduledRoute->getRoute();
+            } else {
+                break;
+            }
+        }
+        
+        ++iter;
+    }
+    
+    return numReserved;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::handoffServiceLoop() {
+    while(isHandoffServiceRunning()) {
+        if(!handoffSocket.poll(Timespan(250*Timespan::MILLISECONDS), Socket::SELECT_READ)) {
+            continue;
+        }
+        
+        try {
+            StreamSocket channel = handoffSocket.acceptConnection();
+            channel.setReceiveTimeout(settings.drainTimeout);
+            
+            if(ofxHTTPServerHandoff::receiveLine(channel) != ofxHTTPServerHandoff::REQUEST) {
+                continue;
+            }
+            
+            ofxHTTPServerHandoff::Sockets sockets;
+            
+            vector<ofxHTTPServerListener::Ptr>::iterator iter = listeners.begin();
+            while(iter != listeners.end()) {
+                sockets[(*iter)->getName()] = (*iter)->getSocketDescriptor();
+                ++iter;
+            }
+            
+            ofxHTTPServerHandoff::sendSockets(channel, sockets);
+            
+            // until the new process is accepting, we keep serving.  If it
+            // fails to start, nothing changes for us.
+            if(ofxHTTPServerHandoff::receiveLine(channel) != ofxHTTPServerHandoff::READY) {
+                ofLogWarning("ofxHTTPServer::handoffServiceLoop") << "Handoff abandoned by the new process.";
+                continue;
+            }
+            
+            ofLogNotice("ofxHTTPServer::handoffServiceLoop") << "Listeners handed off.";
+            
+            // the control socket's path belongs to the new process too
+            ofxUnixServerSocketImpl* pImpl = dynamic_cast<ofxUnixServerSocketImpl*>(handoffSocket.impl());
+            if(pImpl != NULL) {
+                pImpl->setUnlinkOnClose(false);
+            }
+            
+            drain(settings.drainTimeout);
+            break;
+        } catch(const Exception& exc) {
+            ofLogError("ofxHTTPServer::handoffServiceLoop") << "Handoff failed: " << exc.displayText();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+vector<ofxHTTPServerListener::Settings> ofxHTTPServer::getListenerSettings() const {
+    if(!settings.listeners.empty()) {
+        return settings.listeners;
+    }
+
+    // the single listener described by the legacy settings
+    ofxHTTPServerListener::Settings listenerSettings;
+    listenerSettings.port    = settings.port;
+    listenerSettings.backlog = settings.maxQueued;
+#ifdef SSL_ENABLED
+    if(settings.bUseSSL) {
+        listenerSettings.type        = ofxHTTPServerListener::SECURE;
+        listenerSettings.sslSettings = settings.sslSettings;
+    }
+#endif
+    
+    return vector<ofxHTTPServerListener::Settings>(1, listenerSettings);
+}
+
+//------------------------------------------------------------------------------
+HTTPServerParams* ofxHTTPServer::createServerParams(const string& serverName) const {
+    // all of these params are an attempt to make the server shut down VERY quickly.
+    HTTPServerParams* serverParams = new HTTPServerParams();
+    serverParams->setMaxQueued(settings.maxQueued);
+    serverParams->setMaxThreads(settings.maxThreads);
+    serverParams->setKeepAlive(settings.bKeepAlive);
+    serverParams->setMaxKeepAliveRequests(settings.maxKeepAliveRequests);
+    serverParams->setKeepAliveTimeout(settings.keepAliveTimeout);
+    serverParams->setServerName(serverName);
+    serverParams->setTimeout(settings.timeout);
+    serverParams->setThreadIdleTime(settings.threadIdleTime);
+    serverParams->setThreadPriority(settings.threadPriority);
+    serverParams->setSoftwareVersion(settings.softwareVersion);
+    return serverParams;
 }
 
 //------------------------------------------------------------------------------
 string ofxHTTPServer::getURL() const {
+    if(!listeners.empty()) {
+        return listeners.front()->getURL();
+    }
     stringstream ss;
     ss << settings.host << ":" << settings.port << "/";
     return ss.str();
@@ -177,9 +487,25 @@ string ofxHTTPServer::getURL() const {
 
 //------------------------------------------------------------------------------
 int ofxHTTPServer::getPort() const {
+    if(!listeners.empty()) {
+        return listeners.front()->getPort();
+    }
     return settings.port;
 }
 
+//------------------------------------------------------------------------------
+vector<ofxHTTPServerListener::Ptr> ofxHTTPServer::getListeners() const {
+    return listeners;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionMonitor::Metrics ofxHTTPServer::getConnectionMetrics() const {
+    if(connectionMonitor != NULL) {
+        return connectionMonitor->getMetrics();
+    }
+    return ofxHTTPServerConnectionMonitor::Metrics();
+}
+
 //------------------------------------------------------------------------------
 void ofxHTTPServer::clearRoutes() {
     routes.clear();
@@ -200,4 +526,24 @@ void ofxHTTPServer::removeRoute(ofxBaseHTTPServerRoute::Ptr route) {
             ++iter;
         }
     }
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::addVirtualHost(ofxHTTPServerVirtualHost::Ptr virtualHost) {
+    virtualHosts.add(virtualHost);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::removeVirtualHost(ofxHTTPServerVirtualHost::Ptr virtualHost) {
+    virtualHosts.remove(virtualHost);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::addRateLimiter(ofxHTTPServerRateLimiter::Ptr rateLimiter) {
+    rateLimiters.add(rateLimiter);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServer::removeRateLimiter(ofxHTTPServerRateLimiter::Ptr rateLimiter) {
+    rateLimiters.remove(rateLimiter);
+}
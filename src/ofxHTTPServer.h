@@ -24,15 +24,21 @@
 
 #pragma once
 
+#include <set>
 #include <string>
 
+#include "Poco/File.h"
+#include "Poco/RunnableAdapter.h"
 #include "Poco/Thread.h"
 #include "Poco/ThreadPool.h"
 #include "Poco/Timespan.h"
-#include "Poco/Net/HTTPServer.h"
+#include "Poco/Timestamp.h"
 #include "Poco/Net/HTTPServerParams.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
 #include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/Socket.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/TCPServer.h"
 
 #include "ofEvents.h"
 #include "ofThread.h"
@@ -43,17 +49,29 @@
 #include "ofxHTTPBaseTypes.h"
 #include "ofxThreadErrorHandler.h"
 
+#include "ofxHTTPServerAsyncExchange.h"
+#include "ofxHTTPServerBulkheadRoute.h"
+#include "ofxHTTPServerConnection.h"
+#include "ofxHTTPServerConnectionMonitor.h"
+#include "ofxHTTPServerHandoff.h"
+#include "ofxHTTPServerListener.h"
+#include "ofxHTTPServerScheduledRoute.h"
 #include "ofxHTTPServerRouteManager.h"
+#include "ofxHTTPServerVirtualHost.h"
 
+using std::set;
 using std::string;
 
 using Poco::Thread;
 using Poco::ThreadPool;
 using Poco::Timespan;
-using Poco::Net::HTTPServer;
+using Poco::Timestamp;
 using Poco::Net::HTTPServerParams;
 using Poco::Net::ServerSocket;
+using Poco::Net::Socket;
+using Poco::Net::StreamSocket;
 using Poco::Net::HTTPRequestHandlerFactory;
+using Poco::Net::TCPServer;
 
 #ifdef SSL_ENABLED
 //#include "Poco/Net/ConsoleCertificateHandler.h"
@@ -89,22 +107,56 @@ public:
     void stop();
     void threadedFunction();
     
+    bool isRunning() const;
+    
+    // stops accepting and waits up to timeout for open connections and
+    // suspended async exchanges to finish.  Keep-alive is disabled so
+    // clients reconnect elsewhere.
+    void drain(const Timespan& timeout);
+    
+    // true once the listeners were handed to a new process and drained,
+    // at which point the application can stop() and exit.
+    bool isDrained() const;
+    
     void exit(ofEventArgs& args);
         
-    string getURL() const; // TODO: POCO URI
-    int    getPort() const;
+    string getURL() const; // TODO: POCO URI, the URL of the first listener
+    int    getPort() const; // the port of the first listener
+    
+    // valid after start()
+    vector<ofxHTTPServerListener::Ptr> getListeners() const;
+    
+    // connections closed for missing their deadlines, valid after start()
+    ofxHTTPServerConnectionMonitor::Metrics getConnectionMetrics() const;
     
     void clearRoutes();
     
     void addRoute(ofxBaseHTTPServerRoute::Ptr route);
     void removeRoute(ofxBaseHTTPServerRoute::Ptr route);
     
+    // requests whose Host header matches a virtual host are routed through
+    // its routes, the routes above serve all other hosts.  Virtual hosts
+    // can be added and removed while the server is running.
+    void addVirtualHost(ofxHTTPServerVirtualHost::Ptr virtualHost);
+    void removeVirtualHost(ofxHTTPServerVirtualHost::Ptr virtualHost);
+    
+    // checked for every request before routing, in the order added.  Rate
+    // limiters can be added and removed while the server is running.  To
+    // limit a single route, wrap it in an ofxHTTPServerRateLimitedRoute.
+    void addRateLimiter(ofxHTTPServerRateLimiter::Ptr rateLimiter);
+    void removeRateLimiter(ofxHTTPServerRateLimiter::Ptr rateLimiter);
+    
 	struct Settings {
 
+        // if listeners is empty, a single listener is
+        // created from host, port, bUseSSL and sslSettings.
+        vector<ofxHTTPServerListener::Settings> listeners;
+        
         string           host;
         unsigned short   port;
 #ifdef SSL_ENABLED
         bool             bUseSSL;
+        ofxSSLManager::Settings sslSettings;
 #endif
         int              maxQueued;
         int              maxThreads;
@@ -116,19 +168,62 @@ public:
         Timespan         threadIdleTime;
         Thread::Priority threadPriority;
         string           softwareVersion;
+        
+        // deadlines enforced on every connection regardless of
+        // the socket timeout, see ofxHTTPServerConnectionMonitor.
+        Timespan         headerTimeout;
+        Timespan         idleTimeout;
+        int              minBodyRate; // bytes per second, 0 disables
+        Timespan         bodyRateInterval;
+        
+        // if set, start() takes over the listening sockets of a server
+        // already running with the same handoffPath, which then drains.
+        // Listeners are matched by name.  Not available on Windows.
+        string           handoffPath;
+        Timespan         drainTimeout;
                 
 		Settings();
 	};
     
 protected:
+    vector<ofxHTTPServerListener::Settings> getListenerSettings() const;
+    HTTPServerParams* createServerParams(const string& serverName) const;
+    
+    void startHandoffService(bool bTakeOver);
+    void stopHandoffService();
+    void handoffServiceLoop();
+    bool isHandoffServiceRunning() const;
+    
+    // requests queued by a bulkhead or a scheduler wait on a pool thread,
+    // so warns if they could take every thread between them.
+    void checkThreadReservations() const;
+    size_t getNumReservedThreads(const vector<ofxBaseHTTPServerRoute::Ptr>& routes,
+                                 set<const void*>& counted) const;
+    
     ThreadPool& threadPool;
     
-    HTTPServer* server;
+    // one TCPServer per listener, all sharing the thread pool, the
+    // routes and the connection monitor
+    vector<ofxHTTPServerListener::Ptr> listeners;
+    vector<TCPServer*> servers;
+    vector<HTTPServerParams::Ptr> serverParams;
+    
+    ofxHTTPServerConnectionMonitor::Ptr connectionMonitor;
+    
+    // answers handoff requests from the process replacing us
+    ServerSocket handoffSocket;
+    Thread handoffThread;
+    Poco::RunnableAdapter<ofxHTTPServer> handoffRunnable;
+    bool bHandoffServiceRunning;
+    bool bDrained;
+    mutable ofMutex handoffMutex;
     
     bool bSettingsLoaded;
     Settings settings;
 
     vector<ofxBaseHTTPServerRoute::Ptr> routes;
+    ofxHTTPServerRateLimiterChain rateLimiters;
+    ofxHTTPServerVirtualHostTable virtualHosts;
     
     ofThreadErrorHandler errorHandler;
     ErrorHandler* previousErrorHandler;
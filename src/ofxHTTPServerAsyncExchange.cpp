@@ -0,0 +1,365 @@
+#include "ofxHTTPServerAsyncExchange.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "Poco/Exception.h"
+#include "Poco/SingletonHolder.h"
+#include "Poco/Net/Socket.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPUtils.h"
+
+
+using std::ostringstream;
+using std::vector;
+
+using Poco::Net::NameValueCollection;
+using Poco::Net::Socket;
+using Poco::Net::SocketImpl;
+
+//------------------------------------------------------------------------------
+ofxHTTPServerAsyncExchange::Settings::Settings() {
+    timeout       = Timespan(30 * Timespan::SECONDS);
+    timeoutStatus = HTTPResponse::HTTP_SERVICE_UNAVAILABLE;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerAsyncExchange::ofxHTTPServerAsyncExchange(const StreamSocket& _socket,
+                                                       const HTTPServerRequest& _request,
+                                                       const HTTPServerResponse& _response,
+                                                       const Settings& _settings) :
+socket(_socket),
+request(_request.getMethod(), _request.getURI(), _request.getVersion()),
+clientAddress(_request.clientAddress()),
+settings(_settings),
+bCompleted(false),
+bWatched(false)
+{
+    NameValueCollection::ConstIterator iter = _request.begin();
+    while(iter != _request.end()) {
+        request.add((*iter).first, (*iter).second);
+        ++iter;
+    }
+    
+    // what the server already set, e.g. Date and Server
+    response.setVersion(_response.getVersion());
+    iter = _response.begin();
+    while(iter != _response.end()) {
+        response.add((*iter).first, (*iter).second);
+        ++iter;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerAsyncExchange::~ofxHTTPServerAsyncExchange() {
+    if(!bCompleted) {
+        // nobody will answer, don't leave the client hanging
+        socket.close();
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerAsyncExchange::Ptr ofxHTTPServerAsyncExchange::suspend(ofxHTTPServerExchange& exchange,
+                                                                    const Settings& settings) {
+    HTTPServerRequestImpl* pRequestImpl = dynamic_cast<HTTPServerRequestImpl*>(&exchange.request);
+    
+    if(pRequestImpl == NULL) {
+        throw Poco::InvalidArgumentException("Only requests read by the server can be suspended.");
+    }
+    
+    Ptr async(new ofxHTTPServerAsyncExchange(pRequestImpl->detachSocket(),
+                                             exchange.request,
+                                             exchange.response,
+                                             settings));
+    
+    ofxHTTPServerAsyncWriter::defaultWriter().watch(async, Timestamp() + settings.timeout);
+    
+    return async;
+}
+
+//------------------------------------------------------------------------------
+const HTTPRequest& ofxHTTPServerAsyncExchange::getRequest() const {
+    return request;
+}
+
+//------------------------------------------------------------------------------
+const SocketAddress& ofxHTTPServerAsyncExchange::getClientAddress() const {
+    return clientAddress;
+}
+
+//------------------------------------------------------------------------------
+HTTPResponse& ofxHTTPServerAsyncExchange::getResponse() {
+    return response;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerAsyncExchange::complete(const string& body) {
+    ofScopedLock lock(mutex);
+    return finish(body);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerAsyncExchange::complete(HTTPResponse::HTTPStatus status,
+                                          const string& body,
+                                          const string& mediaType) {
+    ofScopedLock lock(mutex);
+    
+    if(bCompleted) {
+        return false;
+    }
+    
+    response.setStatusAndReason(status);
+    response.setContentType(mediaType);
+    
+    return finish(body);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerAsyncExchange::isCompleted() const {
+    ofScopedLock lock(mutex);
+    return bCompleted;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerAsyncExchange::expire() {
+    if(complete(settings.timeoutStatus, "")) {
+        ofLogWarning("ofxHTTPServerAsyncExchange::expire") << "No response for " << request.getURI() << " after " << settings.timeout.totalMilliseconds() << " ms.";
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerAsyncExchange::finish(const string& body) {
+    if(bCompleted) {
+        return false;
+    }
+    
+    bCompleted = true;
+    
+    ofxHTTPServerAsyncWriter& writer = ofxHTTPServerAsyncWriter::defaultWriter();
+    
+    writer.unwatch(*this);
+    
+    // the connection isn't returned to the server
+    response.setContentLength(static_cast<std::streamsize>(body.size()));
+    response.setKeepAlive(false);
+    
+    ostringstream ostr;
+    response.write(ostr);
+    
+    if(request.getMethod() != HTTPRequest::HTTP_HEAD) {
+        ostr << body;
+    }
+    
+    writer.send(socket, ofxHTTPServerAsyncWriter::Buffer(new string(ostr.str())));
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerAsyncWriter::ofxHTTPServerAsyncWriter(const Timespan& _sendTimeout, const Timespan& _pollTimeout) :
+sendTimeout(_sendTimeout),
+pollTimeout(_pollTimeout),
+bRunning(true)
+{
+    thread.setName("ofxHTTPServerAsyncWriter");
+    thread.start(*this);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerAsyncWriter::~ofxHTTPServerAsyncWriter() {
+    {
+        ofScopedLock lock(mutex);
+        bRunning = false;
+    }
+    
+    wakeEvent.set();
+    thread.join();
+    
+    list<Job>::iterator iter = jobs.begin();
+    while(iter != jobs.end()) {
+        (*iter).socket.close();
+        ++iter;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerAsyncWriter::send(const StreamSocket& socket, const Buffer& data) {
+    ofScopedLock lock(mutex);
+    
+    Job job;
+    job.socket = socket;
+    job.data   = data;
+    
+    try {
+        job.socket.setBlocking(false);
+    } catch(const Poco::Exception& exc) {
+        ofLogError("ofxHTTPServerAsyncWriter::send") << exc.displayText();
+        return;
+    }
+    
+    jobs.push_back(job);
+    
+    wakeEvent.set();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerAsyncWriter::watch(ofxHTTPServerAsyncExchange::Ptr exchange, const Timestamp& deadline) {
+    ofScopedLock lock(mutex);
+    
+    if(exchange->bWatched) {
+        deadlines.erase(exchange->deadlinePosition);
+    }
+    
+    exchange->deadlinePosition = deadlines.insert(std::make_pair(deadline, exchange));
+    exchange->bWatched = true;
+    
+    wakeEvent.set();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerAsyncWriter::unwatch(ofxHTTPServerAsyncExchange& exchange) {
+    ofScopedLock lock(mutex);
+    
+    if(exchange.bWatched) {
+        exchange.bWatched = false;
+        deadlines.erase(exchange.deadlinePosition);
+    }
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerAsyncWriter::getNumPending() const {
+    ofScopedLock lock(mutex);
+    return deadlines.size() + jobs.size();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerAsyncWriter& ofxHTTPServerAsyncWriter::defaultWriter() {
+    static Poco::SingletonHolder<ofxHTTPServerAsyncWriter> holder;
+    return *holder.get();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerAsyncWriter::run() {
+    while(true) {
+        Socket::SocketList readList;
+        Socket::SocketList writeList;
+        Socket::SocketList exceptList;
+        
+        map<SocketImpl*, list<Job>::iterator> waiting;
+        vector<ofxHTTPServerAsyncExchange::Ptr> expired;
+        
+        long waitMilliseconds = 1000;
+        
+        {
+            ofScopedLock lock(mutex);
+            
+            if(!bRunning) {
+                break;
+            }
+            
+            Timestamp now;
+            
+            while(!deadlines.empty() && (*deadlines.begin()).first <= now) {
+                ofxHTTPServerAsyncExchange::Ptr exchange = (*deadlines.begin()).second;
+                exchange->bWatched = false;
+                deadlines.erase(deadlines.begin());
+                expired.push_back(exchange);
+            }
+            
+            list<Job>::iterator iter = jobs.begin();
+            while(iter != jobs.end()) {
+                Job& job = *iter;
+                
+                bool bDone = !job.bBlocked && !flush(job, now);
+                
+                if(!bDone && job.bBlocked && now - job.blockedSince >= sendTimeout.totalMicroseconds()) {
+                    bDone = true; // the client stopped reading
+                }
+                
+                if(bDone) {
+                    try {
+                        job.socket.shutdownSend();
+                    } catch(const Poco::Exception&) {
+                        // already gone
+                    }
+                    job.socket.close();
+                    iter = jobs.erase(iter);
+                    continue;
+                }
+                
+                if(job.bBlocked) {
+                    writeList.push_back(job.socket);
+                    waiting[job.socket.impl()] = iter;
+                }
+                
+                ++iter;
+            }
+            
+            if(!deadlines.empty()) {
+                Timestamp::TimeDiff untilDeadline = (*deadlines.begin()).first - now;
+                waitMilliseconds = std::min<long>(waitMilliseconds, static_cast<long>(untilDeadline / 1000) + 1);
+            }
+        }
+        
+        // answered outside the lock, they come back to send()
+        if(!expired.empty()) {
+            for(size_t i = 0; i < expired.size(); ++i) {
+                expired[i]->expire();
+            }
+            continue;
+        }
+        
+        if(writeList.empty()) {
+            wakeEvent.tryWait(waitMilliseconds);
+            continue;
+        }
+        
+        // new responses wait at most pollTimeout
+        try {
+            Socket::select(readList, writeList, exceptList, pollTimeout);
+        } catch(const Poco::Exception& exc) {
+            ofLogError("ofxHTTPServerAsyncWriter::run") << exc.displayText();
+        }
+        
+        ofScopedLock lock(mutex);
+        
+        Socket::SocketList::iterator iter = writeList.begin();
+        while(iter != writeList.end()) {
+            map<SocketImpl*, list<Job>::iterator>::iterator job = waiting.find((*iter).impl());
+            if(job != waiting.end()) {
+                (*(*job).second).bBlocked = false;
+            }
+            ++iter;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerAsyncWriter::flush(Job& job, const Timestamp& now) {
+    while(job.offset < job.data->size()) {
+        int n = 0;
+        
+        try {
+            n = ofSendSome(job.socket, job.data->data() + job.offset, job.data->size() - job.offset);
+        } catch(const Poco::Exception&) {
+            n = -1;
+        }
+        
+        if(n < 0) {
+            return false;
+        }
+        
+        if(n == 0) {
+            job.bBlocked = true;
+            job.blockedSince = now;
+            return true;
+        }
+        
+        job.offset += n;
+    }
+    
+    return false;
+}
@@ -0,0 +1,192 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "Poco/Event.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Net/StreamSocket.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPServerExchange.h"
+
+using std::list;
+using std::multimap;
+using std::string;
+
+using Poco::Runnable;
+using Poco::Thread;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::SocketAddress;
+using Poco::Net::StreamSocket;
+
+class ofxHTTPServerAsyncWriter;
+
+// An exchange whose response is sent later, from any thread.
+//
+// A handler that has to wait, e.g. for a backend or for the main thread,
+// suspends the exchange and returns.  The server thread is then free for
+// other connections, and whoever has the answer calls complete():
+//
+//     void handleExchange(ofxHTTPServerExchange& exchange) {
+//         ofxHTTPServerAsyncExchange::Ptr async = ofxHTTPServerAsyncExchange::suspend(exchange);
+//         jobs.push(Job(exchange.request.getURI(), async)); // answered in update()
+//     }
+//
+//     // any thread
+//     job.async->complete(HTTPResponse::HTTP_OK, result, "application/json");
+//
+// The response is written by the async writer's I/O thread.  The request
+// body must be read before suspending, and the connection is closed after
+// the response.  An exchange that isn't completed within timeout is
+// answered with timeoutStatus.
+class ofxHTTPServerAsyncExchange {
+public:
+    typedef ofPtr<ofxHTTPServerAsyncExchange> Ptr;
+    
+    struct Settings;
+    
+    virtual ~ofxHTTPServerAsyncExchange();
+    
+    // takes the connection from the handler, which returns right after
+    static Ptr suspend(ofxHTTPServerExchange& exchange, const Settings& settings = Settings());
+    
+    // a copy of the request line and headers
+    const HTTPRequest& getRequest() const;
+    const SocketAddress& getClientAddress() const;
+    
+    // status and headers may be set on the response before completing,
+    // by the thread that completes it.
+    HTTPResponse& getResponse();
+    
+    // sends the response with body, returns false if the exchange was
+    // already completed or timed out.
+    bool complete(const string& body = "");
+    bool complete(HTTPResponse::HTTPStatus status,
+                  const string& body,
+                  const string& mediaType = "text/plain");
+    
+    bool isCompleted() const;
+    
+    struct Settings {
+        Timespan timeout;
+        HTTPResponse::HTTPStatus timeoutStatus;
+        
+        Settings();
+    };
+    
+protected:
+    ofxHTTPServerAsyncExchange(const StreamSocket& _socket,
+                               const HTTPServerRequest& _request,
+                               const HTTPServerResponse& _response,
+                               const Settings& _settings);
+    
+    // called by the writer once timeout has passed
+    void expire();
+    
+    // expected to hold the mutex
+    bool finish(const string& body);
+    
+    StreamSocket socket;
+    HTTPRequest request;
+    HTTPResponse response;
+    SocketAddress clientAddress;
+    
+    Settings settings;
+    
+    mutable ofMutex mutex;
+    bool bCompleted;
+    
+    // guarded by the writer's mutex
+    bool bWatched;
+    multimap<Timestamp, Ptr>::iterator deadlinePosition;
+    
+    friend class ofxHTTPServerAsyncWriter;
+    
+};
+
+// The I/O thread that writes completed async responses without blocking
+// and closes their connections, and times out the exchanges left waiting.
+class ofxHTTPServerAsyncWriter : public Runnable {
+public:
+    typedef ofPtr<const string> Buffer;
+    
+    ofxHTTPServerAsyncWriter(const Timespan& _sendTimeout = Timespan(30 * Timespan::SECONDS),
+                             const Timespan& _pollTimeout = Timespan(10 * Timespan::MILLISECONDS));
+    virtual ~ofxHTTPServerAsyncWriter();
+    
+    // writes data and closes the socket
+    void send(const StreamSocket& socket, const Buffer& data);
+    
+    void watch(ofxHTTPServerAsyncExchange::Ptr exchange, const Timestamp& deadline);
+    void unwatch(ofxHTTPServerAsyncExchange& exchange);
+    
+    size_t getNumPending() const;
+    
+    static ofxHTTPServerAsyncWriter& defaultWriter();
+    
+    // overriden from Runnable
+    void run();
+    
+protected:
+    struct Job {
+        Job() : offset(0), bBlocked(false) { }
+        
+        StreamSocket socket;
+        Buffer data;
+        size_t offset;
+        bool bBlocked;
+        Timestamp blockedSince;
+    };
+    
+    // returns false once the job is done, or failed
+    bool flush(Job& job, const Timestamp& now);
+    
+    Timespan sendTimeout;
+    Timespan pollTimeout;
+    
+    mutable ofMutex mutex;
+    
+    list<Job> jobs;
+    multimap<Timestamp, ofxHTTPServerAsyncExchange::Ptr> deadlines;
+    
+    Thread thread;
+    Poco::Event wakeEvent;
+    bool bRunning;
+    
+};
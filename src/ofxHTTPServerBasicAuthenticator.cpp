@@ -0,0 +1,235 @@
+#include "ofxHTTPServerBasicAuthenticator.h"
+
+#include "Poco/Exception.h"
+#include "Poco/String.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPSHA256Engine.h"
+#include "ofxHTTPUtils.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBasicAuthenticator::Settings::Settings() {
+    realm        = "Default";
+    maxCacheSize = 1024;
+    cacheTtl     = Timespan(0, 0, 5, 0, 0); // 5 minutes
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBasicAuthenticator::ofxHTTPServerBasicAuthenticator(const Settings& _settings) :
+settings(_settings),
+dummyCost(0),
+generation(0)
+{
+    map<string, string>::const_iterator hashIter = settings.passwordHashes.begin();
+    while(hashIter != settings.passwordHashes.end()) {
+        setPasswordHash((*hashIter).first, (*hashIter).second);
+        ++hashIter;
+    }
+    
+    vector<ofxHTTPCredentials>::const_iterator iter = settings.credentials.begin();
+    while(iter != settings.credentials.end()) {
+        setPasswordHash((*iter).getUsername(), ofxHTTPPasswordHash::hash((*iter).getPassword(), settings.hashSettings));
+        ++iter;
+    }
+    
+    // plaintext passwords aren't kept once hashed
+    settings.credentials.clear();
+    settings.passwordHashes.clear();
+    
+    if(dummyHash.empty()) {
+        dummyHash = ofxHTTPPasswordHash::hash("", settings.hashSettings);
+        dummyCost = getCost(settings.hashSettings);
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBasicAuthenticator::~ofxHTTPServerBasicAuthenticator() { }
+
+//------------------------------------------------------------------------------
+ofxHTTPAuthStatus ofxHTTPServerBasicAuthenticator::authenticate(HTTPServerRequest& request) {
+    if(!request.hasCredentials()) {
+        return NO_CREDENTIALS;
+    }
+    
+    string scheme;
+    string authInfo;
+    
+    try {
+        request.getCredentials(scheme, authInfo);
+    } catch(const NotAuthenticatedException&) {
+        return UNAUTHORIZED;
+    }
+    
+    if(Poco::icompare(scheme, "Basic") != 0) {
+        return UNAUTHORIZED;
+    }
+    
+    ofxHTTPSHA256Engine engine;
+    engine.update(authInfo);
+    const DigestEngine::Digest& digest = engine.digest();
+    string cacheKey(digest.begin(), digest.end());
+    
+    Timestamp now;
+    string hash;
+    bool bKnown = false;
+    unsigned long long startGeneration = 0;
+    
+    {
+        ofScopedLock lock(mutex);
+        
+        HashMap<string, CacheEntry>::Iterator cacheIter = cache.find(cacheKey);
+        
+        if(cacheIter != cache.end()) {
+            if((*cacheIter).second.expires > now) {
+                lru.splice(lru.begin(), lru, (*cacheIter).second.lruPosition);
+                return OK;
+            }
+            lru.erase((*cacheIter).second.lruPosition);
+            cache.erase(cacheIter);
+        }
+    }
+    
+    string username;
+    string password;
+    
+    try {
+        HTTPBasicCredentials credentials(authInfo);
+        username = credentials.getUsername();
+        password = credentials.getPassword();
+    } catch(const Poco::Exception&) {
+        return UNAUTHORIZED; // malformed
+    }
+    
+    {
+        ofScopedLock lock(mutex);
+        
+        HashMap<string, string>::Iterator iter = users.find(username);
+        
+        bKnown = iter != users.end();
+        hash   = bKnown ? (*iter).second : dummyHash;
+        startGeneration = generation;
+    }
+    
+    // PBKDF2 runs unlocked so concurrent logins don't queue behind it
+    bool bValid = ofxHTTPPasswordHash::verify(password, hash) && bKnown;
+    
+    if(!bValid) {
+        return UNAUTHORIZED;
+    }
+    
+    if(settings.maxCacheSize > 0) {
+        ofScopedLock lock(mutex);
+        
+        if(generation == startGeneration && cache.find(cacheKey) == cache.end()) {
+            CacheEntry& entry = cache[cacheKey];
+            entry.username    = username;
+            entry.expires     = now + settings.cacheTtl;
+            entry.lruPosition = lru.insert(lru.begin(), cacheKey);
+            
+            while(cache.size() > settings.maxCacheSize) {
+                cache.erase(lru.back());
+                lru.pop_back();
+            }
+        }
+    }
+    
+    return OK;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBasicAuthenticator::setAuthenticationRequiredHeaders(HTTPServerResponse& response) {
+    response.set("WWW-Authenticate", "Basic realm=\"" + settings.realm + "\"");
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerBasicAuthenticator::isAuthenticated(HTTPServerRequest& request, HTTPServerResponse& response) {
+    if(authenticate(request) == OK) {
+        return true;
+    }
+    
+    response.setStatusAndReason(HTTPResponse::HTTP_UNAUTHORIZED);
+    setAuthenticationRequiredHeaders(response);
+    response.setContentLength(0);
+    response.send();
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerBasicAuthenticator::setPasswordHash(const string& username, const string& passwordHash) {
+    ofxHTTPPasswordHash::Settings hashSettings;
+    
+    if(!ofxHTTPPasswordHash::getSettings(passwordHash, hashSettings)) {
+        ofLogError("ofxHTTPServerBasicAuthenticator::setPasswordHash") << "Invalid password hash for " << username << ".";
+        return false;
+    }
+    
+    unsigned long long cost = getCost(hashSettings);
+    bool bCostlier = false;
+    
+    {
+        ofScopedLock lock(mutex);
+        bCostlier = cost > dummyCost;
+    }
+    
+    // unknown users must cost as much as the costliest known one
+    string newDummyHash;
+    if(bCostlier) {
+        newDummyHash = ofxHTTPPasswordHash::hash("", hashSettings);
+    }
+    
+    ofScopedLock lock(mutex);
+    
+    if(!newDummyHash.empty() && cost > dummyCost) {
+        dummyHash = newDummyHash;
+        dummyCost = cost;
+    }
+    
+    users[username] = passwordHash;
+    removeCachedUser(username);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBasicAuthenticator::removeUser(const string& username) {
+    ofScopedLock lock(mutex);
+    users.erase(username);
+    removeCachedUser(username);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBasicAuthenticator::clearCache() {
+    ofScopedLock lock(mutex);
+    cache.clear();
+    lru.clear();
+    ++generation;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBasicAuthenticator::Ptr ofxHTTPServerBasicAuthenticator::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerBasicAuthenticator(settings));
+}
+
+//------------------------------------------------------------------------------
+unsigned long long ofxHTTPServerBasicAuthenticator::getCost(const ofxHTTPPasswordHash::Settings& hashSettings) {
+    // PBKDF2 runs all iterations once per digest sized block of output
+    unsigned long long numBlocks = (hashSettings.hashLength + ofxHTTPSHA256Engine::DIGEST_SIZE - 1) / ofxHTTPSHA256Engine::DIGEST_SIZE;
+    return static_cast<unsigned long long>(hashSettings.iterations) * numBlocks;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBasicAuthenticator::removeCachedUser(const string& username) {
+    ++generation;
+    
+    // rare, so a scan is fine
+    list<string>::iterator iter = lru.begin();
+    while(iter != lru.end()) {
+        HashMap<string, CacheEntry>::Iterator cacheIter = cache.find(*iter);
+        if(cacheIter != cache.end() && (*cacheIter).second.username == username) {
+            cache.erase(cacheIter);
+            iter = lru.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
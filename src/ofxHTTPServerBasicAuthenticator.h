@@ -24,60 +24,103 @@
 
 #pragma once
 
+#include <list>
+#include <map>
+#include <string>
 #include <vector>
 
-#include "ofxBaseHTTPServerAuthenticationEngine.h"
+#include "Poco/HashMap.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/HTTPResponse.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPBaseTypes.h"
 #include "ofxHTTPCredentials.h"
+#include "ofxHTTPPasswordHash.h"
 
+using std::list;
+using std::map;
+using std::string;
 using std::vector;
 
-class ofxHTTPServerBasicAuthenticator : public ofxBaseHTTPServerAuthenticationEngine {
+using Poco::HashMap;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::HTTPResponse;
+
+// Basic authentication against salted password hashes.
+//
+// Users are indexed by name and their passwords are checked with
+// ofxHTTPPasswordHash, which is slow on purpose.  So that the cost is paid
+// once per client rather than once per request, verified Authorization
+// headers are remembered for a while, keyed by their SHA-256 so the
+// plaintext is never kept.  Unknown users are checked against a dummy hash
+// as costly as the most costly stored one, so they take as long as known
+// ones.
+class ofxHTTPServerBasicAuthenticator : public ofxBaseHTTPServerAuthenticationManager {
 public:
+    typedef ofPtr<ofxHTTPServerBasicAuthenticator> Ptr;
+    
     struct Settings;
     
-    ofxHTTPServerBasicAuthenticator(const Settings& _settings = Settings()) : settings(_settings) { }
-    virtual ~ofxHTTPServerBasicAuthenticator() { }
+    ofxHTTPServerBasicAuthenticator(const Settings& _settings = Settings());
+    virtual ~ofxHTTPServerBasicAuthenticator();
     
-    bool isAuthenticated(HTTPServerRequest& request, HTTPServerResponse& response) {
-        URI uri(request.getURI());
-        
-        const string path = uri.getPath(); // just get the path
-        
-        if(request.hasCredentials()) {
-            HTTPBasicCredentials credentials(request);
-            
-            vector<ofxHTTPCredentials>::const_iterator iter = settings.credentials.begin();
-
-            while(iter != settings.credentials.end()) {
-                if((*iter).getUsername() == credentials.getUsername() &&
-                   (*iter).getPassword() == credentials.getPassword()) {
-                    // add an authentication cookie?
-                    return true;
-                }
-                ++iter;
-            }
-            
-            // couldn't find a match
-            response.setStatusAndReason(HTTPResponse::HTTP_UNAUTHORIZED);
-            sendErrorResponse(response);
-            return false;
-        } else {
-            // no credentials?  require authentication
-            response.requireAuthentication(settings.realm);
-            response.setContentLength(0);
-            response.send();
-            return false;
-        }
-
-    }
+    ofxHTTPAuthStatus authenticate(HTTPServerRequest& request);
+    void setAuthenticationRequiredHeaders(HTTPServerResponse& response);
+    
+    // sends the 401 response itself if authentication fails
+    bool isAuthenticated(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+    // passwordHash as made by ofxHTTPPasswordHash::hash()
+    bool setPasswordHash(const string& username, const string& passwordHash);
+    void removeUser(const string& username);
+    
+    void clearCache();
     
     struct Settings {
         string realm;
+        
+        // plaintext, hashed when the authenticator is constructed
         vector<ofxHTTPCredentials> credentials;
+        ofxHTTPPasswordHash::Settings hashSettings;
+        
+        map<string, string> passwordHashes; // username -> hash
+        
+        size_t maxCacheSize;   // verified headers remembered
+        Timespan cacheTtl;     // how long a verified header is trusted
+        
         Settings();
     };
-
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
 protected:
+    struct CacheEntry {
+        string username;
+        Timestamp expires;
+        list<string>::iterator lruPosition;
+    };
+    
+    // expected to hold the mutex
+    void removeCachedUser(const string& username);
+    
+    static unsigned long long getCost(const ofxHTTPPasswordHash::Settings& hashSettings);
+    
     Settings settings;
-
-};
\ No newline at end of file
+    
+    ofMutex mutex;
+    HashMap<string, string> users; // username -> hash
+    string dummyHash;
+    unsigned long long dummyCost;
+    
+    HashMap<string, CacheEntry> cache; // keyed by the digest of the header
+    list<string> lru;                  // most recently used first
+    
+    // bumped by every change to the users, so a verification that raced
+    // with a change is not cached
+    unsigned long long generation;
+    
+};
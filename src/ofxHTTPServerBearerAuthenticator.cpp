@@ -0,0 +1,217 @@
+#include "ofxHTTPServerBearerAuthenticator.h"
+
+#include "Poco/String.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPSHA256Engine.h"
+#include "ofxHTTPUtils.h"
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBearerAuthenticator::Shard::erase(HashMap<string, Entry>::Iterator iter) {
+    lru.erase((*iter).second.lruPosition);
+    expiries.erase((*iter).second.expiryPosition);
+    tokens.erase(iter);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBearerAuthenticator::Settings::Settings() {
+    realm           = "Default";
+    clockSkew       = Timespan(0, 0, 1, 0, 0); // 1 minute
+    cacheTtl        = Timespan(0, 0, 5, 0, 0); // 5 minutes
+    maxCachedTokens = 10000;
+    numShards       = 16;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBearerAuthenticator::ofxHTTPServerBearerAuthenticator(const Settings& _settings) :
+settings(_settings),
+maxTokensPerShard(0),
+shards(_settings.numShards)
+{
+    settings.numShards = shards.size();
+    
+    maxTokensPerShard = shards.getCapacityPerShard(settings.maxCachedTokens);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBearerAuthenticator::~ofxHTTPServerBearerAuthenticator() {
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPAuthStatus ofxHTTPServerBearerAuthenticator::authenticate(HTTPServerRequest& request) {
+    ofxHTTPServerTokenInfo info;
+    return authenticate(request, info);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBearerAuthenticator::setAuthenticationRequiredHeaders(HTTPServerResponse& response) {
+    response.set("WWW-Authenticate", "Bearer realm=\"" + settings.realm + "\"");
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPAuthStatus ofxHTTPServerBearerAuthenticator::authenticate(HTTPServerRequest& request,
+                                                                 ofxHTTPServerTokenInfo& info) {
+    if(!request.hasCredentials()) {
+        return NO_CREDENTIALS;
+    }
+    
+    string scheme;
+    string token;
+    
+    try {
+        request.getCredentials(scheme, token);
+    } catch(const NotAuthenticatedException&) {
+        return UNAUTHORIZED;
+    }
+    
+    if(Poco::icompare(scheme, "Bearer") != 0 || token.empty()) {
+        return UNAUTHORIZED;
+    }
+    
+    string tokenHash = hashToken(token);
+    Shard& shard = getShard(tokenHash);
+    Timestamp now;
+    
+    {
+        ofScopedLock lock(shard.mutex);
+        
+        HashMap<string, Entry>::Iterator iter = shard.tokens.find(tokenHash);
+        
+        if(iter != shard.tokens.end()) {
+            if((*iter).second.expires > now) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, (*iter).second.lruPosition);
+                info = (*iter).second.info;
+                return OK;
+            }
+            shard.erase(iter);
+        }
+    }
+    
+    if(settings.verifier == NULL) {
+        ofLogError("ofxHTTPServerBearerAuthenticator::authenticate") << "No token verifier.";
+        return UNAUTHORIZED;
+    }
+    
+    // signature checks don't touch the cache, so no shard is locked
+    if(!settings.verifier->verify(token, info) || !isCurrent(info, now)) {
+        return UNAUTHORIZED;
+    }
+    
+    if(maxTokensPerShard == 0) {
+        return OK;
+    }
+    
+    Timestamp expires = now + settings.cacheTtl;
+    
+    if(info.bExpires && info.expires + settings.clockSkew < expires) {
+        expires = info.expires + settings.clockSkew;
+    }
+    
+    ofScopedLock lock(shard.mutex);
+    
+    if(shard.tokens.find(tokenHash) != shard.tokens.end()) {
+        return OK; // verified by another request meanwhile
+    }
+    
+    // expired tokens go first, then the least recently used
+    while(!shard.expiries.empty() && (*shard.expiries.begin()).first <= now) {
+        shard.erase(shard.tokens.find((*shard.expiries.begin()).second));
+    }
+    
+    while(shard.tokens.size() >= maxTokensPerShard) {
+        shard.erase(shard.tokens.find(shard.lru.back()));
+    }
+    
+    Entry& entry = shard.tokens[tokenHash];
+    entry.info           = info;
+    entry.expires        = expires;
+    entry.lruPosition    = shard.lru.insert(shard.lru.begin(), tokenHash);
+    entry.expiryPosition = shard.expiries.insert(std::make_pair(expires, tokenHash));
+    
+    return OK;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerBearerAuthenticator::isAuthenticated(HTTPServerRequest& request, HTTPServerResponse& response) {
+    ofxHTTPAuthStatus status = authenticate(request);
+    
+    if(status == OK) {
+        return true;
+    }
+    
+    string challenge = "Bearer realm=\"" + settings.realm + "\"";
+    
+    if(status == UNAUTHORIZED) {
+        challenge += ", error=\"invalid_token\"";
+    }
+    
+    response.setStatusAndReason(HTTPResponse::HTTP_UNAUTHORIZED);
+    response.set("WWW-Authenticate", challenge);
+    response.setContentLength(0);
+    response.send();
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBearerAuthenticator::invalidate(const string& token) {
+    string tokenHash = hashToken(token);
+    Shard& shard = getShard(tokenHash);
+    
+    ofScopedLock lock(shard.mutex);
+    
+    HashMap<string, Entry>::Iterator iter = shard.tokens.find(tokenHash);
+    
+    if(iter != shard.tokens.end()) {
+        shard.erase(iter);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBearerAuthenticator::clearCache() {
+    for(size_t i = 0; i < shards.size(); ++i) {
+        ofScopedLock lock(shards[i].mutex);
+        shards[i].tokens.clear();
+        shards[i].lru.clear();
+        shards[i].expiries.clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerBearerAuthenticator::getNumCachedTokens() {
+    size_t numTokens = 0;
+    for(size_t i = 0; i < shards.size(); ++i) {
+        ofScopedLock lock(shards[i].mutex);
+        numTokens += shards[i].tokens.size();
+    }
+    return numTokens;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBearerAuthenticator::Ptr ofxHTTPServerBearerAuthenticator::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerBearerAuthenticator(settings));
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerBearerAuthenticator::isCurrent(const ofxHTTPServerTokenInfo& info, const Timestamp& now) const {
+    if(info.bExpires && now >= info.expires + settings.clockSkew) {
+        return false;
+    }
+    if(info.bNotBefore && now < info.notBefore - settings.clockSkew) {
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerBearerAuthenticator::hashToken(const string& token) {
+    ofxHTTPSHA256Engine engine;
+    engine.update(token);
+    const DigestEngine::Digest& digest = engine.digest();
+    return string(digest.begin(), digest.end());
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBearerAuthenticator::Shard& ofxHTTPServerBearerAuthenticator::getShard(const string& tokenHash) {
+    return shards.get(tokenHash);
+}
@@ -0,0 +1,127 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Poco/HashMap.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/HTTPResponse.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPShards.h"
+
+using std::list;
+using std::multimap;
+using std::string;
+using std::vector;
+
+using Poco::HashMap;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::HTTPResponse;
+
+// Bearer token authentication (RFC 6750).
+//
+// Tokens are checked by a verifier, e.g. ofxHTTPServerJWTVerifier or one
+// that looks opaque tokens up elsewhere.  Verified tokens are cached by
+// their SHA-256 in a table split into independently locked shards, so a
+// client presenting the same token again skips the verifier.  A cached
+// token is dropped when it expires or after cacheTtl, whichever comes
+// first; a full shard drops its expired tokens before its least recently
+// used ones.
+class ofxHTTPServerBearerAuthenticator : public ofxBaseHTTPServerAuthenticationManager {
+public:
+    typedef ofPtr<ofxHTTPServerBearerAuthenticator> Ptr;
+    
+    struct Settings;
+    
+    ofxHTTPServerBearerAuthenticator(const Settings& _settings = Settings());
+    virtual ~ofxHTTPServerBearerAuthenticator();
+    
+    ofxHTTPAuthStatus authenticate(HTTPServerRequest& request);
+    void setAuthenticationRequiredHeaders(HTTPServerResponse& response);
+    
+    // also reports what the token says, e.g. its subject
+    ofxHTTPAuthStatus authenticate(HTTPServerRequest& request, ofxHTTPServerTokenInfo& info);
+    
+    // sends the 401 response itself if authentication fails
+    bool isAuthenticated(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+    // forget a verified token, e.g. when it was revoked
+    void invalidate(const string& token);
+    void clearCache();
+    
+    size_t getNumCachedTokens();
+    
+    struct Settings {
+        string realm;
+        ofxBaseHTTPServerTokenVerifier::Ptr verifier;
+        
+        Timespan clockSkew;        // leeway for exp and nbf
+        Timespan cacheTtl;         // longest a token goes unverified
+        size_t maxCachedTokens;
+        size_t numShards;          // rounded up to a power of two
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+protected:
+    struct Entry {
+        ofxHTTPServerTokenInfo info;
+        Timestamp expires;
+        list<string>::iterator lruPosition;
+        multimap<Timestamp, string>::iterator expiryPosition;
+    };
+    
+    struct Shard {
+        ofMutex mutex;
+        HashMap<string, Entry> tokens;
+        list<string> lru;                    // most recently used first
+        multimap<Timestamp, string> expiries;
+        
+        // expected to hold the mutex
+        void erase(HashMap<string, Entry>::Iterator iter);
+    };
+    
+    bool isCurrent(const ofxHTTPServerTokenInfo& info, const Timestamp& now) const;
+    
+    static string hashToken(const string& token);
+    Shard& getShard(const string& tokenHash);
+    
+    Settings settings;
+    size_t maxTokensPerShard;
+    
+    ofxHTTPShards<Shard> shards;
+    
+};
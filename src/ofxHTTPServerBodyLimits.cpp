@@ -0,0 +1,62 @@
+#include "ofxHTTPServerBodyLimits.h"
+
+#include "Poco/Exception.h"
+#include "Poco/Net/HTTPMessage.h"
+
+#include "ofLog.h"
+
+using Poco::Exception;
+using Poco::Net::HTTPMessage;
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBodyLimits::ofxHTTPServerBodyLimits() :
+bAllowBody(true),
+maxBodySize(0),
+bRequireContentLength(false)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBodyLimits::~ofxHTTPServerBodyLimits() { }
+
+//------------------------------------------------------------------------------
+HTTPResponse::HTTPStatus ofxHTTPServerBodyLimits::check(const HTTPServerRequest& request) const {
+    if(!hasBody(request)) {
+        return HTTPResponse::HTTP_OK;
+    }
+
+    long long contentLength = request.getContentLength();
+
+    if(contentLength == HTTPMessage::UNKNOWN_CONTENT_LENGTH) {
+        // a chunked body has to be limited by whoever reads it
+        if(bRequireContentLength) {
+            return HTTPResponse::HTTP_LENGTH_REQUIRED;
+        }
+    } else if(maxBodySize > 0 && static_cast<unsigned long long>(contentLength) > maxBodySize) {
+        return HTTPResponse::HTTP_REQUESTENTITYTOOLARGE;
+    }
+
+    if(!acceptedContentTypes.empty()) {
+        try {
+            MediaType mediaType(request.getContentType());
+            vector<MediaType>::const_iterator iter = acceptedContentTypes.begin();
+            while(iter != acceptedContentTypes.end()) {
+                if(mediaType.matchesRange(*iter)) {
+                    return HTTPResponse::HTTP_OK;
+                }
+                ++iter;
+            }
+        } catch(const Exception& exc) {
+            ofLogVerbose("ofxHTTPServerBodyLimits::check") << exc.displayText();
+        }
+        return HTTPResponse::HTTP_UNSUPPORTED_MEDIATYPE;
+    }
+
+    return HTTPResponse::HTTP_OK;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerBodyLimits::hasBody(const HTTPServerRequest& request) {
+    long long contentLength = request.getContentLength();
+    return contentLength > 0 ||
+           (contentLength == HTTPMessage::UNKNOWN_CONTENT_LENGTH && request.getChunkedTransferEncoding());
+}
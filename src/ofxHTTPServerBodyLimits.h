@@ -0,0 +1,60 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <vector>
+
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/MediaType.h"
+
+using std::vector;
+
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::MediaType;
+
+// What a route is willing to receive in a request body.  Limits are
+// checked as soon as the request headers arrive, before the handler runs,
+// so a request that would be rejected anyway is answered without reading
+// its body.  Clients that sent "Expect: 100-continue" get the rejection
+// instead of "100 Continue" and never send the body at all.
+class ofxHTTPServerBodyLimits {
+public:
+    ofxHTTPServerBodyLimits();
+    virtual ~ofxHTTPServerBodyLimits();
+
+    // returns HTTP_OK, or the status to reject the request with
+    virtual HTTPResponse::HTTPStatus check(const HTTPServerRequest& request) const;
+
+    // true if the request announces a body (a content length or chunks)
+    static bool hasBody(const HTTPServerRequest& request);
+
+    bool bAllowBody; // if false, a body is never read and the connection is closed after the response
+    unsigned long long maxBodySize; // checked against Content-Length, 0 is unlimited
+    bool bRequireContentLength; // reject chunked bodies with 411
+    vector<MediaType> acceptedContentTypes; // empty accepts all
+
+};
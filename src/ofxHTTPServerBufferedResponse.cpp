@@ -0,0 +1,64 @@
+#include "ofxHTTPServerBufferedResponse.h"
+
+#include <fstream>
+
+#include "Poco/Exception.h"
+#include "Poco/StreamCopier.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBufferedResponse::ofxHTTPServerBufferedResponse() : bSent(false) { }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBufferedResponse::~ofxHTTPServerBufferedResponse() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBufferedResponse::sendContinue() {
+    // there is no client waiting to send a body
+}
+
+//------------------------------------------------------------------------------
+ostream& ofxHTTPServerBufferedResponse::send() {
+    bSent = true;
+    return body;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBufferedResponse::sendFile(const string& path, const string& mediaType) {
+    std::ifstream istr(path.c_str(), std::ios::in | std::ios::binary);
+    
+    if(!istr.good()) {
+        throw Poco::OpenFileException(path);
+    }
+    
+    setContentType(mediaType);
+    Poco::StreamCopier::copyStream(istr, send());
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBufferedResponse::sendBuffer(const void* pBuffer, std::size_t length) {
+    send().write(static_cast<const char*>(pBuffer), static_cast<std::streamsize>(length));
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBufferedResponse::redirect(const string& uri, HTTPStatus status) {
+    setStatusAndReason(status);
+    set("Location", uri);
+    send();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBufferedResponse::requireAuthentication(const string& realm) {
+    setStatusAndReason(HTTP_UNAUTHORIZED);
+    set("WWW-Authenticate", "Basic realm=\"" + realm + "\"");
+    send();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerBufferedResponse::sent() const {
+    return bSent;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerBufferedResponse::getBody() const {
+    return body.str();
+}
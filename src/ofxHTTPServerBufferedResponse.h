@@ -0,0 +1,59 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "Poco/Net/HTTPServerResponse.h"
+
+using std::ostream;
+using std::ostringstream;
+using std::string;
+
+using Poco::Net::HTTPServerResponse;
+
+// An HTTPServerResponse that keeps what a handler sends in memory instead
+// of writing it to a connection, so it can be stored and sent later.
+class ofxHTTPServerBufferedResponse : public HTTPServerResponse {
+public:
+    ofxHTTPServerBufferedResponse();
+    virtual ~ofxHTTPServerBufferedResponse();
+    
+    void sendContinue();
+    ostream& send();
+    void sendFile(const string& path, const string& mediaType);
+    void sendBuffer(const void* pBuffer, std::size_t length);
+    void redirect(const string& uri, HTTPStatus status = HTTP_FOUND);
+    void requireAuthentication(const string& realm);
+    bool sent() const;
+    
+    string getBody() const;
+    
+protected:
+    ostringstream body;
+    bool bSent;
+    
+};
@@ -0,0 +1,135 @@
+#include "ofxHTTPServerBulkhead.h"
+
+#include <algorithm>
+
+#include "Poco/NumberFormatter.h"
+#include "Poco/Timestamp.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPUtils.h"
+
+using Poco::Timestamp;
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBulkhead::Settings::Settings() {
+    name          = "";
+    maxConcurrent = 16;
+    maxQueued     = 16;
+    queueTimeout  = Timespan(5 * Timespan::SECONDS);
+    retryAfter    = Timespan(1 * Timespan::SECONDS);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBulkhead::ofxHTTPServerBulkhead(const Settings& _settings) :
+settings(_settings)
+{
+    if(settings.maxConcurrent < 1) {
+        settings.maxConcurrent = 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBulkhead::~ofxHTTPServerBulkhead() { }
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerBulkhead::acquire() {
+    ofScopedLock lock(mutex);
+    
+    if(metrics.active < settings.maxConcurrent) {
+        ++metrics.active;
+        return true;
+    }
+    
+    if(metrics.queued >= settings.maxQueued) {
+        ++metrics.rejected;
+        return false;
+    }
+    
+    ++metrics.queued;
+    
+    Timestamp deadline = Timestamp() + settings.queueTimeout;
+    
+    while(metrics.active >= settings.maxConcurrent) {
+        Timestamp::TimeDiff remaining = deadline - Timestamp();
+        if(remaining <= 0) {
+            --metrics.queued;
+            ++metrics.timedOut;
+            return false;
+        }
+        slotReleased.tryWait(mutex, static_cast<long>(remaining / 1000) + 1);
+    }
+    
+    --metrics.queued;
+    ++metrics.active;
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBulkhead::release() {
+    ofScopedLock lock(mutex);
+    
+    if(metrics.active == 0) {
+        ofLogError("ofxHTTPServerBulkhead::release") << "Released more slots than were acquired in " << settings.name << ".";
+        return;
+    }
+    
+    --metrics.active;
+    ++metrics.completed;
+    
+    slotReleased.signal();
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerBulkhead::getName() const {
+    return settings.name;
+}
+
+//------------------------------------------------------------------------------
+Timespan ofxHTTPServerBulkhead::getRetryAfter() const {
+    return settings.retryAfter;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerBulkhead::getMaxThreads() const {
+    return settings.maxConcurrent + settings.maxQueued;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBulkhead::Metrics ofxHTTPServerBulkhead::getMetrics() const {
+    ofScopedLock lock(mutex);
+    return metrics;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBulkhead::Ptr ofxHTTPServerBulkhead::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerBulkhead(settings));
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBulkheadHandler::ofxHTTPServerBulkheadHandler(HTTPRequestHandler* _handler,
+                                                           ofxHTTPServerBulkhead::Ptr _bulkhead) :
+ofxHTTPServerDecoratorHandler(_handler),
+bulkhead(_bulkhead)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerBulkheadHandler::~ofxHTTPServerBulkheadHandler() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerBulkheadHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) {
+    if(!bulkhead->acquire()) {
+        Timespan retryAfter = bulkhead->getRetryAfter();
+        
+        ofxHTTPServerRouteHandler::rejectWithoutBody(request, response, HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
+        response.set("Retry-After", Poco::NumberFormatter::format(std::max<Timespan::TimeDiff>(1, retryAfter.totalSeconds())));
+        response.setContentLength(0);
+        response.send();
+        return;
+    }
+    
+    ofxHTTPServerSlotGuard<ofxHTTPServerBulkhead> guard(*bulkhead);
+    
+    forward(request, response);
+}
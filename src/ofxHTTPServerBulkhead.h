@@ -0,0 +1,124 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "Poco/Condition.h"
+#include "Poco/Timespan.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPServerRouteHandler.h"
+
+using std::string;
+
+using Poco::Timespan;
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+
+// A share of the server's threads set aside for a class of routes.
+//
+// Requests for the routes behind a bulkhead run at most maxConcurrent at
+// a time.  Up to maxQueued more wait for a slot for at most queueTimeout,
+// anything beyond that is answered 503 right away.  A waiting request
+// keeps the server thread it arrived on, so a bulkhead can hold up to
+// maxConcurrent + maxQueued threads.  Routes that hold connections for
+// long, such as websockets and uploads, can then only take their share of
+// the threads, and the rest stay free for the other routes.  The shares,
+// queues included, should add up to less than the server's maxThreads;
+// ofxHTTPServer::start() warns if they don't.
+class ofxHTTPServerBulkhead {
+public:
+    typedef ofPtr<ofxHTTPServerBulkhead> Ptr;
+    
+    struct Settings;
+    
+    struct Metrics {
+        Metrics() : active(0), queued(0), completed(0), rejected(0), timedOut(0) { }
+        
+        size_t active;
+        size_t queued;
+        unsigned long long completed;
+        unsigned long long rejected;    // the queue was full
+        unsigned long long timedOut;    // waited queueTimeout
+    };
+    
+    ofxHTTPServerBulkhead(const Settings& _settings = Settings());
+    virtual ~ofxHTTPServerBulkhead();
+    
+    // waits for a slot, returns false if the request is to be turned away.
+    // Every successful acquire must be followed by a release.
+    bool acquire();
+    void release();
+    
+    string getName() const;
+    Timespan getRetryAfter() const;
+    
+    // the most server threads the bulkhead's requests hold at once,
+    // running or waiting
+    size_t getMaxThreads() const;
+    Metrics getMetrics() const;
+    
+    struct Settings {
+        string name;            // for logging
+        size_t maxConcurrent;
+        size_t maxQueued;
+        Timespan queueTimeout;
+        Timespan retryAfter;    // suggested to the clients turned away
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+protected:
+    Settings settings;
+    
+    mutable ofMutex mutex;
+    Poco::Condition slotReleased;
+    
+    Metrics metrics;
+    
+};
+
+// Runs another route's handler inside a bulkhead slot, or answers 503
+// Service Unavailable if no slot became free.
+//------------------------------------------------------------------------------
+class ofxHTTPServerBulkheadHandler : public ofxHTTPServerDecoratorHandler {
+public:
+    ofxHTTPServerBulkheadHandler(HTTPRequestHandler* _handler, ofxHTTPServerBulkhead::Ptr _bulkhead);
+    virtual ~ofxHTTPServerBulkheadHandler();
+    
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+protected:
+    ofxHTTPServerBulkhead::Ptr bulkhead;
+    
+};
@@ -0,0 +1,72 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerBulkhead.h"
+
+// Runs another route's requests inside a bulkhead.  Routes of the same
+// class, e.g. all websocket routes, share one bulkhead.
+//------------------------------------------------------------------------------
+class ofxHTTPServerBulkheadRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofPtr<ofxHTTPServerBulkheadRoute> Ptr;
+
+    ofxHTTPServerBulkheadRoute(ofxBaseHTTPServerRoute::Ptr _route,
+                               ofxHTTPServerBulkhead::Ptr _bulkhead) :
+    route(_route),
+    bulkhead(_bulkhead)
+    { }
+
+    virtual ~ofxHTTPServerBulkheadRoute() { }
+
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        return route->canHandleRequest(request, bIsSecurePort);
+    }
+
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        return route->getBodyLimits(request);
+    }
+
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        HTTPRequestHandler* handler = route->createRequestHandler(request);
+        if(handler == NULL) {
+            return NULL;
+        }
+        return new ofxHTTPServerBulkheadHandler(handler, bulkhead);
+    }
+
+    ofxBaseHTTPServerRoute::Ptr getRoute() const { return route; }
+    ofxHTTPServerBulkhead::Ptr getBulkhead() const { return bulkhead; }
+
+    static Ptr Instance(ofxBaseHTTPServerRoute::Ptr route, ofxHTTPServerBulkhead::Ptr bulkhead) {
+        return Ptr(new ofxHTTPServerBulkheadRoute(route, bulkhead));
+    }
+
+protected:
+    ofxBaseHTTPServerRoute::Ptr route;
+    ofxHTTPServerBulkhead::Ptr bulkhead;
+
+};
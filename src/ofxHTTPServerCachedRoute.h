@@ -0,0 +1,72 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerCachedRouteHandler.h"
+#include "ofxHTTPServerResponseCache.h"
+
+// Puts a response cache in front of another route.  Repeated GET and
+// HEAD requests are answered from memory for a short while, concurrent
+// misses run the route's handler once, and other methods pass through
+// and drop the cached responses for their URI.
+//------------------------------------------------------------------------------
+class ofxHTTPServerCachedRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofPtr<ofxHTTPServerCachedRoute> Ptr;
+
+    ofxHTTPServerCachedRoute(ofxBaseHTTPServerRoute::Ptr _route,
+                             ofxHTTPServerResponseCache::Ptr _cache) :
+    route(_route),
+    cache(_cache)
+    { }
+
+    virtual ~ofxHTTPServerCachedRoute() { }
+
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        return route->canHandleRequest(request, bIsSecurePort);
+    }
+
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        return route->getBodyLimits(request);
+    }
+
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        return new ofxHTTPServerCachedRouteHandler(route, cache, request);
+    }
+
+    ofxBaseHTTPServerRoute::Ptr getRoute() const { return route; }
+    ofxHTTPServerResponseCache::Ptr getCache() const { return cache; }
+
+    static Ptr Instance(ofxBaseHTTPServerRoute::Ptr route,
+                        ofxHTTPServerResponseCache::Ptr cache = ofxHTTPServerResponseCache::Instance()) {
+        return Ptr(new ofxHTTPServerCachedRoute(route, cache));
+    }
+
+protected:
+    ofxBaseHTTPServerRoute::Ptr route;
+    ofxHTTPServerResponseCache::Ptr cache;
+
+};
@@ -0,0 +1,118 @@
+#include "ofxHTTPServerCachedRouteHandler.h"
+
+#include "Poco/Exception.h"
+#include "Poco/String.h"
+#include "Poco/Net/HTTPRequest.h"
+
+using Poco::Net::HTTPRequest;
+
+//------------------------------------------------------------------------------
+ofxHTTPServerCachedRouteHandler::ofxHTTPServerCachedRouteHandler(ofxBaseHTTPServerRoute::Ptr _route,
+                                                                 ofxHTTPServerResponseCache::Ptr _cache,
+                                                                 const HTTPServerRequest& _request) :
+route(_route),
+cache(_cache),
+lookupRequest(_request),
+result(ofxHTTPServerResponseCache::PASS),
+bRevalidate(false),
+bSecure(false),
+bPending(false)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerCachedRouteHandler::~ofxHTTPServerCachedRouteHandler() {
+    // never leave the requests waiting on this one hanging
+    if(bPending) {
+        cache->finish(key, lookupRequest, bSecure, NULL);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerCachedRouteHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) {
+    // the listener is only known once the handler has been tagged
+    bSecure = getListener() != NULL && getListener()->isSecure();
+    
+    // a miss may wait here for another request to compute the response
+    result = cache->lookup(lookupRequest, bSecure, cachedResponse, bRevalidate, key);
+    bPending = result == ofxHTTPServerResponseCache::MISS || bRevalidate;
+    
+    switch(result) {
+        case ofxHTTPServerResponseCache::HIT:
+            ofxHTTPServerResponseCache::send(cachedResponse, response);
+            return;
+        case ofxHTTPServerResponseCache::STALE:
+            ofxHTTPServerResponseCache::send(cachedResponse, response);
+            if(bRevalidate) {
+                // the client has its answer, the replacement is computed
+                // on this thread before it reads the next request.
+                try {
+                    ofxHTTPServerBufferedResponse buffered;
+                    compute(request, buffered);
+                } catch(const Poco::Exception& exc) {
+                    ofLogError("ofxHTTPServerCachedRouteHandler::handleRequest") << "Revalidation failed: " << exc.displayText();
+                }
+            }
+            return;
+        case ofxHTTPServerResponseCache::MISS: {
+            ofxHTTPServerBufferedResponse buffered;
+            compute(request, buffered);
+            send(buffered, response);
+            return;
+        }
+        case ofxHTTPServerResponseCache::PASS:
+            run(request, response);
+            
+            // whatever was cached for it may have just changed
+            if(request.getMethod() != HTTPRequest::HTTP_GET &&
+               request.getMethod() != HTTPRequest::HTTP_HEAD &&
+               request.getMethod() != HTTPRequest::HTTP_OPTIONS) {
+                cache->invalidate(request, bSecure);
+            }
+            return;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerCachedRouteHandler::compute(HTTPServerRequest& request, ofxHTTPServerBufferedResponse& buffered) {
+    buffered.setVersion(HTTPResponse::HTTP_1_1);
+    
+    run(request, buffered);
+    
+    bPending = false;
+    cache->finish(key, request, bSecure, &buffered);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerCachedRouteHandler::run(HTTPServerRequest& request, HTTPServerResponse& response) {
+    ofPtr<HTTPRequestHandler> pHandler(route->createRequestHandler(request));
+    
+    if(pHandler == NULL) {
+        throw Poco::NullPointerException("The cached route did not create a handler.");
+    }
+    
+    forward(*pHandler, request, response);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerCachedRouteHandler::send(const ofxHTTPServerBufferedResponse& buffered, HTTPServerResponse& response) {
+    response.setStatusAndReason(buffered.getStatus(), buffered.getReason());
+    
+    NameValueCollection::ConstIterator iter = buffered.begin();
+    while(iter != buffered.end()) {
+        const string& name = (*iter).first;
+        if(Poco::icompare(name, "Connection") == 0) {
+            if(Poco::icompare((*iter).second, "close") == 0) {
+                response.setKeepAlive(false);
+            }
+        } else if(Poco::icompare(name, "Content-Length") != 0 &&
+                  Poco::icompare(name, "Transfer-Encoding") != 0 &&
+                  Poco::icompare(name, "Date") != 0 &&
+                  Poco::icompare(name, "Server") != 0) {
+            response.add(name, (*iter).second);
+        }
+        ++iter;
+    }
+    
+    string body = buffered.getBody();
+    response.sendBuffer(body.data(), body.size());
+}
@@ -0,0 +1,72 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "Poco/Net/HTTPRequestHandler.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerBufferedResponse.h"
+#include "ofxHTTPServerResponseCache.h"
+#include "ofxHTTPServerRouteHandler.h"
+
+using std::string;
+
+using Poco::Net::HTTPRequestHandler;
+
+// Serves a request from the response cache, or runs the cached route's
+// own handler and stores what it sends.
+//------------------------------------------------------------------------------
+class ofxHTTPServerCachedRouteHandler : public ofxHTTPServerRouteHandler {
+public:
+    ofxHTTPServerCachedRouteHandler(ofxBaseHTTPServerRoute::Ptr _route,
+                                    ofxHTTPServerResponseCache::Ptr _cache,
+                                    const HTTPServerRequest& _request);
+    virtual ~ofxHTTPServerCachedRouteHandler();
+    
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+protected:
+    ofxBaseHTTPServerRoute::Ptr route;
+    ofxHTTPServerResponseCache::Ptr cache;
+    const HTTPServerRequest& lookupRequest;
+    
+    ofxHTTPServerResponseCache::Result result;
+    ofxHTTPServerResponseCache::ResponsePtr cachedResponse;
+    bool bRevalidate;
+    bool bSecure;
+    string key;
+    bool bPending;  // a finish() is owed to the cache
+    
+    // runs the route's handler into a buffered response and stores it
+    void compute(HTTPServerRequest& request, ofxHTTPServerBufferedResponse& buffered);
+    
+    void run(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+    // copies a computed response to the client
+    static void send(const ofxHTTPServerBufferedResponse& buffered, HTTPServerResponse& response);
+    
+};
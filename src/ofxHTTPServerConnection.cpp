@@ -0,0 +1,328 @@
+#include "ofxHTTPServerConnection.h"
+
+#include "Poco/Timestamp.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPServerRequestImpl.h"
+#include "Poco/Net/HTTPServerResponseImpl.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/SocketDefs.h"
+
+#include "ofxHTTPServerExchange.h"
+#include "ofxHTTPServerRouteHandler.h"
+
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPServerRequestImpl;
+using Poco::Net::HTTPServerResponseImpl;
+using Poco::Net::MessageException;
+using Poco::Net::NoMessageException;
+
+#ifdef SSL_ENABLED
+#include "Poco/Net/SecureStreamSocket.h"
+
+using Poco::Net::SecureStreamSocket;
+#endif
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSession::ofxHTTPServerSession(const StreamSocket& socket,
+                                           HTTPServerParams::Ptr params,
+                                           ofxHTTPServerConnection& _connection) :
+HTTPServerSession(socket, params),
+connection(_connection)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSession::~ofxHTTPServerSession() { }
+
+//------------------------------------------------------------------------------
+int ofxHTTPServerSession::read(char* buffer, std::streamsize length) {
+    connection.beginRead();
+    try {
+        int n = HTTPServerSession::read(buffer, length);
+        connection.endRead(n);
+        return n;
+    } catch(...) {
+        connection.endRead(0);
+        throw;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnection::ofxHTTPServerConnection(const StreamSocket& socket,
+                                                 HTTPServerParams::Ptr _params,
+                                                 HTTPRequestHandlerFactory::Ptr _factory,
+                                                 ofxHTTPServerConnectionMonitor& _monitor,
+                                                 ofxHTTPServerListener::Ptr _listener) :
+TCPServerConnection(socket),
+params(_params),
+factory(_factory),
+monitor(_monitor),
+listener(_listener),
+phase(PHASE_NONE),
+timerId(0),
+bAborted(false),
+pendingReads(0),
+bodyBytes(0)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnection::~ofxHTTPServerConnection() {
+    // the wheel must never call a connection that is gone
+    disarm();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnection::run() {
+    string server = params->getSoftwareVersion();
+
+    monitor.connectionOpened();
+
+    // the first request is not preceded by a keep-alive wait, so its
+    // header deadline starts as soon as the connection is accepted.
+    arm(PHASE_HEADER);
+
+    bool bFirstRequest = true;
+
+    try {
+        StreamSocket connectionSocket = socket();
+
+#ifdef SSL_ENABLED
+        if(listener != NULL && listener->isSecure()) {
+            connectionSocket = SecureStreamSocket::attach(socket(), listener->getSSLContext());
+        }
+#endif
+
+        ofxHTTPServerSession session(connectionSocket, params, *this);
+
+        while(!isAborted()) {
+            if(!bFirstRequest) {
+                arm(PHASE_IDLE);
+                // a timeout here was counted by timerExpired(), the rest
+                // are clients closing or keep-alive ending
+                if(!session.hasMoreRequests()) {
+                    break;
+                }
+                arm(PHASE_HEADER);
+            }
+
+            bFirstRequest = false;
+
+            try {
+                ofxHTTPServerResponseImpl response(session);
+                HTTPServerRequestImpl request(response, session, params);
+
+                arm(PHASE_BODY);
+
+                Poco::Timestamp now;
+                response.setDate(now);
+                response.setVersion(request.getVersion());
+                response.setKeepAlive(params->getKeepAlive() && request.getKeepAlive() && session.canKeepAlive());
+
+                if(!server.empty()) {
+                    response.set("Server", server);
+                }
+
+                try {
+                    ofPtr<HTTPRequestHandler> pHandler(factory->createRequestHandler(request));
+
+                    if(pHandler.get() != NULL) {
+                        // route handlers check the route's body limits
+                        // first and decide for themselves.
+                        if(request.expectContinue() &&
+                           dynamic_cast<ofxHTTPServerRouteHandler*>(pHandler.get()) == NULL) {
+                            response.sendContinue();
+                        }
+
+                        pHandler->handleRequest(request, response);
+                        session.setKeepAlive(params->getKeepAlive() && response.getKeepAlive() && session.canKeepAlive());
+                    } else {
+                        sendErrorResponse(session, HTTPResponse::HTTP_NOT_IMPLEMENTED);
+                    }
+                } catch(const Poco::Exception&) {
+                    if(!response.sent() && !isAborted()) {
+                        try {
+                            sendErrorResponse(session, HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+                        } catch(...) {
+                            // the connection is beyond saving
+                        }
+                    }
+                    throw;
+                }
+
+                // the handler took the socket (e.g. a websocket)
+                if(!session.connected()) {
+                    break;
+                }
+            } catch(const NoMessageException&) {
+                break;
+            } catch(const MessageException&) {
+                if(isAborted()) {
+                    break;
+                }
+                sendErrorResponse(session, HTTPResponse::HTTP_BAD_REQUEST);
+            }
+        }
+    } catch(const Poco::Exception&) {
+        disarm();
+        monitor.connectionClosed();
+
+        // failures caused by shutting down an offender are expected
+        if(!isAborted()) {
+            throw;
+        }
+        return;
+    }
+
+    disarm();
+    monitor.connectionClosed();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnection::timerExpired(unsigned long long _timerId) {
+    // called with the wheel's mutex held
+    if(_timerId != timerId) {
+        return; // stale
+    }
+
+    timerId = 0;
+
+    ofxHTTPServerConnectionMonitor::Settings settings = monitor.getSettings();
+
+    switch(phase) {
+        case PHASE_IDLE:
+            monitor.idleTimedOut();
+            abort();
+            break;
+        case PHASE_HEADER:
+            monitor.headerTimedOut();
+            abort();
+            break;
+        case PHASE_BODY: {
+            bool bTooSlow = false;
+            {
+                ofScopedLock lock(bodyMutex);
+
+                // only a handler that is actually waiting on the client is
+                // held to the rate; handlers that are busy or finished reading
+                // are left alone.
+                double seconds = settings.bodyRateInterval.totalMilliseconds() / 1000.0;
+                unsigned long long minBytes = static_cast<unsigned long long>(settings.minBodyRate * seconds);
+
+                bTooSlow = pendingReads > 0 && bodyBytes < minBytes;
+                bodyBytes = 0;
+            }
+
+            if(bTooSlow) {
+                monitor.slowBodyClosed();
+                abort();
+            } else {
+                timerId = monitor.getTimerWheel().schedule(this, settings.bodyRateInterval);
+            }
+            break;
+        }
+        case PHASE_NONE:
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnection::beginRead() {
+    ofScopedLock lock(bodyMutex);
+    ++pendingReads;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnection::endRead(int bytesRead) {
+    ofScopedLock lock(bodyMutex);
+    --pendingReads;
+    if(bytesRead > 0) {
+        bodyBytes += bytesRead;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnection::arm(Phase _phase) {
+    ofxHTTPTimerWheel& wheel = monitor.getTimerWheel();
+    Poco::Mutex::ScopedLock lock(wheel.getMutex());
+
+    if(timerId != 0) {
+        wheel.cancel(timerId);
+        timerId = 0;
+    }
+
+    phase = _phase;
+
+    ofxHTTPServerConnectionMonitor::Settings settings = monitor.getSettings();
+
+    Timespan delay;
+
+    switch(phase) {
+        case PHASE_IDLE:
+            delay = settings.idleTimeout;
+            break;
+        case PHASE_HEADER:
+            delay = settings.headerTimeout;
+            break;
+        case PHASE_BODY: {
+            ofScopedLock bodyLock(bodyMutex);
+            bodyBytes = 0;
+            if(settings.minBodyRate > 0) {
+                delay = settings.bodyRateInterval;
+            }
+            break;
+        }
+        case PHASE_NONE:
+            break;
+    }
+
+    if(delay.totalMicroseconds() > 0) {
+        timerId = wheel.schedule(this, delay);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnection::disarm() {
+    arm(PHASE_NONE);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnection::abort() {
+    bAborted = true;
+    // shutting down (rather than closing) keeps the descriptor valid for the
+    // worker thread, whose blocking call returns with an error or EOF.
+    ::shutdown(socket().impl()->sockfd(), 2); // SHUT_RDWR / SD_BOTH
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerConnection::isAborted() {
+    Poco::Mutex::ScopedLock lock(monitor.getTimerWheel().getMutex());
+    return bAborted;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnection::sendErrorResponse(HTTPServerSession& session, HTTPResponse::HTTPStatus status) {
+    HTTPServerResponseImpl response(session);
+    response.setVersion(HTTPResponse::HTTP_1_1);
+    response.setStatusAndReason(status);
+    response.setKeepAlive(false);
+    response.send();
+    session.setKeepAlive(false);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionFactory::ofxHTTPServerConnectionFactory(HTTPServerParams::Ptr _params,
+                                                               HTTPRequestHandlerFactory::Ptr _factory,
+                                                               ofxHTTPServerConnectionMonitor& _monitor,
+                                                               ofxHTTPServerListener::Ptr _listener) :
+params(_params),
+factory(_factory),
+monitor(_monitor),
+listener(_listener)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionFactory::~ofxHTTPServerConnectionFactory() { }
+
+//------------------------------------------------------------------------------
+TCPServerConnection* ofxHTTPServerConnectionFactory::createConnection(const StreamSocket& socket) {
+    return new ofxHTTPServerConnection(socket, params, factory, monitor, listener);
+}
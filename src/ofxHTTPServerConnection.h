@@ -0,0 +1,147 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+
+#pragma once
+
+#include <string>
+
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPServerSession.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/TCPServerConnection.h"
+#include "Poco/Net/TCPServerConnectionFactory.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPServerConnectionMonitor.h"
+#include "ofxHTTPServerListener.h"
+#include "ofxHTTPTimerWheel.h"
+
+using std::string;
+
+using Poco::Net::HTTPRequestHandlerFactory;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPServerParams;
+using Poco::Net::HTTPServerSession;
+using Poco::Net::StreamSocket;
+using Poco::Net::TCPServerConnection;
+using Poco::Net::TCPServerConnectionFactory;
+
+class ofxHTTPServerConnection;
+
+// Reports body reads to its connection so the minimum body rate can be
+// enforced.  Headers are parsed with get()/peek() and are not counted.
+class ofxHTTPServerSession : public HTTPServerSession {
+public:
+    ofxHTTPServerSession(const StreamSocket& socket,
+                         HTTPServerParams::Ptr params,
+                         ofxHTTPServerConnection& _connection);
+
+    virtual ~ofxHTTPServerSession();
+
+    int read(char* buffer, std::streamsize length);
+
+protected:
+    ofxHTTPServerConnection& connection;
+
+};
+
+// Serves HTTP requests on a single connection, like Poco's own
+// HTTPServerConnection, but with deadlines kept on the monitor's timer
+// wheel rather than on socket timeouts that only apply to a single
+// blocking call.  A connection that misses a deadline is shut down,
+// which unblocks the worker thread serving it.  TLS is negotiated here
+// for SECURE listeners, with the handshake counted against the header
+// deadline.
+class ofxHTTPServerConnection : public TCPServerConnection, public ofxBaseHTTPTimerListener {
+public:
+    ofxHTTPServerConnection(const StreamSocket& socket,
+                            HTTPServerParams::Ptr _params,
+                            HTTPRequestHandlerFactory::Ptr _factory,
+                            ofxHTTPServerConnectionMonitor& _monitor,
+                            ofxHTTPServerListener::Ptr _listener);
+
+    virtual ~ofxHTTPServerConnection();
+
+    void run();
+
+    void timerExpired(unsigned long long _timerId);
+
+    // called by the session around body reads
+    void beginRead();
+    void endRead(int bytesRead);
+
+protected:
+    enum Phase {
+        PHASE_NONE,
+        PHASE_IDLE,   // waiting for the next keep-alive request
+        PHASE_HEADER, // receiving a request header
+        PHASE_BODY    // a handler owns the request
+    };
+
+    void arm(Phase _phase);
+    void disarm();
+    void abort(); // wheel mutex must be held
+    bool isAborted();
+
+    void sendErrorResponse(HTTPServerSession& session, HTTPResponse::HTTPStatus status);
+
+    HTTPServerParams::Ptr params;
+    HTTPRequestHandlerFactory::Ptr factory;
+    ofxHTTPServerConnectionMonitor& monitor;
+    ofxHTTPServerListener::Ptr listener;
+
+    // guarded by the timer wheel's mutex
+    Phase phase;
+    ofxHTTPTimerWheel::TimerId timerId;
+    bool bAborted;
+
+    // guarded by bodyMutex
+    ofMutex bodyMutex;
+    int pendingReads;
+    unsigned long long bodyBytes;
+
+};
+
+class ofxHTTPServerConnectionFactory : public TCPServerConnectionFactory {
+public:
+    ofxHTTPServerConnectionFactory(HTTPServerParams::Ptr _params,
+                                   HTTPRequestHandlerFactory::Ptr _factory,
+                                   ofxHTTPServerConnectionMonitor& _monitor,
+                                   ofxHTTPServerListener::Ptr _listener);
+
+    virtual ~ofxHTTPServerConnectionFactory();
+
+    TCPServerConnection* createConnection(const StreamSocket& socket);
+
+protected:
+    HTTPServerParams::Ptr params;
+    HTTPRequestHandlerFactory::Ptr factory;
+    ofxHTTPServerConnectionMonitor& monitor;
+    ofxHTTPServerListener::Ptr listener;
+
+};
@@ -0,0 +1,92 @@
+#include "ofxHTTPServerConnectionMonitor.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionMonitor::Settings::Settings() {
+    headerTimeout    = Timespan(10*Timespan::SECONDS);
+    idleTimeout      = Timespan(10*Timespan::SECONDS);
+    minBodyRate      = 1024; // 1 KB/s
+    bodyRateInterval = Timespan(10*Timespan::SECONDS);
+    timerResolution  = Timespan(100*Timespan::MILLISECONDS);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionMonitor::Metrics::Metrics() {
+    connectionsAccepted = 0;
+    connectionsActive   = 0;
+    headerTimeouts      = 0;
+    idleTimeouts        = 0;
+    slowBodyClosures    = 0;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionMonitor::ofxHTTPServerConnectionMonitor(const Settings& _settings) :
+settings(_settings),
+timerWheel(_settings.timerResolution)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionMonitor::~ofxHTTPServerConnectionMonitor() {
+    stop();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnectionMonitor::start() {
+    timerWheel.start();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnectionMonitor::stop() {
+    timerWheel.stop();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionMonitor::Settings ofxHTTPServerConnectionMonitor::getSettings() const {
+    return settings;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionMonitor::Metrics ofxHTTPServerConnectionMonitor::getMetrics() const {
+    Metrics metrics;
+    metrics.connectionsAccepted = connectionsAccepted.value();
+    metrics.connectionsActive   = connectionsActive.value();
+    metrics.headerTimeouts      = headerTimeouts.value();
+    metrics.idleTimeouts        = idleTimeouts.value();
+    metrics.slowBodyClosures    = slowBodyClosures.value();
+    return metrics;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPTimerWheel& ofxHTTPServerConnectionMonitor::getTimerWheel() {
+    return timerWheel;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnectionMonitor::connectionOpened() {
+    ++connectionsAccepted;
+    ++connectionsActive;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnectionMonitor::connectionClosed() {
+    --connectionsActive;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnectionMonitor::headerTimedOut() {
+    ++headerTimeouts;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnectionMonitor::idleTimedOut() {
+    ++idleTimeouts;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerConnectionMonitor::slowBodyClosed() {
+    ++slowBodyClosures;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerConnectionMonitor::Ptr ofxHTTPServerConnectionMonitor::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerConnectionMonitor(settings));
+}
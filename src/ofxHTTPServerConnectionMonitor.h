@@ -0,0 +1,98 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+
+#pragma once
+
+#include "Poco/AtomicCounter.h"
+#include "Poco/Timespan.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPTimerWheel.h"
+
+using Poco::AtomicCounter;
+using Poco::Timespan;
+
+// Owns the timer wheel that enforces connection deadlines and keeps
+// count of the connections that were closed for missing them.
+class ofxHTTPServerConnectionMonitor {
+public:
+    struct Settings;
+    struct Metrics;
+
+    typedef ofPtr<ofxHTTPServerConnectionMonitor> Ptr;
+
+    ofxHTTPServerConnectionMonitor(const Settings& _settings);
+    virtual ~ofxHTTPServerConnectionMonitor();
+
+    void start();
+    void stop();
+
+    Settings getSettings() const;
+    Metrics  getMetrics() const;
+
+    ofxHTTPTimerWheel& getTimerWheel();
+
+    // called by connections
+    void connectionOpened();
+    void connectionClosed();
+    void headerTimedOut();
+    void idleTimedOut();
+    void slowBodyClosed();
+
+    struct Settings {
+        Timespan headerTimeout;    // time allowed to receive a complete request header
+        Timespan idleTimeout;      // time allowed between keep-alive requests
+        int      minBodyRate;      // bytes per second while a handler waits on the body, 0 disables
+        Timespan bodyRateInterval; // the window minBodyRate is measured over
+        Timespan timerResolution;
+
+        Settings();
+    };
+
+    struct Metrics {
+        int connectionsAccepted;
+        int connectionsActive;
+        int headerTimeouts;
+        int idleTimeouts;
+        int slowBodyClosures;
+
+        Metrics();
+    };
+
+    static Ptr Instance(const Settings& settings = Settings());
+
+protected:
+    Settings settings;
+
+    ofxHTTPTimerWheel timerWheel;
+
+    AtomicCounter connectionsAccepted;
+    AtomicCounter connectionsActive;
+    AtomicCounter headerTimeouts;
+    AtomicCounter idleTimeouts;
+    AtomicCounter slowBodyClosures;
+
+};
@@ -24,24 +24,47 @@
 
 #pragma once
 
-#include <string>
+#include <list>
 #include <map>
+#include <string>
+#include <vector>
 
-#include "Poco/DigestStream.h"
-#include "Poco/MD5Engine.h"
+#include "Poco/Checksum.h"
+#include "Poco/DigestEngine.h"
+#include "Poco/Event.h"
+#include "Poco/HashMap.h"
+#include "Poco/RandomStream.h"
+#include "Poco/RunnableAdapter.h"
+#include "Poco/Thread.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/HTTPCookie.h"
 #include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/NameValueCollection.h"
 
+#include "ofTypes.h"
 #include "ofUtils.h"
 
-#include "ofxBaseHTTPSessionManager.h"
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPShards.h"
+#include "ofxHTTPTimerWheel.h"
 
-using std::string;
+using std::list;
 using std::map;
+using std::string;
+using std::vector;
 
-using Poco::DigestOutputStream;
+using Poco::Checksum;
 using Poco::DigestEngine;
-using Poco::MD5Engine;
+using Poco::HashMap;
+using Poco::Thread;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::HTTPCookie;
 using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+using Poco::Net::NameValueCollection;
 
 template<class T, class B>
 struct DerivedFrom {
@@ -55,112 +78,596 @@ public:
     virtual ~ofxBaseHTTPServerSessionData() { }
     
     virtual bool update(HTTPServerRequest& request, HTTPServerResponse& response) = 0;
+    
+    // only session data that can be written to and read back from a
+    // string is kept by a session store.
+    virtual bool serialize(string& buffer) const { return false; }
+    virtual bool deserialize(const string& buffer) { return false; }
 };
 
-//class ofxDefaultHTTPServerSession {
-//public:
-//    ofxDefaultHTTPServerSession(const string& _sessionId, unsigned long long _lastConnected) :
-//    sessionId(_sessionId),
-//    lastConnected(_lastConnected)
-//    { }
-//    virtual ~ofxDefaultHTTPServerSession() { }
+// Keeps session data for visitors identified by a session cookie.
 //
-//    string getSessionId() const { return sessionId; }
-//    void setSessionId(const string& _sessionId) { sessionId = _sessionId; }
-//    
-//    unsigned long long getLastConnected() const { return lastConnected; }
-//    void setLastConnected(unsigned long long _lastConnected) { lastConnected = _lastConnected; }
-//    
-//protected:
-//    string sessionId;
-//    unsigned long long lastConnected;
-//};
-
+// Sessions are spread over independently locked shards by the hash of
+// their key, so concurrent requests rarely contend.  Each session has an
+// expiry timer on a timer wheel that is pushed back on every request, and
+// each shard evicts its least recently used sessions once the store is
+// full.  Session keys are 128 bits from the system's random source.
+//
+// With a session store, sessions survive a restart of the process.
+// Changed session data is handed to the store after each request, and
+// unchanged data now and then to keep its expiry current, so a restored
+// session may expire up to a quarter of the ttl early.  The store is
+// flushed and compacted on a background thread.
 template<typename SessionDataType>
 class ofxHTTPServerDefaultSessionManager : public ofxBaseHTTPServerSessionManager {
 public:
-    ofxHTTPServerDefaultSessionManager(const string& _sessionKeyName = "session_key");
+    struct Settings;
+    
+    ofxHTTPServerDefaultSessionManager(const Settings& _settings = Settings());
     virtual ~ofxHTTPServerDefaultSessionManager();
     
+    // finds the request's session, or starts a new one and sets its
+    // cookie, then lets the session data update itself.
     bool update(HTTPServerRequest& request, HTTPServerResponse& response);
 
-    void hasSessionData(const string& sessionKey);
+    bool hasSessionData(const string& sessionKey);
     void setSessionData(const string& sessionKey, const SessionDataType& sessionData);
     SessionDataType getSessionData(const string& sessionKey);
+    bool removeSession(const string& sessionKey);
     
-    string getSessionKey(const HTTPServerRequest& request);
+    size_t getNumSessions();
+    
+    // the session key from the request's cookie, or empty
+    string getSessionKey(const HTTPServerRequest& request) const;
+    
+    static string createSessionKey();
+    
+    struct Settings {
+        string sessionKeyName;     // the cookie name
+        string cookiePath;
+        bool bHttpOnly;
+        bool bSecure;              // only send the cookie over https
+        Timespan ttl;              // sessions expire after this long without a request
+        size_t maxSessions;        // least recently used sessions are evicted beyond this
+        size_t numShards;          // rounded up to a power of two
+        Timespan timerResolution;  // granularity of expiry
+        
+        ofxBaseHTTPServerSessionStore::Ptr sessionStore; // empty keeps sessions in memory only
+        Timespan persistInterval;  // how often the store is flushed
+        
+        Settings();
+    };
 
 protected:
-    ofMutex mutex;
+    typedef ofxHTTPTimerWheel::TimerId TimerId;
+    
+    struct Entry {
+        Entry() : timerId(0), persistedChecksum(0), persistedAt(0) { }
+        
+        SessionDataType data;
+        TimerId timerId;
+        list<string>::iterator lruPosition;
+        Timestamp expires;
+        
+        Poco::UInt32 persistedChecksum; // of the data last handed to the store
+        Timestamp persistedAt;
+    };
+    
+    class Shard : public ofxBaseHTTPTimerListener {
+    public:
+        Shard() : wheel(NULL) { }
+        virtual ~Shard() { }
+        
+        // called by the wheel with its mutex held.  Nothing calls into
+        // the wheel with a shard's mutex held, except from here where the
+        // wheel's recursive mutex is already ours, so this can't deadlock.
+        void timerExpired(unsigned long long timerId) {
+            ofScopedLock lock(mutex);
+            
+            typename map<TimerId, string>::iterator timerIter = timers.find(timerId);
+            
+            if(timerIter == timers.end()) {
+                return; // removed in the meantime
+            }
+            
+            typename HashMap<string, Entry>::Iterator iter = sessions.find((*timerIter).second);
+            
+            if(iter != sessions.end()) {
+                Entry& entry = (*iter).second;
+                Timestamp now;
+                
+                // touched after the timer fired, but before the request
+                // could push it back, so it is armed again instead
+                if(now < entry.expires && wheel != NULL) {
+                    entry.timerId = wheel->schedule(this, Timespan(entry.expires - now));
+                    timers[entry.timerId] = (*timerIter).second;
+                    timers.erase(timerIter);
+                    return;
+                }
+                
+                lru.erase(entry.lruPosition);
+                sessions.erase(iter);
+            }
+            
+            timers.erase(timerIter);
+        }
+        
+        // all calls are expected to hold the mutex
+        void touch(Entry& entry) {
+            lru.splice(lru.begin(), lru, entry.lruPosition);
+        }
+        
+        ofMutex mutex;
+        HashMap<string, Entry> sessions;
+        map<TimerId, string> timers;
+        list<string> lru; // most recently used first
+        
+        ofxHTTPTimerWheel* wheel; // set once by the manager
+        
+    private:
+        Shard(const Shard&);
+        Shard& operator = (const Shard&);
+    };
+    
+    Shard& getShard(const string& sessionKey);
+    
+    // returns true if the session is new
+    bool insert(const string& sessionKey, const SessionDataType& sessionData, const Timespan& ttl);
+    
+    // serializes a session for the store if it needs to be written.
+    // expected to hold the shard's mutex.  The store itself is only
+    // called without a shard lock.
+    bool preparePersist(Entry& entry, bool bForce, string& data, Timestamp& expires);
     
-    string sessionKeyName;
+    void restore();
+    void compact();
+    void runPersistence();
     
-    map<string,SessionDataType> sessions;
+    Settings settings;
+    size_t maxSessionsPerShard;
+    
+    ofxHTTPShards<Shard> shards;
+    
+    ofxHTTPTimerWheel wheel;
+    
+    Thread persistenceThread;
+    Poco::RunnableAdapter<ofxHTTPServerDefaultSessionManager<SessionDataType> > persistenceRunnable;
+    Poco::Event stopEvent;
     
 };
 
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+ofxHTTPServerDefaultSessionManager<SessionDataType>::Settings::Settings() {
+    sessionKeyName  = "session_key";
+    cookiePath      = "/";
+    bHttpOnly       = true;
+    bSecure         = false;
+    ttl             = Timespan(0, 0, 30, 0, 0); // 30 minutes
+    maxSessions     = 100000;
+    numShards       = 16;
+    timerResolution = Timespan(1, 0); // 1 second
+    persistInterval = Timespan(1, 0); // 1 second
+}
+
+//------------------------------------------------------------------------------
 template<typename SessionDataType>
-ofxHTTPServerDefaultSessionManager<SessionDataType>::ofxHTTPServerDefaultSessionManager(const string& _sessionKeyName)
-: sessionKeyName(_sessionKeyName) {
+ofxHTTPServerDefaultSessionManager<SessionDataType>::ofxHTTPServerDefaultSessionManager(const Settings& _settings) :
+settings(_settings),
+maxSessionsPerShard(0),
+shards(_settings.numShards),
+wheel(_settings.timerResolution),
+persistenceRunnable(*this, &ofxHTTPServerDefaultSessionManager<SessionDataType>::runPersistence),
+stopEvent(false)
+{
     // we use this check to make sure that SessionDataType extends ofxBaseHTTPServerSessionData
     // if it does not extend ofxBaseHTTPServerSessionData, then the compiler will complain
     DerivedFrom<SessionDataType,ofxBaseHTTPServerSessionData>();
+    
+    settings.numShards  = shards.size();
+    maxSessionsPerShard = shards.getCapacityPerShard(settings.maxSessions);
+    
+    for(size_t i = 0; i < shards.size(); ++i) {
+        shards[i].wheel = &wheel;
+    }
+    
+    wheel.start();
+    
+    if(settings.sessionStore != NULL) {
+        restore();
+        persistenceThread.setName("ofxHTTPServerDefaultSessionManager persistence");
+        persistenceThread.start(persistenceRunnable);
+    }
 }
 
+//------------------------------------------------------------------------------
 template<typename SessionDataType>
-ofxHTTPServerDefaultSessionManager<SessionDataType>::~ofxHTTPServerDefaultSessionManager() { }
+ofxHTTPServerDefaultSessionManager<SessionDataType>::~ofxHTTPServerDefaultSessionManager() {
+    if(settings.sessionStore != NULL) {
+        stopEvent.set();
+        persistenceThread.join();
+    }
+    
+    // no timers may fire into shards that are gone
+    wheel.stop();
+}
 
+//------------------------------------------------------------------------------
 template<typename SessionDataType>
 bool ofxHTTPServerDefaultSessionManager<SessionDataType>::update(HTTPServerRequest& request,
                                                                  HTTPServerResponse& response) {
-    ofScopedLock lock(mutex);
+    string sessionKey = getSessionKey(request);
     
+    string data;
+    Timestamp expires;
+    bool bPersist = false;
     
-//    string sessionKey = getSessionKey(request);
-//    if(hasSessionData(sessionKey)) {
-//        SessionDataType
-//    }
-//    
-//    hasSessionData()
-//    
-//    update(request,response)
+    if(!sessionKey.empty()) {
+        TimerId timerId = 0;
+        bool bFound = false;
+        bool bResult = false;
+        
+        {
+            Shard& shard = getShard(sessionKey);
+            ofScopedLock lock(shard.mutex);
+            
+            typename HashMap<string, Entry>::Iterator iter = shard.sessions.find(sessionKey);
+            
+            if(iter != shard.sessions.end()) {
+                Entry& entry = (*iter).second;
+                shard.touch(entry);
+                entry.expires = Timestamp() + settings.ttl;
+                timerId  = entry.timerId;
+                bFound   = true;
+                bResult  = entry.data.update(request, response);
+                bPersist = preparePersist(entry, false, data, expires);
+            }
+        }
+        
+        if(bFound) {
+            // outside of the shard lock, see Shard::timerExpired
+            if(timerId != 0) {
+                wheel.reschedule(timerId, settings.ttl);
+            }
+            if(bPersist) {
+                settings.sessionStore->put(sessionKey, data, expires);
+            }
+            return bResult;
+        }
+    }
     
-    return true;
+    // unknown or expired, start over with a fresh key so a key chosen by
+    // the client is never adopted.
+    sessionKey = createSessionKey();
+    insert(sessionKey, SessionDataType(), settings.ttl);
+    
+    HTTPCookie cookie(settings.sessionKeyName, sessionKey);
+    cookie.setPath(settings.cookiePath);
+    cookie.setHttpOnly(settings.bHttpOnly);
+    cookie.setSecure(settings.bSecure);
+    // no max age, so it expires at the end of the browser session
+    response.addCookie(cookie);
+    
+    bool bResult = false;
+    
+    {
+        Shard& shard = getShard(sessionKey);
+        ofScopedLock lock(shard.mutex);
+        
+        typename HashMap<string, Entry>::Iterator iter = shard.sessions.find(sessionKey);
+        
+        if(iter != shard.sessions.end()) {
+            bResult  = (*iter).second.data.update(request, response);
+            bPersist = preparePersist((*iter).second, true, data, expires);
+        }
+    }
+    
+    if(bPersist) {
+        settings.sessionStore->put(sessionKey, data, expires);
+    }
+    
+    return bResult;
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+bool ofxHTTPServerDefaultSessionManager<SessionDataType>::hasSessionData(const string& sessionKey) {
+    Shard& shard = getShard(sessionKey);
+    ofScopedLock lock(shard.mutex);
+    return shard.sessions.find(sessionKey) != shard.sessions.end();
 }
 
+//------------------------------------------------------------------------------
 template<typename SessionDataType>
 void ofxHTTPServerDefaultSessionManager<SessionDataType>::setSessionData(const string& sessionKey,
                                                                          const SessionDataType& sessionData) {
-    ofScopedLock lock(mutex);
-    sessions[sessionKey] = sessionData;
+    insert(sessionKey, sessionData, settings.ttl);
+    
+    string data;
+    Timestamp expires;
+    bool bPersist = false;
+    
+    {
+        Shard& shard = getShard(sessionKey);
+        ofScopedLock lock(shard.mutex);
+        
+        typename HashMap<string, Entry>::Iterator iter = shard.sessions.find(sessionKey);
+        
+        if(iter != shard.sessions.end()) {
+            bPersist = preparePersist((*iter).second, true, data, expires);
+        }
+    }
+    
+    if(bPersist) {
+        settings.sessionStore->put(sessionKey, data, expires);
+    }
 }
 
+//------------------------------------------------------------------------------
 template<typename SessionDataType>
 SessionDataType ofxHTTPServerDefaultSessionManager<SessionDataType>::getSessionData(const string& sessionKey) {
-    ofScopedLock lock(mutex);
+    Shard& shard = getShard(sessionKey);
+    ofScopedLock lock(shard.mutex);
     
-    map<string,SessionDataType>::iterator iter = sessions.find(sessionKey);
-   
+    typename HashMap<string, Entry>::Iterator iter = shard.sessions.find(sessionKey);
     
-    if(iter != sessions.end()) {
-        return *iter;
+    if(iter != shard.sessions.end()) {
+        return (*iter).second.data;
     } else {
         SessionDataType emptyData;
         return emptyData;
     }
 }
 
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+bool ofxHTTPServerDefaultSessionManager<SessionDataType>::removeSession(const string& sessionKey) {
+    TimerId timerId = 0;
+    
+    {
+        Shard& shard = getShard(sessionKey);
+        ofScopedLock lock(shard.mutex);
+        
+        typename HashMap<string, Entry>::Iterator iter = shard.sessions.find(sessionKey);
+        
+        if(iter == shard.sessions.end()) {
+            return false;
+        }
+        
+        timerId = (*iter).second.timerId;
+        shard.timers.erase(timerId);
+        shard.lru.erase((*iter).second.lruPosition);
+        shard.sessions.erase(iter);
+    }
+    
+    if(timerId != 0) {
+        wheel.cancel(timerId);
+    }
+    
+    if(settings.sessionStore != NULL) {
+        settings.sessionStore->remove(sessionKey);
+    }
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+size_t ofxHTTPServerDefaultSessionManager<SessionDataType>::getNumSessions() {
+    size_t numSessions = 0;
+    for(size_t i = 0; i < shards.size(); ++i) {
+        ofScopedLock lock(shards[i].mutex);
+        numSessions += shards[i].sessions.size();
+    }
+    return numSessions;
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+string ofxHTTPServerDefaultSessionManager<SessionDataType>::getSessionKey(const HTTPServerRequest& request) const {
+    NameValueCollection cookies;
+    request.getCookies(cookies);
+    return cookies.get(settings.sessionKeyName, "");
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+string ofxHTTPServerDefaultSessionManager<SessionDataType>::createSessionKey() {
+    DigestEngine::Digest bytes(16);
+    Poco::RandomInputStream random;
+    random.read(reinterpret_cast<char*>(&bytes[0]), static_cast<std::streamsize>(bytes.size()));
+    return DigestEngine::digestToHex(bytes);
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+typename ofxHTTPServerDefaultSessionManager<SessionDataType>::Shard&
+ofxHTTPServerDefaultSessionManager<SessionDataType>::getShard(const string& sessionKey) {
+    return shards.get(sessionKey);
+}
 
+//------------------------------------------------------------------------------
 template<typename SessionDataType>
-string ofxHTTPServerDefaultSessionManager<SessionDataType>::getSessionKey(const HTTPServerRequest& request) {
+bool ofxHTTPServerDefaultSessionManager<SessionDataType>::insert(const string& sessionKey,
+                                                                 const SessionDataType& sessionData,
+                                                                 const Timespan& ttl) {
+    Shard& shard = getShard(sessionKey);
+    
+    vector<TimerId> evicted;
+    vector<string> evictedKeys;
+    TimerId existingTimerId = 0;
+    bool bExists = false;
+    
+    {
+        ofScopedLock lock(shard.mutex);
+        
+        typename HashMap<string, Entry>::Iterator iter = shard.sessions.find(sessionKey);
+        
+        if(iter != shard.sessions.end()) {
+            (*iter).second.data    = sessionData;
+            (*iter).second.expires = Timestamp() + ttl;
+            shard.touch((*iter).second);
+            existingTimerId = (*iter).second.timerId;
+            bExists = true;
+        } else {
+            Entry& entry = shard.sessions[sessionKey];
+            entry.data        = sessionData;
+            entry.expires     = Timestamp() + ttl;
+            entry.lruPosition = shard.lru.insert(shard.lru.begin(), sessionKey);
+            
+            while(maxSessionsPerShard > 0 && shard.lru.size() > maxSessionsPerShard) {
+                typename HashMap<string, Entry>::Iterator oldest = shard.sessions.find(shard.lru.back());
+                if(oldest != shard.sessions.end()) {
+                    evicted.push_back((*oldest).second.timerId);
+                    evictedKeys.push_back(shard.lru.back());
+                    shard.timers.erase((*oldest).second.timerId);
+                    shard.sessions.erase(oldest);
+                }
+                shard.lru.pop_back();
+            }
+        }
+    }
+    
+    // timers are only touched without the shard lock, see Shard::timerExpired
+    if(bExists) {
+        if(existingTimerId != 0) {
+            wheel.reschedule(existingTimerId, ttl);
+        }
+        return false;
+    }
     
+    for(size_t i = 0; i < evicted.size(); ++i) {
+        wheel.cancel(evicted[i]);
+    }
+    
+    if(settings.sessionStore != NULL) {
+        for(size_t i = 0; i < evictedKeys.size(); ++i) {
+            settings.sessionStore->remove(evictedKeys[i]);
+        }
+    }
+    
+    TimerId timerId = wheel.schedule(&shard, ttl);
+    
+    {
+        ofScopedLock lock(shard.mutex);
+        
+        typename HashMap<string, Entry>::Iterator iter = shard.sessions.find(sessionKey);
+        
+        if(iter != shard.sessions.end() && (*iter).second.timerId == 0) {
+            (*iter).second.timerId = timerId;
+            shard.timers[timerId] = sessionKey;
+            return true;
+        }
+    }
+    
+    // evicted or removed before its timer was set
+    wheel.cancel(timerId);
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+bool ofxHTTPServerDefaultSessionManager<SessionDataType>::preparePersist(Entry& entry,
+                                                                         bool bForce,
+                                                                         string& data,
+                                                                         Timestamp& expires) {
+    if(settings.sessionStore == NULL) {
+        return false;
+    }
+    
+    string buffer;
+    
+    if(!entry.data.serialize(buffer)) {
+        return false;
+    }
     
-    // TODO: use Poco::UDID?
-    MD5Engine md5;
-    DigestOutputStream ostr(md5);
-    // md5(micros + client address)
-    ostr << ofGetSystemTimeMicros() << request.clientAddress().host().toString();
-    ostr.flush(); // Ensure everything gets passed to the digest engine
-    const DigestEngine::Digest& digest = md5.digest(); // obtain result
-    return DigestEngine::digestToHex(digest);
-}
\ No newline at end of file
+    Checksum checksum(Checksum::TYPE_CRC32);
+    checksum.update(buffer);
+    
+    // unchanged data is only written now and then, to keep its expiry current
+    if(!bForce &&
+       checksum.checksum() == entry.persistedChecksum &&
+       !entry.persistedAt.isElapsed(settings.ttl.totalMicroseconds() / 4)) {
+        return false;
+    }
+    
+    entry.persistedChecksum = checksum.checksum();
+    entry.persistedAt.update();
+    
+    data.swap(buffer);
+    expires = entry.expires;
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+void ofxHTTPServerDefaultSessionManager<SessionDataType>::restore() {
+    vector<ofxBaseHTTPServerSessionStore::Record> records;
+    
+    if(!settings.sessionStore->load(records)) {
+        ofLogError("ofxHTTPServerDefaultSessionManager::restore") << "Unable to load sessions, starting empty.";
+        return;
+    }
+    
+    Timestamp now;
+    
+    for(size_t i = 0; i < records.size(); ++i) {
+        SessionDataType sessionData;
+        
+        if(records[i].expires > now && sessionData.deserialize(records[i].data)) {
+            insert(records[i].key, sessionData, Timespan(records[i].expires - now));
+        }
+    }
+    
+    ofLogNotice("ofxHTTPServerDefaultSessionManager::restore") << "Restored " << getNumSessions() << " of " << records.size() << " sessions.";
+    
+    // start from a clean snapshot
+    compact();
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+void ofxHTTPServerDefaultSessionManager<SessionDataType>::compact() {
+    settings.sessionStore->beginCompaction();
+    
+    vector<ofxBaseHTTPServerSessionStore::Record> records;
+    
+    // one shard at a time, so requests to the others carry on
+    for(size_t i = 0; i < shards.size(); ++i) {
+        ofScopedLock lock(shards[i].mutex);
+        
+        typename HashMap<string, Entry>::Iterator iter = shards[i].sessions.begin();
+        
+        while(iter != shards[i].sessions.end()) {
+            ofxBaseHTTPServerSessionStore::Record record;
+            
+            if(preparePersist((*iter).second, true, record.data, record.expires)) {
+                record.key = (*iter).first;
+                records.push_back(record);
+            }
+            
+            ++iter;
+        }
+    }
+    
+    settings.sessionStore->compact(records);
+}
+
+//------------------------------------------------------------------------------
+template<typename SessionDataType>
+void ofxHTTPServerDefaultSessionManager<SessionDataType>::runPersistence() {
+    long waitMilliseconds = static_cast<long>(settings.persistInterval.totalMilliseconds());
+    if(waitMilliseconds < 1) waitMilliseconds = 1;
+    
+    while(!stopEvent.tryWait(waitMilliseconds)) {
+        settings.sessionStore->flush();
+        
+        if(settings.sessionStore->needsCompaction()) {
+            compact();
+        }
+    }
+    
+    settings.sessionStore->flush();
+}
@@ -0,0 +1,379 @@
+#include "ofxHTTPServerDigestAuthenticator.h"
+
+#include "Poco/DigestEngine.h"
+#include "Poco/Exception.h"
+#include "Poco/MD5Engine.h"
+#include "Poco/NumberParser.h"
+#include "Poco/RandomStream.h"
+#include "Poco/String.h"
+#include "Poco/Net/HTTPAuthenticationParams.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPPasswordHash.h"
+#include "ofxHTTPUtils.h"
+
+using Poco::DigestEngine;
+using Poco::MD5Engine;
+using Poco::Net::HTTPAuthenticationParams;
+
+namespace {
+
+    //--------------------------------------------------------------------------
+    string createRandomHex() {
+        DigestEngine::Digest bytes(16);
+        Poco::RandomInputStream random;
+        random.read(reinterpret_cast<char*>(&bytes[0]), static_cast<std::streamsize>(bytes.size()));
+        return DigestEngine::digestToHex(bytes);
+    }
+
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerDigestAuthenticator::Nonce::accept(UInt64 count) {
+    if(count == 0) {
+        return false;
+    }
+    
+    if(count > highestCount) {
+        UInt64 shift = count - highestCount;
+        window = shift >= 64 ? 0 : window << shift;
+        window |= 1;
+        highestCount = count;
+        return true;
+    }
+    
+    UInt64 age = highestCount - count;
+    
+    if(age >= 64) {
+        return false;
+    }
+    
+    UInt64 bit = UInt64(1) << age;
+    
+    if((window & bit) != 0) {
+        return false;
+    }
+    
+    window |= bit;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerDigestAuthenticator::Settings::Settings() {
+    realm     = "Default";
+    nonceTtl  = Timespan(0, 0, 5, 0, 0); // 5 minutes
+    maxNonces = 100000;
+    numShards = 16;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerDigestAuthenticator::ofxHTTPServerDigestAuthenticator(const Settings& _settings) :
+settings(_settings),
+maxNoncesPerShard(0),
+shards(_settings.numShards)
+{
+    settings.numShards = shards.size();
+    
+    maxNoncesPerShard = shards.getCapacityPerShard(settings.maxNonces);
+    
+    map<string, string>::const_iterator ha1Iter = settings.ha1s.begin();
+    while(ha1Iter != settings.ha1s.end()) {
+        users[(*ha1Iter).first] = Poco::toLower((*ha1Iter).second);
+        ++ha1Iter;
+    }
+    
+    vector<ofxHTTPCredentials>::const_iterator iter = settings.credentials.begin();
+    while(iter != settings.credentials.end()) {
+        users[(*iter).getUsername()] = createHA1((*iter).getUsername(), settings.realm, (*iter).getPassword());
+        ++iter;
+    }
+    
+    // only the HA1 table is kept
+    settings.credentials.clear();
+    settings.ha1s.clear();
+    
+    opaque = createRandomHex();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerDigestAuthenticator::~ofxHTTPServerDigestAuthenticator() {
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPAuthStatus ofxHTTPServerDigestAuthenticator::authenticate(HTTPServerRequest& request) {
+    Verification verification;
+    
+    switch(check(request, verification)) {
+        case RESULT_OK:
+            return OK;
+        case RESULT_NO_CREDENTIALS:
+            return NO_CREDENTIALS;
+        default:
+            return UNAUTHORIZED;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerDigestAuthenticator::setAuthenticationRequiredHeaders(HTTPServerResponse& response) {
+    setChallenge(response, false);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPAuthStatus ofxHTTPServerDigestAuthenticator::authenticate(HTTPServerRequest& request,
+                                                                 HTTPServerResponse& response) {
+    Verification verification;
+    
+    switch(check(request, verification)) {
+        case RESULT_OK:
+            setAuthenticationInfo(response, verification);
+            return OK;
+        case RESULT_NO_CREDENTIALS:
+            setChallenge(response, false);
+            return NO_CREDENTIALS;
+        case RESULT_STALE:
+            setChallenge(response, true);
+            return UNAUTHORIZED;
+        default:
+            setChallenge(response, false);
+            return UNAUTHORIZED;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerDigestAuthenticator::isAuthenticated(HTTPServerRequest& request, HTTPServerResponse& response) {
+    if(authenticate(request, response) == OK) {
+        return true;
+    }
+    
+    response.setStatusAndReason(HTTPResponse::HTTP_UNAUTHORIZED);
+    response.setContentLength(0);
+    response.send();
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerDigestAuthenticator::setHA1(const string& username, const string& ha1) {
+    RWLock::ScopedWriteLock lock(usersLock);
+    users[username] = Poco::toLower(ha1);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerDigestAuthenticator::removeUser(const string& username) {
+    RWLock::ScopedWriteLock lock(usersLock);
+    users.erase(username);
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerDigestAuthenticator::getNumNonces() {
+    size_t numNonces = 0;
+    for(size_t i = 0; i < shards.size(); ++i) {
+        ofScopedLock lock(shards[i].mutex);
+        numNonces += shards[i].nonces.size();
+    }
+    return numNonces;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerDigestAuthenticator::createHA1(const string& username,
+                                                   const string& realm,
+                                                   const string& password) {
+    return md5(username + ":" + realm + ":" + password);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerDigestAuthenticator::Ptr ofxHTTPServerDigestAuthenticator::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerDigestAuthenticator(settings));
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerDigestAuthenticator::Result ofxHTTPServerDigestAuthenticator::check(HTTPServerRequest& request,
+                                                                                 Verification& verification) {
+    if(!request.hasCredentials()) {
+        return RESULT_NO_CREDENTIALS;
+    }
+    
+    string scheme;
+    string authInfo;
+    
+    try {
+        request.getCredentials(scheme, authInfo);
+    } catch(const NotAuthenticatedException&) {
+        return RESULT_UNAUTHORIZED;
+    }
+    
+    if(Poco::icompare(scheme, "Digest") != 0) {
+        return RESULT_UNAUTHORIZED;
+    }
+    
+    HTTPAuthenticationParams params;
+    
+    try {
+        params.fromAuthInfo(authInfo);
+    } catch(const Poco::Exception&) {
+        return RESULT_UNAUTHORIZED; // malformed
+    }
+    
+    verification.username = params.get("username", "");
+    verification.nonce    = params.get("nonce", "");
+    verification.nc       = params.get("nc", "");
+    verification.cnonce   = params.get("cnonce", "");
+    verification.qop      = params.get("qop", "");
+    verification.uri      = params.get("uri", "");
+    
+    string response  = Poco::toLower(params.get("response", ""));
+    string algorithm = params.get("algorithm", "MD5");
+    
+    if(params.get("realm", "") != settings.realm ||
+       params.get("opaque", opaque) != opaque ||
+       Poco::icompare(algorithm, "MD5") != 0 ||
+       verification.qop != "auth" ||
+       verification.nonce.empty() ||
+       verification.nc.empty() ||
+       verification.cnonce.empty() ||
+       verification.uri != request.getURI()) {
+        return RESULT_UNAUTHORIZED;
+    }
+    
+    UInt64 count = 0;
+    
+    if(!Poco::NumberParser::tryParseHex64(verification.nc, count)) {
+        return RESULT_UNAUTHORIZED;
+    }
+    
+    {
+        RWLock::ScopedReadLock lock(usersLock);
+        
+        HashMap<string, string>::Iterator iter = users.find(verification.username);
+        
+        if(iter == users.end()) {
+            return RESULT_UNAUTHORIZED;
+        }
+        
+        verification.ha1 = (*iter).second;
+    }
+    
+    string ha2      = md5(request.getMethod() + ":" + verification.uri);
+    string expected = md5(verification.ha1 + ":" +
+                          verification.nonce + ":" +
+                          verification.nc + ":" +
+                          verification.cnonce + ":" +
+                          verification.qop + ":" +
+                          ha2);
+    
+    if(!ofxHTTPPasswordHash::constantTimeEquals(response, expected)) {
+        return RESULT_UNAUTHORIZED;
+    }
+    
+    // the password was right, only the nonce can still be wrong
+    Shard& shard = getShard(verification.nonce);
+    ofScopedLock lock(shard.mutex);
+    
+    HashMap<string, Nonce>::Iterator iter = shard.nonces.find(verification.nonce);
+    
+    if(iter == shard.nonces.end()) {
+        return RESULT_STALE;
+    }
+    
+    Nonce& nonce = (*iter).second;
+    
+    Timestamp now;
+    
+    if(nonce.expires <= now) {
+        shard.order.erase(nonce.position);
+        shard.nonces.erase(iter);
+        return RESULT_STALE;
+    }
+    
+    if(!nonce.accept(count)) {
+        return RESULT_UNAUTHORIZED; // a replay
+    }
+    
+    // late in its life, offer the next one
+    verification.bNextNonce = nonce.expires - now < settings.nonceTtl.totalMicroseconds() / 4;
+    
+    return RESULT_OK;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerDigestAuthenticator::createNonce() {
+    string nonce = createRandomHex();
+    
+    Timestamp now;
+    
+    Shard& shard = getShard(nonce);
+    ofScopedLock lock(shard.mutex);
+    
+    // all nonces live equally long, so the oldest expire first
+    while(!shard.order.empty()) {
+        HashMap<string, Nonce>::Iterator iter = shard.nonces.find(shard.order.front());
+        
+        bool bExpired = iter == shard.nonces.end() || (*iter).second.expires <= now;
+        bool bFull    = maxNoncesPerShard > 0 && shard.nonces.size() >= maxNoncesPerShard;
+        
+        if(!bExpired && !bFull) {
+            break;
+        }
+        
+        if(iter != shard.nonces.end()) {
+            shard.nonces.erase(iter);
+        }
+        shard.order.pop_front();
+    }
+    
+    Nonce& entry = shard.nonces[nonce];
+    entry.expires  = now + settings.nonceTtl;
+    entry.position = shard.order.insert(shard.order.end(), nonce);
+    
+    return nonce;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerDigestAuthenticator::Shard& ofxHTTPServerDigestAuthenticator::getShard(const string& nonce) {
+    return shards.get(nonce);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerDigestAuthenticator::setChallenge(HTTPServerResponse& response, bool bStale) {
+    string challenge = "Digest realm=\"" + settings.realm + "\"";
+    challenge += ", qop=\"auth\"";
+    challenge += ", algorithm=MD5";
+    challenge += ", nonce=\"" + createNonce() + "\"";
+    challenge += ", opaque=\"" + opaque + "\"";
+    
+    if(bStale) {
+        challenge += ", stale=true";
+    }
+    
+    response.set("WWW-Authenticate", challenge);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerDigestAuthenticator::setAuthenticationInfo(HTTPServerResponse& response,
+                                                             const Verification& verification) {
+    // lets the client check that the server knew the password, too
+    string rspauth = md5(verification.ha1 + ":" +
+                         verification.nonce + ":" +
+                         verification.nc + ":" +
+                         verification.cnonce + ":" +
+                         verification.qop + ":" +
+                         md5(":" + verification.uri));
+    
+    string info = "qop=" + verification.qop;
+    info += ", rspauth=\"" + rspauth + "\"";
+    info += ", cnonce=\"" + verification.cnonce + "\"";
+    info += ", nc=" + verification.nc;
+    
+    if(verification.bNextNonce) {
+        info += ", nextnonce=\"" + createNonce() + "\"";
+    }
+    
+    response.set("Authentication-Info", info);
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerDigestAuthenticator::md5(const string& text) {
+    MD5Engine engine;
+    engine.update(text);
+    return DigestEngine::digestToHex(engine.digest());
+}
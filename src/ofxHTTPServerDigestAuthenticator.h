@@ -0,0 +1,176 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Poco/HashMap.h"
+#include "Poco/RWLock.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Types.h"
+#include "Poco/Net/HTTPResponse.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPCredentials.h"
+#include "ofxHTTPShards.h"
+
+using std::list;
+using std::map;
+using std::string;
+using std::vector;
+
+using Poco::HashMap;
+using Poco::RWLock;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::UInt64;
+using Poco::Net::HTTPResponse;
+
+// Digest authentication (RFC 2617, MD5 with qop="auth").
+//
+// Issued nonces live in a table split into shards, each with its own lock,
+// so concurrent requests rarely contend.  Every nonce remembers the highest
+// nonce count it has seen and a 64 wide window below it, which makes replay
+// checks constant time while still allowing a client's requests to arrive
+// out of order.
+//
+// A request with a correct response for an expired or forgotten nonce is
+// answered with stale=true, so the client retries without asking the user.
+// Before that happens, successful requests late in a nonce's life are
+// given a nextnonce in Authentication-Info, so well behaved clients switch
+// without a 401 at all.
+//
+// authenticate(request, response) sets the headers for both outcomes.
+class ofxHTTPServerDigestAuthenticator : public ofxBaseHTTPServerAuthenticationManager {
+public:
+    typedef ofPtr<ofxHTTPServerDigestAuthenticator> Ptr;
+    
+    struct Settings;
+    
+    ofxHTTPServerDigestAuthenticator(const Settings& _settings = Settings());
+    virtual ~ofxHTTPServerDigestAuthenticator();
+    
+    // checks the credentials without touching a response
+    ofxHTTPAuthStatus authenticate(HTTPServerRequest& request);
+    
+    // a fresh challenge
+    void setAuthenticationRequiredHeaders(HTTPServerResponse& response);
+    
+    // checks the credentials and sets Authentication-Info on success or
+    // the challenge (stale if need be) on failure.
+    ofxHTTPAuthStatus authenticate(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+    // sends the 401 response itself if authentication fails
+    bool isAuthenticated(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+    // ha1 is the hex MD5 of "username:realm:password"
+    void setHA1(const string& username, const string& ha1);
+    void removeUser(const string& username);
+    
+    size_t getNumNonces();
+    
+    static string createHA1(const string& username, const string& realm, const string& password);
+    
+    struct Settings {
+        string realm;
+        
+        // plaintext, reduced to HA1 when the authenticator is constructed
+        vector<ofxHTTPCredentials> credentials;
+        map<string, string> ha1s; // username -> HA1
+        
+        Timespan nonceTtl;
+        size_t maxNonces;
+        size_t numShards;          // rounded up to a power of two
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+protected:
+    enum Result {
+        RESULT_OK,
+        RESULT_NO_CREDENTIALS,
+        RESULT_UNAUTHORIZED,
+        RESULT_STALE
+    };
+    
+    struct Nonce {
+        Nonce() : highestCount(0), window(0) { }
+        
+        Timestamp expires;
+        UInt64 highestCount; // the highest nonce count seen
+        UInt64 window;       // bit n is set if highestCount - n was seen
+        list<string>::iterator position;
+        
+        // false for a count that was already used or is too old to tell
+        bool accept(UInt64 count);
+    };
+    
+    struct Shard {
+        ofMutex mutex;
+        HashMap<string, Nonce> nonces;
+        list<string> order; // oldest first, which is also expiry order
+    };
+    
+    struct Verification {
+        Verification() : bNextNonce(false) { }
+        
+        string username;
+        string ha1;
+        string nonce;
+        string nc;
+        string cnonce;
+        string qop;
+        string uri;
+        bool bNextNonce;
+    };
+    
+    Result check(HTTPServerRequest& request, Verification& verification);
+    
+    string createNonce();
+    Shard& getShard(const string& nonce);
+    
+    void setChallenge(HTTPServerResponse& response, bool bStale);
+    void setAuthenticationInfo(HTTPServerResponse& response, const Verification& verification);
+    
+    static string md5(const string& text);
+    
+    Settings settings;
+    size_t maxNoncesPerShard;
+    string opaque;
+    
+    RWLock usersLock;
+    HashMap<string, string> users; // username -> HA1
+    
+    ofxHTTPShards<Shard> shards;
+    
+};
@@ -25,20 +25,66 @@
 #pragma once
 
 #include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerRequestImpl.h"
 #include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTPServerResponseImpl.h"
+#include "Poco/Net/HTTPServerSession.h"
+
+#include "ofxUnixSocket.h"
 
 using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerRequestImpl;
 using Poco::Net::HTTPServerResponse;
+using Poco::Net::HTTPServerResponseImpl;
+using Poco::Net::HTTPServerSession;
+
+class ofxHTTPServerListener;
+
+// The response the server's connections answer with.  A handler that
+// writes to the socket itself marks it sent, so that a failure after
+// the first byte doesn't get a stray error response behind it.
+class ofxHTTPServerResponseImpl : public HTTPServerResponseImpl {
+public:
+    ofxHTTPServerResponseImpl(HTTPServerSession& session) :
+    HTTPServerResponseImpl(session),
+    bSentDirectly(false)
+    { }
+    
+    virtual ~ofxHTTPServerResponseImpl() { }
+    
+    void setSentDirectly() { bSentDirectly = true; }
+    
+    bool sent() const { return bSentDirectly || HTTPServerResponseImpl::sent(); }
+    
+protected:
+    bool bSentDirectly;
+};
 
 class ofxHTTPServerExchange {
 public:
-    ofxHTTPServerExchange(HTTPServerRequest& _request, HTTPServerResponse& _response) :
+    ofxHTTPServerExchange(HTTPServerRequest& _request,
+                          HTTPServerResponse& _response,
+                          const ofxHTTPServerListener* _listener = NULL) :
     request(_request),
-    response(_response)
+    response(_response),
+    listener(_listener)
     { }
     
     virtual ~ofxHTTPServerExchange() { }
     
+    // the listener that accepted this request, or NULL if unknown
+    const ofxHTTPServerListener* getListener() const { return listener; }
+    
+    // returns true if the request arrived on a unix socket listener
+    // and fills in the credentials of the connected process.
+    bool getPeerCredentials(ofxUnixPeerCredentials& credentials) const {
+        HTTPServerRequestImpl* pRequestImpl = dynamic_cast<HTTPServerRequestImpl*>(&request);
+        return pRequestImpl != NULL && ofxUnixSocket::getPeerCredentials(pRequestImpl->socket(), credentials);
+    }
+    
     HTTPServerRequest&  request;
     HTTPServerResponse& response;
+    
+protected:
+    const ofxHTTPServerListener* listener;
 };
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "ofxHTTPServerHandoff.h"
+
+#include <vector>
+
+#include "Poco/Exception.h"
+#include "Poco/Net/NetException.h"
+
+#include "ofLog.h"
+#include "ofUtils.h"
+
+#include "ofxUnixSocket.h"
+
+#ifndef TARGET_WIN32
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+using std::vector;
+
+const string ofxHTTPServerHandoff::REQUEST = "LISTENERS";
+const string ofxHTTPServerHandoff::READY   = "READY";
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerHandoff::requestSockets(const string& path,
+                                          StreamSocket& channel,
+                                          Sockets& sockets,
+                                          const Timespan& timeout) {
+    try {
+        channel = ofxUnixSocket::connect(path);
+    } catch(const Poco::Exception& exc) {
+        ofLogVerbose("ofxHTTPServerHandoff::requestSockets") << "No running server at " << path << ": " << exc.displayText();
+        return false;
+    }
+
+    channel.setReceiveTimeout(timeout);
+    channel.setSendTimeout(timeout);
+
+    sendLine(channel, REQUEST);
+    receiveSockets(channel, sockets);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerHandoff::sendSockets(StreamSocket& channel, const Sockets& sockets) {
+#ifndef TARGET_WIN32
+    if(sockets.size() > MAX_SOCKETS) {
+        throw Poco::InvalidArgumentException("Too many sockets to hand off", ofToString(sockets.size()));
+    }
+
+    string names;
+    vector<int> fds;
+
+    Sockets::const_iterator iter = sockets.begin();
+    while(iter != sockets.end()) {
+        names += (*iter).first + "\n";
+        fds.push_back((*iter).second);
+        ++iter;
+    }
+
+    names += "\n"; // never send an empty message, it reads as a close
+
+    struct iovec iov;
+    iov.iov_base = const_cast<char*>(names.data());
+    iov.iov_len  = names.size();
+
+    char control[CMSG_SPACE(sizeof(int) * MAX_SOCKETS)];
+    memset(control, 0, sizeof(control));
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov    = &iov;
+    message.msg_iovlen = 1;
+
+    if(!fds.empty()) {
+        message.msg_control    = control;
+        message.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+
+        struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type  = SCM_RIGHTS;
+        header->cmsg_len   = CMSG_LEN(sizeof(int) * fds.size());
+        memcpy(CMSG_DATA(header), &fds[0], sizeof(int) * fds.size());
+    }
+
+    ssize_t result;
+
+    do {
+        result = ::sendmsg(channel.impl()->sockfd(), &message, 0);
+    } while(result < 0 && errno == EINTR);
+
+    if(result != static_cast<ssize_t>(names.size())) {
+        throw Poco::Net::NetException("Unable to send sockets", strerror(errno));
+    }
+#else
+    throw Poco::NotImplementedException("Socket handoff is not available on this platform");
+#endif
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerHandoff::receiveSockets(StreamSocket& channel, Sockets& sockets) {
+#ifndef TARGET_WIN32
+    char buffer[4096];
+
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len  = sizeof(buffer);
+
+    char control[CMSG_SPACE(sizeof(int) * MAX_SOCKETS)];
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov        = &iov;
+    message.msg_iovlen     = 1;
+    message.msg_control    = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t result;
+
+    do {
+        result = ::recvmsg(channel.impl()->sockfd(), &message, 0);
+    } while(result < 0 && errno == EINTR);
+
+    if(result <= 0) {
+        throw Poco::Net::NetException("Unable to receive sockets", result < 0 ? strerror(errno) : "connection closed");
+    }
+
+    vector<int> fds;
+
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    while(header != NULL) {
+        if(header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+            size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const int* data = reinterpret_cast<const int*>(CMSG_DATA(header));
+            fds.insert(fds.end(), data, data + count);
+        }
+        header = CMSG_NXTHDR(&message, header);
+    }
+
+    vector<string> names = ofSplitString(string(buffer, result), "\n", true, true);
+
+    if(names.size() != fds.size() || (message.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+        for(size_t i = 0; i < fds.size(); ++i) {
+            ::close(fds[i]);
+        }
+        throw Poco::Net::NetException("Malformed socket handoff message");
+    }
+
+    for(size_t i = 0; i < names.size(); ++i) {
+        sockets[names[i]] = fds[i];
+    }
+#else
+    throw Poco::NotImplementedException("Socket handoff is not available on this platform");
+#endif
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerHandoff::sendLine(StreamSocket& channel, const string& line) {
+    string data = line + "\n";
+    channel.sendBytes(data.data(), static_cast<int>(data.size()));
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerHandoff::receiveLine(StreamSocket& channel) {
+    string line;
+    char c;
+
+    while(line.size() < 256) {
+        if(channel.receiveBytes(&c, 1) <= 0 || c == '\n') {
+            break;
+        }
+        line += c;
+    }
+
+    return line;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerHandoff::closeSockets(const Sockets& sockets) {
+#ifndef TARGET_WIN32
+    Sockets::const_iterator iter = sockets.begin();
+    while(iter != sockets.end()) {
+        ::close((*iter).second);
+        ++iter;
+    }
+#endif
+}
@@ -0,0 +1,86 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Poco/Timespan.h"
+#include "Poco/Net/StreamSocket.h"
+
+#include "ofConstants.h"
+
+using std::map;
+using std::string;
+
+using Poco::Timespan;
+using Poco::Net::StreamSocket;
+
+// The protocol used to pass listening sockets from a running server to the
+// process replacing it, over a unix socket:
+//
+//   new process                     running process
+//   LISTENERS\n            ---->
+//                          <----    listener names, one per line, with the
+//                                   descriptors attached (SCM_RIGHTS)
+//   (starts accepting)
+//   READY\n                ---->
+//                                   stops accepting and drains
+//
+// Both processes accept from the same kernel queues during the exchange,
+// so no connection is refused or reset.
+class ofxHTTPServerHandoff {
+public:
+    typedef map<string, poco_socket_t> Sockets; // by listener name
+
+    static const string REQUEST;
+    static const string READY;
+
+    // connects to a running server at path and receives its sockets.
+    // returns false if no server is listening at path.  On success the
+    // channel is left open for sendLine(channel, READY).
+    static bool requestSockets(const string& path,
+                               StreamSocket& channel,
+                               Sockets& sockets,
+                               const Timespan& timeout = Timespan(10*Timespan::SECONDS));
+
+    // sends the listener names and duplicates of their descriptors.
+    static void sendSockets(StreamSocket& channel, const Sockets& sockets);
+
+    static void   sendLine(StreamSocket& channel, const string& line);
+    static string receiveLine(StreamSocket& channel);
+
+    // closes received descriptors that were not adopted
+    static void closeSockets(const Sockets& sockets);
+
+    enum {
+        MAX_SOCKETS = 64
+    };
+
+protected:
+    static void receiveSockets(StreamSocket& channel, Sockets& sockets);
+
+};
@@ -0,0 +1,405 @@
+#include "ofxHTTPServerJWTVerifier.h"
+
+#include <cmath>
+#include <map>
+#include <sstream>
+
+#include "Poco/Base64Decoder.h"
+#include "Poco/Exception.h"
+#include "Poco/HMACEngine.h"
+#include "Poco/NumberParser.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Timestamp.h"
+
+#include "ofxHTTPPasswordHash.h"
+#include "ofxHTTPSHA256Engine.h"
+
+using std::istringstream;
+using std::map;
+
+using Poco::Timestamp;
+
+namespace {
+
+    //--------------------------------------------------------------------------
+    bool decodeBase64URL(const string& text, string& result) {
+        string base64 = text;
+        
+        for(size_t i = 0; i < base64.size(); ++i) {
+            if(base64[i] == '-') {
+                base64[i] = '+';
+            } else if(base64[i] == '_') {
+                base64[i] = '/';
+            } else if(base64[i] == '+' || base64[i] == '/' || base64[i] == '=') {
+                return false; // not url safe
+            }
+        }
+        
+        if(base64.size() % 4 == 1) {
+            return false;
+        }
+        
+        while(base64.size() % 4 != 0) {
+            base64 += '=';
+        }
+        
+        try {
+            istringstream istr(base64);
+            Poco::Base64Decoder decoder(istr);
+            result.clear();
+            Poco::StreamCopier::copyToString(decoder, result);
+        } catch(const Poco::Exception&) {
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //--------------------------------------------------------------------------
+    void skipWhitespace(const string& json, size_t& pos) {
+        while(pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\r' || json[pos] == '\n')) {
+            ++pos;
+        }
+    }
+    
+    //--------------------------------------------------------------------------
+    bool skipString(const string& json, size_t& pos) {
+        // pos is on the opening quote
+        for(++pos; pos < json.size(); ++pos) {
+            if(json[pos] == '\\') {
+                ++pos;
+            } else if(json[pos] == '"') {
+                ++pos;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    //--------------------------------------------------------------------------
+    bool skipValue(const string& json, size_t& pos) {
+        if(pos >= json.size()) {
+            return false;
+        }
+        
+        if(json[pos] == '"') {
+            return skipString(json, pos);
+        }
+        
+        if(json[pos] == '{' || json[pos] == '[') {
+            int depth = 0;
+            while(pos < json.size()) {
+                char c = json[pos];
+                if(c == '"') {
+                    if(!skipString(json, pos)) {
+                        return false;
+                    }
+                    continue;
+                }
+                if(c == '{' || c == '[') {
+                    ++depth;
+                } else if(c == '}' || c == ']') {
+                    --depth;
+                }
+                ++pos;
+                if(depth == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        size_t start = pos;
+        while(pos < json.size() && json[pos] != ',' && json[pos] != '}' && json[pos] != ']' &&
+              json[pos] != ' ' && json[pos] != '\t' && json[pos] != '\r' && json[pos] != '\n') {
+            ++pos;
+        }
+        return pos > start;
+    }
+    
+    //--------------------------------------------------------------------------
+    void appendUTF8(string& text, unsigned codePoint) {
+        if(codePoint < 0x80) {
+            text += static_cast<char>(codePoint);
+        } else if(codePoint < 0x800) {
+            text += static_cast<char>(0xC0 | (codePoint >> 6));
+            text += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            text += static_cast<char>(0xE0 | (codePoint >> 12));
+            text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            text += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+    
+    //--------------------------------------------------------------------------
+    bool decodeString(const string& raw, string& text) {
+        if(raw.size() < 2 || raw[0] != '"' || raw[raw.size() - 1] != '"') {
+            return false;
+        }
+        
+        text.clear();
+        
+        for(size_t i = 1; i + 1 < raw.size(); ++i) {
+            if(raw[i] != '\\') {
+                text += raw[i];
+                continue;
+            }
+            
+            if(++i + 1 >= raw.size()) {
+                return false;
+            }
+            
+            switch(raw[i]) {
+                case '"':  text += '"';  break;
+                case '\\': text += '\\'; break;
+                case '/':  text += '/';  break;
+                case 'b':  text += '\b'; break;
+                case 'f':  text += '\f'; break;
+                case 'n':  text += '\n'; break;
+                case 'r':  text += '\r'; break;
+                case 't':  text += '\t'; break;
+                case 'u': {
+                    unsigned codePoint = 0;
+                    if(i + 5 >= raw.size() || !Poco::NumberParser::tryParseHex(raw.substr(i + 1, 4), codePoint)) {
+                        return false;
+                    }
+                    appendUTF8(text, codePoint);
+                    i += 4;
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    // The members of a JSON object, their values left as JSON text.  Claims
+    // are flat, so this is all of JSON a token needs.
+    //--------------------------------------------------------------------------
+    bool parseObject(const string& json, map<string, string>& members) {
+        size_t pos = 0;
+        
+        skipWhitespace(json, pos);
+        if(pos >= json.size() || json[pos] != '{') {
+            return false;
+        }
+        ++pos;
+        
+        skipWhitespace(json, pos);
+        if(pos < json.size() && json[pos] == '}') {
+            return true;
+        }
+        
+        while(pos < json.size()) {
+            skipWhitespace(json, pos);
+            
+            size_t keyStart = pos;
+            if(pos >= json.size() || json[pos] != '"' || !skipString(json, pos)) {
+                return false;
+            }
+            
+            string key;
+            if(!decodeString(json.substr(keyStart, pos - keyStart), key)) {
+                return false;
+            }
+            
+            skipWhitespace(json, pos);
+            if(pos >= json.size() || json[pos] != ':') {
+                return false;
+            }
+            ++pos;
+            skipWhitespace(json, pos);
+            
+            size_t valueStart = pos;
+            if(!skipValue(json, pos)) {
+                return false;
+            }
+            members[key] = json.substr(valueStart, pos - valueStart);
+            
+            skipWhitespace(json, pos);
+            if(pos >= json.size()) {
+                return false;
+            }
+            if(json[pos] == '}') {
+                return true;
+            }
+            if(json[pos] != ',') {
+                return false;
+            }
+            ++pos;
+        }
+        
+        return false;
+    }
+    
+    //--------------------------------------------------------------------------
+    bool getString(const map<string, string>& members, const string& name, string& value) {
+        map<string, string>::const_iterator iter = members.find(name);
+        return iter != members.end() && decodeString((*iter).second, value);
+    }
+    
+    enum TimeClaim {
+        TIME_ABSENT,
+        TIME_VALID,
+        TIME_INVALID
+    };
+    
+    // the end of year 9999, well within a Timestamp
+    const double MAX_EPOCH_SECONDS = 253402300799.0;
+    
+    //--------------------------------------------------------------------------
+    TimeClaim getTime(const map<string, string>& members, const string& name, Timestamp& value) {
+        map<string, string>::const_iterator iter = members.find(name);
+        if(iter == members.end()) {
+            return TIME_ABSENT;
+        }
+        
+        double seconds = 0;
+        
+        // also false for NaN
+        if(!Poco::NumberParser::tryParseFloat((*iter).second, seconds) ||
+           !(seconds >= 0 && seconds <= MAX_EPOCH_SECONDS)) {
+            return TIME_INVALID;
+        }
+        
+        value = Timestamp(static_cast<Timestamp::TimeVal>(std::floor(seconds)) * Timestamp::resolution());
+        return TIME_VALID;
+    }
+    
+    //--------------------------------------------------------------------------
+    bool hasAudience(const map<string, string>& members, const string& audience) {
+        map<string, string>::const_iterator iter = members.find("aud");
+        
+        if(iter == members.end()) {
+            return false;
+        }
+        
+        const string& raw = (*iter).second;
+        string value;
+        
+        if(decodeString(raw, value)) {
+            return value == audience;
+        }
+        
+        // an array of strings
+        if(raw.empty() || raw[0] != '[') {
+            return false;
+        }
+        
+        size_t pos = 1;
+        while(pos < raw.size()) {
+            skipWhitespace(raw, pos);
+            size_t start = pos;
+            if(pos < raw.size() && raw[pos] == '"' && skipString(raw, pos)) {
+                if(decodeString(raw.substr(start, pos - start), value) && value == audience) {
+                    return true;
+                }
+            } else if(!skipValue(raw, pos)) {
+                return false;
+            }
+            skipWhitespace(raw, pos);
+            if(pos >= raw.size() || raw[pos] != ',') {
+                break;
+            }
+            ++pos;
+        }
+        
+        return false;
+    }
+    
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerJWTVerifier::Settings::Settings() {
+    secret         = "";
+    issuer         = "";
+    audience       = "";
+    bRequireExpiry = true;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerJWTVerifier::ofxHTTPServerJWTVerifier(const Settings& _settings) :
+settings(_settings)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerJWTVerifier::~ofxHTTPServerJWTVerifier() { }
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerJWTVerifier::verify(const string& token, ofxHTTPServerTokenInfo& info) {
+    if(settings.secret.empty()) {
+        return false; // anyone could sign
+    }
+    
+    size_t first  = token.find('.');
+    size_t second = first == string::npos ? string::npos : token.find('.', first + 1);
+    
+    if(second == string::npos || token.find('.', second + 1) != string::npos) {
+        return false;
+    }
+    
+    string header;
+    string payload;
+    string signature;
+    
+    if(!decodeBase64URL(token.substr(0, first), header) ||
+       !decodeBase64URL(token.substr(first + 1, second - first - 1), payload) ||
+       !decodeBase64URL(token.substr(second + 1), signature)) {
+        return false;
+    }
+    
+    map<string, string> headerMembers;
+    string algorithm;
+    
+    if(!parseObject(header, headerMembers) ||
+       !getString(headerMembers, "alg", algorithm) ||
+       algorithm != "HS256") {
+        return false;
+    }
+    
+    Poco::HMACEngine<ofxHTTPSHA256Engine> hmac(settings.secret);
+    hmac.update(token.data(), second);
+    const DigestEngine::Digest& digest = hmac.digest();
+    
+    if(!ofxHTTPPasswordHash::constantTimeEquals(string(digest.begin(), digest.end()), signature)) {
+        return false;
+    }
+    
+    // only trusted from here on
+    map<string, string> claims;
+    
+    if(!parseObject(payload, claims)) {
+        return false;
+    }
+    
+    string issuer;
+    if(!settings.issuer.empty() && (!getString(claims, "iss", issuer) || issuer != settings.issuer)) {
+        return false;
+    }
+    
+    if(!settings.audience.empty() && !hasAudience(claims, settings.audience)) {
+        return false;
+    }
+    
+    info.claims = payload;
+    getString(claims, "sub", info.subject);
+    // a time that can't be read must not be taken for one that isn't there
+    TimeClaim expires   = getTime(claims, "exp", info.expires);
+    TimeClaim notBefore = getTime(claims, "nbf", info.notBefore);
+    
+    if(expires == TIME_INVALID || notBefore == TIME_INVALID) {
+        return false;
+    }
+    
+    info.bExpires   = expires == TIME_VALID;
+    info.bNotBefore = notBefore == TIME_VALID;
+    
+    return info.bExpires || !settings.bRequireExpiry;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerJWTVerifier::Ptr ofxHTTPServerJWTVerifier::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerJWTVerifier(settings));
+}
@@ -0,0 +1,66 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "ofTypes.h"
+
+#include "ofxHTTPBaseTypes.h"
+
+using std::string;
+
+// Verifies JSON Web Tokens signed with HMAC-SHA256 (alg "HS256").
+//
+// Tokens with any other algorithm, including "none", are rejected.  The
+// exp, nbf, sub, iss and aud claims are read; exp and nbf are handed to
+// the caller to enforce, and a token whose exp or nbf isn't a plausible
+// time is rejected.
+class ofxHTTPServerJWTVerifier : public ofxBaseHTTPServerTokenVerifier {
+public:
+    typedef ofPtr<ofxHTTPServerJWTVerifier> Ptr;
+    
+    struct Settings;
+    
+    ofxHTTPServerJWTVerifier(const Settings& _settings = Settings());
+    virtual ~ofxHTTPServerJWTVerifier();
+    
+    bool verify(const string& token, ofxHTTPServerTokenInfo& info);
+    
+    struct Settings {
+        string secret;
+        string issuer;     // empty accepts any
+        string audience;   // empty accepts any
+        bool bRequireExpiry;
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+protected:
+    Settings settings;
+    
+};
@@ -0,0 +1,181 @@
+#include "ofxHTTPServerListener.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPServerListener::Settings::Settings() {
+    name          = ""; // empty, will be auto generated
+    type          = PLAIN;
+    host          = ""; // all interfaces
+    port          = 8080;
+    backlog       = 64;
+    bReuseAddress = true;
+    path          = "";
+    permissions   = 0660;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerListener::ofxHTTPServerListener(const Settings& _settings) :
+settings(_settings)
+{
+    if(settings.name.empty()) {
+        settings.name = toString();
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerListener::~ofxHTTPServerListener() { }
+
+//------------------------------------------------------------------------------
+ServerSocket ofxHTTPServerListener::createServerSocket() {
+    switch(settings.type) {
+        case SECURE:
+            createSSLManager();
+            // fall through, the listening socket is a plain one
+        case PLAIN: {
+            SocketAddress address = getSocketAddress();
+            ServerSocket socket = ofxAdoptedServerSocket(new ofxHTTPServerSocketImpl());
+            socket.bind(address, settings.bReuseAddress);
+            socket.listen(settings.backlog);
+            serverSocket = socket;
+            return serverSocket;
+        }
+        case UNIX:
+            serverSocket = ofxUnixSocket::listen(settings.path,
+                                                 settings.backlog,
+                                                 settings.permissions,
+                                                 settings.peerFilter);
+            return serverSocket;
+    }
+
+    throw Poco::InvalidArgumentException("Unknown listener type", toString());
+}
+
+//------------------------------------------------------------------------------
+ServerSocket ofxHTTPServerListener::adoptServerSocket(poco_socket_t sockfd) {
+    switch(settings.type) {
+        case SECURE:
+            createSSLManager();
+            // fall through
+        case PLAIN:
+            serverSocket = ofxAdoptedServerSocket(new ofxHTTPServerSocketImpl(sockfd));
+            return serverSocket;
+        case UNIX:
+            serverSocket = ofxUnixSocket::adopt(sockfd, settings.path, settings.peerFilter);
+            return serverSocket;
+    }
+
+    throw Poco::InvalidArgumentException("Unknown listener type", toString());
+}
+
+//------------------------------------------------------------------------------
+poco_socket_t ofxHTTPServerListener::getSocketDescriptor() const {
+    return serverSocket.impl()->sockfd();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerListener::handOff() {
+    ofxHTTPServerSocketImpl* pImpl = dynamic_cast<ofxHTTPServerSocketImpl*>(serverSocket.impl());
+
+    if(pImpl != NULL) {
+        pImpl->setAccepting(false);
+    }
+
+#ifndef TARGET_WIN32
+    ofxUnixServerSocketImpl* pUnixImpl = dynamic_cast<ofxUnixServerSocketImpl*>(serverSocket.impl());
+
+    if(pUnixImpl != NULL) {
+        pUnixImpl->setUnlinkOnClose(false); // the path belongs to the new process now
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerListener::createSSLManager() {
+#ifdef SSL_ENABLED
+    // the ssl manager owns the context, the session cache and the
+    // session ticket keys, so it lives as long as the listener.
+    if(sslManager == NULL) {
+        sslManager = ofxSSLManager::Instance(settings.sslSettings);
+    }
+#else
+    throw Poco::NotImplementedException("SECURE listeners require SSL_ENABLED", toString());
+#endif
+}
+
+#ifdef SSL_ENABLED
+//------------------------------------------------------------------------------
+Context::Ptr ofxHTTPServerListener::getSSLContext() const {
+    if(sslManager != NULL) {
+        return sslManager->getContext();
+    }
+    return Context::Ptr();
+}
+#endif
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerListener::getName() const {
+    return settings.name;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerListener::Type ofxHTTPServerListener::getType() const {
+    return settings.type;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerListener::isSecure() const {
+    return settings.type == SECURE;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerListener::getHost() const {
+    return settings.host;
+}
+
+//------------------------------------------------------------------------------
+unsigned short ofxHTTPServerListener::getPort() const {
+    return settings.port;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerListener::getPath() const {
+    return settings.path;
+}
+
+//------------------------------------------------------------------------------
+SocketAddress ofxHTTPServerListener::getSocketAddress() const {
+    return settings.host.empty() ? SocketAddress(settings.port) : SocketAddress(settings.host, settings.port);
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerListener::getURL() const {
+    if(settings.type == UNIX) {
+        return "http://localhost/"; // only reachable through the socket path
+    }
+    stringstream ss;
+    ss << (isSecure() ? "https://" : "http://");
+    ss << (settings.host.empty() ? "127.0.0.1" : settings.host);
+    ss << ":" << settings.port << "/";
+    return ss.str();
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerListener::toString() const {
+    if(settings.type == UNIX) {
+        return "unix:" + settings.path;
+    }
+    stringstream ss;
+    ss << (isSecure() ? "https" : "http") << "://";
+    ss << (settings.host.empty() ? "*" : settings.host);
+    ss << ":" << settings.port;
+    return ss.str();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerListener::Settings ofxHTTPServerListener::getSettings() const {
+    return settings;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerListener::Ptr ofxHTTPServerListener::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerListener(settings));
+}
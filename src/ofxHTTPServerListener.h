@@ -0,0 +1,137 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/SocketAddress.h"
+
+#include "ofTypes.h"
+#include "ofUtils.h"
+
+#include "ofxHTTPConstants.h"
+#include "ofxHTTPServerSocketImpl.h"
+#include "ofxUnixSocket.h"
+
+#ifdef SSL_ENABLED
+#include "Poco/Net/Context.h"
+
+#include "ofxSSLManager.h"
+
+using Poco::Net::Context;
+#endif
+
+using std::string;
+
+using Poco::Net::ServerSocket;
+using Poco::Net::SocketAddress;
+
+// A single endpoint that an ofxHTTPServer accepts connections on.
+// All listeners of a server share its route table and thread pool.
+class ofxHTTPServerListener {
+public:
+    struct Settings;
+
+    typedef ofPtr<ofxHTTPServerListener> Ptr;
+
+    enum Type {
+        PLAIN,
+        SECURE,
+        UNIX
+    };
+
+    ofxHTTPServerListener(const Settings& _settings);
+    virtual ~ofxHTTPServerListener();
+
+    // creates a bound and listening socket (will throw exceptions)
+    ServerSocket createServerSocket();
+
+    // takes over a listening descriptor handed off by another process
+    ServerSocket adoptServerSocket(poco_socket_t sockfd);
+
+    // the descriptor of the socket created or adopted above
+    poco_socket_t getSocketDescriptor() const;
+
+    // stops accepting, leaving the socket (and a unix socket's file)
+    // to the process it was handed to.  Connections already accepted
+    // are not affected.
+    void handOff();
+
+#ifdef SSL_ENABLED
+    // TLS is negotiated per connection, so the listening socket itself
+    // is a plain one and can be handed off.  Null unless SECURE.
+    Context::Ptr getSSLContext() const;
+#endif
+
+    string getName() const;
+    Type   getType() const;
+    bool   isSecure() const;
+
+    string getHost() const;
+    unsigned short getPort() const;
+    string getPath() const;
+
+    string getURL() const;
+    string toString() const;
+
+    Settings getSettings() const;
+
+    struct Settings {
+        string         name; // empty, will be auto generated
+        Type           type;
+        string         host; // the interface to bind, empty binds all interfaces
+        unsigned short port;
+        int            backlog;
+        bool           bReuseAddress;
+
+        // UNIX listeners only.
+        string            path; // filesystem path, or @name for the abstract namespace
+        int               permissions; // applied to filesystem sockets
+        ofxUnixPeerFilter peerFilter;
+#ifdef SSL_ENABLED
+        ofxSSLManager::Settings sslSettings;
+#endif
+
+        Settings();
+    };
+
+    static Ptr Instance(const Settings& settings = Settings());
+
+protected:
+    SocketAddress getSocketAddress() const;
+
+    // for SECURE listeners, throws without SSL_ENABLED
+    void createSSLManager();
+
+    Settings settings;
+
+    ServerSocket serverSocket;
+
+#ifdef SSL_ENABLED
+    ofxSSLManager::Ptr sslManager;
+#endif
+
+};
@@ -0,0 +1,99 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "Poco/URI.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerMJPEGRouteHandler.h"
+#include "ofxHTTPServerMJPEGStream.h"
+
+using Poco::SyntaxException;
+using Poco::URI;
+
+// A live JPEG stream at settings.route, shown by browsers with a plain
+// <img src="/stream.mjpeg">.  Frames published here are encoded once,
+// however many viewers there are.
+//------------------------------------------------------------------------------
+class ofxHTTPServerMJPEGRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofxHTTPServerMJPEGRouteHandler::Settings Settings;
+    typedef ofPtr<ofxHTTPServerMJPEGRoute> Ptr;
+
+    ofxHTTPServerMJPEGRoute(const Settings& _settings = Settings(),
+                            ofxHTTPServerMJPEGStream::Ptr _stream = ofxHTTPServerMJPEGStream::Instance()) :
+    settings(_settings),
+    stream(_stream)
+    { }
+
+    virtual ~ofxHTTPServerMJPEGRoute() { }
+
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        URI uri;
+        try {
+            uri = URI(request.getURI());
+        } catch(const SyntaxException& exc) {
+            ofLogError("ofxHTTPServerMJPEGRoute::canHandleRequest") << exc.what();
+            return false;
+        }
+
+        string path = uri.getPath();
+        if(path.empty()) { path = "/"; }
+
+        return path == settings.route;
+    }
+
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        ofxHTTPServerBodyLimits limits;
+        limits.bAllowBody = false;
+        return limits;
+    }
+
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        return new ofxHTTPServerMJPEGRouteHandler(stream, settings);
+    }
+
+    void publish(const ofPixels& pixels) {
+        stream->publish(pixels);
+    }
+
+    void publish(ofImage& image) {
+        stream->publish(image.getPixelsRef());
+    }
+
+    ofxHTTPServerMJPEGStream::Ptr getStream() const { return stream; }
+
+    static Ptr Instance(const Settings& settings = Settings(),
+                        ofxHTTPServerMJPEGStream::Ptr stream = ofxHTTPServerMJPEGStream::Instance()) {
+        return Ptr(new ofxHTTPServerMJPEGRoute(settings, stream));
+    }
+
+protected:
+    Settings settings;
+    ofxHTTPServerMJPEGStream::Ptr stream;
+
+};
@@ -0,0 +1,73 @@
+#include "ofxHTTPServerMJPEGRouteHandler.h"
+
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPServerRequestImpl.h"
+
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPServerRequestImpl;
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGRouteHandler::Settings::Settings() {
+    route                     = "/stream.mjpeg";
+    bAllowCrossOriginRequests = false;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGRouteHandler::ofxHTTPServerMJPEGRouteHandler(ofxHTTPServerMJPEGStream::Ptr _stream,
+                                                               const Settings& _settings) :
+stream(_stream),
+settings(_settings)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGRouteHandler::~ofxHTTPServerMJPEGRouteHandler() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerMJPEGRouteHandler::handleExchange(ofxHTTPServerExchange& exchange) {
+    HTTPServerRequest& request = exchange.request;
+    HTTPServerResponse& response = exchange.response;
+    
+    bool bHead = request.getMethod() == HTTPRequest::HTTP_HEAD;
+    
+    if(!bHead && request.getMethod() != HTTPRequest::HTTP_GET) {
+        response.setStatusAndReason(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+        response.set("Allow", "GET, HEAD");
+        sendErrorResponse(response);
+        return;
+    }
+    
+    HTTPServerRequestImpl* pRequestImpl = dynamic_cast<HTTPServerRequestImpl*>(&request);
+    
+    if(pRequestImpl == NULL || stream->isFull()) {
+        response.setStatusAndReason(HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
+        sendErrorResponse(response);
+        return;
+    }
+    
+    // each part replaces the last, the stream ends when the connection does
+    response.setStatusAndReason(HTTPResponse::HTTP_OK);
+    response.setContentType(stream->getContentType());
+    response.set("Cache-Control", "no-cache, no-store");
+    response.set("Pragma", "no-cache");
+    response.set("X-Accel-Buffering", "no"); // for nginx in front
+    response.setChunkedTransferEncoding(false);
+    response.setKeepAlive(false);
+    
+    if(settings.bAllowCrossOriginRequests) {
+        response.set("Access-Control-Allow-Origin", "*");
+    }
+    
+    std::ostream& ostr = response.send();
+    ostr.flush();
+    
+    if(bHead) {
+        return;
+    }
+    
+    StreamSocket socket = pRequestImpl->detachSocket();
+    
+    if(!stream->addViewer(socket)) {
+        // filled up since we checked
+        socket.close();
+    }
+}
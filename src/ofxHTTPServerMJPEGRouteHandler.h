@@ -0,0 +1,57 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "ofxHTTPServerMJPEGStream.h"
+#include "ofxHTTPServerRouteHandler.h"
+
+using std::string;
+
+// Answers a multipart/x-mixed-replace request and hands its connection to
+// the stream, freeing the server thread that accepted it.
+//------------------------------------------------------------------------------
+class ofxHTTPServerMJPEGRouteHandler : public ofxHTTPServerRouteHandler {
+public:
+    struct Settings;
+    
+    ofxHTTPServerMJPEGRouteHandler(ofxHTTPServerMJPEGStream::Ptr _stream, const Settings& _settings);
+    virtual ~ofxHTTPServerMJPEGRouteHandler();
+    
+    struct Settings {
+        string route;               // e.g. /stream.mjpeg
+        bool bAllowCrossOriginRequests;
+        
+        Settings();
+    };
+    
+protected:
+    ofxHTTPServerMJPEGStream::Ptr stream;
+    Settings settings;
+    
+    void handleExchange(ofxHTTPServerExchange& exchange);
+    
+};
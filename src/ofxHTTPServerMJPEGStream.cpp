@@ -0,0 +1,415 @@
+#include "ofxHTTPServerMJPEGStream.h"
+
+#include "Poco/Exception.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Net/Socket.h"
+
+#include "ofLog.h"
+#include "ofUtils.h"
+
+#include "ofxHTTPUtils.h"
+
+using Poco::Net::Socket;
+using Poco::Net::SocketImpl;
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGStream::Settings::Settings() {
+    quality     = OF_IMAGE_QUALITY_HIGH;
+    numEncoders = 1;
+    maxViewers  = 100;
+    boundary    = "ofxHTTPServerMJPEGFrame";
+    sendTimeout = Timespan(10 * Timespan::SECONDS);
+    pollTimeout = Timespan(10 * Timespan::MILLISECONDS);
+    checkInterval = Timespan(1 * Timespan::SECONDS);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGStream::Metrics::Metrics() {
+    numFramesPublished = 0;
+    numFramesEncoded   = 0;
+    numFramesSkipped   = 0;
+    numFramesDropped   = 0;
+    numFramesOutOfOrder = 0;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGStream::ofxHTTPServerMJPEGStream(const Settings& _settings) :
+settings(_settings),
+pendingSequence(0),
+lastSequence(0),
+lastEncodedSequence(0),
+encoderRunnable(*this, &ofxHTTPServerMJPEGStream::encode),
+bRunning(true)
+{
+    if(settings.numEncoders < 1) {
+        settings.numEncoders = 1;
+    }
+    
+    thread.setName("ofxHTTPServerMJPEGStream");
+    thread.start(*this);
+    
+    for(size_t i = 0; i < settings.numEncoders; ++i) {
+        Thread* encoder = new Thread("ofxHTTPServerMJPEGStream encoder " + ofToString(i));
+        encoder->start(encoderRunnable);
+        encoders.push_back(encoder);
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGStream::~ofxHTTPServerMJPEGStream() {
+    {
+        ofScopedLock lock(mutex);
+        bRunning = false;
+        frameCondition.broadcast();
+    }
+    
+    wakeEvent.set();
+    thread.join();
+    
+    for(size_t i = 0; i < encoders.size(); ++i) {
+        encoders[i]->join();
+        delete encoders[i];
+    }
+    
+    encoders.clear();
+    
+    set<Viewer*>::iterator iter = viewers.begin();
+    while(iter != viewers.end()) {
+        (*iter)->socket.close();
+        delete *iter;
+        ++iter;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerMJPEGStream::publish(const ofPixels& pixels) {
+    ofScopedLock lock(mutex);
+    
+    ++metrics.numFramesPublished;
+    
+    if(viewers.empty()) {
+        // whoever joins next shouldn't start with an old frame
+        lastFrame.reset();
+        return;
+    }
+    
+    if(pendingFrame != NULL) {
+        ++metrics.numFramesSkipped; // the encoders are behind
+    }
+    
+    pendingFrame    = ofPtr<ofPixels>(new ofPixels(pixels));
+    pendingSequence = ++lastSequence;
+    
+    frameCondition.signal();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerMJPEGStream::addViewer(const StreamSocket& socket) {
+    ofScopedLock lock(mutex);
+    
+    if(!bRunning || viewers.size() >= settings.maxViewers) {
+        return false;
+    }
+    
+    Viewer* viewer = new Viewer();
+    viewer->socket = socket;
+    viewer->socket.setBlocking(false);
+    
+    viewers.insert(viewer);
+    
+    if(lastFrame != NULL) {
+        enqueue(viewer, lastFrame);
+        wakeEvent.set();
+    }
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerMJPEGStream::isFull() const {
+    ofScopedLock lock(mutex);
+    return viewers.size() >= settings.maxViewers;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerMJPEGStream::getNumViewers() const {
+    ofScopedLock lock(mutex);
+    return viewers.size();
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerMJPEGStream::getBoundary() const {
+    return settings.boundary;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerMJPEGStream::getContentType() const {
+    return "multipart/x-mixed-replace; boundary=" + settings.boundary;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGStream::Metrics ofxHTTPServerMJPEGStream::getMetrics() const {
+    ofScopedLock lock(mutex);
+    return metrics;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGStream::Ptr ofxHTTPServerMJPEGStream::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerMJPEGStream(settings));
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerMJPEGStream::encode() {
+    while(true) {
+        ofPtr<ofPixels> pixels;
+        unsigned long long sequence = 0;
+        
+        {
+            ofScopedLock lock(mutex);
+            
+            while(bRunning && pendingFrame == NULL) {
+                frameCondition.wait(mutex);
+            }
+            
+            if(!bRunning) {
+                break;
+            }
+            
+            pixels   = pendingFrame;
+            sequence = pendingSequence;
+            pendingFrame.reset();
+        }
+        
+        ofBuffer jpeg;
+        ofSaveImage(*pixels, jpeg, OF_IMAGE_FORMAT_JPEG, settings.quality);
+        
+        if(jpeg.size() == 0) {
+            ofLogError("ofxHTTPServerMJPEGStream::encode") << "Unable to encode frame " << sequence << ".";
+            continue;
+        }
+        
+        Buffer frame = createPart(jpeg);
+        
+        ofScopedLock lock(mutex);
+        
+        ++metrics.numFramesEncoded;
+        
+        // with several encoders a later frame may have finished first
+        if(sequence < lastEncodedSequence) {
+            ++metrics.numFramesOutOfOrder;
+            continue;
+        }
+        
+        lastEncodedSequence = sequence;
+        lastFrame = frame;
+        
+        set<Viewer*>::iterator iter = viewers.begin();
+        while(iter != viewers.end()) {
+            enqueue(*iter, frame);
+            ++iter;
+        }
+        
+        wakeEvent.set();
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerMJPEGStream::Buffer ofxHTTPServerMJPEGStream::createPart(const ofBuffer& jpeg) const {
+    string header = "--" + settings.boundary + "\r\n";
+    header += "Content-Type: image/jpeg\r\n";
+    header += "Content-Length: " + Poco::NumberFormatter::format(static_cast<Poco::UInt64>(jpeg.size())) + "\r\n\r\n";
+    
+    string* part = new string();
+    part->reserve(header.size() + jpeg.size() + 2);
+    part->append(header);
+    part->append(jpeg.getBinaryBuffer(), jpeg.size());
+    part->append("\r\n");
+    
+    return Buffer(part);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerMJPEGStream::run() {
+    while(true) {
+        Socket::SocketList readList;
+        Socket::SocketList writeList;
+        Socket::SocketList exceptList;
+        
+        map<SocketImpl*, Viewer*> watched;
+        
+        {
+            ofScopedLock lock(mutex);
+            
+            if(!bRunning) {
+                break;
+            }
+            
+            Timestamp now;
+            
+            vector<Viewer*> dropped;
+            
+            set<Viewer*>::iterator iter = pending.begin();
+            while(iter != pending.end()) {
+                if(!flush(*iter, now)) {
+                    dropped.push_back(*iter);
+                }
+                ++iter;
+            }
+            
+            pending.clear();
+            
+            iter = blocked.begin();
+            while(iter != blocked.end()) {
+                Viewer* viewer = *iter;
+                if(now - viewer->blockedSince >= settings.sendTimeout.totalMicroseconds()) {
+                    dropped.push_back(viewer);
+                } else {
+                    writeList.push_back(viewer->socket);
+                }
+                ++iter;
+            }
+            
+            for(size_t i = 0; i < dropped.size(); ++i) {
+                remove(dropped[i]);
+            }
+            
+            iter = viewers.begin();
+            while(iter != viewers.end()) {
+                readList.push_back((*iter)->socket);
+                watched[(*iter)->socket.impl()] = *iter;
+                ++iter;
+            }
+        }
+        
+        // new frames for writable viewers wait at most pollTimeout
+        Timespan timeout = settings.pollTimeout;
+        
+        if(writeList.empty()) {
+            if(readList.empty()) {
+                wakeEvent.wait();
+                continue;
+            }
+            
+            // nothing to send, but viewers may leave while it's quiet
+            if(wakeEvent.tryWait(static_cast<long>(settings.checkInterval.totalMilliseconds()))) {
+                continue;
+            }
+            
+            timeout = Timespan(0);
+        }
+        
+        try {
+            Socket::select(readList, writeList, exceptList, timeout);
+        } catch(const Poco::Exception& exc) {
+            ofLogError("ofxHTTPServerMJPEGStream::run") << exc.displayText();
+        }
+        
+        ofScopedLock lock(mutex);
+        
+        Socket::SocketList::iterator iter = readList.begin();
+        while(iter != readList.end()) {
+            map<SocketImpl*, Viewer*>::iterator viewer = watched.find((*iter).impl());
+            if(viewer != watched.end() && hasLeft((*viewer).second)) {
+                remove((*viewer).second);
+                watched.erase(viewer);
+            }
+            ++iter;
+        }
+        
+        iter = writeList.begin();
+        while(iter != writeList.end()) {
+            map<SocketImpl*, Viewer*>::iterator viewer = watched.find((*iter).impl());
+            if(viewer != watched.end()) {
+                (*viewer).second->bBlocked = false;
+                blocked.erase((*viewer).second);
+                pending.insert((*viewer).second);
+            }
+            ++iter;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerMJPEGStream::enqueue(Viewer* viewer, const Buffer& frame) {
+    if(viewer->current == NULL) {
+        viewer->current = frame;
+        viewer->offset  = 0;
+    } else {
+        if(viewer->next != NULL) {
+            ++metrics.numFramesDropped; // never sent to this viewer
+        }
+        viewer->next = frame;
+    }
+    
+    if(!viewer->bBlocked) {
+        pending.insert(viewer);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerMJPEGStream::flush(Viewer* viewer, const Timestamp& now) {
+    while(viewer->current != NULL) {
+        const string& frame = *viewer->current;
+        
+        int n = 0;
+        
+        try {
+            n = ofSendSome(viewer->socket, frame.data() + viewer->offset, frame.size() - viewer->offset);
+        } catch(const Poco::Exception&) {
+            n = -1;
+        }
+        
+        if(n < 0) {
+            return false;
+        }
+        
+        if(n == 0) {
+            if(!viewer->bBlocked) {
+                viewer->bBlocked = true;
+                viewer->blockedSince = now;
+                blocked.insert(viewer);
+            }
+            return true;
+        }
+        
+        viewer->offset += n;
+        
+        if(viewer->offset == frame.size()) {
+            viewer->current = viewer->next;
+            viewer->offset  = 0;
+            viewer->next.reset();
+        }
+    }
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerMJPEGStream::hasLeft(Viewer* viewer) {
+    char buffer[256];
+    
+    try {
+        // anything a viewer sends is ignored, the end of it means it left
+        int n = viewer->socket.receiveBytes(buffer, sizeof(buffer));
+        return n == 0;
+    } catch(const Poco::Exception&) {
+        return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerMJPEGStream::remove(Viewer* viewer) {
+    viewers.erase(viewer);
+    pending.erase(viewer);
+    blocked.erase(viewer);
+    
+    try {
+        viewer->socket.shutdown();
+    } catch(const Poco::Exception&) {
+        // already gone
+    }
+    
+    viewer->socket.close();
+    
+    delete viewer;
+}
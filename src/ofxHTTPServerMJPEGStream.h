@@ -0,0 +1,175 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Poco/Condition.h"
+#include "Poco/Event.h"
+#include "Poco/Runnable.h"
+#include "Poco/RunnableAdapter.h"
+#include "Poco/Thread.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/StreamSocket.h"
+
+#include "ofImage.h"
+#include "ofTypes.h"
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+using Poco::Runnable;
+using Poco::Thread;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::StreamSocket;
+
+// Streams published frames to browsers as multipart/x-mixed-replace JPEG.
+//
+// The app publishes ofPixels as often as it likes.  Encoder threads
+// compress each frame to JPEG once and every viewer sends the same encoded
+// part.  A frame that arrives while the previous one still waits for an
+// encoder replaces it, and a viewer that is still sending one frame keeps
+// only the newest next frame, so a slow viewer sees a lower frame rate
+// instead of a growing delay.  Nothing is encoded while nobody watches.
+//
+// Viewers are sockets taken over from the server once their response
+// headers are sent, written to by one thread without blocking, like the
+// subscribers of an ofxHTTPServerSSEBroker.  Viewers never send anything
+// after their request, so a readable socket means the browser went away;
+// a stream without new frames checks for that every checkInterval.
+class ofxHTTPServerMJPEGStream : public Runnable {
+public:
+    typedef ofPtr<ofxHTTPServerMJPEGStream> Ptr;
+    typedef ofPtr<const string> Buffer;
+    
+    struct Settings;
+    struct Metrics;
+    
+    ofxHTTPServerMJPEGStream(const Settings& _settings);
+    virtual ~ofxHTTPServerMJPEGStream();
+    
+    // copies the pixels for the encoders and returns right away
+    void publish(const ofPixels& pixels);
+    
+    // takes over a socket whose response headers have been sent.  Returns
+    // false if there are already maxViewers, the socket is then left alone.
+    bool addViewer(const StreamSocket& socket);
+    
+    bool isFull() const;
+    size_t getNumViewers() const;
+    
+    string getBoundary() const;
+    string getContentType() const;
+    
+    Metrics getMetrics() const;
+    
+    struct Settings {
+        ofImageQualityType quality;
+        size_t numEncoders;
+        size_t maxViewers;
+        string boundary;
+        Timespan sendTimeout;   // longest a viewer may stay unwritable
+        Timespan pollTimeout;   // how often full sockets are rechecked
+        Timespan checkInterval; // how often idle viewers are checked for EOF
+        
+        Settings();
+    };
+    
+    struct Metrics {
+        unsigned long long numFramesPublished;
+        unsigned long long numFramesEncoded;
+        unsigned long long numFramesSkipped;   // replaced before encoding
+        unsigned long long numFramesDropped;   // replaced before a viewer sent them
+        unsigned long long numFramesOutOfOrder; // encoded after a later frame
+        
+        Metrics();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+    // overriden from Runnable, the writer thread
+    void run();
+    
+protected:
+    struct Viewer {
+        Viewer() : offset(0), bBlocked(false) { }
+        
+        StreamSocket socket;
+        Buffer current;         // being sent
+        size_t offset;          // sent of current
+        Buffer next;            // the newest frame after current
+        bool bBlocked;          // waiting for the socket to drain
+        Timestamp blockedSince;
+    };
+    
+    // run by each encoder thread
+    void encode();
+    
+    // the multipart framing of one frame
+    Buffer createPart(const ofBuffer& jpeg) const;
+    
+    // all expected to hold the mutex
+    void enqueue(Viewer* viewer, const Buffer& frame);
+    
+    // returns false if the viewer is to be closed
+    bool flush(Viewer* viewer, const Timestamp& now);
+    bool hasLeft(Viewer* viewer);
+    void remove(Viewer* viewer);
+    
+    Settings settings;
+    
+    mutable ofMutex mutex;
+    Poco::Condition frameCondition;
+    
+    ofPtr<ofPixels> pendingFrame;    // waiting for an encoder
+    unsigned long long pendingSequence;
+    unsigned long long lastSequence;
+    unsigned long long lastEncodedSequence;
+    
+    Buffer lastFrame;                // for viewers that just joined
+    
+    Metrics metrics;
+    
+    // viewers are only deleted by the writer thread
+    set<Viewer*> viewers;
+    set<Viewer*> pending;   // have something to send
+    set<Viewer*> blocked;   // waiting for their sockets
+    
+    Thread thread;
+    Poco::Event wakeEvent;
+    
+    vector<Thread*> encoders;
+    Poco::RunnableAdapter<ofxHTTPServerMJPEGStream> encoderRunnable;
+    
+    bool bRunning;
+    
+};
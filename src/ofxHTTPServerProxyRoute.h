@@ -0,0 +1,106 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <vector>
+
+#include "Poco/AtomicCounter.h"
+#include "Poco/URI.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerProxyRouteHandler.h"
+#include "ofxHTTPUpstream.h"
+
+using std::vector;
+
+using Poco::SyntaxException;
+using Poco::URI;
+
+// Forwards requests below settings.route to one or more upstream servers,
+// over pooled keep-alive connections, streaming bodies both ways.
+//------------------------------------------------------------------------------
+class ofxHTTPServerProxyRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofxHTTPServerProxyRouteHandler::Settings Settings;
+    typedef ofPtr<ofxHTTPServerProxyRoute> Ptr;
+
+    ofxHTTPServerProxyRoute(const Settings& _settings = Settings()) : settings(_settings) {
+        vector<ofxHTTPUpstream::Settings>::const_iterator iter = settings.upstreams.begin();
+        while(iter != settings.upstreams.end()) {
+            upstreams.push_back(ofxHTTPUpstream::Instance(*iter));
+            ++iter;
+        }
+    }
+
+    virtual ~ofxHTTPServerProxyRoute() { }
+
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        URI uri;
+        try {
+            uri = URI(request.getURI());
+        } catch(const SyntaxException& exc) {
+            ofLogError("ofxHTTPServerProxyRoute::canHandleRequest") << exc.what();
+            return false;
+        }
+
+        string path = uri.getPath();
+
+        if(settings.route.empty() || settings.route == "/") {
+            return true;
+        }
+
+        // the route itself or anything below it
+        return path.compare(0, settings.route.size(), settings.route) == 0 &&
+               (path.size() == settings.route.size() || path[settings.route.size()] == '/');
+    }
+
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        ofxHTTPServerBodyLimits limits;
+        limits.maxBodySize = settings.maxBodySize;
+        return limits;
+    }
+
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        return new ofxHTTPServerProxyRouteHandler(settings, upstreams, nextUpstream);
+    }
+
+    // in the order of settings.upstreams, e.g. for their metrics
+    const vector<ofxHTTPUpstream::Ptr>& getUpstreams() const {
+        return upstreams;
+    }
+
+    static Ptr Instance(const Settings& settings = Settings()) {
+        return Ptr(new ofxHTTPServerProxyRoute(settings));
+    }
+
+protected:
+    Settings settings;
+
+    vector<ofxHTTPUpstream::Ptr> upstreams;
+    Poco::AtomicCounter nextUpstream;
+
+};
@@ -0,0 +1,274 @@
+#include "ofxHTTPServerProxyRouteHandler.h"
+
+#include <set>
+
+#include "Poco/Exception.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/String.h"
+#include "Poco/StringTokenizer.h"
+#include "Poco/Timestamp.h"
+
+using std::istream;
+using std::ostream;
+using std::set;
+
+using Poco::StreamCopier;
+using Poco::Timestamp;
+
+namespace {
+
+    const char* HOP_BY_HOP_HEADERS[] = {
+        "Connection",
+        "Keep-Alive",
+        "Proxy-Authenticate",
+        "Proxy-Authorization",
+        "Proxy-Connection",
+        "TE",
+        "Trailer",
+        "Transfer-Encoding",
+        "Upgrade"
+    };
+
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerProxyRouteHandler::Settings::Settings() {
+    route                = "/proxy";
+    bStripRoute          = true;
+    maxBodySize          = 0;
+    bufferSize           = 64 * 1024; // 64 KB
+    bAddForwardedHeaders = true;
+    bPreserveHost        = false;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerProxyRouteHandler::ofxHTTPServerProxyRouteHandler(const Settings& _settings,
+                                                               const vector<ofxHTTPUpstream::Ptr>& _upstreams,
+                                                               Poco::AtomicCounter& _nextUpstream) :
+settings(_settings),
+upstreams(_upstreams),
+nextUpstream(_nextUpstream)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerProxyRouteHandler::~ofxHTTPServerProxyRouteHandler() { }
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerProxyRouteHandler::isHopByHop(const string& name) {
+    for(size_t i = 0; i < sizeof(HOP_BY_HOP_HEADERS) / sizeof(HOP_BY_HOP_HEADERS[0]); ++i) {
+        if(Poco::icompare(name, HOP_BY_HOP_HEADERS[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerProxyRouteHandler::handleExchange(ofxHTTPServerExchange& exchange) {
+    HTTPServerRequest&  request  = exchange.request;
+    HTTPServerResponse& response = exchange.response;
+    
+    bool bHasBody = ofxHTTPServerBodyLimits::hasBody(request);
+    
+    if(upstreams.empty()) {
+        rejectWithoutBody(request, response, HTTPResponse::HTTP_BAD_GATEWAY);
+        sendErrorResponse(response);
+        return;
+    }
+    
+    unsigned int index = static_cast<unsigned int>(nextUpstream++);
+    ofxHTTPUpstream& upstream = *upstreams[index % upstreams.size()];
+    
+    HTTPRequest upstreamRequest;
+    prepareRequest(exchange, upstream, upstreamRequest);
+    
+    Timestamp start;
+    UInt64 bytesSent = 0;
+    UInt64 bytesReceived = 0;
+    
+    HTTPClientSession* session = NULL;
+    HTTPResponse upstreamResponse;
+    istream* upstreamBody = NULL;
+    HTTPResponse::HTTPStatus failureStatus = HTTPResponse::HTTP_BAD_GATEWAY;
+    
+    // the upstream may have closed a pooled connection while it sat idle.
+    // Without a body, which can't be read twice, the request is simply
+    // sent again on a fresh one.
+    for(int attempt = 0; attempt < 2 && upstreamBody == NULL; ++attempt) {
+        bool bReused = false;
+        session = upstream.acquire(bReused);
+        
+        if(session == NULL) {
+            failureStatus = HTTPResponse::HTTP_SERVICE_UNAVAILABLE;
+            break;
+        }
+        
+        try {
+            ostream& upstreamOut = session->sendRequest(upstreamRequest);
+            
+            if(bHasBody) {
+                bytesSent = StreamCopier::copyStream(request.stream(), upstreamOut, settings.bufferSize);
+            }
+            
+            upstreamBody = &session->receiveResponse(upstreamResponse);
+        } catch(const Poco::Exception& exc) {
+            upstream.release(session, false);
+            session = NULL;
+            
+            if(!bReused || bHasBody) {
+                ofLogError("ofxHTTPServerProxyRouteHandler::handleExchange") << upstream.getURI().toString() << ": " << exc.displayText();
+                if(dynamic_cast<const Poco::TimeoutException*>(&exc) != NULL) {
+                    failureStatus = HTTPResponse::HTTP_GATEWAY_TIMEOUT;
+                }
+                break;
+            }
+        }
+    }
+    
+    if(upstreamBody == NULL) {
+        upstream.requestFinished(false, Timespan(start.elapsed()), bytesSent, 0);
+        response.setStatusAndReason(failureStatus);
+        if(bHasBody) {
+            response.setKeepAlive(false); // the body may not have been read
+        }
+        sendErrorResponse(response);
+        return;
+    }
+    
+    Timespan timeToFirstByte(start.elapsed());
+    
+    prepareResponse(upstreamResponse, request, response);
+    
+    bool bSuccess = false;
+    
+    try {
+        ostream& out = response.send();
+        
+        // HEAD, 204 and 304 responses come with an empty stream
+        bytesReceived = StreamCopier::copyStream(*upstreamBody, out, settings.bufferSize);
+        out.flush();
+        
+        bSuccess = !out.bad() && !upstreamBody->bad();
+    } catch(const Poco::Exception& exc) {
+        ofLogWarning("ofxHTTPServerProxyRouteHandler::handleExchange") << "Response from " << upstream.getURI().toString() << " aborted: " << exc.displayText();
+    }
+    
+    // only a fully read response leaves the connection usable
+    upstream.release(session, bSuccess && upstreamResponse.getKeepAlive());
+    upstream.requestFinished(bSuccess, timeToFirstByte, bytesSent, bytesReceived);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerProxyRouteHandler::prepareRequest(ofxHTTPServerExchange& exchange,
+                                                    ofxHTTPUpstream& upstream,
+                                                    HTTPRequest& upstreamRequest) {
+    HTTPServerRequest& request = exchange.request;
+    
+    string path = request.getURI();
+    
+    if(settings.bStripRoute &&
+       settings.route != "/" &&
+       path.compare(0, settings.route.size(), settings.route) == 0) {
+        path = path.substr(settings.route.size());
+    }
+    
+    if(path.empty() || path[0] != '/') {
+        path = "/" + path;
+    }
+    
+    upstreamRequest.setMethod(request.getMethod());
+    upstreamRequest.setURI(upstream.getBasePath() + path);
+    upstreamRequest.setVersion(HTTPMessage::HTTP_1_1);
+    
+    NameValueCollection::ConstIterator iter = request.begin();
+    while(iter != request.end()) {
+        if(!isHopByHop((*iter).first) &&
+           Poco::icompare((*iter).first, "Host") != 0 &&
+           Poco::icompare((*iter).first, "Expect") != 0 && // answered by us
+           Poco::icompare((*iter).first, "Content-Length") != 0) {
+            upstreamRequest.add((*iter).first, (*iter).second);
+        }
+        ++iter;
+    }
+    
+    // headers the client declared hop-by-hop in its Connection header
+    if(request.has("Connection")) {
+        StringTokenizer tokens(request.get("Connection"), ",", StringTokenizer::TOK_TRIM | StringTokenizer::TOK_IGNORE_EMPTY);
+        StringTokenizer::Iterator token = tokens.begin();
+        while(token != tokens.end()) {
+            upstreamRequest.erase(*token);
+            ++token;
+        }
+    }
+    
+    upstreamRequest.setHost(settings.bPreserveHost && request.has("Host") ? request.getHost() : upstream.getHostHeader());
+    upstreamRequest.setKeepAlive(true);
+    
+    if(ofxHTTPServerBodyLimits::hasBody(request)) {
+        if(request.getChunkedTransferEncoding()) {
+            upstreamRequest.setChunkedTransferEncoding(true);
+        } else {
+            upstreamRequest.setContentLength64(request.getContentLength64());
+        }
+    }
+    
+    if(settings.bAddForwardedHeaders) {
+        string clientAddress = request.clientAddress().host().toString();
+        
+        if(request.has("X-Forwarded-For")) {
+            upstreamRequest.set("X-Forwarded-For", request.get("X-Forwarded-For") + ", " + clientAddress);
+        } else {
+            upstreamRequest.set("X-Forwarded-For", clientAddress);
+        }
+        
+        if(request.has("Host")) {
+            upstreamRequest.set("X-Forwarded-Host", request.getHost());
+        }
+        
+        const ofxHTTPServerListener* listener = exchange.getListener();
+        upstreamRequest.set("X-Forwarded-Proto", listener != NULL && listener->isSecure() ? "https" : "http");
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerProxyRouteHandler::prepareResponse(const HTTPResponse& upstreamResponse,
+                                                     HTTPServerRequest& request,
+                                                     HTTPServerResponse& response) {
+    response.setStatusAndReason(upstreamResponse.getStatus(), upstreamResponse.getReason());
+    
+    set<string> connectionHeaders;
+    
+    if(upstreamResponse.has("Connection")) {
+        StringTokenizer tokens(upstreamResponse.get("Connection"), ",", StringTokenizer::TOK_TRIM | StringTokenizer::TOK_IGNORE_EMPTY);
+        StringTokenizer::Iterator token = tokens.begin();
+        while(token != tokens.end()) {
+            connectionHeaders.insert(Poco::toLower(*token));
+            ++token;
+        }
+    }
+    
+    NameValueCollection::ConstIterator iter = upstreamResponse.begin();
+    while(iter != upstreamResponse.end()) {
+        if(!isHopByHop((*iter).first) &&
+           Poco::icompare((*iter).first, "Content-Length") != 0 &&
+           connectionHeaders.find(Poco::toLower((*iter).first)) == connectionHeaders.end()) {
+            response.add((*iter).first, (*iter).second);
+        }
+        ++iter;
+    }
+    
+    int status = upstreamResponse.getStatus();
+    bool bNoBody = status == HTTPResponse::HTTP_NO_CONTENT ||
+                   status == HTTPResponse::HTTP_NOT_MODIFIED ||
+                   status < 200;
+    
+    if(upstreamResponse.getContentLength64() != HTTPMessage::UNKNOWN_CONTENT_LENGTH) {
+        response.setContentLength64(upstreamResponse.getContentLength64());
+    } else if(bNoBody || request.getMethod() == HTTPRequest::HTTP_HEAD) {
+        // nothing follows
+    } else if(request.getVersion() == HTTPMessage::HTTP_1_1) {
+        response.setChunkedTransferEncoding(true);
+    } else {
+        response.setKeepAlive(false); // the end of the body is the end of the connection
+    }
+}
@@ -0,0 +1,89 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Poco/AtomicCounter.h"
+#include "Poco/Net/HTTPMessage.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+
+#include "ofxHTTPServerRouteHandler.h"
+#include "ofxHTTPUpstream.h"
+
+using std::string;
+using std::vector;
+
+using Poco::Net::HTTPMessage;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+
+//------------------------------------------------------------------------------
+class ofxHTTPServerProxyRouteHandler : public ofxHTTPServerRouteHandler {
+public:
+    struct Settings;
+    
+    ofxHTTPServerProxyRouteHandler(const Settings& _settings,
+                                   const vector<ofxHTTPUpstream::Ptr>& _upstreams,
+                                   Poco::AtomicCounter& _nextUpstream);
+    virtual ~ofxHTTPServerProxyRouteHandler();
+    
+    struct Settings {
+        string route;              // a path prefix, e.g. /render
+        bool bStripRoute;          // /render/a is forwarded as <upstream path>/a
+        
+        // requests are spread over the upstreams in turn
+        vector<ofxHTTPUpstream::Settings> upstreams;
+        
+        unsigned long long maxBodySize; // 0 is unlimited
+        size_t bufferSize;
+        
+        bool bAddForwardedHeaders; // X-Forwarded-For, -Host and -Proto
+        bool bPreserveHost;        // forward the client's Host header
+        
+        Settings();
+    };
+    
+    // true for the headers that only concern a single connection
+    static bool isHopByHop(const string& name);
+    
+protected:
+    Settings settings;
+    const vector<ofxHTTPUpstream::Ptr>& upstreams;
+    Poco::AtomicCounter& nextUpstream;
+    
+    void handleExchange(ofxHTTPServerExchange& exchange);
+    
+    void prepareRequest(ofxHTTPServerExchange& exchange,
+                        ofxHTTPUpstream& upstream,
+                        HTTPRequest& upstreamRequest);
+    
+    void prepareResponse(const HTTPResponse& upstreamResponse,
+                         HTTPServerRequest& request,
+                         HTTPServerResponse& response);
+    
+};
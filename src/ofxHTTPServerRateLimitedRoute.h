@@ -0,0 +1,72 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerRateLimiter.h"
+
+// Puts a rate limit in front of another route.  Requests over the limit
+// are answered with 429 before the route creates its handler.
+//------------------------------------------------------------------------------
+class ofxHTTPServerRateLimitedRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofPtr<ofxHTTPServerRateLimitedRoute> Ptr;
+
+    ofxHTTPServerRateLimitedRoute(ofxBaseHTTPServerRoute::Ptr _route,
+                                  ofxHTTPServerRateLimiter::Ptr _limiter) :
+    route(_route),
+    limiter(_limiter)
+    { }
+
+    virtual ~ofxHTTPServerRateLimitedRoute() { }
+
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        return route->canHandleRequest(request, bIsSecurePort);
+    }
+
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        return route->getBodyLimits(request);
+    }
+
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        Timespan retryAfter;
+        if(!limiter->acquire(request, retryAfter)) {
+            return ofxHTTPServerRateLimiter::createRejectionHandler(retryAfter);
+        }
+        return route->createRequestHandler(request);
+    }
+
+    ofxBaseHTTPServerRoute::Ptr getRoute() const { return route; }
+    ofxHTTPServerRateLimiter::Ptr getLimiter() const { return limiter; }
+
+    static Ptr Instance(ofxBaseHTTPServerRoute::Ptr route, ofxHTTPServerRateLimiter::Ptr limiter) {
+        return Ptr(new ofxHTTPServerRateLimitedRoute(route, limiter));
+    }
+
+protected:
+    ofxBaseHTTPServerRoute::Ptr route;
+    ofxHTTPServerRateLimiter::Ptr limiter;
+
+};
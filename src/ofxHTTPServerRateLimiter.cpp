@@ -0,0 +1,284 @@
+#include "ofxHTTPServerRateLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Poco/NumberFormatter.h"
+#include "Poco/Net/NameValueCollection.h"
+
+#include "ofxHTTPUtils.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPServerRateLimiter::Settings::Settings() {
+    algorithm  = TOKEN_BUCKET;
+    keySource  = CLIENT_ADDRESS;
+    keyName    = "";
+    limit      = 60;
+    window     = Timespan(0, 0, 1, 0, 0); // 1 minute
+    maxClients = 100000;
+    numShards  = 16;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerRateLimiter::ofxHTTPServerRateLimiter(const Settings& _settings) :
+settings(_settings),
+maxClientsPerShard(0),
+shards(_settings.numShards)
+{
+    settings.numShards = shards.size();
+    
+    maxClientsPerShard = std::max<size_t>(1, shards.getCapacityPerShard(settings.maxClients));
+    
+    if(settings.window.totalMicroseconds() <= 0) {
+        settings.window = Timespan(1, 0);
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerRateLimiter::~ofxHTTPServerRateLimiter() {
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerRateLimiter::acquire(const HTTPServerRequest& request, Timespan& retryAfter) {
+    return acquire(getClientKey(request), retryAfter);
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerRateLimiter::acquire(const string& clientKey, Timespan& retryAfter) {
+    Shard& shard = getShard(clientKey);
+    Timestamp now;
+    
+    ofScopedLock lock(shard.mutex);
+    
+    HashMap<string, Client>::Iterator iter = shard.clients.find(clientKey);
+    
+    if(iter == shard.clients.end()) {
+        while(shard.clients.size() >= maxClientsPerShard) {
+            shard.clients.erase(shard.lru.back());
+            shard.lru.pop_back();
+        }
+        
+        Client& client = shard.clients[clientKey];
+        client.time  = now;
+        client.value = settings.algorithm == TOKEN_BUCKET ? static_cast<float>(settings.limit) : 0;
+        client.lruPosition = shard.lru.insert(shard.lru.begin(), clientKey);
+        
+        iter = shard.clients.find(clientKey);
+    } else {
+        shard.lru.splice(shard.lru.begin(), shard.lru, (*iter).second.lruPosition);
+    }
+    
+    if(settings.algorithm == TOKEN_BUCKET) {
+        return acquireToken((*iter).second, now, retryAfter);
+    } else {
+        return acquireSlot((*iter).second, now, retryAfter);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerRateLimiter::release(const string& clientKey) {
+    Shard& shard = getShard(clientKey);
+    
+    ofScopedLock lock(shard.mutex);
+    
+    HashMap<string, Client>::Iterator iter = shard.clients.find(clientKey);
+    
+    if(iter == shard.clients.end()) {
+        return; // forgotten in the meantime, which is a fresh allowance anyway
+    }
+    
+    Client& client = (*iter).second;
+    
+    if(settings.algorithm == TOKEN_BUCKET) {
+        client.value = static_cast<float>(std::min(settings.limit, client.value + 1.0));
+    } else if(client.value >= 1) {
+        client.value -= 1;
+    } else if(client.previous >= 1) {
+        client.previous -= 1; // the window moved on since it was counted
+    }
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerRateLimiter::getClientKey(const HTTPServerRequest& request) const {
+    switch(settings.keySource) {
+        case SESSION_COOKIE: {
+            NameValueCollection cookies;
+            request.getCookies(cookies);
+            string value = cookies.get(settings.keyName, "");
+            if(!value.empty()) {
+                return "c:" + value;
+            }
+            break;
+        }
+        case HEADER: {
+            string value = request.get(settings.keyName, "");
+            if(!value.empty()) {
+                return "h:" + value;
+            }
+            break;
+        }
+        case CLIENT_ADDRESS:
+            break;
+    }
+    
+    return "a:" + request.clientAddress().host().toString();
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerRateLimiter::getNumClients() {
+    size_t numClients = 0;
+    for(size_t i = 0; i < shards.size(); ++i) {
+        ofScopedLock lock(shards[i].mutex);
+        numClients += shards[i].clients.size();
+    }
+    return numClients;
+}
+
+//------------------------------------------------------------------------------
+HTTPRequestHandler* ofxHTTPServerRateLimiter::createRejectionHandler(const Timespan& retryAfter) {
+    return new ofxHTTPServerTooManyRequestsHandler(retryAfter);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerRateLimiter::Ptr ofxHTTPServerRateLimiter::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerRateLimiter(settings));
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerRateLimiter::acquireToken(Client& client, const Timestamp& now, Timespan& retryAfter) {
+    double window  = static_cast<double>(settings.window.totalMicroseconds());
+    double elapsed = static_cast<double>(now - client.time);
+    
+    double tokens = std::min(settings.limit, client.value + elapsed * settings.limit / window);
+    
+    client.time = now;
+    
+    if(tokens >= 1) {
+        client.value = static_cast<float>(tokens - 1);
+        return true;
+    }
+    
+    client.value = static_cast<float>(tokens);
+    
+    double wait = settings.limit > 0 ? (1 - tokens) * window / settings.limit : window;
+    retryAfter = Timespan(static_cast<Timespan::TimeDiff>(std::ceil(wait)));
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerRateLimiter::acquireSlot(Client& client, const Timestamp& now, Timespan& retryAfter) {
+    Timespan::TimeDiff window  = settings.window.totalMicroseconds();
+    Timespan::TimeDiff elapsed = now - client.time;
+    
+    if(elapsed >= 2 * window) {
+        client.previous = 0;
+        client.value    = 0;
+        client.time     = now;
+        elapsed         = 0;
+    } else if(elapsed >= window) {
+        client.previous = client.value;
+        client.value    = 0;
+        client.time    += window;
+        elapsed        -= window;
+    }
+    
+    // the previous window counts for the part of it still covered
+    double covered  = 1.0 - static_cast<double>(elapsed) / window;
+    double estimate = client.previous * covered + client.value;
+    
+    if(estimate + 1 <= settings.limit) {
+        client.value += 1;
+        return true;
+    }
+    
+    double wait;
+    
+    if(client.value + 1 > settings.limit || client.previous <= 0) {
+        wait = static_cast<double>(window - elapsed); // not before the next window
+    } else {
+        // until enough of the previous window has slid out
+        double neededCovered = (settings.limit - client.value - 1) / client.previous;
+        wait = (covered - neededCovered) * window;
+    }
+    
+    retryAfter = Timespan(static_cast<Timespan::TimeDiff>(std::ceil(std::max(wait, 1.0))));
+    return false;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerRateLimiter::Shard& ofxHTTPServerRateLimiter::getShard(const string& clientKey) {
+    return shards.get(clientKey);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerRateLimiterChain::ofxHTTPServerRateLimiterChain() { }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerRateLimiterChain::~ofxHTTPServerRateLimiterChain() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerRateLimiterChain::add(ofxHTTPServerRateLimiter::Ptr limiter) {
+    RWLock::ScopedWriteLock writeLock(lock);
+    limiters.push_back(limiter);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerRateLimiterChain::remove(ofxHTTPServerRateLimiter::Ptr limiter) {
+    RWLock::ScopedWriteLock writeLock(lock);
+    vector<ofxHTTPServerRateLimiter::Ptr>::iterator iter = limiters.begin();
+    while(iter != limiters.end()) {
+        if(*iter == limiter) {
+            iter = limiters.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerRateLimiterChain::clear() {
+    RWLock::ScopedWriteLock writeLock(lock);
+    limiters.clear();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerRateLimiterChain::acquire(const HTTPServerRequest& request, Timespan& retryAfter) {
+    RWLock::ScopedReadLock readLock(lock);
+    
+    vector<string> clientKeys;
+    clientKeys.reserve(limiters.size());
+    
+    for(size_t i = 0; i < limiters.size(); ++i) {
+        string clientKey = limiters[i]->getClientKey(request);
+        
+        if(!limiters[i]->acquire(clientKey, retryAfter)) {
+            for(size_t j = 0; j < clientKeys.size(); ++j) {
+                limiters[j]->release(clientKeys[j]);
+            }
+            return false;
+        }
+        
+        clientKeys.push_back(clientKey);
+    }
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerTooManyRequestsHandler::ofxHTTPServerTooManyRequestsHandler(const Timespan& _retryAfter) :
+retryAfter(_retryAfter)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerTooManyRequestsHandler::~ofxHTTPServerTooManyRequestsHandler() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerTooManyRequestsHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) {
+    // whole seconds, rounded up
+    Timespan::TimeDiff seconds = (retryAfter.totalMicroseconds() + Timespan::SECONDS - 1) / Timespan::SECONDS;
+    
+    ofxHTTPServerRouteHandler::rejectWithoutBody(request, response, static_cast<HTTPResponse::HTTPStatus>(429), "Too Many Requests");
+    response.set("Retry-After", Poco::NumberFormatter::format(std::max<Timespan::TimeDiff>(1, seconds)));
+    response.setContentLength(0);
+    response.send();
+}
@@ -0,0 +1,186 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "Poco/HashMap.h"
+#include "Poco/RWLock.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPServerRouteHandler.h"
+#include "ofxHTTPShards.h"
+
+using std::list;
+using std::string;
+using std::vector;
+
+using Poco::HashMap;
+using Poco::RWLock;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+
+// Limits how many requests each client may make.
+//
+// Clients are told apart by address, session cookie or a header such as
+// an API key.  TOKEN_BUCKET allows bursts of up to limit requests and
+// refills at limit per window; SLIDING_WINDOW estimates the requests of
+// the last window from the counts of the current and the previous fixed
+// window, which needs two counters per client instead of a log.
+//
+// Client state lives in a table split into independently locked shards.
+// The table is bounded by maxClients; when it is full the least recently
+// seen client is forgotten, which at worst gives it a fresh allowance.
+//
+// A limiter is checked either by an ofxHTTPServerRateLimitedRoute around a
+// single route or, for all routes, by ofxHTTPServer::addRateLimiter().
+class ofxHTTPServerRateLimiter {
+public:
+    typedef ofPtr<ofxHTTPServerRateLimiter> Ptr;
+    
+    enum Algorithm {
+        TOKEN_BUCKET,
+        SLIDING_WINDOW
+    };
+    
+    enum KeySource {
+        CLIENT_ADDRESS,
+        SESSION_COOKIE, // the cookie named keyName
+        HEADER          // the header named keyName
+    };
+    
+    struct Settings;
+    
+    ofxHTTPServerRateLimiter(const Settings& _settings = Settings());
+    virtual ~ofxHTTPServerRateLimiter();
+    
+    // counts the request against its client.  If the client is over its
+    // limit, returns false and how long it should wait.
+    bool acquire(const HTTPServerRequest& request, Timespan& retryAfter);
+    bool acquire(const string& clientKey, Timespan& retryAfter);
+    
+    // gives back a request counted by acquire(), for when another check
+    // turned the request away after all
+    void release(const string& clientKey);
+    
+    // falls back to the client's address if the cookie or header is missing
+    string getClientKey(const HTTPServerRequest& request) const;
+    
+    size_t getNumClients();
+    
+    // a handler answering 429 Too Many Requests
+    static HTTPRequestHandler* createRejectionHandler(const Timespan& retryAfter);
+    
+    struct Settings {
+        Algorithm algorithm;
+        KeySource keySource;
+        string keyName;
+        
+        double limit;          // requests per window
+        Timespan window;
+        
+        size_t maxClients;
+        size_t numShards;      // rounded up to a power of two
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+protected:
+    // floats are plenty for approximate counts and keep clients small
+    struct Client {
+        Client() : value(0), previous(0) { }
+        
+        Timestamp time;  // last refill, or the start of the current window
+        float value;     // tokens left, or requests in the current window
+        float previous;  // requests in the previous window
+        list<string>::iterator lruPosition;
+    };
+    
+    struct Shard {
+        ofMutex mutex;
+        HashMap<string, Client> clients;
+        list<string> lru; // most recently seen first
+    };
+    
+    bool acquireToken(Client& client, const Timestamp& now, Timespan& retryAfter);
+    bool acquireSlot(Client& client, const Timestamp& now, Timespan& retryAfter);
+    
+    Shard& getShard(const string& clientKey);
+    
+    Settings settings;
+    size_t maxClientsPerShard;
+    
+    ofxHTTPShards<Shard> shards;
+    
+};
+
+// The limiters checked for every request, in the order added.  A request
+// is only counted if every limiter lets it through; when one turns it
+// away, those before it are given their request back.  Limiters can be
+// added and removed while the server is running.
+class ofxHTTPServerRateLimiterChain {
+public:
+    ofxHTTPServerRateLimiterChain();
+    virtual ~ofxHTTPServerRateLimiterChain();
+    
+    void add(ofxHTTPServerRateLimiter::Ptr limiter);
+    void remove(ofxHTTPServerRateLimiter::Ptr limiter);
+    void clear();
+    
+    // returns false and how long the client should wait if any limiter
+    // turns the request away
+    bool acquire(const HTTPServerRequest& request, Timespan& retryAfter);
+    
+protected:
+    vector<ofxHTTPServerRateLimiter::Ptr> limiters;
+    
+    mutable RWLock lock;
+    
+};
+
+// Answers 429 Too Many Requests with a Retry-After header, without
+// reading the request body.
+class ofxHTTPServerTooManyRequestsHandler : public ofxHTTPServerRouteHandler {
+public:
+    ofxHTTPServerTooManyRequestsHandler(const Timespan& _retryAfter);
+    virtual ~ofxHTTPServerTooManyRequestsHandler();
+    
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+protected:
+    Timespan retryAfter;
+    
+};
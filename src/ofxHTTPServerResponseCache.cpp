@@ -0,0 +1,446 @@
+#include "ofxHTTPServerResponseCache.h"
+
+#include <algorithm>
+
+#include "Poco/NumberFormatter.h"
+#include "Poco/NumberParser.h"
+#include "Poco/String.h"
+#include "Poco/StringTokenizer.h"
+#include "Poco/Net/HTTPRequest.h"
+
+#include "ofxHTTPUtils.h"
+
+using Poco::StringTokenizer;
+using Poco::Net::HTTPRequest;
+using Poco::Net::NameValueCollection;
+
+namespace {
+
+    // headers that describe a connection or a transfer rather than the response
+    const char* UNSTORED_HEADERS[] = {
+        "Connection",
+        "Content-Length",
+        "Date",
+        "Keep-Alive",
+        "Server",
+        "Trailer",
+        "Transfer-Encoding",
+        "Upgrade"
+    };
+    
+    //--------------------------------------------------------------------------
+    bool isStored(const string& name) {
+        for(size_t i = 0; i < sizeof(UNSTORED_HEADERS) / sizeof(UNSTORED_HEADERS[0]); ++i) {
+            if(Poco::icompare(name, UNSTORED_HEADERS[i]) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    //--------------------------------------------------------------------------
+    bool isCacheableStatus(int status) {
+        switch(status) {
+            case 200: case 203: case 204: case 300: case 301: case 404: case 410:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    const size_t MAX_PASS_MARKERS = 10000;
+
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerResponseCache::Settings::Settings() {
+    ttl                  = Timespan(1, 0);  // 1 second
+    staleWhileRevalidate = Timespan(5, 0);  // 5 seconds
+    collapseTimeout      = Timespan(10, 0); // 10 seconds
+    maxBytes             = 64 * 1024 * 1024; // 64 MB
+    maxEntrySize         = 1024 * 1024;      // 1 MB
+    bCacheAuthorized     = false;
+    bCacheCookies        = false;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerResponseCache::ofxHTTPServerResponseCache(const Settings& _settings) :
+settings(_settings),
+numBytes(0)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerResponseCache::~ofxHTTPServerResponseCache() { }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerResponseCache::Result ofxHTTPServerResponseCache::lookup(const HTTPServerRequest& request,
+                                                                      bool bSecure,
+                                                                      ResponsePtr& response,
+                                                                      bool& bRevalidate,
+                                                                      string& key) {
+    bRevalidate = false;
+    
+    bool bGet = request.getMethod() == HTTPRequest::HTTP_GET;
+    
+    if(!bGet && request.getMethod() != HTTPRequest::HTTP_HEAD) {
+        return PASS;
+    }
+    
+    if(!settings.bCacheAuthorized && request.has("Authorization")) {
+        return PASS;
+    }
+    
+    // e.g. a session, whose pages are that client's alone
+    if(!settings.bCacheCookies && request.has("Cookie")) {
+        return PASS;
+    }
+    
+    string primaryKey = getPrimaryKey(request, bSecure);
+    
+    ofScopedLock lock(mutex);
+    
+    Timestamp now;
+    
+    while(true) {
+        key = getKey(primaryKey, request);
+        
+        HashMap<string, Entry>::Iterator iter = entries.find(key);
+        
+        if(iter != entries.end()) {
+            Entry& entry = (*iter).second;
+            
+            if(now < entry.freshUntil) {
+                lru.splice(lru.begin(), lru, entry.lruPosition);
+                response = entry.response;
+                return HIT;
+            }
+            
+            if(now < entry.staleUntil) {
+                lru.splice(lru.begin(), lru, entry.lruPosition);
+                response = entry.response;
+                if(bGet && !entry.bRevalidating) {
+                    entry.bRevalidating = true;
+                    bRevalidate = true;
+                }
+                return STALE;
+            }
+            
+            erase(key);
+        }
+        
+        // responses are only computed for GET, HEAD is served if one exists
+        if(!bGet) {
+            return PASS;
+        }
+        
+        map<string, Variants>::iterator variantsIter = variants.find(primaryKey);
+        
+        if(variantsIter != variants.end() && now < (*variantsIter).second.passUntil) {
+            return PASS;
+        }
+        
+        if(flights.find(key) == flights.end()) {
+            flights.insert(key);
+            return MISS;
+        }
+        
+        // another request is computing it, wait for that
+        Timestamp deadline = now + settings.collapseTimeout;
+        
+        while(flights.find(key) != flights.end()) {
+            Timestamp::TimeDiff remaining = deadline - Timestamp();
+            if(remaining <= 0) {
+                return PASS;
+            }
+            flightFinished.tryWait(mutex, static_cast<long>(remaining / 1000) + 1);
+        }
+        
+        now.update();
+        
+        // once more, but a response that didn't get stored is not waited for twice
+        iter = entries.find(getKey(primaryKey, request));
+        
+        if(iter == entries.end()) {
+            return PASS;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResponseCache::finish(const string& key,
+                                        const HTTPServerRequest& request,
+                                        bool bSecure,
+                                        const ofxHTTPServerBufferedResponse* response) {
+    string primaryKey = getPrimaryKey(request, bSecure);
+    
+    Timespan lifetime;
+    bool bCacheable = response != NULL && getLifetime(*response, lifetime);
+    
+    vector<string> varyNames;
+    
+    if(bCacheable && response->has("Vary")) {
+        StringTokenizer tokens(response->get("Vary"), ",", StringTokenizer::TOK_TRIM | StringTokenizer::TOK_IGNORE_EMPTY);
+        StringTokenizer::Iterator token = tokens.begin();
+        while(token != tokens.end()) {
+            if(*token == "*") {
+                bCacheable = false; // varies by things we can't see
+            }
+            varyNames.push_back(Poco::toLower(*token));
+            ++token;
+        }
+        std::sort(varyNames.begin(), varyNames.end());
+    }
+    
+    ofPtr<Response> stored;
+    size_t size = 0;
+    
+    if(bCacheable) {
+        // copied before taking the lock
+        stored = ofPtr<Response>(new Response());
+        stored->status = response->getStatus();
+        stored->reason = response->getReason();
+        stored->body   = response->getBody();
+        
+        size = key.size() + stored->body.size();
+        
+        NameValueCollection::ConstIterator iter = response->begin();
+        while(iter != response->end()) {
+            if(isStored((*iter).first)) {
+                stored->headers.push_back(*iter);
+                size += (*iter).first.size() + (*iter).second.size();
+            }
+            ++iter;
+        }
+        
+        bCacheable = size <= settings.maxEntrySize;
+    }
+    
+    ofScopedLock lock(mutex);
+    
+    Timestamp now;
+    
+    flights.erase(key);
+    
+    HashMap<string, Entry>::Iterator iter = entries.find(key);
+    if(iter != entries.end()) {
+        (*iter).second.bRevalidating = false;
+    }
+    
+    if(!bCacheable) {
+        if(response != NULL) {
+            // don't make the next requests wait for something that won't be stored
+            if(variants.size() >= MAX_PASS_MARKERS) {
+                map<string, Variants>::iterator variantsIter = variants.begin();
+                while(variantsIter != variants.end()) {
+                    if((*variantsIter).second.keys.empty() && (*variantsIter).second.passUntil <= now) {
+                        variants.erase(variantsIter++);
+                    } else {
+                        ++variantsIter;
+                    }
+                }
+            }
+            if(variants.size() < MAX_PASS_MARKERS || variants.find(primaryKey) != variants.end()) {
+                variants[primaryKey].passUntil = now + settings.ttl;
+            }
+        }
+        flightFinished.broadcast();
+        return;
+    }
+    
+    stored->stored = now;
+    
+    map<string, Variants>::iterator variantsIter = variants.find(primaryKey);
+    
+    if(variantsIter != variants.end() && (*variantsIter).second.varyNames != varyNames) {
+        // the variants were stored under other headers
+        vector<string> keys = (*variantsIter).second.keys;
+        for(size_t i = 0; i < keys.size(); ++i) {
+            erase(keys[i]);
+        }
+    }
+    
+    // erase() drops the variants once the last one is gone
+    Variants& current = variants[primaryKey];
+    current.varyNames = varyNames;
+    current.passUntil = Timestamp(0);
+    
+    string storedKey = getKey(primaryKey, request);
+    
+    if(entries.find(storedKey) != entries.end()) {
+        erase(storedKey);
+        variants[primaryKey].varyNames = varyNames;
+    }
+    
+    Variants& primary = variants[primaryKey];
+    
+    Entry& entry = entries[storedKey];
+    entry.response    = stored;
+    entry.primaryKey  = primaryKey;
+    entry.size        = size;
+    entry.freshUntil  = now + lifetime;
+    entry.staleUntil  = entry.freshUntil + settings.staleWhileRevalidate;
+    entry.lruPosition = lru.insert(lru.begin(), storedKey);
+    
+    primary.keys.push_back(storedKey);
+    numBytes += size;
+    
+    evict();
+    
+    flightFinished.broadcast();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResponseCache::invalidate(const HTTPServerRequest& request, bool bSecure) {
+    string primaryKey = getPrimaryKey(request, bSecure);
+    
+    ofScopedLock lock(mutex);
+    
+    map<string, Variants>::iterator iter = variants.find(primaryKey);
+    
+    if(iter != variants.end()) {
+        vector<string> keys = (*iter).second.keys;
+        for(size_t i = 0; i < keys.size(); ++i) {
+            erase(keys[i]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResponseCache::clear() {
+    ofScopedLock lock(mutex);
+    entries.clear();
+    variants.clear();
+    lru.clear();
+    numBytes = 0;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerResponseCache::getNumBytes() const {
+    ofScopedLock lock(mutex);
+    return numBytes;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerResponseCache::getNumEntries() const {
+    ofScopedLock lock(mutex);
+    return entries.size();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResponseCache::send(const ResponsePtr& response, HTTPServerResponse& serverResponse) {
+    serverResponse.setStatusAndReason(response->status, response->reason);
+    
+    vector<pair<string, string> >::const_iterator iter = response->headers.begin();
+    while(iter != response->headers.end()) {
+        serverResponse.add((*iter).first, (*iter).second);
+        ++iter;
+    }
+    
+    serverResponse.set("Age", Poco::NumberFormatter::format(response->stored.elapsed() / Timestamp::resolution()));
+    serverResponse.sendBuffer(response->body.data(), response->body.size());
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerResponseCache::Ptr ofxHTTPServerResponseCache::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerResponseCache(settings));
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerResponseCache::getPrimaryKey(const HTTPServerRequest& request, bool bSecure) {
+    // routes reached through several host names may share a cache
+    string scheme = bSecure ? "https://" : "http://";
+    return scheme + Poco::toLower(request.get("Host", "")) + request.getURI(); // path and query
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerResponseCache::getKey(const string& primaryKey, const HTTPServerRequest& request) const {
+    map<string, Variants>::const_iterator iter = variants.find(primaryKey);
+    
+    if(iter == variants.end()) {
+        return primaryKey;
+    }
+    
+    string key = primaryKey;
+    
+    const vector<string>& varyNames = (*iter).second.varyNames;
+    for(size_t i = 0; i < varyNames.size(); ++i) {
+        key += "\n" + varyNames[i] + ":" + request.get(varyNames[i], "");
+    }
+    
+    return key;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResponseCache::erase(const string& key) {
+    HashMap<string, Entry>::Iterator iter = entries.find(key);
+    
+    if(iter == entries.end()) {
+        return;
+    }
+    
+    map<string, Variants>::iterator variantsIter = variants.find((*iter).second.primaryKey);
+    
+    if(variantsIter != variants.end()) {
+        vector<string>& keys = (*variantsIter).second.keys;
+        keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+        if(keys.empty() && (*variantsIter).second.passUntil <= Timestamp()) {
+            variants.erase(variantsIter);
+        }
+    }
+    
+    numBytes -= (*iter).second.size;
+    lru.erase((*iter).second.lruPosition);
+    entries.erase(iter);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResponseCache::evict() {
+    while(numBytes > settings.maxBytes && !lru.empty()) {
+        erase(lru.back());
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerResponseCache::getLifetime(const ofxHTTPServerBufferedResponse& response, Timespan& lifetime) const {
+    if(!isCacheableStatus(response.getStatus()) || response.has("Set-Cookie")) {
+        return false;
+    }
+    
+    lifetime = settings.ttl;
+    
+    if(!response.has("Cache-Control")) {
+        return true;
+    }
+    
+    bool bSharedMaxAge = false;
+    
+    StringTokenizer tokens(response.get("Cache-Control"), ",", StringTokenizer::TOK_TRIM | StringTokenizer::TOK_IGNORE_EMPTY);
+    StringTokenizer::Iterator token = tokens.begin();
+    
+    while(token != tokens.end()) {
+        string directive = Poco::toLower(*token);
+        string value;
+        
+        size_t equals = directive.find('=');
+        if(equals != string::npos) {
+            value = directive.substr(equals + 1);
+            directive = Poco::trim(directive.substr(0, equals));
+            value = Poco::trim(value);
+        }
+        
+        int seconds = 0;
+        
+        if(directive == "no-store" || directive == "private" || directive == "no-cache") {
+            return false;
+        } else if(directive == "s-maxage" && Poco::NumberParser::tryParse(value, seconds)) {
+            lifetime = Timespan(seconds, 0);
+            bSharedMaxAge = true;
+        } else if(directive == "max-age" && !bSharedMaxAge && Poco::NumberParser::tryParse(value, seconds)) {
+            lifetime = Timespan(seconds, 0);
+        }
+        
+        ++token;
+    }
+    
+    return lifetime.totalMicroseconds() > 0;
+}
@@ -0,0 +1,186 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Poco/Condition.h"
+#include "Poco/HashMap.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPServerBufferedResponse.h"
+
+using std::list;
+using std::map;
+using std::pair;
+using std::set;
+using std::string;
+using std::vector;
+
+using Poco::HashMap;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+
+// Complete responses kept in memory for a short while.
+//
+// Responses are keyed by scheme, host, path and query, plus the request
+// headers named in their Vary header.  HEAD requests are served from the
+// GET response for the same key rather than stored apart.  A response is fresh for its max-age, or ttl if
+// it has none, and may then be served stale for staleWhileRevalidate
+// while one request computes its replacement.  Responses that say
+// no-store or private, set cookies or are larger than maxEntrySize are
+// not kept, and the total size is bounded by maxBytes, least recently
+// used first.
+//
+// Requests with credentials or cookies are passed through unless
+// bCacheAuthorized or bCacheCookies say otherwise, since what they get
+// back may be meant for that client alone.
+//
+// Misses for the same key are collapsed: the first request computes the
+// response while the others wait for it instead of all running the
+// handler at once.
+class ofxHTTPServerResponseCache {
+public:
+    typedef ofPtr<ofxHTTPServerResponseCache> Ptr;
+    
+    struct Settings;
+    
+    struct Response {
+        HTTPResponse::HTTPStatus status;
+        string reason;
+        vector<pair<string, string> > headers;
+        string body;
+        Timestamp stored;
+    };
+    
+    typedef ofPtr<const Response> ResponsePtr;
+    
+    enum Result {
+        HIT,          // serve the response
+        STALE,        // serve the response; if bRevalidate, compute and finish() a new one
+        MISS,         // compute the response and finish() it
+        PASS          // compute the response, it won't be stored
+    };
+    
+    ofxHTTPServerResponseCache(const Settings& _settings = Settings());
+    virtual ~ofxHTTPServerResponseCache();
+    
+    // only GET and HEAD requests are looked up.  bSecure tells whether the
+    // request came in on a secure port.  A MISS must be followed by
+    // finish() with the key it returned, as must a STALE that asked to
+    // revalidate.
+    Result lookup(const HTTPServerRequest& request,
+                  bool bSecure,
+                  ResponsePtr& response,
+                  bool& bRevalidate,
+                  string& key);
+    
+    // stores the computed response if it can be cached and wakes the
+    // requests waiting for it.  response is NULL if computing it failed.
+    void finish(const string& key,
+                const HTTPServerRequest& request,
+                bool bSecure,
+                const ofxHTTPServerBufferedResponse* response);
+    
+    // drops every stored variant of the request's host, path and query,
+    // e.g. after a POST to it
+    void invalidate(const HTTPServerRequest& request, bool bSecure);
+    void clear();
+    
+    size_t getNumBytes() const;
+    size_t getNumEntries() const;
+    
+    // writes a stored response to a client
+    static void send(const ResponsePtr& response, HTTPServerResponse& serverResponse);
+    
+    struct Settings {
+        Timespan ttl;                   // for responses without max-age
+        Timespan staleWhileRevalidate;
+        Timespan collapseTimeout;       // longest a miss waits for another
+        size_t maxBytes;
+        size_t maxEntrySize;
+        bool bCacheAuthorized;          // also cache requests with credentials
+        bool bCacheCookies;             // also cache requests with cookies
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+protected:
+    struct Entry {
+        Entry() : size(0), bRevalidating(false) { }
+        
+        ResponsePtr response;
+        string primaryKey;
+        size_t size;
+        Timestamp freshUntil;
+        Timestamp staleUntil;
+        bool bRevalidating;
+        list<string>::iterator lruPosition;
+    };
+    
+    struct Variants {
+        vector<string> varyNames;          // as learned from the last response
+        vector<string> keys;               // the stored variants
+        Timestamp passUntil;               // recently found uncacheable
+    };
+    
+    static string getPrimaryKey(const HTTPServerRequest& request, bool bSecure);
+    string getKey(const string& primaryKey, const HTTPServerRequest& request) const;
+    
+    // expected to hold the mutex
+    void erase(const string& key);
+    void evict();
+    
+    // how long a response may be stored, or false if it mustn't be
+    bool getLifetime(const ofxHTTPServerBufferedResponse& response, Timespan& lifetime) const;
+    
+    Settings settings;
+    
+    mutable ofMutex mutex;
+    Poco::Condition flightFinished;
+    
+    HashMap<string, Entry> entries;
+    map<string, Variants> variants;     // by primary key
+    set<string> flights;                // keys being computed
+    list<string> lru;                   // most recently used first
+    size_t numBytes;
+    
+};
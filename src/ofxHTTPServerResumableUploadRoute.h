@@ -0,0 +1,123 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "Poco/URI.h"
+#include "Poco/Net/HTTPRequest.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPBufferPool.h"
+#include "ofxHTTPResumableUploadStore.h"
+#include "ofxHTTPServerResumableUploadRouteHandler.h"
+#include "ofxHTTPServerUploadEvents.h"
+
+using Poco::SyntaxException;
+using Poco::URI;
+using Poco::Net::HTTPRequest;
+
+//------------------------------------------------------------------------------
+class ofxHTTPServerResumableUploadRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofxHTTPServerResumableUploadRouteHandler::Settings Settings;
+    typedef ofPtr<ofxHTTPServerResumableUploadRoute> Ptr;
+
+    ofxHTTPServerResumableUploadRoute(const Settings& _settings = Settings()) :
+    settings(_settings),
+    store(ofxHTTPResumableUploadStore::Instance(_settings.storeSettings)),
+    writeBufferPool(ofxHTTPBufferPool::Instance(_settings.writeBufferSize, 4 * _settings.fileSinkSettings.numBuffers))
+    { }
+
+    virtual ~ofxHTTPServerResumableUploadRoute() { }
+
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        string method = request.get("X-HTTP-Method-Override", request.getMethod());
+
+        if(method != HTTPRequest::HTTP_OPTIONS &&
+           method != HTTPRequest::HTTP_POST &&
+           method != HTTPRequest::HTTP_HEAD &&
+           method != HTTPRequest::HTTP_DELETE &&
+           method != "PATCH") {
+            return false;
+        }
+
+        URI uri;
+        try {
+            uri = URI(request.getURI());
+        } catch(const SyntaxException& exc) {
+            ofLogError("ofxHTTPServerResumableUploadRoute::canHandleRequest") << exc.what();
+            return false;
+        }
+
+        string path = uri.getPath();
+
+        // the route itself, or an upload directly below it
+        return path == settings.route ||
+               (path.size() > settings.route.size() + 1 &&
+                path.compare(0, settings.route.size() + 1, settings.route + "/") == 0 &&
+                path.find('/', settings.route.size() + 1) == string::npos);
+    }
+
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        ofxHTTPServerBodyLimits limits;
+
+        if(request.get("X-HTTP-Method-Override", request.getMethod()) == "PATCH") {
+            limits.maxBodySize = settings.maxUploadSize;
+            limits.acceptedContentTypes.push_back(MediaType("application/offset+octet-stream"));
+        } else {
+            limits.bAllowBody = false; // creation-with-upload is not supported
+        }
+
+        return limits;
+    }
+
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        return new ofxHTTPServerResumableUploadRouteHandler(settings,
+                                                            *store,
+                                                            *writeBufferPool,
+                                                            events);
+    }
+
+    // deletes uploads that have expired, they are also purged as requests come in
+    size_t purgeExpired() {
+        return store->purgeExpired(true);
+    }
+
+    static Ptr Instance(const Settings& settings = Settings()) {
+        return Ptr(new ofxHTTPServerResumableUploadRoute(settings));
+    }
+
+    ofxHTTPServerUploadEvents events;
+
+protected:
+    Settings settings;
+
+    ofxHTTPResumableUploadStore::Ptr store;
+
+    // shared by all of the route's requests
+    ofxHTTPBufferPool::Ptr writeBufferPool;
+
+};
@@ -0,0 +1,469 @@
+#include "ofxHTTPServerResumableUploadRouteHandler.h"
+
+#include <sstream>
+
+#include "Poco/Base64Decoder.h"
+#include "Poco/DateTimeFormat.h"
+#include "Poco/DateTimeFormatter.h"
+#include "Poco/File.h"
+#include "Poco/NumberParser.h"
+#include "Poco/String.h"
+#include "Poco/StringTokenizer.h"
+#include "Poco/URI.h"
+#include "Poco/Net/HTTPMessage.h"
+#include "Poco/Net/HTTPRequest.h"
+
+using Poco::DateTimeFormat;
+using Poco::DateTimeFormatter;
+using Poco::StringTokenizer;
+using Poco::Net::HTTPMessage;
+using Poco::Net::HTTPRequest;
+
+namespace {
+
+    const string OFFSET_CONTENT_TYPE = "application/offset+octet-stream";
+
+}
+
+const string ofxHTTPServerResumableUploadRouteHandler::TUS_VERSION = "1.0.0";
+
+//------------------------------------------------------------------------------
+ofxHTTPServerResumableUploadRouteHandler::Settings::Settings() {
+    route = "/files";
+
+    uploadFolder = "uploads";
+
+    maxUploadSize = 4ULL * 1024 * 1024 * 1024; // 4 GB
+
+    writeBufferSize = 1024 * 1024; // 1 MB
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerResumableUploadRouteHandler::ofxHTTPServerResumableUploadRouteHandler(const Settings& _settings,
+                                                                                   ofxHTTPResumableUploadStore& _store,
+                                                                                   ofxHTTPBufferPool& _writeBufferPool,
+                                                                                   ofxHTTPServerUploadEvents& _events) :
+settings(_settings),
+store(_store),
+writeBufferPool(_writeBufferPool),
+events(_events)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerResumableUploadRouteHandler::~ofxHTTPServerResumableUploadRouteHandler() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResumableUploadRouteHandler::handleExchange(ofxHTTPServerExchange& exchange) {
+    exchange.response.set("Tus-Resumable", TUS_VERSION);
+
+    // for clients behind proxies that only pass GET and POST
+    string method = exchange.request.get("X-HTTP-Method-Override", exchange.request.getMethod());
+
+    if(method == HTTPRequest::HTTP_OPTIONS) {
+        handleOptions(exchange);
+        return;
+    }
+
+    if(exchange.request.get("Tus-Resumable", "") != TUS_VERSION) {
+        exchange.response.set("Tus-Version", TUS_VERSION);
+        sendStatus(exchange, HTTPResponse::HTTP_PRECONDITION_FAILED, "Unsupported tus version.");
+        return;
+    }
+
+    string path = Poco::URI(exchange.request.getURI()).getPath();
+    string id;
+
+    if(path.size() > settings.route.size() + 1) {
+        id = path.substr(settings.route.size() + 1);
+    }
+
+    if(method == HTTPRequest::HTTP_POST && id.empty()) {
+        handleCreate(exchange);
+    } else if(id.empty()) {
+        sendStatus(exchange, HTTPResponse::HTTP_NOT_FOUND);
+    } else if(method == HTTPRequest::HTTP_HEAD) {
+        handleHead(exchange, id);
+    } else if(method == "PATCH") {
+        handlePatch(exchange, id);
+    } else if(method == HTTPRequest::HTTP_DELETE) {
+        handleDelete(exchange, id);
+    } else {
+        sendStatus(exchange, HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResumableUploadRouteHandler::handleOptions(ofxHTTPServerExchange& exchange) {
+    exchange.response.set("Tus-Version", TUS_VERSION);
+    exchange.response.set("Tus-Extension", "creation,expiration,termination");
+
+    if(settings.maxUploadSize > 0) {
+        exchange.response.set("Tus-Max-Size", ofToString(settings.maxUploadSize));
+    }
+
+    sendStatus(exchange, HTTPResponse::HTTP_NO_CONTENT);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResumableUploadRouteHandler::handleCreate(ofxHTTPServerExchange& exchange) {
+    Poco::UInt64 length = 0;
+
+    // deferred lengths are not supported
+    if(!Poco::NumberParser::tryParseUnsigned64(exchange.request.get("Upload-Length", ""), length)) {
+        sendStatus(exchange, HTTPResponse::HTTP_BAD_REQUEST, "Missing or invalid Upload-Length.");
+        return;
+    }
+
+    if(settings.maxUploadSize > 0 && length > settings.maxUploadSize) {
+        sendStatus(exchange, HTTPResponse::HTTP_REQUESTENTITYTOOLARGE);
+        return;
+    }
+
+    ofxHTTPResumableUploadInfo info;
+
+    if(!store.create(length, exchange.request.get("Upload-Metadata", ""), info)) {
+        sendStatus(exchange, HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, "Unable to create upload.");
+        return;
+    }
+
+    ofxHTTPServerUploadEventArgs args = makeEventArgs(info);
+    ofNotifyEvent(events.onUploadStartedEvent, args, this);
+
+    // an empty upload is complete as soon as it exists
+    if(length == 0 && finish(info)) {
+        store.get(info.id, info);
+    }
+
+    // relative, so it stays correct behind a reverse proxy
+    exchange.response.set("Location", settings.route + "/" + info.id);
+    setUploadHeaders(exchange.response, info);
+    sendStatus(exchange, HTTPResponse::HTTP_CREATED);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResumableUploadRouteHandler::handleHead(ofxHTTPServerExchange& exchange, const string& id) {
+    ofxHTTPResumableUploadInfo info;
+
+    if(!store.get(id, info)) {
+        sendStatus(exchange, HTTPResponse::HTTP_NOT_FOUND);
+        return;
+    }
+
+    exchange.response.set("Upload-Length", ofToString(info.length));
+
+    if(!info.metadata.empty()) {
+        exchange.response.set("Upload-Metadata", info.metadata);
+    }
+
+    exchange.response.set("Cache-Control", "no-store");
+    setUploadHeaders(exchange.response, info);
+    sendStatus(exchange, HTTPResponse::HTTP_OK);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResumableUploadRouteHandler::handlePatch(ofxHTTPServerExchange& exchange, const string& id) {
+    if(Poco::icompare(exchange.request.getContentType(), OFFSET_CONTENT_TYPE) != 0) {
+        sendStatus(exchange, HTTPResponse::HTTP_UNSUPPORTED_MEDIATYPE);
+        return;
+    }
+
+    Poco::UInt64 uploadOffset = 0;
+
+    if(!Poco::NumberParser::tryParseUnsigned64(exchange.request.get("Upload-Offset", ""), uploadOffset)) {
+        sendStatus(exchange, HTTPResponse::HTTP_BAD_REQUEST, "Missing or invalid Upload-Offset.");
+        return;
+    }
+
+    ofxHTTPResumableUploadInfo info;
+
+    if(!store.get(id, info)) {
+        sendStatus(exchange, HTTPResponse::HTTP_NOT_FOUND);
+        return;
+    }
+
+    if(!store.lock(id, info)) {
+        sendStatus(exchange, HTTPResponse::HTTPStatus(423), "Locked");
+        return;
+    }
+
+    if(uploadOffset != info.offset) {
+        store.unlock(id);
+        setUploadHeaders(exchange.response, info);
+        sendStatus(exchange, HTTPResponse::HTTP_CONFLICT, "Upload-Offset does not match.");
+        return;
+    }
+
+    unsigned long long remaining = info.length - info.offset;
+    long long contentLength = exchange.request.getContentLength();
+
+    if(info.bComplete && contentLength == 0) {
+        store.unlock(id);
+        setUploadHeaders(exchange.response, info);
+        sendStatus(exchange, HTTPResponse::HTTP_NO_CONTENT);
+        return;
+    }
+
+    if(info.bComplete ||
+       (contentLength != HTTPMessage::UNKNOWN_CONTENT_LENGTH &&
+        static_cast<unsigned long long>(contentLength) > remaining)) {
+        store.unlock(id);
+        sendStatus(exchange, HTTPResponse::HTTP_REQUESTENTITYTOOLARGE, "Chunk exceeds Upload-Length.");
+        return;
+    }
+
+    bool bTooLarge    = false;
+    bool bWriteFailed = false;
+
+    unsigned long long numBytesAppended = appendBody(exchange,
+                                                     store.getDataPath(id),
+                                                     info.offset,
+                                                     remaining,
+                                                     bTooLarge,
+                                                     bWriteFailed);
+
+    // whatever arrived before the connection dropped is kept, unless it
+    // couldn't be written or went past the end of the upload.
+    if(!bTooLarge && !bWriteFailed) {
+        info.offset += numBytesAppended;
+        store.commit(id, info.offset);
+    }
+
+    bool bFinished = !bTooLarge && !bWriteFailed && info.offset == info.length && finish(info);
+
+    store.unlock(id);
+    store.get(id, info);
+
+    if(bTooLarge) {
+        sendStatus(exchange, HTTPResponse::HTTP_REQUESTENTITYTOOLARGE, "Chunk exceeds Upload-Length.");
+        return;
+    }
+
+    if(bWriteFailed || (info.offset == info.length && !bFinished)) {
+        sendStatus(exchange, HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, "Unable to store upload.");
+        return;
+    }
+
+    if(!bFinished) {
+        ofxHTTPServerUploadEventArgs args = makeEventArgs(info);
+        ofNotifyEvent(events.onUploadProgressEvent, args, this);
+    }
+
+    setUploadHeaders(exchange.response, info);
+    sendStatus(exchange, HTTPResponse::HTTP_NO_CONTENT);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResumableUploadRouteHandler::handleDelete(ofxHTTPServerExchange& exchange, const string& id) {
+    ofxHTTPResumableUploadInfo info;
+
+    if(!store.get(id, info)) {
+        sendStatus(exchange, HTTPResponse::HTTP_NOT_FOUND);
+        return;
+    }
+
+    if(!store.remove(id)) {
+        sendStatus(exchange, HTTPResponse::HTTPStatus(423), "Locked");
+        return;
+    }
+
+    if(!info.bComplete) {
+        ofxHTTPServerUploadEventArgs args = makeEventArgs(info, "Upload terminated.");
+        ofNotifyEvent(events.onUploadFailedEvent, args, this);
+    }
+
+    sendStatus(exchange, HTTPResponse::HTTP_NO_CONTENT);
+}
+
+//------------------------------------------------------------------------------
+unsigned long long ofxHTTPServerResumableUploadRouteHandler::appendBody(ofxHTTPServerExchange& exchange,
+                                                                        const string& dataPath,
+                                                                        unsigned long long offset,
+                                                                        unsigned long long maxLength,
+                                                                        bool& bTooLarge,
+                                                                        bool& bWriteFailed) {
+    bTooLarge    = false;
+    bWriteFailed = false;
+
+    try {
+        // drop anything past the committed offset that a failed request left
+        Poco::File(dataPath).setSize(offset);
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServerResumableUploadRouteHandler::appendBody") << exc.displayText();
+        bWriteFailed = true;
+        return 0;
+    }
+
+    ofxHTTPFileSink::Ptr sink = ofxHTTPFileSink::Instance(writeBufferPool, settings.fileSinkSettings);
+
+    if(!sink->open(dataPath, true)) {
+        ofLogError("ofxHTTPServerResumableUploadRouteHandler::appendBody") << sink->getError();
+        bWriteFailed = true;
+        return 0;
+    }
+
+    istream& stream = exchange.request.stream();
+
+    size_t bufferSize = sink->getBufferSize();
+    unsigned long long numBytesAppended = 0;
+
+    char*  buffer = NULL;
+    size_t fill   = 0;
+
+    try {
+        while(stream.good() && !bWriteFailed) {
+            buffer = sink->getBuffer();
+            fill   = 0;
+
+            while(fill < bufferSize && stream.good()) {
+                stream.read(buffer + fill, static_cast<streamsize>(bufferSize - fill));
+                fill += static_cast<size_t>(stream.gcount());
+            }
+
+            if(numBytesAppended + fill > maxLength) {
+                bTooLarge = true;
+                break;
+            }
+
+            numBytesAppended += fill;
+            bWriteFailed = !sink->write(buffer, fill);
+            buffer = NULL;
+        }
+    } catch(const Exception& exc) {
+        // the client went away, keep what it managed to send
+        ofLogVerbose("ofxHTTPServerResumableUploadRouteHandler::appendBody") << exc.displayText();
+    }
+
+    if(buffer != NULL) {
+        if(!bTooLarge) {
+            numBytesAppended += fill;
+            bWriteFailed = !sink->write(buffer, fill);
+        } else {
+            sink->returnBuffer(buffer);
+        }
+    }
+
+    if(!sink->close()) {
+        ofLogError("ofxHTTPServerResumableUploadRouteHandler::appendBody") << sink->getError();
+        bWriteFailed = true;
+    }
+
+    return numBytesAppended;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerResumableUploadRouteHandler::finish(const ofxHTTPResumableUploadInfo& info) {
+    Path uploadFolder(ofToDataPath(settings.uploadFolder, true));
+    uploadFolder.makeDirectory();
+
+    // clients may send a full path, keep the file name only
+    string fileName = getMetadata(info.metadata, "filename");
+    size_t separator = fileName.find_last_of("/\\");
+    if(separator != string::npos) {
+        fileName = fileName.substr(separator + 1);
+    }
+
+    if(fileName.empty() || fileName == "." || fileName == "..") {
+        fileName = info.id;
+    }
+
+    string path;
+
+    try {
+        path = ofCreateUniqueFile(uploadFolder.toString(), fileName);
+        Poco::File(store.getDataPath(info.id)).renameTo(path);
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServerResumableUploadRouteHandler::finish") << exc.displayText();
+        if(!path.empty()) {
+            try {
+                Poco::File(path).remove(); // the claimed name goes unused
+            } catch(const Exception&) {
+                // nothing else to do
+            }
+        }
+        ofxHTTPServerUploadEventArgs args = makeEventArgs(info, exc.displayText());
+        ofNotifyEvent(events.onUploadFailedEvent, args, this);
+        return false;
+    }
+
+    store.complete(info.id, path);
+
+    ofxHTTPServerUploadEventArgs args = makeEventArgs(info);
+    args.fileName = path;
+    ofNotifyEvent(events.onUploadFinishedEvent, args, this);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResumableUploadRouteHandler::sendStatus(ofxHTTPServerExchange& exchange,
+                                                          HTTPResponse::HTTPStatus status,
+                                                          const string& reason) {
+    if(reason.empty()) {
+        exchange.response.setStatusAndReason(status);
+    } else {
+        exchange.response.setStatusAndReason(status, reason);
+    }
+
+    if(status >= HTTPResponse::HTTP_BAD_REQUEST) {
+        // the body of a rejected chunk may still be on its way
+        exchange.response.setKeepAlive(false);
+    }
+
+    exchange.response.setContentLength(0);
+    exchange.response.send();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerResumableUploadRouteHandler::setUploadHeaders(HTTPServerResponse& response, const ofxHTTPResumableUploadInfo& info) {
+    response.set("Upload-Offset", ofToString(info.offset));
+    response.set("Upload-Expires", DateTimeFormatter::format(info.expires, DateTimeFormat::HTTP_FORMAT));
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerUploadEventArgs ofxHTTPServerResumableUploadRouteHandler::makeEventArgs(const ofxHTTPResumableUploadInfo& info,
+                                                                                     const string& error) const {
+    return ofxHTTPServerUploadEventArgs("",
+                                        getMetadata(info.metadata, "filename"),
+                                        info.fileName,
+                                        getMetadata(info.metadata, "filetype"),
+                                        info.offset,
+                                        static_cast<long long>(info.length),
+                                        error);
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerResumableUploadRouteHandler::getMetadata(const string& metadata, const string& key) {
+    StringTokenizer pairs(metadata, ",", StringTokenizer::TOK_TRIM | StringTokenizer::TOK_IGNORE_EMPTY);
+
+    StringTokenizer::Iterator iter = pairs.begin();
+
+    while(iter != pairs.end()) {
+        size_t space = (*iter).find(' ');
+
+        if((*iter).substr(0, space) == key) {
+            if(space == string::npos) {
+                return ""; // a key without a value
+            }
+
+            std::istringstream istr((*iter).substr(space + 1));
+            Poco::Base64Decoder decoder(istr);
+
+            string value;
+            char c;
+
+            try {
+                while(decoder.get(c)) {
+                    value += c;
+                }
+            } catch(const Exception& exc) {
+                return "";
+            }
+
+            return value;
+        }
+
+        ++iter;
+    }
+
+    return "";
+}
@@ -0,0 +1,130 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "Poco/Exception.h"
+#include "Poco/Path.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPServerResponse.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPBufferPool.h"
+#include "ofxHTTPFileSink.h"
+#include "ofxHTTPResumableUploadStore.h"
+#include "ofxHTTPServerRouteHandler.h"
+#include "ofxHTTPServerUploadEvents.h"
+
+using std::string;
+
+using Poco::Exception;
+using Poco::Path;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPServerResponse;
+
+// Resumable uploads using the tus 1.0.0 protocol (core, creation,
+// expiration and termination).  A client creates an upload with POST,
+// asks how much has arrived with HEAD and appends the rest with PATCH, so
+// a dropped connection only costs the chunk that was in flight.
+//
+//     POST   /files        Upload-Length, Upload-Metadata -> 201 Location
+//     HEAD   /files/<id>   -> Upload-Offset, Upload-Length
+//     PATCH  /files/<id>   Upload-Offset, application/offset+octet-stream
+//     DELETE /files/<id>
+//
+// When the last byte arrives, the file is moved to the upload folder and
+// named after the "filename" metadata.
+//------------------------------------------------------------------------------
+class ofxHTTPServerResumableUploadRouteHandler : public ofxHTTPServerRouteHandler {
+public:
+
+    struct Settings;
+
+    ofxHTTPServerResumableUploadRouteHandler(const Settings& _settings,
+                                             ofxHTTPResumableUploadStore& _store,
+                                             ofxHTTPBufferPool& _writeBufferPool,
+                                             ofxHTTPServerUploadEvents& _events);
+
+    virtual ~ofxHTTPServerResumableUploadRouteHandler();
+
+    struct Settings {
+        string route; // a path prefix, uploads live at route/<id>
+
+        string uploadFolder; // completed uploads, relative to the data folder
+
+        unsigned long long maxUploadSize; // 0 is unlimited
+
+        size_t writeBufferSize;
+        ofxHTTPFileSink::Settings fileSinkSettings;
+
+        ofxHTTPResumableUploadStore::Settings storeSettings;
+
+        Settings();
+    };
+
+    static const string TUS_VERSION;
+
+protected:
+    void handleExchange(ofxHTTPServerExchange& exchange);
+
+    void handleOptions(ofxHTTPServerExchange& exchange);
+    void handleCreate(ofxHTTPServerExchange& exchange);
+    void handleHead(ofxHTTPServerExchange& exchange, const string& id);
+    void handlePatch(ofxHTTPServerExchange& exchange, const string& id);
+    void handleDelete(ofxHTTPServerExchange& exchange, const string& id);
+
+    // appends the request body at offset and returns the number of bytes
+    // appended.  Sets bTooLarge if the body is longer than maxLength.
+    unsigned long long appendBody(ofxHTTPServerExchange& exchange,
+                                  const string& dataPath,
+                                  unsigned long long offset,
+                                  unsigned long long maxLength,
+                                  bool& bTooLarge,
+                                  bool& bWriteFailed);
+
+    // moves the data file to the upload folder
+    bool finish(const ofxHTTPResumableUploadInfo& info);
+
+    void sendStatus(ofxHTTPServerExchange& exchange,
+                    HTTPResponse::HTTPStatus status,
+                    const string& reason = "");
+
+    void setUploadHeaders(HTTPServerResponse& response, const ofxHTTPResumableUploadInfo& info);
+
+    ofxHTTPServerUploadEventArgs makeEventArgs(const ofxHTTPResumableUploadInfo& info,
+                                               const string& error = "") const;
+
+    // Upload-Metadata is a list of "key base64value" pairs
+    static string getMetadata(const string& metadata, const string& key);
+
+    Settings settings;
+
+    ofxHTTPResumableUploadStore& store;
+    ofxHTTPBufferPool& writeBufferPool;
+    ofxHTTPServerUploadEvents& events;
+
+};
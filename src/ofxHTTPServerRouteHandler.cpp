@@ -1,21 +1,38 @@
 #include "ofxHTTPServerRouteHandler.h"
 
 //------------------------------------------------------------------------------
-ofxHTTPServerRouteHandler::ofxHTTPServerRouteHandler() { }
+ofxHTTPServerRouteHandler::ofxHTTPServerRouteHandler() : listener(NULL) { }
 
 //------------------------------------------------------------------------------
 ofxHTTPServerRouteHandler::~ofxHTTPServerRouteHandler() { }
 
 //------------------------------------------------------------------------------
 void ofxHTTPServerRouteHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) {
-    ofxHTTPServerExchange exchange(request,response);
+    ofxHTTPServerExchange exchange(request,response,listener);
+    
+    bool bHasBody = ofxHTTPServerBodyLimits::hasBody(request);
+    
+    HTTPResponse::HTTPStatus bodyStatus = bodyLimits.check(request);
+    if(bodyStatus != HTTPResponse::HTTP_OK) {
+        rejectWithoutBody(request, response, bodyStatus);
+        sendErrorResponse(response);
+        return;
+    }
+    
     ofxHTTPAuthStatus authStatus = authenticate(exchange);
     if(authStatus == OK) {
         updateSession(exchange);
+        if(bHasBody) {
+            if(!bodyLimits.bAllowBody) {
+                response.setKeepAlive(false); // the body is never read
+            } else if(request.expectContinue()) {
+                response.sendContinue();
+            }
+        }
         handleExchange(exchange);
         return;
     } else if(authStatus == UNAUTHORIZED || authStatus == NO_CREDENTIALS) {
-        response.setStatusAndReason(HTTPResponse::HTTP_UNAUTHORIZED);
+        rejectWithoutBody(request, response, HTTPResponse::HTTP_UNAUTHORIZED);
         sendErrorResponse(response);
         return;
     } else {
@@ -26,6 +43,52 @@ void ofxHTTPServerRouteHandler::handleRequest(HTTPServerRequest& request, HTTPSe
     }
 }
 
+//------------------------------------------------------------------------------
+void ofxHTTPServerRouteHandler::rejectWithoutBody(HTTPServerRequest& request,
+                                                  HTTPServerResponse& response,
+                                                  HTTPResponse::HTTPStatus status,
+                                                  const string& reason) {
+    if(reason.empty()) {
+        response.setStatusAndReason(status);
+    } else {
+        response.setStatusAndReason(status, reason);
+    }
+    
+    if(ofxHTTPServerBodyLimits::hasBody(request)) {
+        response.setKeepAlive(false); // the body is never read
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerRouteHandler::tag(HTTPRequestHandler* handler,
+                                    const ofxHTTPServerListener* listener,
+                                    const ofxHTTPServerBodyLimits& bodyLimits) {
+    ofxHTTPServerRouteHandler* routeHandler = dynamic_cast<ofxHTTPServerRouteHandler*>(handler);
+    if(routeHandler != NULL) {
+        routeHandler->setListener(listener);
+        routeHandler->setBodyLimits(bodyLimits);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerRouteHandler::setListener(const ofxHTTPServerListener* _listener) {
+    listener = _listener;
+}
+
+//------------------------------------------------------------------------------
+const ofxHTTPServerListener* ofxHTTPServerRouteHandler::getListener() const {
+    return listener;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerRouteHandler::setBodyLimits(const ofxHTTPServerBodyLimits& _bodyLimits) {
+    bodyLimits = _bodyLimits;
+}
+
+//------------------------------------------------------------------------------
+const ofxHTTPServerBodyLimits& ofxHTTPServerRouteHandler::getBodyLimits() const {
+    return bodyLimits;
+}
 
 ////------------------------------------------------------------------------------
 //bool ofxHTTPServerDefaultRouteHandler::isValidRequest(HTTPServerRequest& request,
@@ -113,3 +176,23 @@ void ofxHTTPServerRouteHandler::sendErrorResponse(HTTPServerResponse& response)
     }
 }
 
+//------------------------------------------------------------------------------
+void ofxHTTPServerRouteHandler::forward(HTTPRequestHandler& handler, HTTPServerRequest& request, HTTPServerResponse& response) {
+    tag(&handler, listener, bodyLimits);
+    handler.handleRequest(request, response);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerDecoratorHandler::ofxHTTPServerDecoratorHandler(HTTPRequestHandler* _handler) :
+handler(_handler)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerDecoratorHandler::~ofxHTTPServerDecoratorHandler() {
+    delete handler;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerDecoratorHandler::forward(HTTPServerRequest& request, HTTPServerResponse& response) {
+    ofxHTTPServerRouteHandler::forward(*handler, request, response);
+}
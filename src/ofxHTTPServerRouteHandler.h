@@ -40,7 +40,9 @@
 #include "ofUtils.h"
 
 #include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerBodyLimits.h"
 #include "ofxHTTPServerExchange.h"
+#include "ofxHTTPServerListener.h"
 #include "ofxHTTPUtils.h"
 #include "ofxMediaTypes.h"
 
@@ -67,7 +69,35 @@ public:
     // overriden from HTTPRequestHandler
     void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
 
+    // called by the route manager before handleRequest
+    void setListener(const ofxHTTPServerListener* _listener);
+    const ofxHTTPServerListener* getListener() const;
+
+    // called by the route manager before handleRequest.  Requests that
+    // fail the limits are rejected before authentication, and
+    // "100 Continue" is only sent once a request has passed both.
+    void setBodyLimits(const ofxHTTPServerBodyLimits& _bodyLimits);
+    const ofxHTTPServerBodyLimits& getBodyLimits() const;
+
+    // sets the status of a response that refuses the request without
+    // reading its body.  If the request carries one, the connection is
+    // closed after the response rather than kept alive with unread bytes.
+    // The caller adds any headers and sends the response.
+    static void rejectWithoutBody(HTTPServerRequest& request,
+                                  HTTPServerResponse& response,
+                                  HTTPResponse::HTTPStatus status,
+                                  const string& reason = "");
+    
+    // tells a route handler which listener accepted its request and what
+    // its route is willing to receive.  Other handlers are left alone.
+    static void tag(HTTPRequestHandler* handler,
+                    const ofxHTTPServerListener* listener,
+                    const ofxHTTPServerBodyLimits& bodyLimits);
+
 protected:
+    const ofxHTTPServerListener* listener;
+    ofxHTTPServerBodyLimits bodyLimits;
+
 
     // authenticate is expected to check authentication and also
     // set any response headers if authentication has failed.
@@ -77,5 +107,45 @@ protected:
     virtual void handleExchange(ofxHTTPServerExchange& exchange);
     
     virtual void sendErrorResponse(HTTPServerResponse& response);
+    
+    // runs another handler for this request, tagged like the route
+    // manager would have tagged it
+    void forward(HTTPRequestHandler& handler, HTTPServerRequest& request, HTTPServerResponse& response);
+
+};
+
+// Runs the handler of another route, e.g. once a bulkhead or a scheduler
+// lets it.  The wrapped handler is owned.
+//------------------------------------------------------------------------------
+class ofxHTTPServerDecoratorHandler : public ofxHTTPServerRouteHandler {
+public:
+    ofxHTTPServerDecoratorHandler(HTTPRequestHandler* _handler);
+    virtual ~ofxHTTPServerDecoratorHandler();
+    
+protected:
+    void forward(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+    HTTPRequestHandler* handler;
+    
+private:
+    ofxHTTPServerDecoratorHandler(const ofxHTTPServerDecoratorHandler&);
+    ofxHTTPServerDecoratorHandler& operator = (const ofxHTTPServerDecoratorHandler&);
+    
+};
 
+// Gives a slot back to whatever handed it out, e.g. a bulkhead, however
+// the handler returns.
+//------------------------------------------------------------------------------
+template<typename SlotSource>
+class ofxHTTPServerSlotGuard {
+public:
+    ofxHTTPServerSlotGuard(SlotSource& _source) : source(_source) { }
+    ~ofxHTTPServerSlotGuard() { source.release(); }
+    
+private:
+    ofxHTTPServerSlotGuard(const ofxHTTPServerSlotGuard&);
+    ofxHTTPServerSlotGuard& operator = (const ofxHTTPServerSlotGuard&);
+    
+    SlotSource& source;
+    
 };
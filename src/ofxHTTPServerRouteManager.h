@@ -29,7 +29,10 @@
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
 
 //#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerListener.h"
+#include "ofxHTTPServerRateLimiter.h"
 #include "ofxHTTPServerRouteHandler.h"
+#include "ofxHTTPServerVirtualHost.h"
 
 using std::vector;
 
@@ -39,27 +42,71 @@ using Poco::Net::HTTPRequestHandlerFactory;
 class ofxHTTPServerRouteManager : public HTTPRequestHandlerFactory {
 public:
     
+    // each listener gets its own route manager, but they all share
+    // the server's route table, virtual hosts and rate limiters.
     ofxHTTPServerRouteManager(vector<ofxBaseHTTPServerRoutePtr>& _factories,
-                              bool _bIsSecurePort)
-    : factories(_factories), bIsSecurePort(_bIsSecurePort) { }
+                              ofxHTTPServerRateLimiterChain& _rateLimiters,
+                              ofxHTTPServerVirtualHostTable& _virtualHosts,
+                              ofxHTTPServerListener::Ptr _listener)
+    : factories(_factories), rateLimiters(_rateLimiters), virtualHosts(_virtualHosts), listener(_listener) { }
     
     virtual ~ofxHTTPServerRouteManager() { }
 
     HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        // clients over a limit are turned away before any route is asked
+        Timespan retryAfter;
+        if(!rateLimiters.acquire(request, retryAfter)) {
+            return tagHandler(ofxHTTPServerRateLimiter::createRejectionHandler(retryAfter),
+                              ofxHTTPServerBodyLimits());
+        }
+        
+        // a virtual host only serves its own routes, requests for any
+        // other host, or without a Host header, get the server's.
+        ofxHTTPServerVirtualHost::Ptr virtualHost;
+        if(!virtualHosts.empty()) {
+            virtualHost = virtualHosts.find(request.get("Host", ""));
+        }
+        
+        vector<ofxBaseHTTPServerRoutePtr> hostRoutes;
+        if(virtualHost != NULL) {
+            hostRoutes = virtualHost->getRoutes();
+        }
+        
+        const vector<ofxBaseHTTPServerRoutePtr>& routes = virtualHost != NULL ? hostRoutes : factories;
+        
         // We start with the last factory that was added.
         // Thus, factories with overlapping routes should be
         // carefully ordered.
-        vector<ofxBaseHTTPServerRoutePtr>::reverse_iterator iter = factories.rbegin();
-        while(iter != factories.rend()) {
+        bool bIsSecurePort = listener->isSecure();
+        
+        vector<ofxBaseHTTPServerRoutePtr>::const_reverse_iterator iter = routes.rbegin();
+        while(iter != routes.rend()) {
             if((*iter)->canHandleRequest(request,bIsSecurePort)) {
-                return (*iter)->createRequestHandler(request);
+                return tagHandler((*iter)->createRequestHandler(request),
+                                  (*iter)->getBodyLimits(request));
             }
             ++iter;
         }
-        return new ofxHTTPServerRouteHandler(); // if we get to this point, we didn't find a matching route
+        
+        // if we get to this point, we didn't find a matching route,
+        // so there is no point in receiving the body.
+        ofxHTTPServerBodyLimits noBody;
+        noBody.bAllowBody = false;
+        return tagHandler(new ofxHTTPServerRouteHandler(), noBody);
     }
     
+    ofxHTTPServerListener::Ptr getListener() const { return listener; }
+    
 protected:
+    // let the handler know which listener accepted its request
+    // and what its route is willing to receive
+    HTTPRequestHandler* tagHandler(HTTPRequestHandler* handler, const ofxHTTPServerBodyLimits& bodyLimits) {
+        ofxHTTPServerRouteHandler::tag(handler, listener.get(), bodyLimits);
+        return handler;
+    }
+    
     vector<ofxBaseHTTPServerRoutePtr>& factories;
-    bool bIsSecurePort; // TODO can we get this from teh HTTPServerRequest somehow?
+    ofxHTTPServerRateLimiterChain& rateLimiters;
+    ofxHTTPServerVirtualHostTable& virtualHosts;
+    ofxHTTPServerListener::Ptr listener;
 };
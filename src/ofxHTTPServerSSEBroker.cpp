@@ -0,0 +1,381 @@
+#include "ofxHTTPServerSSEBroker.h"
+
+#include <algorithm>
+
+#include "Poco/Exception.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Net/Socket.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPUtils.h"
+
+using Poco::Net::Socket;
+using Poco::Net::SocketImpl;
+
+const string ofxHTTPServerSSEBroker::ALL_TOPICS = "*";
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSEBroker::Settings::Settings() {
+    replaySize        = 1024;
+    maxSubscribers    = 10000;
+    maxQueuedBytes    = 1024 * 1024;                    // 1 MB
+    heartbeatInterval = Timespan(15 * Timespan::SECONDS);
+    sendTimeout       = Timespan(30 * Timespan::SECONDS);
+    pollTimeout       = Timespan(10 * Timespan::MILLISECONDS);
+    retry             = Timespan(3 * Timespan::SECONDS);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSEBroker::ofxHTTPServerSSEBroker(const Settings& _settings) :
+settings(_settings),
+lastEventId(0),
+heartbeat(new string(":\n\n")),
+bRunning(true)
+{
+    thread.setName("ofxHTTPServerSSEBroker");
+    thread.start(*this);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSEBroker::~ofxHTTPServerSSEBroker() {
+    {
+        ofScopedLock lock(mutex);
+        bRunning = false;
+    }
+    
+    wakeEvent.set();
+    thread.join();
+    
+    set<Subscriber*>::iterator iter = subscribers.begin();
+    while(iter != subscribers.end()) {
+        (*iter)->socket.close();
+        delete *iter;
+        ++iter;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSEBroker::EventId ofxHTTPServerSSEBroker::publish(const string& topic,
+                                                                const string& data,
+                                                                const string& type) {
+    ofScopedLock lock(mutex);
+    
+    EventId id = ++lastEventId;
+    
+    // the only copy, however many subscribers there are
+    Event event;
+    event.id     = id;
+    event.topic  = topic;
+    event.buffer = Buffer(new string(encode(id, type.empty() ? topic : type, data)));
+    
+    replay.push_back(event);
+    while(replay.size() > settings.replaySize) {
+        replay.pop_front();
+    }
+    
+    enqueue(topic, event.buffer);
+    
+    // subscribers to every topic, unless that's where it was published
+    if(topic != ALL_TOPICS) {
+        enqueue(ALL_TOPICS, event.buffer);
+    }
+    
+    wakeEvent.set();
+    
+    return id;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSSEBroker::subscribe(const StreamSocket& socket,
+                                       const vector<string>& _topics,
+                                       EventId _lastEventId,
+                                       bool bReplay) {
+    ofScopedLock lock(mutex);
+    
+    if(!bRunning || subscribers.size() >= settings.maxSubscribers) {
+        return false;
+    }
+    
+    Subscriber* subscriber = new Subscriber();
+    subscriber->socket = socket;
+    subscriber->socket.setBlocking(false);
+    
+    // everything covers the rest
+    if(std::find(_topics.begin(), _topics.end(), ALL_TOPICS) != _topics.end()) {
+        subscriber->topics.insert(ALL_TOPICS);
+    } else {
+        subscriber->topics.insert(_topics.begin(), _topics.end());
+    }
+    
+    subscribers.insert(subscriber);
+    
+    set<string>::const_iterator topic = subscriber->topics.begin();
+    while(topic != subscriber->topics.end()) {
+        topics[*topic].insert(subscriber);
+        ++topic;
+    }
+    
+    long retry = static_cast<long>(settings.retry.totalMilliseconds());
+    enqueue(subscriber, Buffer(new string("retry: " + Poco::NumberFormatter::format(retry) + "\n\n")));
+    
+    // replayed under the same lock as publish, so nothing falls in between
+    if(bReplay) {
+        bool bAll = subscriber->topics.count(ALL_TOPICS) > 0;
+        deque<Event>::const_iterator iter = replay.begin();
+        while(iter != replay.end()) {
+            if((*iter).id > _lastEventId && (bAll || subscriber->topics.count((*iter).topic) > 0)) {
+                enqueue(subscriber, (*iter).buffer);
+            }
+            ++iter;
+        }
+    }
+    
+    wakeEvent.set();
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSSEBroker::isFull() const {
+    ofScopedLock lock(mutex);
+    return subscribers.size() >= settings.maxSubscribers;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerSSEBroker::getNumSubscribers() const {
+    ofScopedLock lock(mutex);
+    return subscribers.size();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSEBroker::EventId ofxHTTPServerSSEBroker::getLastEventId() const {
+    ofScopedLock lock(mutex);
+    return lastEventId;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerSSEBroker::encode(EventId id, const string& type, const string& data) {
+    string event = "id: " + Poco::NumberFormatter::format(id) + "\n";
+    
+    if(!type.empty()) {
+        event += "event: " + type + "\n";
+    }
+    
+    // one data field per line, the client joins them with \n again
+    size_t start = 0;
+    while(true) {
+        size_t end = data.find_first_of("\r\n", start);
+        
+        event += "data: " + data.substr(start, end == string::npos ? string::npos : end - start) + "\n";
+        
+        if(end == string::npos) {
+            break;
+        }
+        
+        start = end + 1;
+        if(data[end] == '\r' && start < data.size() && data[start] == '\n') {
+            ++start;
+        }
+    }
+    
+    return event + "\n";
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSEBroker::Ptr ofxHTTPServerSSEBroker::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerSSEBroker(settings));
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSSEBroker::run() {
+    while(true) {
+        Socket::SocketList readList;
+        Socket::SocketList writeList;
+        Socket::SocketList exceptList;
+        
+        map<SocketImpl*, Subscriber*> waiting;
+        
+        long waitMilliseconds = 0;
+        
+        {
+            ofScopedLock lock(mutex);
+            
+            if(!bRunning) {
+                break;
+            }
+            
+            Timestamp now;
+            
+            if(now - lastHeartbeat >= settings.heartbeatInterval.totalMicroseconds()) {
+                set<Subscriber*>::iterator iter = subscribers.begin();
+                while(iter != subscribers.end()) {
+                    enqueue(*iter, heartbeat);
+                    ++iter;
+                }
+                lastHeartbeat = now;
+            }
+            
+            vector<Subscriber*> dropped;
+            
+            set<Subscriber*>::iterator iter = pending.begin();
+            while(iter != pending.end()) {
+                if(!flush(*iter, now)) {
+                    dropped.push_back(*iter);
+                }
+                ++iter;
+            }
+            
+            pending.clear();
+            
+            iter = blocked.begin();
+            while(iter != blocked.end()) {
+                Subscriber* subscriber = *iter;
+                if(subscriber->bDropped || now - subscriber->blockedSince >= settings.sendTimeout.totalMicroseconds()) {
+                    dropped.push_back(subscriber);
+                } else {
+                    writeList.push_back(subscriber->socket);
+                    waiting[subscriber->socket.impl()] = subscriber;
+                }
+                ++iter;
+            }
+            
+            for(size_t i = 0; i < dropped.size(); ++i) {
+                remove(dropped[i]);
+            }
+            
+            Timestamp::TimeDiff untilHeartbeat = settings.heartbeatInterval.totalMicroseconds() - (now - lastHeartbeat);
+            waitMilliseconds = static_cast<long>(untilHeartbeat / 1000) + 1;
+        }
+        
+        if(writeList.empty()) {
+            wakeEvent.tryWait(waitMilliseconds);
+            continue;
+        }
+        
+        // new events for writable subscribers wait at most pollTimeout
+        try {
+            Socket::select(readList, writeList, exceptList, settings.pollTimeout);
+        } catch(const Poco::Exception& exc) {
+            ofLogError("ofxHTTPServerSSEBroker::run") << exc.displayText();
+        }
+        
+        ofScopedLock lock(mutex);
+        
+        Socket::SocketList::iterator iter = writeList.begin();
+        while(iter != writeList.end()) {
+            map<SocketImpl*, Subscriber*>::iterator subscriber = waiting.find((*iter).impl());
+            if(subscriber != waiting.end()) {
+                (*subscriber).second->bBlocked = false;
+                blocked.erase((*subscriber).second);
+                pending.insert((*subscriber).second);
+            }
+            ++iter;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSSEBroker::enqueue(Subscriber* subscriber, const Buffer& buffer) {
+    if(subscriber->bDropped) {
+        return;
+    }
+    
+    if(subscriber->queuedBytes + buffer->size() > settings.maxQueuedBytes) {
+        // too far behind, it can catch up by replaying
+        subscriber->bDropped = true;
+    } else {
+        subscriber->queue.push_back(buffer);
+        subscriber->queuedBytes += buffer->size();
+    }
+    
+    if(!subscriber->bBlocked) {
+        pending.insert(subscriber);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSSEBroker::enqueue(const string& topic, const Buffer& buffer) {
+    map<string, set<Subscriber*> >::iterator topicIter = topics.find(topic);
+    
+    if(topicIter == topics.end()) {
+        return;
+    }
+    
+    set<Subscriber*>::iterator iter = (*topicIter).second.begin();
+    while(iter != (*topicIter).second.end()) {
+        enqueue(*iter, buffer);
+        ++iter;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSSEBroker::flush(Subscriber* subscriber, const Timestamp& now) {
+    if(subscriber->bDropped) {
+        return false;
+    }
+    
+    while(!subscriber->queue.empty()) {
+        const string& buffer = *subscriber->queue.front();
+        
+        int n = 0;
+        
+        try {
+            n = ofSendSome(subscriber->socket, buffer.data() + subscriber->offset, buffer.size() - subscriber->offset);
+        } catch(const Poco::Exception&) {
+            n = -1;
+        }
+        
+        if(n < 0) {
+            return false;
+        }
+        
+        if(n == 0) {
+            if(!subscriber->bBlocked) {
+                subscriber->bBlocked = true;
+                subscriber->blockedSince = now;
+                blocked.insert(subscriber);
+            }
+            return true;
+        }
+        
+        subscriber->offset += n;
+        
+        if(subscriber->offset == buffer.size()) {
+            subscriber->queuedBytes -= buffer.size();
+            subscriber->queue.pop_front();
+            subscriber->offset = 0;
+        }
+    }
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSSEBroker::remove(Subscriber* subscriber) {
+    set<string>::iterator topic = subscriber->topics.begin();
+    while(topic != subscriber->topics.end()) {
+        map<string, set<Subscriber*> >::iterator topicIter = topics.find(*topic);
+        if(topicIter != topics.end()) {
+            (*topicIter).second.erase(subscriber);
+            if((*topicIter).second.empty()) {
+                topics.erase(topicIter);
+            }
+        }
+        ++topic;
+    }
+    
+    subscribers.erase(subscriber);
+    pending.erase(subscriber);
+    blocked.erase(subscriber);
+    
+    try {
+        subscriber->socket.shutdown();
+    } catch(const Poco::Exception&) {
+        // already gone
+    }
+    
+    subscriber->socket.close();
+    
+    delete subscriber;
+}
@@ -0,0 +1,163 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Poco/Event.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/StreamSocket.h"
+
+#include "ofTypes.h"
+
+using std::deque;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+using Poco::Runnable;
+using Poco::Thread;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::StreamSocket;
+
+// Fans Server-Sent Events out to subscribed connections.
+//
+// Subscribers are sockets taken over from the server once their response
+// headers are sent, so an open event stream does not hold on to one of
+// the server's threads.  A single writer thread sends to all of them
+// without blocking, waiting for the sockets that are full to drain.
+//
+// An event is encoded once into a shared buffer which every subscriber of
+// its topic queues by reference.  The last replaySize events are kept so
+// reconnecting clients can resume after their Last-Event-ID.  Subscribers
+// that fall more than maxQueuedBytes behind, or that can't be written to
+// for sendTimeout, are disconnected; they reconnect and replay.
+class ofxHTTPServerSSEBroker : public Runnable {
+public:
+    typedef ofPtr<ofxHTTPServerSSEBroker> Ptr;
+    typedef unsigned long long EventId;
+    typedef ofPtr<const string> Buffer;
+    
+    struct Settings;
+    
+    ofxHTTPServerSSEBroker(const Settings& _settings);
+    virtual ~ofxHTTPServerSSEBroker();
+    
+    // encodes the event once and queues it for every subscriber of topic
+    // and of ALL_TOPICS.  The event's type is the topic unless given.
+    EventId publish(const string& topic, const string& data, const string& type = "");
+    
+    // takes over a socket whose response headers have been sent.  Events
+    // after lastEventId are replayed first if bReplay.  Returns false if
+    // there are already maxSubscribers, the socket is then left alone.
+    bool subscribe(const StreamSocket& socket,
+                   const vector<string>& topics,
+                   EventId lastEventId = 0,
+                   bool bReplay = false);
+    
+    bool isFull() const;
+    size_t getNumSubscribers() const;
+    EventId getLastEventId() const;
+    
+    // the wire format of one event
+    static string encode(EventId id, const string& type, const string& data);
+    
+    static const string ALL_TOPICS;
+    
+    struct Settings {
+        size_t replaySize;          // events kept for Last-Event-ID
+        size_t maxSubscribers;
+        size_t maxQueuedBytes;      // per subscriber
+        Timespan heartbeatInterval; // comments that keep idle streams alive
+        Timespan sendTimeout;       // longest a subscriber may stay unwritable
+        Timespan pollTimeout;       // how often full sockets are rechecked
+        Timespan retry;             // the clients' reconnection delay
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+    // overriden from Runnable, the writer thread
+    void run();
+    
+protected:
+    struct Event {
+        EventId id;
+        string topic;
+        Buffer buffer;
+    };
+    
+    struct Subscriber {
+        Subscriber() : offset(0), queuedBytes(0), bBlocked(false), bDropped(false) { }
+        
+        StreamSocket socket;
+        set<string> topics;
+        deque<Buffer> queue;
+        size_t offset;          // sent of queue.front()
+        size_t queuedBytes;
+        bool bBlocked;          // waiting for the socket to drain
+        Timestamp blockedSince;
+        bool bDropped;          // to be closed by the writer thread
+    };
+    
+    // all expected to hold the mutex
+    void enqueue(Subscriber* subscriber, const Buffer& buffer);
+    void enqueue(const string& topic, const Buffer& buffer);
+    
+    // returns false if the subscriber is to be closed
+    bool flush(Subscriber* subscriber, const Timestamp& now);
+    void remove(Subscriber* subscriber);
+    
+    Settings settings;
+    
+    mutable ofMutex mutex;
+    
+    EventId lastEventId;
+    deque<Event> replay;
+    
+    // subscribers are only deleted by the writer thread
+    set<Subscriber*> subscribers;
+    map<string, set<Subscriber*> > topics;
+    set<Subscriber*> pending;   // have something to send
+    set<Subscriber*> blocked;   // waiting for their sockets
+    
+    Buffer heartbeat;
+    Timestamp lastHeartbeat;
+    
+    Thread thread;
+    Poco::Event wakeEvent;
+    bool bRunning;
+    
+};
@@ -0,0 +1,95 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "Poco/URI.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerSSEBroker.h"
+#include "ofxHTTPServerSSERouteHandler.h"
+
+using Poco::SyntaxException;
+using Poco::URI;
+
+// Server-Sent Events at settings.route.  Browsers connect with
+// new EventSource("/events?topic=status") and receive what is published
+// to their topics, each event encoded once for all of them.
+//------------------------------------------------------------------------------
+class ofxHTTPServerSSERoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofxHTTPServerSSERouteHandler::Settings Settings;
+    typedef ofPtr<ofxHTTPServerSSERoute> Ptr;
+
+    ofxHTTPServerSSERoute(const Settings& _settings = Settings(),
+                          ofxHTTPServerSSEBroker::Ptr _broker = ofxHTTPServerSSEBroker::Instance()) :
+    settings(_settings),
+    broker(_broker)
+    { }
+
+    virtual ~ofxHTTPServerSSERoute() { }
+
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        URI uri;
+        try {
+            uri = URI(request.getURI());
+        } catch(const SyntaxException& exc) {
+            ofLogError("ofxHTTPServerSSERoute::canHandleRequest") << exc.what();
+            return false;
+        }
+
+        string path = uri.getPath();
+        if(path.empty()) { path = "/"; }
+
+        return path == settings.route;
+    }
+
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        ofxHTTPServerBodyLimits limits;
+        limits.bAllowBody = false;
+        return limits;
+    }
+
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        return new ofxHTTPServerSSERouteHandler(broker, settings);
+    }
+
+    ofxHTTPServerSSEBroker::EventId publish(const string& topic, const string& data, const string& type = "") {
+        return broker->publish(topic, data, type);
+    }
+
+    ofxHTTPServerSSEBroker::Ptr getBroker() const { return broker; }
+
+    static Ptr Instance(const Settings& settings = Settings(),
+                        ofxHTTPServerSSEBroker::Ptr broker = ofxHTTPServerSSEBroker::Instance()) {
+        return Ptr(new ofxHTTPServerSSERoute(settings, broker));
+    }
+
+protected:
+    Settings settings;
+    ofxHTTPServerSSEBroker::Ptr broker;
+
+};
@@ -0,0 +1,144 @@
+#include "ofxHTTPServerSSERouteHandler.h"
+
+#include "Poco/NumberParser.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPServerRequestImpl.h"
+
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPServerRequestImpl;
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSERouteHandler::Settings::Settings() {
+    route                     = "/events";
+    topicParameter            = "topic";
+    defaultTopics.push_back(ofxHTTPServerSSEBroker::ALL_TOPICS);
+    bAllowCrossOriginRequests = false;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSERouteHandler::ofxHTTPServerSSERouteHandler(ofxHTTPServerSSEBroker::Ptr _broker,
+                                                           const Settings& _settings) :
+broker(_broker),
+settings(_settings)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSSERouteHandler::~ofxHTTPServerSSERouteHandler() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSSERouteHandler::handleExchange(ofxHTTPServerExchange& exchange) {
+    HTTPServerRequest& request = exchange.request;
+    HTTPServerResponse& response = exchange.response;
+    
+    bool bHead = request.getMethod() == HTTPRequest::HTTP_HEAD;
+    
+    if(!bHead && request.getMethod() != HTTPRequest::HTTP_GET) {
+        response.setStatusAndReason(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+        response.set("Allow", "GET, HEAD");
+        sendErrorResponse(response);
+        return;
+    }
+    
+    vector<string> topics;
+    if(!getTopics(request, topics)) {
+        response.setStatusAndReason(HTTPResponse::HTTP_FORBIDDEN);
+        sendErrorResponse(response);
+        return;
+    }
+    
+    HTTPServerRequestImpl* pRequestImpl = dynamic_cast<HTTPServerRequestImpl*>(&request);
+    
+    if(pRequestImpl == NULL || broker->isFull()) {
+        response.setStatusAndReason(HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
+        sendErrorResponse(response);
+        return;
+    }
+    
+    ofxHTTPServerSSEBroker::EventId lastEventId = 0;
+    bool bReplay = getLastEventId(request, lastEventId);
+    
+    // the stream is never framed, it ends when the connection does
+    response.setStatusAndReason(HTTPResponse::HTTP_OK);
+    response.setContentType("text/event-stream");
+    response.set("Cache-Control", "no-cache");
+    response.set("X-Accel-Buffering", "no"); // for nginx in front
+    response.setChunkedTransferEncoding(false);
+    response.setKeepAlive(false);
+    
+    if(settings.bAllowCrossOriginRequests) {
+        response.set("Access-Control-Allow-Origin", "*");
+    }
+    
+    std::ostream& ostr = response.send();
+    ostr.flush();
+    
+    if(bHead) {
+        return;
+    }
+    
+    StreamSocket socket = pRequestImpl->detachSocket();
+    
+    if(!broker->subscribe(socket, topics, lastEventId, bReplay)) {
+        // filled up since we checked, the client will retry
+        socket.close();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSSERouteHandler::getTopics(const HTTPServerRequest& request, vector<string>& topics) const {
+    URI uri;
+    
+    try {
+        uri = URI(request.getURI());
+    } catch(const Poco::SyntaxException& exc) {
+        ofLogError("ofxHTTPServerSSERouteHandler::getTopics") << exc.what();
+        return false;
+    }
+    
+    NameValueCollection query = ofGetQueryMap(uri);
+    
+    // the collection ignores case, the parameter name doesn't
+    NameValueCollection::ConstIterator param = query.begin();
+    while(param != query.end()) {
+        if((*param).first == settings.topicParameter) {
+            topics.push_back((*param).second);
+        }
+        ++param;
+    }
+    
+    if(topics.empty()) {
+        topics = settings.defaultTopics;
+        return true;
+    }
+    
+    if(!settings.allowedTopics.empty()) {
+        vector<string>::iterator iter = topics.begin();
+        while(iter != topics.end()) {
+            if(settings.allowedTopics.count(*iter) == 0) {
+                return false;
+            }
+            ++iter;
+        }
+    }
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSSERouteHandler::getLastEventId(const HTTPServerRequest& request,
+                                                  ofxHTTPServerSSEBroker::EventId& lastEventId) const {
+    string value = request.get("Last-Event-ID", "");
+    
+    if(value.empty()) {
+        value = ofGetQueryMap(URI(request.getURI())).get("lastEventId", "");
+    }
+    
+    Poco::UInt64 id = 0;
+    
+    if(value.empty() || !Poco::NumberParser::tryParseUnsigned64(value, id)) {
+        return false;
+    }
+    
+    lastEventId = id;
+    return true;
+}
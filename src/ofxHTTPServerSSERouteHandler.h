@@ -0,0 +1,74 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ofxHTTPServerRouteHandler.h"
+#include "ofxHTTPServerSSEBroker.h"
+
+using std::set;
+using std::string;
+using std::vector;
+
+// Answers a text/event-stream request and hands its connection to the
+// broker, freeing the server thread that accepted it.
+//------------------------------------------------------------------------------
+class ofxHTTPServerSSERouteHandler : public ofxHTTPServerRouteHandler {
+public:
+    struct Settings;
+    
+    ofxHTTPServerSSERouteHandler(ofxHTTPServerSSEBroker::Ptr _broker, const Settings& _settings);
+    virtual ~ofxHTTPServerSSERouteHandler();
+    
+    struct Settings {
+        string route;               // e.g. /events
+        
+        // clients pick topics with ?topic=a&topic=b, or get defaultTopics
+        string topicParameter;
+        vector<string> defaultTopics;
+        set<string> allowedTopics;  // empty allows any
+        
+        bool bAllowCrossOriginRequests;
+        
+        Settings();
+    };
+    
+protected:
+    ofxHTTPServerSSEBroker::Ptr broker;
+    Settings settings;
+    
+    void handleExchange(ofxHTTPServerExchange& exchange);
+    
+    // false if a topic isn't allowed
+    bool getTopics(const HTTPServerRequest& request, vector<string>& topics) const;
+    
+    // from the Last-Event-ID header, or ?lastEventId= for clients that
+    // can't set headers
+    bool getLastEventId(const HTTPServerRequest& request, ofxHTTPServerSSEBroker::EventId& lastEventId) const;
+    
+};
@@ -0,0 +1,82 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerScheduler.h"
+
+// Runs another route's requests through a scheduler with the route's
+// priority and deadline.  Higher priorities run first.
+//------------------------------------------------------------------------------
+class ofxHTTPServerScheduledRoute : public ofxBaseHTTPServerRoute {
+public:
+    typedef ofPtr<ofxHTTPServerScheduledRoute> Ptr;
+
+    ofxHTTPServerScheduledRoute(ofxBaseHTTPServerRoute::Ptr _route,
+                                ofxHTTPServerScheduler::Ptr _scheduler,
+                                int _priority = 0,
+                                const Timespan& _deadline = Timespan(30 * Timespan::SECONDS)) :
+    route(_route),
+    scheduler(_scheduler),
+    priority(_priority),
+    deadline(_deadline)
+    { }
+
+    virtual ~ofxHTTPServerScheduledRoute() { }
+
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        return route->canHandleRequest(request, bIsSecurePort);
+    }
+
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        return route->getBodyLimits(request);
+    }
+
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        HTTPRequestHandler* handler = route->createRequestHandler(request);
+        if(handler == NULL) {
+            return NULL;
+        }
+        return new ofxHTTPServerScheduledHandler(handler, scheduler, priority, deadline);
+    }
+
+    ofxBaseHTTPServerRoute::Ptr getRoute() const { return route; }
+    ofxHTTPServerScheduler::Ptr getScheduler() const { return scheduler; }
+    int getPriority() const { return priority; }
+
+    static Ptr Instance(ofxBaseHTTPServerRoute::Ptr route,
+                        ofxHTTPServerScheduler::Ptr scheduler,
+                        int priority = 0,
+                        const Timespan& deadline = Timespan(30 * Timespan::SECONDS)) {
+        return Ptr(new ofxHTTPServerScheduledRoute(route, scheduler, priority, deadline));
+    }
+
+protected:
+    ofxBaseHTTPServerRoute::Ptr route;
+    ofxHTTPServerScheduler::Ptr scheduler;
+    int priority;
+    Timespan deadline;
+
+};
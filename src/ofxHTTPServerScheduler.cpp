@@ -0,0 +1,214 @@
+#include "ofxHTTPServerScheduler.h"
+
+#include "Poco/NumberParser.h"
+
+#include "ofxHTTPUtils.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPServerScheduler::Settings::Settings() {
+    maxConcurrent = 16;
+    maxQueued     = 32;
+    timeoutHeader = "X-Request-Timeout";
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerScheduler::ofxHTTPServerScheduler(const Settings& _settings) :
+settings(_settings),
+sequence(0)
+{
+    if(settings.maxConcurrent < 1) {
+        settings.maxConcurrent = 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerScheduler::~ofxHTTPServerScheduler() { }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerScheduler::Admission ofxHTTPServerScheduler::admit(int priority, const Timestamp& deadline) {
+    Timestamp enqueued;
+    
+    Waiter waiter;
+    Queue::iterator position;
+    
+    {
+        ofScopedLock lock(mutex);
+        
+        if(deadline <= enqueued) {
+            ++metrics.expired;
+            return EXPIRED;
+        }
+        
+        // nobody to overtake
+        if(metrics.active < settings.maxConcurrent && queue.empty()) {
+            ++metrics.active;
+            ++metrics.admitted;
+            return ADMITTED;
+        }
+        
+        Key key;
+        key.priority = priority;
+        key.deadline = deadline;
+        key.sequence = ++sequence;
+        
+        if(queue.size() >= settings.maxQueued) {
+            Queue::iterator last = queue.end();
+            
+            // make room by turning away the least urgent, unless it's us
+            if(queue.empty() || !(key < (*--last).first)) {
+                ++metrics.rejected;
+                return REJECTED;
+            }
+            
+            (*last).second->bRejected = true;
+            (*last).second->event.set();
+            queue.erase(last);
+            ++metrics.rejected;
+        }
+        
+        position = queue.insert(std::make_pair(key, &waiter)).first;
+        metrics.queued = queue.size();
+    }
+    
+    Timestamp::TimeDiff remaining = deadline - Timestamp();
+    if(remaining > 0) {
+        waiter.event.tryWait(static_cast<long>(remaining / 1000) + 1);
+    }
+    
+    ofScopedLock lock(mutex);
+    
+    // admitted, turned away or expired while we woke up, the flags decide
+    if(waiter.bAdmitted) {
+        recordWait(enqueued);
+        ++metrics.admitted;
+        return ADMITTED;
+    }
+    
+    if(waiter.bRejected) {
+        return REJECTED;
+    }
+    
+    if(!waiter.bExpired) {
+        queue.erase(position);
+        metrics.queued = queue.size();
+        ++metrics.expired;
+    }
+    
+    recordWait(enqueued);
+    
+    return EXPIRED;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerScheduler::release() {
+    ofScopedLock lock(mutex);
+    
+    if(metrics.active > 0) {
+        --metrics.active;
+    }
+    
+    admitNext();
+}
+
+//------------------------------------------------------------------------------
+Timestamp ofxHTTPServerScheduler::getDeadline(const HTTPServerRequest& request, const Timespan& routeDeadline) const {
+    Timestamp now;
+    Timestamp deadline = now + routeDeadline;
+    
+    if(!settings.timeoutHeader.empty() && request.has(settings.timeoutHeader)) {
+        Poco::UInt64 milliseconds = 0;
+        if(Poco::NumberParser::tryParseUnsigned64(request.get(settings.timeoutHeader), milliseconds) &&
+           milliseconds < static_cast<Poco::UInt64>(routeDeadline.totalMilliseconds())) {
+            deadline = now + Timespan(static_cast<Timespan::TimeDiff>(milliseconds) * Timespan::MILLISECONDS);
+        }
+    }
+    
+    return deadline;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerScheduler::Metrics ofxHTTPServerScheduler::getMetrics() const {
+    ofScopedLock lock(mutex);
+    return metrics;
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPServerScheduler::getMaxThreads() const {
+    return settings.maxConcurrent + settings.maxQueued;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerScheduler::Ptr ofxHTTPServerScheduler::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerScheduler(settings));
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerScheduler::admitNext() {
+    Timestamp now;
+    
+    while(metrics.active < settings.maxConcurrent && !queue.empty()) {
+        Queue::iterator next = queue.begin();
+        Waiter* waiter = (*next).second;
+        
+        // no point in starting what the client has given up on
+        if((*next).first.deadline <= now) {
+            waiter->bExpired = true;
+            ++metrics.expired;
+        } else {
+            waiter->bAdmitted = true;
+            ++metrics.active;
+        }
+        
+        queue.erase(next);
+        waiter->event.set();
+    }
+    
+    metrics.queued = queue.size();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerScheduler::recordWait(const Timestamp& enqueued) {
+    Timespan wait(enqueued.elapsed());
+    
+    ++metrics.numWaits;
+    metrics.totalWait += wait;
+    
+    if(wait > metrics.maxWait) {
+        metrics.maxWait = wait;
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerScheduledHandler::ofxHTTPServerScheduledHandler(HTTPRequestHandler* _handler,
+                                                             ofxHTTPServerScheduler::Ptr _scheduler,
+                                                             int _priority,
+                                                             const Timespan& _deadline) :
+ofxHTTPServerDecoratorHandler(_handler),
+scheduler(_scheduler),
+priority(_priority),
+deadline(_deadline)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerScheduledHandler::~ofxHTTPServerScheduledHandler() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerScheduledHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) {
+    ofxHTTPServerScheduler::Admission admission = scheduler->admit(priority, scheduler->getDeadline(request, deadline));
+    
+    if(admission != ofxHTTPServerScheduler::ADMITTED) {
+        ofxHTTPServerRouteHandler::rejectWithoutBody(request, response, HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
+        
+        if(admission == ofxHTTPServerScheduler::REJECTED) {
+            response.set("Retry-After", "1");
+        }
+        
+        response.setContentLength(0);
+        response.send();
+        return;
+    }
+    
+    ofxHTTPServerSlotGuard<ofxHTTPServerScheduler> guard(*scheduler);
+    
+    forward(request, response);
+}
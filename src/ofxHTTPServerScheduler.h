@@ -0,0 +1,176 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Poco/Event.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPServerRouteHandler.h"
+
+using std::map;
+using std::string;
+
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+
+// Orders the requests of the routes it schedules by priority and deadline.
+//
+// At most maxConcurrent scheduled requests run at a time.  The others
+// wait, and whenever one finishes the waiting request with the highest
+// priority runs next, among equals the one with the earliest deadline.
+// A waiting request keeps the server thread it arrived on, so the
+// scheduler can hold up to maxConcurrent + maxQueued threads, which
+// should be well below the server's maxThreads; ofxHTTPServer::start()
+// warns if it isn't.
+// A request's deadline is its route's deadline, or sooner if the client
+// sent a timeout in timeoutHeader.  Requests whose deadline has passed
+// are answered 503 without running.  If maxQueued requests are already
+// waiting, the least urgent of them is turned away.
+//
+// Routes are scheduled by wrapping them in an ofxHTTPServerScheduledRoute
+// with their priority, e.g. control requests above bulk exports.
+class ofxHTTPServerScheduler {
+public:
+    typedef ofPtr<ofxHTTPServerScheduler> Ptr;
+    
+    struct Settings;
+    
+    enum Admission {
+        ADMITTED,   // run the request, then release()
+        REJECTED,   // the queue is full of more urgent requests
+        EXPIRED     // the deadline passed before it could run
+    };
+    
+    struct Metrics {
+        Metrics() : active(0), queued(0), admitted(0), rejected(0), expired(0), numWaits(0) { }
+        
+        size_t active;
+        size_t queued;
+        unsigned long long admitted;
+        unsigned long long rejected;
+        unsigned long long expired;
+        
+        // time spent waiting by the requests that had to wait
+        unsigned long long numWaits;
+        Timespan totalWait;
+        Timespan maxWait;
+    };
+    
+    ofxHTTPServerScheduler(const Settings& _settings = Settings());
+    virtual ~ofxHTTPServerScheduler();
+    
+    // waits until the request may run or must be dropped
+    Admission admit(int priority, const Timestamp& deadline);
+    void release();
+    
+    // now plus the route's deadline, or the client's timeout if sooner
+    Timestamp getDeadline(const HTTPServerRequest& request, const Timespan& routeDeadline) const;
+    
+    Metrics getMetrics() const;
+    
+    // the most server threads the scheduled requests hold at once,
+    // running or waiting
+    size_t getMaxThreads() const;
+    
+    struct Settings {
+        size_t maxConcurrent;
+        size_t maxQueued;
+        string timeoutHeader;   // milliseconds, empty to ignore clients
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings = Settings());
+    
+protected:
+    struct Key {
+        int priority;
+        Timestamp deadline;
+        unsigned long long sequence;
+        
+        // the most urgent first
+        bool operator<(const Key& other) const {
+            if(priority != other.priority) return priority > other.priority;
+            if(deadline != other.deadline) return deadline < other.deadline;
+            return sequence < other.sequence;
+        }
+    };
+    
+    struct Waiter {
+        Waiter() : bAdmitted(false), bRejected(false), bExpired(false) { }
+        
+        Poco::Event event;
+        bool bAdmitted;
+        bool bRejected;
+        bool bExpired;
+    };
+    
+    typedef map<Key, Waiter*> Queue;
+    
+    // expected to hold the mutex
+    void admitNext();
+    void recordWait(const Timestamp& enqueued);
+    
+    Settings settings;
+    
+    mutable ofMutex mutex;
+    
+    Queue queue;
+    unsigned long long sequence;
+    
+    Metrics metrics;
+    
+};
+
+// Runs another route's handler once the scheduler admits it.
+//------------------------------------------------------------------------------
+class ofxHTTPServerScheduledHandler : public ofxHTTPServerDecoratorHandler {
+public:
+    ofxHTTPServerScheduledHandler(HTTPRequestHandler* _handler,
+                                  ofxHTTPServerScheduler::Ptr _scheduler,
+                                  int _priority,
+                                  const Timespan& _deadline);
+    virtual ~ofxHTTPServerScheduledHandler();
+    
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
+    
+protected:
+    ofxHTTPServerScheduler::Ptr scheduler;
+    int priority;
+    Timespan deadline;
+    
+};
@@ -0,0 +1,411 @@
+#include "ofxHTTPServerSessionLogStore.h"
+
+#include <cstring>
+#include <map>
+
+#include "Poco/Checksum.h"
+#include "Poco/Exception.h"
+#include "Poco/File.h"
+#include "Poco/SharedMemory.h"
+#include "Poco/Types.h"
+
+#include "ofLog.h"
+#include "ofUtils.h"
+
+using std::map;
+
+using Poco::Checksum;
+using Poco::Exception;
+using Poco::Int64;
+using Poco::SharedMemory;
+using Poco::UInt16;
+using Poco::UInt32;
+using Poco::UInt64;
+
+namespace {
+
+    const char   MAGIC[]     = "OFXSESS1";
+    const size_t MAGIC_SIZE  = 8;
+    const size_t HEADER_SIZE = 1 + 2 + 4 + 8; // type, key length, data length, expires
+    const size_t CRC_SIZE    = 4;
+
+    //--------------------------------------------------------------------------
+    void appendLE(string& buffer, UInt64 value, size_t numBytes) {
+        for(size_t i = 0; i < numBytes; ++i) {
+            buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    UInt64 readLE(const char* data, size_t numBytes) {
+        UInt64 value = 0;
+        for(size_t i = 0; i < numBytes; ++i) {
+            value |= static_cast<UInt64>(static_cast<unsigned char>(data[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    //--------------------------------------------------------------------------
+    bool isEncodable(const string& key, const string& data) {
+        return key.size() <= 0xFFFF && data.size() <= 0xFFFFFFFFULL;
+    }
+
+    //--------------------------------------------------------------------------
+    UInt32 crc32(const char* data, size_t length) {
+        Checksum checksum(Checksum::TYPE_CRC32);
+        checksum.update(data, static_cast<unsigned>(length));
+        return checksum.checksum();
+    }
+
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSessionLogStore::Settings::Settings() {
+    path              = "sessions.log";
+    minCompactionSize = 1024 * 1024; // 1 MB
+    compactionRatio   = 2.0;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSessionLogStore::ofxHTTPServerSessionLogStore(const Settings& _settings) :
+settings(_settings),
+logSize(0),
+snapshotSize(0),
+numWriteErrors(0),
+bNeedsRewrite(false),
+bCompacting(false)
+{
+    settings.path = ofToDataPath(settings.path, true);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSessionLogStore::~ofxHTTPServerSessionLogStore() {
+    ofScopedLock lock(mutex);
+    if(log.is_open()) {
+        log.close();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSessionLogStore::load(vector<Record>& records) {
+    ofScopedLock lock(mutex);
+
+    records.clear();
+
+    Poco::File file(settings.path);
+
+    size_t validSize = 0;
+
+    try {
+        if(file.exists() && file.getSize() >= MAGIC_SIZE) {
+            map<string, Record> live;
+
+            SharedMemory memory(file, SharedMemory::AM_READ);
+
+            const char* data = memory.begin();
+            size_t size = static_cast<size_t>(memory.end() - memory.begin());
+
+            if(memcmp(data, MAGIC, MAGIC_SIZE) != 0) {
+                ofLogError("ofxHTTPServerSessionLogStore::load") << settings.path << " is not a session log.";
+                return false;
+            }
+
+            size_t offset = MAGIC_SIZE;
+
+            while(offset + HEADER_SIZE + CRC_SIZE <= size) {
+                const char* header = data + offset;
+
+                int    type       = static_cast<int>(readLE(header, 1));
+                size_t keyLength  = static_cast<size_t>(readLE(header + 1, 2));
+                size_t dataLength = static_cast<size_t>(readLE(header + 3, 4));
+                Int64  expires    = static_cast<Int64>(readLE(header + 7, 8));
+
+                size_t recordSize = HEADER_SIZE + keyLength + dataLength + CRC_SIZE;
+
+                if(offset + recordSize > size ||
+                   crc32(header, recordSize - CRC_SIZE) != static_cast<UInt32>(readLE(header + recordSize - CRC_SIZE, CRC_SIZE))) {
+                    ofLogWarning("ofxHTTPServerSessionLogStore::load") << "Dropping a torn record at " << offset << ".";
+                    break;
+                }
+
+                string key(header + HEADER_SIZE, keyLength);
+
+                if(type == RECORD_PUT) {
+                    Record& record = live[key];
+                    record.key     = key;
+                    record.data.assign(header + HEADER_SIZE + keyLength, dataLength);
+                    record.expires = Timestamp(expires);
+                } else {
+                    live.erase(key);
+                }
+
+                offset += recordSize;
+            }
+
+            validSize = offset;
+
+            Timestamp now;
+
+            map<string, Record>::const_iterator iter = live.begin();
+            while(iter != live.end()) {
+                if(now < (*iter).second.expires) {
+                    records.push_back((*iter).second);
+                }
+                ++iter;
+            }
+        }
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServerSessionLogStore::load") << exc.displayText();
+        return false;
+    }
+
+    // appends continue after the last good record
+    try {
+        if(validSize > 0 && file.getSize() > validSize) {
+            file.setSize(validSize);
+        }
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServerSessionLogStore::load") << exc.displayText();
+        return false;
+    }
+
+    if(!openLog(validSize == 0)) {
+        return false;
+    }
+
+    logSize      = validSize > 0 ? validSize : MAGIC_SIZE;
+    snapshotSize = logSize;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSessionLogStore::put(const string& key, const string& data, const Timestamp& expires) {
+    ofScopedLock lock(mutex);
+    append(RECORD_PUT, key, data, expires);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSessionLogStore::remove(const string& key) {
+    ofScopedLock lock(mutex);
+    append(RECORD_REMOVE, key, "", Timestamp(0));
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSessionLogStore::flush() {
+    ofScopedLock lock(mutex);
+    // handing the data to the OS is enough to survive a process restart
+    if(log.is_open()) {
+        log.flush();
+        if(!log) {
+            writeFailed("ofxHTTPServerSessionLogStore::flush");
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSessionLogStore::needsCompaction() {
+    ofScopedLock lock(mutex);
+    return !bCompacting &&
+           (bNeedsRewrite ||
+            (logSize > settings.minCompactionSize &&
+             logSize > snapshotSize * settings.compactionRatio));
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSessionLogStore::beginCompaction() {
+    ofScopedLock lock(mutex);
+    bCompacting = true;
+    pendingRecords.clear();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSessionLogStore::compact(const vector<Record>& records) {
+    // settings.path doesn't change after construction, so the bulk of the
+    // snapshot is written without the lock while puts and removes go on.
+    string tempPath = settings.path + ".tmp";
+
+    unsigned long long size = 0;
+
+    try {
+        std::ofstream snapshot(tempPath.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+        string buffer(MAGIC, MAGIC_SIZE);
+
+        for(size_t i = 0; i < records.size(); ++i) {
+            if(!isEncodable(records[i].key, records[i].data)) {
+                continue;
+            }
+
+            encode(buffer, RECORD_PUT, records[i].key, records[i].data, records[i].expires);
+
+            if(buffer.size() >= 64 * 1024) {
+                snapshot.write(buffer.data(), buffer.size());
+                size += buffer.size();
+                buffer.clear();
+            }
+        }
+
+        snapshot.write(buffer.data(), buffer.size());
+        size += buffer.size();
+
+        snapshot.close();
+
+        if(!snapshot) {
+            throw Poco::WriteFileException(tempPath);
+        }
+    } catch(const Exception& exc) {
+        ofScopedLock lock(mutex);
+        ofLogError("ofxHTTPServerSessionLogStore::compact") << exc.displayText();
+        ++numWriteErrors;
+        bCompacting = false;
+        pendingRecords.clear();
+        return;
+    }
+
+    ofScopedLock lock(mutex);
+
+    try {
+        // what changed since beginCompaction(), on top of the snapshot
+        std::ofstream snapshot(tempPath.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+
+        string buffer;
+
+        for(size_t i = 0; i < pendingRecords.size(); ++i) {
+            const PendingRecord& pending = pendingRecords[i];
+            encode(buffer, pending.type, pending.record.key, pending.record.data, pending.record.expires);
+        }
+
+        snapshot.write(buffer.data(), buffer.size());
+        size += buffer.size();
+
+        snapshot.close();
+
+        if(!snapshot) {
+            throw Poco::WriteFileException(tempPath);
+        }
+
+        log.close();
+        Poco::File(tempPath).renameTo(settings.path);
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServerSessionLogStore::compact") << exc.displayText();
+        ++numWriteErrors;
+        // keep appending to whichever log is there
+        if(!log.is_open()) {
+            openLog(false);
+        }
+        bCompacting = false;
+        pendingRecords.clear();
+        return;
+    }
+
+    openLog(false);
+
+    logSize       = size;
+    snapshotSize  = size;
+    bNeedsRewrite = false;
+
+    bCompacting = false;
+    pendingRecords.clear();
+}
+
+//------------------------------------------------------------------------------
+unsigned long long ofxHTTPServerSessionLogStore::getLogSize() const {
+    ofScopedLock lock(mutex);
+    return logSize;
+}
+
+//------------------------------------------------------------------------------
+unsigned long long ofxHTTPServerSessionLogStore::getNumWriteErrors() const {
+    ofScopedLock lock(mutex);
+    return numWriteErrors;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSessionLogStore::openLog(bool bTruncate) {
+    if(log.is_open()) {
+        log.close();
+    }
+
+    log.clear();
+
+    if(bTruncate) {
+        log.open(settings.path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        log.write(MAGIC, MAGIC_SIZE);
+    } else {
+        log.open(settings.path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+    }
+
+    if(!log) {
+        ofLogError("ofxHTTPServerSessionLogStore::openLog") << "Unable to open " << settings.path;
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSessionLogStore::append(RecordType type, const string& key, const string& data, const Timestamp& expires) {
+    if(!log.is_open()) {
+        return; // not loaded
+    }
+
+    if(!isEncodable(key, data)) {
+        ofLogError("ofxHTTPServerSessionLogStore::append") << "Session too large to store: " << key;
+        return;
+    }
+
+    // kept for the snapshot even if the write below fails
+    if(bCompacting) {
+        PendingRecord pending;
+        pending.type           = type;
+        pending.record.key     = key;
+        pending.record.data    = data;
+        pending.record.expires = expires;
+        pendingRecords.push_back(pending);
+    }
+
+    string buffer;
+    encode(buffer, type, key, data, expires);
+
+    log.write(buffer.data(), buffer.size());
+
+    if(!log) {
+        writeFailed("ofxHTTPServerSessionLogStore::append");
+        return;
+    }
+
+    logSize += buffer.size();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSessionLogStore::writeFailed(const string& method) {
+    ofLogError(method) << "Unable to write " << settings.path;
+    ++numWriteErrors;
+    // a partly written record would hide everything after it on load
+    bNeedsRewrite = true;
+    log.clear();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSessionLogStore::encode(string& buffer,
+                                          RecordType type,
+                                          const string& key,
+                                          const string& data,
+                                          const Timestamp& expires) {
+    size_t start = buffer.size();
+
+    appendLE(buffer, static_cast<UInt64>(type), 1);
+    appendLE(buffer, static_cast<UInt64>(key.size()), 2);
+    appendLE(buffer, static_cast<UInt64>(data.size()), 4);
+    appendLE(buffer, static_cast<UInt64>(expires.epochMicroseconds()), 8);
+    buffer += key;
+    buffer += data;
+
+    appendLE(buffer, crc32(buffer.data() + start, buffer.size() - start), CRC_SIZE);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSessionLogStore::Ptr ofxHTTPServerSessionLogStore::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerSessionLogStore(settings));
+}
@@ -0,0 +1,120 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Poco/Timestamp.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPBaseTypes.h"
+
+using std::string;
+using std::vector;
+
+using Poco::Timestamp;
+
+// Persists sessions in a compact binary log.  Every put and remove is
+// appended, so saving a change costs a single buffered write, and the log
+// is periodically rewritten as a snapshot of the live sessions.  At
+// startup, the log is memory mapped and replayed.  A torn record at the
+// end, left by a crash, is detected by its checksum and dropped.
+//
+//     file   := "OFXSESS1" record*
+//     record := type:u8 keyLength:u16 dataLength:u32 expires:i64 key data crc32:u32
+//
+// Integers are little endian.  The crc covers everything before it.
+class ofxHTTPServerSessionLogStore : public ofxBaseHTTPServerSessionStore {
+public:
+    struct Settings;
+
+    typedef ofPtr<ofxHTTPServerSessionLogStore> Ptr;
+
+    ofxHTTPServerSessionLogStore(const Settings& _settings);
+    virtual ~ofxHTTPServerSessionLogStore();
+
+    bool load(vector<Record>& records);
+
+    void put(const string& key, const string& data, const Timestamp& expires);
+    void remove(const string& key);
+
+    void flush();
+
+    bool needsCompaction();
+    void beginCompaction();
+    void compact(const vector<Record>& records);
+
+    unsigned long long getLogSize() const;
+
+    // failed appends, flushes and compactions.  After a failed write the
+    // log may end in a partial record, so it is rewritten by the next
+    // compaction.
+    unsigned long long getNumWriteErrors() const;
+
+    struct Settings {
+        string path; // relative to the data folder
+        unsigned long long minCompactionSize; // don't bother below this
+        double compactionRatio; // compact when the log is this much larger than the last snapshot
+
+        Settings();
+    };
+
+    static Ptr Instance(const Settings& settings = Settings());
+
+protected:
+    enum RecordType {
+        RECORD_PUT    = 1,
+        RECORD_REMOVE = 2
+    };
+
+    struct PendingRecord {
+        RecordType type;
+        Record record;
+    };
+
+    // all calls are expected to hold the mutex
+    bool openLog(bool bTruncate);
+    void append(RecordType type, const string& key, const string& data, const Timestamp& expires);
+    void writeFailed(const string& method);
+
+    static void encode(string& buffer, RecordType type, const string& key, const string& data, const Timestamp& expires);
+
+    Settings settings;
+
+    std::ofstream log;
+    unsigned long long logSize;
+    unsigned long long snapshotSize;
+    unsigned long long numWriteErrors;
+    bool bNeedsRewrite;
+
+    bool bCompacting;
+    vector<PendingRecord> pendingRecords; // changes made while compacting
+
+    mutable ofMutex mutex;
+
+};
@@ -0,0 +1,36 @@
+#include "ofxHTTPServerSocketImpl.h"
+
+#include "Poco/Thread.h"
+#include "Poco/Net/Socket.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSocketImpl::ofxHTTPServerSocketImpl() : bAccepting(true) { }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSocketImpl::ofxHTTPServerSocketImpl(poco_socket_t sockfd) : bAccepting(true) {
+    reset(sockfd);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerSocketImpl::~ofxHTTPServerSocketImpl() { }
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSocketImpl::poll(const Timespan& timeout, int mode) {
+    if((mode & Poco::Net::Socket::SELECT_READ) && !isAccepting()) {
+        Poco::Thread::sleep(static_cast<long>(timeout.totalMilliseconds()));
+        return false;
+    }
+    return ServerSocketImpl::poll(timeout, mode);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerSocketImpl::setAccepting(bool _bAccepting) {
+    ofScopedLock lock(mutex);
+    bAccepting = _bAccepting;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerSocketImpl::isAccepting() const {
+    ofScopedLock lock(mutex);
+    return bAccepting;
+}
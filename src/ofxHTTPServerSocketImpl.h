@@ -0,0 +1,57 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+
+#pragma once
+
+#include "Poco/Timespan.h"
+#include "Poco/Net/ServerSocketImpl.h"
+
+#include "ofTypes.h"
+
+using Poco::Timespan;
+using Poco::Net::ServerSocketImpl;
+
+// A listening socket that can be told to stop accepting without being
+// closed, so that another process can take over its accept queue.  It can
+// also adopt a listening descriptor inherited from another process.
+class ofxHTTPServerSocketImpl : public ServerSocketImpl {
+public:
+    ofxHTTPServerSocketImpl();
+    ofxHTTPServerSocketImpl(poco_socket_t sockfd); // takes ownership
+
+    // while not accepting, read polls wait out their timeout and report
+    // nothing, so the TCPServer polling us never calls accept.
+    bool poll(const Timespan& timeout, int mode);
+
+    void setAccepting(bool _bAccepting);
+    bool isAccepting() const;
+
+protected:
+    virtual ~ofxHTTPServerSocketImpl();
+
+    mutable ofMutex mutex;
+    bool bAccepting;
+
+};
@@ -0,0 +1,255 @@
+#include "ofxHTTPServerStreamWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "Poco/Exception.h"
+#include "Poco/Net/HTTPMessage.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/NetException.h"
+
+using std::ostringstream;
+
+using Poco::Net::HTTPMessage;
+using Poco::Net::HTTPRequest;
+
+//------------------------------------------------------------------------------
+ofxHTTPServerStreamWriter::Settings::Settings() {
+    coalesceSize = 16 * 1024; // 16 KB
+    sendTimeout  = Timespan(30 * Timespan::SECONDS);
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerStreamWriter::ofxHTTPServerStreamWriter(ofxHTTPServerExchange& _exchange,
+                                                     ofxHTTPBufferPool& _pool,
+                                                     const Settings& _settings) :
+exchange(_exchange),
+pool(_pool),
+settings(_settings),
+pResponseImpl(NULL),
+buffer(NULL),
+capacity(0),
+numBuffered(0),
+bBegun(false),
+bChunked(false),
+bHead(false),
+bFinished(false),
+numBytesWritten(0)
+{
+    HTTPServerRequestImpl* pRequestImpl = dynamic_cast<HTTPServerRequestImpl*>(&exchange.request);
+    
+    if(pRequestImpl == NULL) {
+        throw Poco::InvalidArgumentException("Only requests read by the server can be streamed to.");
+    }
+    
+    pResponseImpl = dynamic_cast<ofxHTTPServerResponseImpl*>(&exchange.response);
+    
+    if(pResponseImpl == NULL) {
+        throw Poco::InvalidArgumentException("Only responses sent by the server can be streamed.");
+    }
+    
+    if(pool.getBufferSize() <= HEADER_SIZE + 2) {
+        throw Poco::InvalidArgumentException("The pool's buffers are too small to stream with.");
+    }
+    
+    socket   = pRequestImpl->socket();
+    bHead    = exchange.request.getMethod() == HTTPRequest::HTTP_HEAD;
+    bChunked = exchange.request.getVersion() == HTTPMessage::HTTP_1_1;
+    
+    buffer   = pool.acquire();
+    capacity = pool.getBufferSize() - HEADER_SIZE - 2; // and the trailing CRLF
+    
+    settings.coalesceSize = std::max<size_t>(1, std::min(settings.coalesceSize, capacity));
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerStreamWriter::~ofxHTTPServerStreamWriter() {
+    if(bBegun && !bFinished) {
+        exchange.response.setKeepAlive(false);
+        try {
+            socket.shutdown();
+        } catch(const Poco::Exception&) {
+            // already gone
+        }
+    }
+    
+    if(bBegun) {
+        restoreSendTimeout();
+    }
+    
+    pool.release(buffer);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerStreamWriter::begin() {
+    if(bBegun) {
+        return;
+    }
+    
+    bBegun = true;
+    
+    // from here on the client has bytes, so a failure must not be
+    // answered with another response
+    pResponseImpl->setSentDirectly();
+    
+    HTTPServerResponse& response = exchange.response;
+    
+    if(bChunked) {
+        response.setChunkedTransferEncoding(true);
+        
+        if(!settings.trailerNames.empty()) {
+            string names;
+            for(size_t i = 0; i < settings.trailerNames.size(); ++i) {
+                names += (i > 0 ? ", " : "") + settings.trailerNames[i];
+            }
+            response.set("Trailer", names);
+        }
+    } else {
+        response.setChunkedTransferEncoding(false);
+        if(!response.hasContentLength()) {
+            response.setKeepAlive(false); // the end of the body is the end of the connection
+        }
+    }
+    
+    previousSendTimeout = socket.getSendTimeout();
+    socket.setSendTimeout(settings.sendTimeout);
+    
+    ostringstream ostr;
+    response.write(ostr);
+    
+    string header = ostr.str();
+    send(header.data(), header.size());
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerStreamWriter::write(const char* data, size_t length) {
+    if(bFinished) {
+        throw Poco::IllegalStateException("The stream is finished.");
+    }
+    
+    begin();
+    
+    if(bHead) {
+        numBytesWritten += length;
+        return;
+    }
+    
+    while(length > 0) {
+        size_t n = std::min(length, capacity - numBuffered);
+        
+        memcpy(buffer + HEADER_SIZE + numBuffered, data, n);
+        
+        numBuffered     += n;
+        numBytesWritten += n;
+        data   += n;
+        length -= n;
+        
+        if(numBuffered >= settings.coalesceSize) {
+            flush();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerStreamWriter::write(const string& data) {
+    write(data.data(), data.size());
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerStreamWriter::flush() {
+    begin();
+    
+    if(numBuffered == 0) {
+        return;
+    }
+    
+    if(!bChunked) {
+        send(buffer + HEADER_SIZE, numBuffered);
+        numBuffered = 0;
+        return;
+    }
+    
+    // the size goes right in front of the data, so the chunk is one send
+    char size[HEADER_SIZE + 1];
+    int sizeLength = snprintf(size, sizeof(size), "%lx\r\n", static_cast<unsigned long>(numBuffered));
+    
+    char* start = buffer + HEADER_SIZE - sizeLength;
+    memcpy(start, size, sizeLength);
+    
+    char* end = buffer + HEADER_SIZE + numBuffered;
+    end[0] = '\r';
+    end[1] = '\n';
+    
+    send(start, sizeLength + numBuffered + 2);
+    
+    numBuffered = 0;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerStreamWriter::finish(const NameValueCollection& trailers) {
+    if(bFinished) {
+        return;
+    }
+    
+    flush();
+    
+    bFinished = true;
+    
+    if(!bChunked || bHead) {
+        restoreSendTimeout();
+        return;
+    }
+    
+    string last = "0\r\n";
+    
+    NameValueCollection::ConstIterator iter = trailers.begin();
+    while(iter != trailers.end()) {
+        last += (*iter).first + ": " + (*iter).second + "\r\n";
+        ++iter;
+    }
+    
+    last += "\r\n";
+    
+    send(last.data(), last.size());
+    
+    restoreSendTimeout();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerStreamWriter::isChunked() const {
+    return bChunked;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerStreamWriter::isFinished() const {
+    return bFinished;
+}
+
+//------------------------------------------------------------------------------
+unsigned long long ofxHTTPServerStreamWriter::getNumBytesWritten() const {
+    return numBytesWritten;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerStreamWriter::send(const char* data, size_t length) {
+    // blocks while the client is slow, up to the send timeout
+    while(length > 0) {
+        int n = socket.sendBytes(data, static_cast<int>(length));
+        if(n <= 0) {
+            throw Poco::Net::NetException("Unable to send the stream.");
+        }
+        data   += n;
+        length -= n;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerStreamWriter::restoreSendTimeout() {
+    try {
+        socket.setSendTimeout(previousSendTimeout);
+    } catch(const Poco::Exception&) {
+        // the socket is gone, nothing to restore
+    }
+}
@@ -0,0 +1,136 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Poco/Timespan.h"
+#include "Poco/Net/NameValueCollection.h"
+#include "Poco/Net/StreamSocket.h"
+
+#include "ofxHTTPBufferPool.h"
+#include "ofxHTTPServerExchange.h"
+
+using std::string;
+using std::vector;
+
+using Poco::Timespan;
+using Poco::Net::NameValueCollection;
+using Poco::Net::StreamSocket;
+
+// Streams a response body in chunks of the handler's choosing.
+//
+// Small writes are collected in a buffer borrowed from a pool and sent as
+// one chunk once coalesceSize bytes are waiting, or when the handler calls
+// flush(), e.g. at the end of each message.  Each chunk goes out with its
+// framing in a single send, and a stream never holds more than its one
+// buffer.  Writes block while the client is slow to read, for at most
+// sendTimeout, which holds the producer back instead of queueing.
+//
+//     ofxHTTPServerStreamWriter writer(exchange, pool);
+//     while(bRunning) {
+//         writer.write(nextLogLine());
+//         writer.flush();
+//     }
+//     writer.finish();
+//
+// HTTP/1.0 clients get the body unframed and the connection is closed at
+// the end, so trailers are only sent to HTTP/1.1 clients.  Status and
+// headers are set on the exchange's response before the first write, and
+// the writer sends them itself, so response.send() must not be called.
+// Only responses made by the server's connections can be streamed; a
+// buffered response, e.g. behind a cached route, is refused.  The socket's
+// send timeout is put back when the stream is finished.
+class ofxHTTPServerStreamWriter {
+public:
+    struct Settings;
+    
+    ofxHTTPServerStreamWriter(ofxHTTPServerExchange& _exchange,
+                              ofxHTTPBufferPool& _pool,
+                              const Settings& _settings = Settings());
+    
+    // a stream that wasn't finished is cut off, so the client can't take
+    // it for complete
+    virtual ~ofxHTTPServerStreamWriter();
+    
+    // sends the status line and headers, done by the first write or flush
+    void begin();
+    
+    void write(const char* data, size_t length);
+    void write(const string& data);
+    
+    // sends what is buffered as one chunk
+    void flush();
+    
+    // sends the last chunk and the trailers, which should have been named
+    // in settings.trailerNames
+    void finish(const NameValueCollection& trailers = NameValueCollection());
+    
+    bool isChunked() const;
+    bool isFinished() const;
+    unsigned long long getNumBytesWritten() const;
+    
+    struct Settings {
+        size_t coalesceSize;            // at most the pool's buffer size
+        Timespan sendTimeout;
+        vector<string> trailerNames;    // announced in the Trailer header
+        
+        Settings();
+    };
+    
+protected:
+    enum {
+        HEADER_SIZE = 18    // hex length, CRLF and some room
+    };
+    
+    void send(const char* data, size_t length);
+    void restoreSendTimeout();
+    
+    ofxHTTPServerExchange& exchange;
+    ofxHTTPBufferPool& pool;
+    Settings settings;
+    
+    ofxHTTPServerResponseImpl* pResponseImpl;
+    
+    StreamSocket socket;
+    Timespan previousSendTimeout;
+    
+    char* buffer;
+    size_t capacity;            // for chunk data
+    size_t numBuffered;
+    
+    bool bBegun;
+    bool bChunked;
+    bool bHead;
+    bool bFinished;
+    
+    unsigned long long numBytesWritten;
+    
+private:
+    ofxHTTPServerStreamWriter(const ofxHTTPServerStreamWriter&);
+    ofxHTTPServerStreamWriter& operator = (const ofxHTTPServerStreamWriter&);
+    
+};
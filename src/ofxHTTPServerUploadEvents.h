@@ -0,0 +1,73 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+
+#include "ofEvents.h"
+#include "ofEventUtils.h"
+
+using std::string;
+
+class ofxHTTPServerUploadEventArgs {
+public:
+    ofxHTTPServerUploadEventArgs(const string& _fieldName,
+                                 const string& _originalFileName,
+                                 const string& _fileName,
+                                 const string& _contentType,
+                                 unsigned long long _numBytesUploaded,
+                                 long long _requestContentLength,
+                                 const string& _error = "") :
+    fieldName(_fieldName),
+    originalFileName(_originalFileName),
+    fileName(_fileName),
+    contentType(_contentType),
+    numBytesUploaded(_numBytesUploaded),
+    requestContentLength(_requestContentLength),
+    error(_error),
+    bDuplicate(false)
+    { }
+
+    bool hasError() const { return !error.empty(); }
+
+    string fieldName;
+    string originalFileName;      // as sent by the client
+    string fileName;              // where it was stored, empty until finished
+    string contentType;
+    unsigned long long numBytesUploaded;
+    long long requestContentLength; // -1 if unknown (chunked)
+    string error;
+    string digest;                // hex SHA-256, set when finished
+    bool bDuplicate;              // the content was already stored
+};
+
+// Upload events are notified from the server's worker threads.
+class ofxHTTPServerUploadEvents {
+public:
+    ofEvent<ofxHTTPServerUploadEventArgs> onUploadStartedEvent;
+    ofEvent<ofxHTTPServerUploadEventArgs> onUploadProgressEvent;
+    ofEvent<ofxHTTPServerUploadEventArgs> onUploadFinishedEvent;
+    ofEvent<ofxHTTPServerUploadEventArgs> onUploadFailedEvent;
+};
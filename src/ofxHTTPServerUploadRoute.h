@@ -24,41 +24,89 @@
 
 #pragma once
 
-#include "ofxHTTPServerBaseRoute.h"
+#include "Poco/RegularExpression.h"
+#include "Poco/URI.h"
+#include "Poco/Net/HTTPRequest.h"
+
+#include "ofFileUtils.h"
+#include "ofLog.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPBufferPool.h"
+#include "ofxHTTPServerUploadEvents.h"
 #include "ofxHTTPServerUploadRouteHandler.h"
 
-typedef ofxHTTPServerUploadRouteHandler::Settings Settings; // to keep the lines shorter.
+using Poco::RegularExpression;
+using Poco::SyntaxException;
+using Poco::URI;
+using Poco::Net::HTTPRequest;
 
 //------------------------------------------------------------------------------
-class ofxHTTPServerUploadRoute : public ofxHTTPServerBaseRoute {
+class ofxHTTPServerUploadRoute : public ofxBaseHTTPServerRoute {
 public:
+    typedef ofxHTTPServerUploadRouteHandler::Settings Settings;
+    typedef ofPtr<ofxHTTPServerUploadRoute> Ptr;
 
-    ofxHTTPServerUploadRoute(const Settings& _settings) : settings(_settings) {
+    ofxHTTPServerUploadRoute(const Settings& _settings = Settings()) :
+    settings(_settings),
+    readBufferPool(ofxHTTPBufferPool::Instance(_settings.readBufferSize)),
+    writeBufferPool(ofxHTTPBufferPool::Instance(_settings.writeBufferSize, 4 * _settings.fileSinkSettings.numBuffers))
+    {
         ofDirectory uploadsDirectory(settings.uploadFolder);
-        if(!uploadsDirectory.exists()) {
+        if(settings.bAutoCreateUploadFolder &&
+           !uploadsDirectory.exists()) {
             uploadsDirectory.create();
         }
     }
 
     virtual ~ofxHTTPServerUploadRoute() { }
     
-    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
-        if(ofxHTTPServerUploadRouteHandler::matchRoute(URI(request.getURI()), settings.route)) {
-            return new ofxHTTPServerUploadRouteHandler(settings);
-        } else {
-            return NULL;
+    bool canHandleRequest(const HTTPServerRequest& request, bool bIsSecurePort) {
+        // require HTTP_POST
+        if(request.getMethod() != HTTPRequest::HTTP_POST) return false;
+        
+        // require a valid path
+        URI uri;
+        try {
+            uri = URI(request.getURI());
+        } catch(const SyntaxException& exc) {
+            ofLogError("ofxHTTPServerUploadRoute::canHandleRequest") << exc.what();
+            return false;
         }
+        
+        // just get the path
+        string path = uri.getPath();
+        // make paths absolute
+        if(path.empty()) { path = "/"; }
+        
+        return RegularExpression(settings.route).match(path);
+    }
+    
+    ofxHTTPServerBodyLimits getBodyLimits(const HTTPServerRequest& request) {
+        ofxHTTPServerBodyLimits limits;
+        limits.maxBodySize = settings.maxRequestSize;
+        limits.acceptedContentTypes.push_back(MediaType("multipart/form-data"));
+        return limits;
+    }
+    
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) {
+        return new ofxHTTPServerUploadRouteHandler(settings,
+                                                   *readBufferPool,
+                                                   *writeBufferPool,
+                                                   events);
     }
     
-    static ofPtr<ofxHTTPServerUploadRoute> Instance(const Settings& settings = Settings::Settings()) {
-        return ofPtr<ofxHTTPServerUploadRoute>(new ofxHTTPServerUploadRoute(settings));
+    static Ptr Instance(const Settings& settings = Settings()) {
+        return Ptr(new ofxHTTPServerUploadRoute(settings));
     }
+    
+    ofxHTTPServerUploadEvents events;
 
 protected:
-    Settings::Settings settings;
+    Settings settings;
+    
+    // shared by all of the route's requests
+    ofxHTTPBufferPool::Ptr readBufferPool;
+    ofxHTTPBufferPool::Ptr writeBufferPool;
     
 };
-
-
-
-
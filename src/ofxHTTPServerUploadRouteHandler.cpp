@@ -1,135 +1,567 @@
 #include "ofxHTTPServerUploadRouteHandler.h"
 
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "Poco/AtomicCounter.h"
+#include "Poco/File.h"
+#include "Poco/String.h"
+#include "Poco/Timestamp.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+    //--------------------------------------------------------------------------
+    string escapeJSON(const string& value) {
+        string escaped;
+        for(size_t i = 0; i < value.size(); ++i) {
+            unsigned char c = value[i];
+            switch(c) {
+                case '"':  escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n";  break;
+                case '\r': escaped += "\\r";  break;
+                case '\t': escaped += "\\t";  break;
+                default:
+                    if(c < 0x20) {
+                        char code[8];
+                        sprintf(code, "\\u%04x", c);
+                        escaped += code;
+                    } else {
+                        escaped += c;
+                    }
+            }
+        }
+        return escaped;
+    }
+
+    Poco::AtomicCounter uploadCounter;
+
+}
+
 //------------------------------------------------------------------------------
 ofxHTTPServerUploadRouteHandler::Settings::Settings() {
+    route = "/upload";
+    
     bRequireUploadFolderInDataFolder = true;
     uploadFolder = "uploads";
     bAutoCreateUploadFolder = false;
     
     uploadRedirect = "uploaded.html";
     
-    writeBufferSize = 8192;
-};
+    readBufferSize  = 64 * 1024;   // 64 KB
+    writeBufferSize = 1024 * 1024; // 1 MB
+    
+    maxFileSize    = 512ULL * 1024 * 1024;  // 512 MB
+    maxRequestSize = 1024ULL * 1024 * 1024; // 1 GB
+    maxFieldSize   = 64 * 1024;             // 64 KB
+    
+    progressInterval = 1024 * 1024; // 1 MB
+    
+    bComputeDigest    = true;
+    bContentAddressed = false;
+    contentFolder     = ".content";
+}
 
 //------------------------------------------------------------------------------
-ofxHTTPServerUploadRouteHandler::ofxHTTPServerUploadRouteHandler(const Settings& _settings)
-:
-settings(_settings)
+ofxHTTPServerUploadRouteHandler::ofxHTTPServerUploadRouteHandler(const Settings& _settings,
+                                                                 ofxHTTPBufferPool& _readBufferPool,
+                                                                 ofxHTTPBufferPool& _writeBufferPool,
+                                                                 ofxHTTPServerUploadEvents& _events) :
+settings(_settings),
+readBufferPool(_readBufferPool),
+writeBufferPool(_writeBufferPool),
+events(_events),
+requestContentLength(HTTPMessage::UNKNOWN_CONTENT_LENGTH),
+errorStatus(HTTPResponse::HTTP_OK),
+bPartIsFile(false),
+partSize(0),
+partNextProgress(0),
+writeBuffer(NULL),
+writeBufferFill(0)
 { }
 
 //------------------------------------------------------------------------------
 ofxHTTPServerUploadRouteHandler::~ofxHTTPServerUploadRouteHandler() { }
 
 //------------------------------------------------------------------------------
-void ofxHTTPServerUploadRouteHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) {
-//    if(isValidRequest(request,response,settings.route)) {
-//        
-//        Path dataFolder(ofToDataPath("",true));
-//        Path uploadFolder(ofToDataPath(settings.uploadFolder,true));
-//        
-//        string dataFolderString = dataFolder.toString();
-//        string uploadFolderString = uploadFolder.toString();
-//        
-//        // upload folder validity check
-//        if(settings.bRequireUploadFolderInDataFolder &&
-//           (uploadFolderString.length() < dataFolderString.length() ||
-//            uploadFolderString.substr(0,dataFolderString.length()) != dataFolderString)) {
-//               ofLogError("ofxHTTPServerUploadRouteHandler::handleRequest") << "Upload folder is not a sub directory of the data folder.";
-//               response.setStatusAndReason(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-//               sendErrorResponse(response);
-//               return;
-//        }
-//
-//        HTMLForm form(request, request.stream(), *this);
-//        
-//        if(!settings.uploadRedirect.empty()) {
-//            response.redirect(settings.uploadRedirect);
-//        } else {
-//            response.setStatusAndReason(HTTPResponse::HTTP_OK);
-//            response.setContentLength(0);
-//            response.send();
-//        }
-//    } else {
-//        return; // isValidRequest took care of the response
-//    }
+void ofxHTTPServerUploadRouteHandler::handleExchange(ofxHTTPServerExchange& exchange) {
+    Path dataFolder(ofToDataPath("",true));
+    uploadFolder = Path(ofToDataPath(settings.uploadFolder,true));
+    
+    string dataFolderString = dataFolder.toString();
+    string uploadFolderString = uploadFolder.toString();
+    
+    // upload folder validity check
+    if(settings.bRequireUploadFolderInDataFolder &&
+       (uploadFolderString.length() < dataFolderString.length() ||
+        uploadFolderString.substr(0,dataFolderString.length()) != dataFolderString)) {
+        ofLogError("ofxHTTPServerUploadRouteHandler::handleExchange") << "Upload folder is not a sub directory of the data folder.";
+        exchange.response.setStatusAndReason(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+        exchange.response.setKeepAlive(false);
+        sendErrorResponse(exchange.response);
+        return;
+    }
+    
+    uploadFolder.makeDirectory();
+    
+    MediaType contentType("application/octet-stream");
+    
+    try {
+        contentType = MediaType(exchange.request.getContentType());
+    } catch(const Exception& exc) {
+        // handled below
+    }
+    
+    if(!contentType.matches("multipart", "form-data") || !contentType.hasParameter("boundary")) {
+        exchange.response.setStatusAndReason(HTTPResponse::HTTP_UNSUPPORTED_MEDIATYPE);
+        exchange.response.setKeepAlive(false);
+        sendErrorResponse(exchange.response);
+        return;
+    }
+    
+    requestContentLength = exchange.request.getContentLength();
+    
+    // reject what we can before reading a single byte of the body
+    if(settings.maxRequestSize > 0 &&
+       requestContentLength != HTTPMessage::UNKNOWN_CONTENT_LENGTH &&
+       static_cast<unsigned long long>(requestContentLength) > settings.maxRequestSize) {
+        exchange.response.setStatusAndReason(HTTPResponse::HTTP_REQUESTENTITYTOOLARGE);
+        exchange.response.setKeepAlive(false);
+        sendErrorResponse(exchange.response);
+        return;
+    }
+    
+    ofxHTTPMultipartParser parser(contentType.getParameter("boundary"), *this);
+    
+    ofxHTTPBufferPool::ScopedBuffer readBuffer(readBufferPool);
+    
+    istream& stream = exchange.request.stream();
+    
+    unsigned long long requestSize = 0;
+    size_t fill = 0;
+    
+    while(!parser.isDone() && !parser.hasError()) {
+        if(fill == readBuffer.size()) {
+            fail(HTTPResponse::HTTP_BAD_REQUEST, "Multipart headers too large.");
+            break;
+        }
+        
+        stream.read(readBuffer.data() + fill, readBuffer.size() - fill);
+        size_t numBytesRead = static_cast<size_t>(stream.gcount());
+        bool bEndOfStream = !stream;
+        
+        requestSize += numBytesRead;
+        
+        if(settings.maxRequestSize > 0 && requestSize > settings.maxRequestSize) {
+            fail(HTTPResponse::HTTP_REQUESTENTITYTOOLARGE, "Request too large.");
+            break;
+        }
+        
+        fill += numBytesRead;
+        
+        size_t consumed = parser.parse(readBuffer.data(), fill, bEndOfStream);
+        
+        memmove(readBuffer.data(), readBuffer.data() + consumed, fill - consumed);
+        fill -= consumed;
+    }
+    
+    if(parser.hasError() && errorStatus == HTTPResponse::HTTP_OK) {
+        fail(HTTPResponse::HTTP_BAD_REQUEST, parser.getError());
+    }
+    
+    // the part that was being received when things went wrong
+    discardPart();
+    
+    if(errorStatus != HTTPResponse::HTTP_OK) {
+        ofLogError("ofxHTTPServerUploadRouteHandler::handleExchange") << errorReason;
+        exchange.response.setStatusAndReason(errorStatus, errorReason);
+        // the rest of the body is still on its way
+        exchange.response.setKeepAlive(false);
+        sendErrorResponse(exchange.response);
+        return;
+    }
+    
+    sendUploadResponse(exchange);
 }
 
 //------------------------------------------------------------------------------
-void ofxHTTPServerUploadRouteHandler::handlePart(const MessageHeader& header, std::istream& stream) {
-    //NameValueCollection::ConstIterator iter = header.begin();
-    
-    //        while(iter != header.end()) {
-    //            cout << (*iter).first << "=" << (*iter).second << endl;
-    //            ++iter;
-    //        }
-    //
-    
-    if(header.has("Content-Type")) {
-        string contentType = header["Content-Type"];
-        if(!isContentTypeValid(contentType)) {
-            ofLogError("ofxHTTPServerUploadRouteHandler::handlePart") << "Invalid content type: " << contentType;
-            return; // reject
+bool ofxHTTPServerUploadRouteHandler::onPartBegin(const MessageHeader& header) {
+    bPartIsFile          = false;
+    partFieldName        = "";
+    partOriginalFileName = "";
+    partTempPath         = "";
+    partFieldValue       = "";
+    partSize             = 0;
+    partNextProgress     = settings.progressInterval;
+    partContentType      = header.get("Content-Type", "text/plain");
+    partDigest.reset();
+    
+    string contentDisposition = header.get("Content-Disposition", "");
+    
+    string disposition;
+    NameValueCollection parameters;
+    MessageHeader::splitParameters(contentDisposition, disposition, parameters);
+    
+    if(Poco::icompare(disposition, "form-data") != 0 || !parameters.has("name")) {
+        return fail(HTTPResponse::HTTP_BAD_REQUEST, "Invalid Content-Disposition: " + contentDisposition);
+    }
+    
+    partFieldName = parameters["name"];
+    
+    if(!parameters.has("filename")) {
+        return true; // a plain form field
+    }
+    
+    // clients may send a full path, keep the file name only
+    string fileName = parameters["filename"];
+    size_t separator = fileName.find_last_of("/\\");
+    if(separator != string::npos) {
+        fileName = fileName.substr(separator + 1);
+    }
+    
+    if(fileName.empty() || fileName == "." || fileName == "..") {
+        // an empty file input
+        return true;
+    }
+    
+    if(!isContentTypeValid(partContentType)) {
+        return fail(HTTPResponse::HTTP_UNSUPPORTED_MEDIATYPE, "Invalid content type: " + partContentType);
+    }
+    
+    bPartIsFile          = true;
+    partOriginalFileName = fileName;
+    
+    Path tempPath(uploadFolder, "." + ofToString(Poco::Timestamp().epochMicroseconds()) + "-" + ofToString(++uploadCounter) + ".part");
+    partTempPath = tempPath.toString();
+    
+    partSink = ofxHTTPFileSink::Instance(writeBufferPool, settings.fileSinkSettings);
+    
+    if(!partSink->open(partTempPath)) {
+        bPartIsFile = false;
+        string sinkError = partSink->getError();
+        partSink.reset();
+        return fail(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, sinkError);
+    }
+    
+    writeBuffer     = partSink->getBuffer();
+    writeBufferFill = 0;
+    
+    ofxHTTPServerUploadEventArgs args = makeEventArgs();
+    ofNotifyEvent(events.onUploadStartedEvent, args, this);
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerUploadRouteHandler::onPartData(const char* data, size_t length) {
+    partSize += length;
+    
+    if(!bPartIsFile) {
+        if(partFieldValue.size() + length > settings.maxFieldSize) {
+            return fail(HTTPResponse::HTTP_REQUESTENTITYTOOLARGE, "Form field too large: " + partFieldName);
+        }
+        partFieldValue.append(data, length);
+        return true;
+    }
+    
+    if(settings.maxFileSize > 0 && partSize > settings.maxFileSize) {
+        return fail(HTTPResponse::HTTP_REQUESTENTITYTOOLARGE, "File too large: " + partOriginalFileName);
+    }
+    
+    if(settings.bComputeDigest || settings.bContentAddressed) {
+        partDigest.update(data, length);
+    }
+    
+    // only whole buffers are written until the part ends
+    size_t capacity = partSink->getBufferSize();
+    
+    while(length > 0) {
+        size_t numBytes = std::min(length, capacity - writeBufferFill);
+        memcpy(writeBuffer + writeBufferFill, data, numBytes);
+        writeBufferFill += numBytes;
+        data            += numBytes;
+        length          -= numBytes;
+        
+        if(writeBufferFill == capacity && !flushWriteBuffer(false)) {
+            return false;
+        }
+    }
+    
+    if(settings.progressInterval > 0 && partSize >= partNextProgress) {
+        partNextProgress = partSize + settings.progressInterval;
+        ofxHTTPServerUploadEventArgs args = makeEventArgs();
+        ofNotifyEvent(events.onUploadProgressEvent, args, this);
+    }
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerUploadRouteHandler::onPartEnd() {
+    if(!bPartIsFile) {
+        if(!partFieldName.empty()) {
+            fields.add(partFieldName, partFieldValue);
+        }
+        return true;
+    }
+    
+    if(!flushWriteBuffer(true)) {
+        return false;
+    }
+    
+    bool bClosed = partSink->close();
+    string sinkError = partSink->getError();
+    partSink.reset();
+    
+    if(!bClosed) {
+        return fail(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, "Unable to write " + partTempPath + ": " + sinkError);
+    }
+    
+    string digest;
+    bool bDuplicate = false;
+    
+    if(settings.bComputeDigest || settings.bContentAddressed) {
+        digest = DigestEngine::digestToHex(partDigest.digest());
+    }
+    
+    string fileName;
+    
+    if(settings.bContentAddressed) {
+        if(!storeContent(digest, partOriginalFileName, fileName, bDuplicate)) {
+            return false;
         }
     } else {
-        ofLogError("ofxHTTPServerUploadRouteHandler::handlePart") << "No Content-Type header.";
+        try {
+            fileName = ofCreateUniqueFile(uploadFolder.toString(), partOriginalFileName);
+            Poco::File(partTempPath).renameTo(fileName);
+        } catch(const Exception& exc) {
+            removePlaceholder(fileName);
+            return fail(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, "Unable to store " + partOriginalFileName + ": " + exc.displayText());
+        }
+    }
+    
+    UploadedFile uploadedFile;
+    uploadedFile.fieldName        = partFieldName;
+    uploadedFile.originalFileName = partOriginalFileName;
+    uploadedFile.fileName         = fileName;
+    uploadedFile.contentType      = partContentType;
+    uploadedFile.size             = partSize;
+    uploadedFile.digest           = digest;
+    uploadedFile.bDuplicate       = bDuplicate;
+    uploadedFiles.push_back(uploadedFile);
+    
+    bPartIsFile  = false;
+    partTempPath = "";
+    
+    ofxHTTPServerUploadEventArgs args = makeEventArgs();
+    args.fileName   = fileName;
+    args.digest     = digest;
+    args.bDuplicate = bDuplicate;
+    ofNotifyEvent(events.onUploadFinishedEvent, args, this);
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerUploadRouteHandler::isContentTypeValid(const string& contentType) const {
+    if(settings.acceptedContentTypes.empty()) {
+        return true;
+    }
+    
+    try {
+        MediaType mediaType(contentType);
+        vector<MediaType>::const_iterator iter = settings.acceptedContentTypes.begin();
+        while(iter != settings.acceptedContentTypes.end()) {
+            if(mediaType.matchesRange(*iter)) {
+                return true;
+            }
+            ++iter;
+        }
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServerUploadRouteHandler::isContentTypeValid") << exc.displayText();
+    }
+    
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerUploadRouteHandler::sendUploadResponse(ofxHTTPServerExchange& exchange) {
+    if(!settings.uploadRedirect.empty()) {
+        exchange.response.redirect(settings.uploadRedirect);
         return;
     }
     
-    // is this an uploaded file?
-    if(header.has("Content-Disposition")) {// && header.has("form-data")) {
-        string contentDisposition = header["Content-Disposition"];
-        NameValueCollection parameters;
-        MessageHeader::splitParameters(contentDisposition.begin(),contentDisposition.end(),parameters);
+    stringstream ss;
+    ss << "{\"files\":[";
+    for(size_t i = 0; i < uploadedFiles.size(); ++i) {
+        const UploadedFile& file = uploadedFiles[i];
+        if(i > 0) ss << ",";
+        ss << "{";
+        ss << "\"field\":\""        << escapeJSON(file.fieldName) << "\",";
+        ss << "\"name\":\""         << escapeJSON(Path(file.fileName).getFileName()) << "\",";
+        ss << "\"originalName\":\"" << escapeJSON(file.originalFileName) << "\",";
+        ss << "\"contentType\":\""  << escapeJSON(file.contentType) << "\",";
+        ss << "\"size\":"           << file.size;
+        if(!file.digest.empty()) {
+            ss << ",\"sha256\":\""   << file.digest << "\"";
+            ss << ",\"duplicate\":"   << (file.bDuplicate ? "true" : "false");
+        }
+        ss << "}";
+    }
+    ss << "]}";
+    
+    string body = ss.str();
+    
+    exchange.response.setStatusAndReason(HTTPResponse::HTTP_OK);
+    exchange.response.setContentType("application/json");
+    exchange.response.sendBuffer(body.data(), body.size());
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerUploadRouteHandler::fail(HTTPResponse::HTTPStatus status, const string& reason) {
+    if(errorStatus == HTTPResponse::HTTP_OK) {
+        errorStatus = status;
+        errorReason = reason;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerUploadRouteHandler::flushWriteBuffer(bool bFinal) {
+    // queue the buffer and move on to the next one while it is written
+    bool bSuccess = partSink->write(writeBuffer, writeBufferFill);
+    
+    writeBuffer     = bFinal ? NULL : partSink->getBuffer();
+    writeBufferFill = 0;
+    
+    if(!bSuccess) {
+        return fail(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, "Unable to write " + partTempPath + ": " + partSink->getError());
+    }
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerUploadRouteHandler::storeContent(const string& digest,
+                                                   const string& originalFileName,
+                                                   string& fileName,
+                                                   bool& bDuplicate) {
+    // fan out on the first two hex digits to keep directories small
+    Path contentPath(uploadFolder);
+    contentPath.pushDirectory(settings.contentFolder);
+    contentPath.pushDirectory(digest.substr(0, 2));
+    contentPath.setFileName(digest);
+    
+    string contentPathString = contentPath.toString();
+    
+    try {
+        Poco::File(contentPath.parent()).createDirectories();
         
-        if(parameters.has("filename")) {
-            try {
-            
-                ofFile file(settings.uploadFolder + "/" + parameters["filename"], ofFile::WriteOnly);
-
-                cout << file.getAbsolutePath() << endl;
-                
-                streamsize sz = StreamCopier::copyStream(stream,file,settings.writeBufferSize);
-                
-                cout << sz << endl;
-                
-                // The section below is from StreamCopier::copyStream,
-                // and can be used for upload progress feedback
-                //                int bufferSize = 8192;
-                //                Buffer<char> buffer(bufferSize);
-                //                streamsize len = 0;
-                //                stream.read(buffer.begin(), bufferSize);
-                //                streamsize n = stream.gcount();
-                //                while (n > 0) {
-                //                    len += n;
-                //                    file.write(buffer.begin(), n);
-                //                    if (stream && file) {
-                //                        stream.read(buffer.begin(), bufferSize);
-                //                        n = stream.gcount();
-                //                        cout << n << endl;
-                //                    }
-                //                    else n = 0;
-                //                }
-                
-                file.close();
-                
-            } catch(const Exception& exc) {
-                ofLogError("ofxHTTPServerUploadRouteHandler::handlePart") << exc.displayText();
-            } catch(const exception& exc) {
-                ofLogError("ofxHTTPServerUploadRouteHandler::handlePart") << exc.what();
-            } catch(...) {
-                ofLogError("ofxHTTPServerUploadRouteHandler::handlePart") << "Uncaught thread exception: Unknown exception.";
-            }
-            
+        Poco::File contentFile(contentPathString);
+        
+        if(contentFile.exists()) {
+            // the same bytes are already stored, keep the existing copy
+            Poco::File(partTempPath).remove();
+            bDuplicate = true;
+        } else {
+            // if another request stores the same content at the same time,
+            // the rename replaces identical bytes, which is harmless.
+            Poco::File(partTempPath).renameTo(contentPathString);
+            bDuplicate = false;
+        }
+    } catch(const Exception& exc) {
+        return fail(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, "Unable to store " + contentPathString + ": " + exc.displayText());
+    }
+    
+    string tempPath = partTempPath;
+    partTempPath = ""; // nothing left to clean up
+    
+    try {
+        fileName = ofCreateUniqueFile(uploadFolder.toString(), originalFileName);
+    } catch(const Exception& exc) {
+        return fail(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, "Unable to store " + originalFileName + ": " + exc.displayText());
+    }
+    
+    // the claimed name is taken by its placeholder, so the link is made
+    // under the free temporary name and renamed over it
+#ifdef TARGET_WIN32
+    bool bLinked = CreateHardLinkA(tempPath.c_str(), contentPathString.c_str(), NULL) != 0;
+#else
+    bool bLinked = ::link(contentPathString.c_str(), tempPath.c_str()) == 0;
+#endif
+    
+    try {
+        if(bLinked) {
+            Poco::File(tempPath).renameTo(fileName);
         } else {
-            // error
+            // e.g. a file system without hard links, fall back to a copy
+            Poco::File(contentPathString).copyTo(fileName);
         }
+    } catch(const Exception& exc) {
+        removePlaceholder(fileName);
+        return fail(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, "Unable to link " + fileName + ": " + exc.displayText());
     }
     
+    return true;
 }
 
 //------------------------------------------------------------------------------
-bool ofxHTTPServerUploadRouteHandler::isContentTypeValid(const string& contentType) const {
-    // default true
-    return true;
+void ofxHTTPServerUploadRouteHandler::removePlaceholder(const string& fileName) {
+    if(fileName.empty()) {
+        return;
+    }
+    
+    try {
+        Poco::File(fileName).remove();
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServerUploadRouteHandler::removePlaceholder") << exc.displayText();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerUploadRouteHandler::discardPart() {
+    if(!bPartIsFile) {
+        return;
+    }
+    
+    if(partSink != NULL) {
+        if(writeBuffer != NULL) {
+            partSink->returnBuffer(writeBuffer);
+            writeBuffer = NULL;
+        }
+        partSink->close();
+        partSink.reset();
+    }
+    
+    try {
+        if(!partTempPath.empty()) {
+            Poco::File(partTempPath).remove();
+        }
+    } catch(const Exception& exc) {
+        ofLogError("ofxHTTPServerUploadRouteHandler::discardPart") << exc.displayText();
+    }
+    
+    ofxHTTPServerUploadEventArgs args = makeEventArgs(errorReason.empty() ? "Upload incomplete." : errorReason);
+    ofNotifyEvent(events.onUploadFailedEvent, args, this);
+    
+    bPartIsFile  = false;
+    partTempPath = "";
 }
 
+//------------------------------------------------------------------------------
+ofxHTTPServerUploadEventArgs ofxHTTPServerUploadRouteHandler::makeEventArgs(const string& error) const {
+    return ofxHTTPServerUploadEventArgs(partFieldName,
+                                        partOriginalFileName,
+                                        "",
+                                        partContentType,
+                                        partSize,
+                                        requestContentLength,
+                                        error);
+}
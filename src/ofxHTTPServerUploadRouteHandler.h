@@ -26,63 +26,156 @@
 
 #include <istream>
 
+#include "ofFileUtils.h"
 #include "ofLog.h"
 
-#include "Poco/Buffer.h"
 #include "Poco/Exception.h"
-#include "Poco/StreamCopier.h"
-#include "Poco/Net/HTMLForm.h"
+#include "Poco/Path.h"
+#include "Poco/Net/HTTPMessage.h"
 #include "Poco/Net/HTTPResponse.h"
 #include "Poco/Net/HTTPServerRequest.h"
 #include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/MediaType.h"
 #include "Poco/Net/MessageHeader.h"
 #include "Poco/Net/NameValueCollection.h"
-#include "Poco/Net/PartHandler.h"
 
 #include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPBufferPool.h"
+#include "ofxHTTPFileSink.h"
+#include "ofxHTTPMultipartParser.h"
+#include "ofxHTTPSHA256Engine.h"
 #include "ofxHTTPServerRouteHandler.h"
+#include "ofxHTTPServerUploadEvents.h"
 
-using Poco::Buffer;
 using Poco::Exception;
-using Poco::StreamCopier;
-using Poco::Net::HTMLForm;
+using Poco::Path;
+using Poco::Net::HTTPMessage;
 using Poco::Net::HTTPResponse;
 using Poco::Net::HTTPServerRequest;
 using Poco::Net::HTTPServerResponse;
+using Poco::Net::MediaType;
 using Poco::Net::MessageHeader;
 using Poco::Net::NameValueCollection;
-using Poco::Net::PartHandler;
 
+// Streams multipart/form-data uploads to the upload folder.  The body is
+// parsed incrementally from pooled buffers and files are written in large
+// blocks through a file sink, so memory use is independent of the upload
+// size and disk writes overlap with reading the body.  Size limits are
+// enforced as the body arrives.
+//
+// Each file's SHA-256 is computed while it streams in.  With
+// bContentAddressed, file content is stored once under contentFolder by
+// its digest and uploaded files are hard links to it, so a duplicate
+// upload costs no extra disk space and nothing has to be re-read later.
 //------------------------------------------------------------------------------
-class ofxHTTPServerUploadRouteHandler : public ofxHTTPServerRouteHandler, public PartHandler {
+class ofxHTTPServerUploadRouteHandler : public ofxHTTPServerRouteHandler, public ofxBaseHTTPMultipartListener {
 public:
     
     struct Settings;
     
-    ofxHTTPServerUploadRouteHandler(const Settings& _settings = Settings());
+    ofxHTTPServerUploadRouteHandler(const Settings& _settings,
+                                    ofxHTTPBufferPool& _readBufferPool,
+                                    ofxHTTPBufferPool& _writeBufferPool,
+                                    ofxHTTPServerUploadEvents& _events);
+
     virtual ~ofxHTTPServerUploadRouteHandler();
     
-    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
-    void handlePart(const MessageHeader& header, istream& stream);
+    bool onPartBegin(const MessageHeader& header);
+    bool onPartData(const char* data, size_t length);
+    bool onPartEnd();
 
+    // by default, checks the accepted content types in the settings
     virtual bool isContentTypeValid(const string& contentType) const;
     
     struct Settings {
+        string route;
         
         bool bRequireUploadFolderInDataFolder;
         string uploadFolder;
         bool bAutoCreateUploadFolder;
         
-        string uploadRedirect;
+        string uploadRedirect; // if empty, a JSON summary is sent
+        
+        size_t readBufferSize;  // also limits the size of a part's headers
+        size_t writeBufferSize; // files are written in blocks of this size
+        
+        ofxHTTPFileSink::Settings fileSinkSettings;
+        
+        unsigned long long maxFileSize;    // 0 is unlimited
+        unsigned long long maxRequestSize; // 0 is unlimited
+        size_t maxFieldSize;               // for non-file form fields
+        
+        vector<MediaType> acceptedContentTypes; // empty accepts all
         
-        size_t writeBufferSize;
+        unsigned long long progressInterval; // bytes between progress events
+        
+        bool bComputeDigest;    // SHA-256 of each file, reported in events and the response
+        bool bContentAddressed; // store file content once per digest, implies bComputeDigest
+        string contentFolder;   // relative to the upload folder
         
         Settings();
     };
 
 protected:
+    struct UploadedFile {
+        string fieldName;
+        string originalFileName;
+        string fileName;
+        string contentType;
+        unsigned long long size;
+        string digest;
+        bool bDuplicate;
+    };
+    
+    void handleExchange(ofxHTTPServerExchange& exchange);
+    
+    void sendUploadResponse(ofxHTTPServerExchange& exchange);
+    
+    bool fail(HTTPResponse::HTTPStatus status, const string& reason);
+    bool flushWriteBuffer(bool bFinal);
+    void discardPart();
+    
+    // moves the finished part into the content store, or drops it if the
+    // content is already there, and links a unique name for
+    // originalFileName, returned in fileName, to the stored content.
+    bool storeContent(const string& digest,
+                      const string& originalFileName,
+                      string& fileName,
+                      bool& bDuplicate);
+    
+    // a name claimed with ofCreateUniqueFile that won't be used after all
+    void removePlaceholder(const string& fileName);
+    
+    ofxHTTPServerUploadEventArgs makeEventArgs(const string& error = "") const;
+    
     Settings settings;
     
+    ofxHTTPBufferPool& readBufferPool;
+    ofxHTTPBufferPool& writeBufferPool;
+    ofxHTTPServerUploadEvents& events;
+    
+    Path uploadFolder;
+    long long requestContentLength;
+    
+    HTTPResponse::HTTPStatus errorStatus;
+    string errorReason;
+    
+    // the part being received
+    bool bPartIsFile;
+    string partFieldName;
+    string partOriginalFileName;
+    string partContentType;
+    string partTempPath;
+    string partFieldValue;
+    ofxHTTPFileSink::Ptr partSink;
+    unsigned long long partSize;
+    unsigned long long partNextProgress;
+    ofxHTTPSHA256Engine partDigest;
+    
+    char* writeBuffer;
+    size_t writeBufferFill;
+    
+    NameValueCollection fields;
+    vector<UploadedFile> uploadedFiles;
     
 };
-
@@ -0,0 +1,207 @@
+#include "ofxHTTPServerVirtualHost.h"
+
+#include <algorithm>
+
+#include "Poco/String.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPUtils.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPServerVirtualHost::Settings::Settings() {
+    bServeDocumentRoot = false;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerVirtualHost::ofxHTTPServerVirtualHost(const Settings& _settings) :
+settings(_settings)
+{
+    if(settings.bServeDocumentRoot) {
+        addRoute(ofxHTTPServerDefaultRoute::Instance(settings.defaultRoute));
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerVirtualHost::~ofxHTTPServerVirtualHost() { }
+
+//------------------------------------------------------------------------------
+const vector<string>& ofxHTTPServerVirtualHost::getNames() const {
+    return settings.names;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerVirtualHost::clearRoutes() {
+    ofScopedLock lock(mutex);
+    routes.clear();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerVirtualHost::addRoute(ofxBaseHTTPServerRoute::Ptr route) {
+    ofScopedLock lock(mutex);
+    routes.push_back(route);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerVirtualHost::removeRoute(ofxBaseHTTPServerRoute::Ptr route) {
+    ofScopedLock lock(mutex);
+    vector<ofxBaseHTTPServerRoute::Ptr>::iterator iter = routes.begin();
+    while(iter != routes.end()) {
+        if(*iter == route) {
+            iter = routes.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+vector<ofxBaseHTTPServerRoute::Ptr> ofxHTTPServerVirtualHost::getRoutes() const {
+    ofScopedLock lock(mutex);
+    return routes;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPServerVirtualHost::normalize(const string& host) {
+    string name = Poco::toLower(Poco::trim(host));
+    
+    if(!name.empty() && name[0] == '[') {
+        // an IPv6 literal, the port follows the bracket
+        size_t end = name.find(']');
+        return end == string::npos ? name : name.substr(0, end + 1);
+    }
+    
+    size_t colon = name.find(':');
+    if(colon != string::npos) {
+        name = name.substr(0, colon);
+    }
+    
+    if(!name.empty() && name[name.size() - 1] == '.') {
+        name = name.substr(0, name.size() - 1);
+    }
+    
+    return name;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerVirtualHost::Ptr ofxHTTPServerVirtualHost::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPServerVirtualHost(settings));
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerVirtualHostTable::ofxHTTPServerVirtualHostTable() { }
+
+//------------------------------------------------------------------------------
+ofxHTTPServerVirtualHostTable::~ofxHTTPServerVirtualHostTable() { }
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerVirtualHostTable::add(ofxHTTPServerVirtualHost::Ptr host) {
+    RWLock::ScopedWriteLock writeLock(lock);
+    
+    vector<string>::const_iterator iter = host->getNames().begin();
+    while(iter != host->getNames().end()) {
+        string name = ofxHTTPServerVirtualHost::normalize(*iter);
+        
+        Hosts& hosts = name.compare(0, 2, "*.") == 0 ? wildcardHosts : exactHosts;
+        
+        if(&hosts == &wildcardHosts) {
+            name = name.substr(2);
+        }
+        
+        Hosts::Iterator existing = hosts.find(name);
+        
+        if(existing != hosts.end() && (*existing).second != host) {
+            ofLogWarning("ofxHTTPServerVirtualHostTable::add") << "Host name " << *iter << " is already in use, it now belongs to the new host.";
+        }
+        
+        hosts[name] = host;
+        
+        ++iter;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerVirtualHostTable::remove(ofxHTTPServerVirtualHost::Ptr host) {
+    RWLock::ScopedWriteLock writeLock(lock);
+    
+    vector<string>::const_iterator iter = host->getNames().begin();
+    while(iter != host->getNames().end()) {
+        string name = ofxHTTPServerVirtualHost::normalize(*iter);
+        
+        Hosts& hosts = name.compare(0, 2, "*.") == 0 ? wildcardHosts : exactHosts;
+        
+        if(&hosts == &wildcardHosts) {
+            name = name.substr(2);
+        }
+        
+        // only if the name wasn't taken over since
+        Hosts::Iterator existing = hosts.find(name);
+        if(existing != hosts.end() && (*existing).second == host) {
+            hosts.erase(existing);
+        }
+        
+        ++iter;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPServerVirtualHostTable::clear() {
+    RWLock::ScopedWriteLock writeLock(lock);
+    exactHosts.clear();
+    wildcardHosts.clear();
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPServerVirtualHostTable::empty() const {
+    RWLock::ScopedReadLock readLock(lock);
+    return exactHosts.empty() && wildcardHosts.empty();
+}
+
+//------------------------------------------------------------------------------
+vector<ofxHTTPServerVirtualHost::Ptr> ofxHTTPServerVirtualHostTable::getHosts() const {
+    RWLock::ScopedReadLock readLock(lock);
+    
+    vector<ofxHTTPServerVirtualHost::Ptr> hosts;
+    
+    const Hosts* tables[] = { &exactHosts, &wildcardHosts };
+    
+    for(size_t i = 0; i < 2; ++i) {
+        Hosts::ConstIterator iter = tables[i]->begin();
+        while(iter != tables[i]->end()) {
+            if(std::find(hosts.begin(), hosts.end(), (*iter).second) == hosts.end()) {
+                hosts.push_back((*iter).second);
+            }
+            ++iter;
+        }
+    }
+    
+    return hosts;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPServerVirtualHost::Ptr ofxHTTPServerVirtualHostTable::find(const string& host) const {
+    string name = ofxHTTPServerVirtualHost::normalize(host);
+    
+    RWLock::ScopedReadLock readLock(lock);
+    
+    Hosts::ConstIterator iter = exactHosts.find(name);
+    
+    if(iter != exactHosts.end()) {
+        return (*iter).second;
+    }
+    
+    // a.b.example.com tries b.example.com, then example.com, then com
+    size_t dot = name.find('.');
+    
+    while(dot != string::npos && !wildcardHosts.empty()) {
+        iter = wildcardHosts.find(name.substr(dot + 1));
+        
+        if(iter != wildcardHosts.end()) {
+            return (*iter).second;
+        }
+        
+        dot = name.find('.', dot + 1);
+    }
+    
+    return ofxHTTPServerVirtualHost::Ptr();
+}
@@ -0,0 +1,121 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Poco/HashMap.h"
+#include "Poco/RWLock.h"
+
+#include "ofTypes.h"
+
+#include "ofxHTTPBaseTypes.h"
+#include "ofxHTTPServerDefaultRoute.h"
+
+using std::string;
+using std::vector;
+
+using Poco::HashMap;
+using Poco::RWLock;
+
+// A site served by the server, with its own route table.
+//
+// Requests whose Host header matches one of the host's names are routed
+// through its routes only.  Names are either exact, e.g. example.com, or
+// wildcards for any subdomain, e.g. *.example.com.  If bServeDocumentRoot
+// is set, the host gets a default route for its own document root.
+class ofxHTTPServerVirtualHost {
+public:
+    typedef ofPtr<ofxHTTPServerVirtualHost> Ptr;
+    
+    struct Settings;
+    
+    ofxHTTPServerVirtualHost(const Settings& _settings);
+    virtual ~ofxHTTPServerVirtualHost();
+    
+    const vector<string>& getNames() const;
+    
+    void clearRoutes();
+    void addRoute(ofxBaseHTTPServerRoute::Ptr route);
+    void removeRoute(ofxBaseHTTPServerRoute::Ptr route);
+    
+    // a copy, in the order added, the last added is tried first.  Routes
+    // can be added and removed while requests are being routed.
+    vector<ofxBaseHTTPServerRoute::Ptr> getRoutes() const;
+    
+    // lower case, without the port and a trailing dot
+    static string normalize(const string& host);
+    
+    struct Settings {
+        vector<string> names;
+        
+        bool bServeDocumentRoot;
+        ofxHTTPServerDefaultRoute::Settings defaultRoute;
+        
+        Settings();
+    };
+    
+    static Ptr Instance(const Settings& settings);
+    
+protected:
+    Settings settings;
+    
+    vector<ofxBaseHTTPServerRoute::Ptr> routes;
+    
+    mutable ofMutex mutex;
+    
+};
+
+// Finds the virtual host for a Host header.  Exact names are a single
+// hash lookup, wildcards one more for each label stripped from the front,
+// the most specific first.
+class ofxHTTPServerVirtualHostTable {
+public:
+    ofxHTTPServerVirtualHostTable();
+    virtual ~ofxHTTPServerVirtualHostTable();
+    
+    // a name already taken by another host is moved to this one
+    void add(ofxHTTPServerVirtualHost::Ptr host);
+    void remove(ofxHTTPServerVirtualHost::Ptr host);
+    void clear();
+    
+    bool empty() const;
+    
+    // each host once, however many names it has
+    vector<ofxHTTPServerVirtualHost::Ptr> getHosts() const;
+    
+    // returns NULL if no host matches
+    ofxHTTPServerVirtualHost::Ptr find(const string& host) const;
+    
+protected:
+    typedef HashMap<string, ofxHTTPServerVirtualHost::Ptr> Hosts;
+    
+    Hosts exactHosts;
+    Hosts wildcardHosts;    // by the suffix after "*."
+    
+    mutable RWLock lock;
+    
+};
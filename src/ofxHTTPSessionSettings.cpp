@@ -9,6 +9,7 @@ maxRedirects(20),
 keepAliveTimeout(8000),
 bUseProxy(false),
 proxy(ofxHTTPProxySettings()),
+unixSocketPath(""),
 bUseCookieStore(true),
 bUseCredentialStore(true)
 { }
@@ -25,6 +26,7 @@ ofxHTTPSessionSettings::ofxHTTPSessionSettings(ofxHTTPSessionSettings& that) {
     keepAliveTimeout    = that.keepAliveTimeout;
     bUseProxy           = that.bUseProxy;
     proxy               = that.proxy;
+    unixSocketPath      = that.unixSocketPath;
     bUseCredentialStore = that.bUseCredentialStore;
     bUseCookieStore     = that.bUseCookieStore;
     
@@ -43,6 +45,7 @@ ofxHTTPSessionSettings& ofxHTTPSessionSettings::operator = (ofxHTTPSessionSettin
     keepAliveTimeout    = that.keepAliveTimeout;
     bUseProxy           = that.bUseProxy;
     proxy               = that.proxy;
+    unixSocketPath      = that.unixSocketPath;
     bUseCredentialStore = that.bUseCredentialStore;
     bUseCookieStore     = that.bUseCookieStore;
     
@@ -234,6 +237,30 @@ bool ofxHTTPSessionSettings::hasProxyCredentials() {
     return bUseProxy && proxy.hasCredentials();
 }
 
+//------------------------------------------------------------------------------
+void ofxHTTPSessionSettings::setUnixSocketPath(const string& _unixSocketPath) {
+    ofScopedLock lock(mutex);
+    unixSocketPath = _unixSocketPath;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPSessionSettings::getUnixSocketPath() {
+    ofScopedLock lock(mutex);
+    return unixSocketPath;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPSessionSettings::hasUnixSocketPath() {
+    ofScopedLock lock(mutex);
+    return !unixSocketPath.empty();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPSessionSettings::clearUnixSocketPath() {
+    ofScopedLock lock(mutex);
+    unixSocketPath.clear();
+}
+
 
 //------------------------------------------------------------------------------
 void ofxHTTPSessionSettings::setUseCredentialStore(bool _bUseCredentialStore) {
@@ -88,6 +88,14 @@ public:
     bool isProxyEnabled();
     void clearProxy();
     
+    // connect to a local server over a unix socket rather than tcp.
+    // a path beginning with '@' names a Linux abstract socket.
+    // the URI host is still sent in the Host header.
+    void setUnixSocketPath(const string& _unixSocketPath);
+    string getUnixSocketPath();
+    bool hasUnixSocketPath();
+    void clearUnixSocketPath();
+    
     void setUseCredentialStore(bool _bUseCredentialStore);
     bool useCredentialStore();
 
@@ -114,6 +122,8 @@ private:
     bool   bUseProxy;
     ofxHTTPProxySettings proxy;
 
+    string unixSocketPath;
+
     bool   bUseCredentialStore;
     bool   bUseCookieStore;
     
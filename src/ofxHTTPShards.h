@@ -0,0 +1,114 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Poco/Hash.h"
+
+using std::string;
+using std::vector;
+
+// A fixed set of independently locked shards, picked by the hash of a key
+// so that concurrent requests rarely contend.  The number of shards is
+// rounded up to a power of two, which lets the index be a mask.  Shards
+// are allocated once and never move, so their addresses can be handed out
+// (e.g. as timer listeners).
+template<typename ShardType>
+class ofxHTTPShards {
+public:
+    ofxHTTPShards(size_t numShards);
+    virtual ~ofxHTTPShards();
+    
+    ShardType& get(const string& key);
+    
+    ShardType& operator [] (size_t index);
+    const ShardType& operator [] (size_t index) const;
+    
+    size_t size() const;
+    
+    // a total capacity split evenly across the shards.  0 stays 0,
+    // which the stores take to mean unlimited.
+    size_t getCapacityPerShard(size_t capacity) const;
+    
+private:
+    ofxHTTPShards(const ofxHTTPShards&);
+    ofxHTTPShards& operator = (const ofxHTTPShards&);
+    
+    vector<ShardType*> shards;
+    
+};
+
+//------------------------------------------------------------------------------
+template<typename ShardType>
+ofxHTTPShards<ShardType>::ofxHTTPShards(size_t numShards) {
+    size_t n = 1;
+    while(n < numShards) {
+        n <<= 1;
+    }
+    
+    for(size_t i = 0; i < n; ++i) {
+        shards.push_back(new ShardType());
+    }
+}
+
+//------------------------------------------------------------------------------
+template<typename ShardType>
+ofxHTTPShards<ShardType>::~ofxHTTPShards() {
+    for(size_t i = 0; i < shards.size(); ++i) {
+        delete shards[i];
+    }
+}
+
+//------------------------------------------------------------------------------
+template<typename ShardType>
+ShardType& ofxHTTPShards<ShardType>::get(const string& key) {
+    return *shards[Poco::hash(key) & (shards.size() - 1)];
+}
+
+//------------------------------------------------------------------------------
+template<typename ShardType>
+ShardType& ofxHTTPShards<ShardType>::operator [] (size_t index) {
+    return *shards[index];
+}
+
+//------------------------------------------------------------------------------
+template<typename ShardType>
+const ShardType& ofxHTTPShards<ShardType>::operator [] (size_t index) const {
+    return *shards[index];
+}
+
+//------------------------------------------------------------------------------
+template<typename ShardType>
+size_t ofxHTTPShards<ShardType>::size() const {
+    return shards.size();
+}
+
+//------------------------------------------------------------------------------
+template<typename ShardType>
+size_t ofxHTTPShards<ShardType>::getCapacityPerShard(size_t capacity) const {
+    return (capacity + shards.size() - 1) / shards.size();
+}
@@ -40,4 +40,57 @@ streamsize ofxHTTPStreamUtils::copyTo(ofxHTTPResponseStream* responseStream, ost
 //------------------------------------------------------------------------------
 streamsize ofxHTTPStreamUtils::copyTo(istream& istr, ostream& ostr, size_t bufferSize) {
     return StreamCopier::copyStream(istr,ostr,bufferSize);
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------------------
+streamsize ofxHTTPStreamUtils::copyToFile(ofxHTTPResponseStream* responseStream,
+                                          const string& path,
+                                          size_t bufferSize,
+                                          const ofxHTTPFileSink::Settings& settings) {
+    if(responseStream != NULL && responseStream->hasResponseStream()) {
+        return copyToFile(*responseStream->getResponseStream(),path,bufferSize,settings);
+    } else {
+        return 0; // error
+    }
+}
+
+//------------------------------------------------------------------------------
+streamsize ofxHTTPStreamUtils::copyToFile(istream& istr,
+                                          const string& path,
+                                          size_t bufferSize,
+                                          const ofxHTTPFileSink::Settings& settings) {
+    ofxHTTPBufferPool pool(bufferSize, settings.numBuffers);
+    
+    ofxHTTPFileSink::Ptr sink = ofxHTTPFileSink::Instance(pool, settings);
+    
+    if(!sink->open(path)) {
+        ofLogError("ofxHTTPStreamUtils::copyToFile") << sink->getError();
+        return -1;
+    }
+    
+    streamsize total = 0;
+    
+    while(istr.good()) {
+        char* buffer = sink->getBuffer();
+        size_t fill = 0;
+        
+        // fill whole buffers so the writes stay large and aligned
+        while(fill < bufferSize && istr.good()) {
+            istr.read(buffer + fill, static_cast<streamsize>(bufferSize - fill));
+            fill += static_cast<size_t>(istr.gcount());
+        }
+        
+        total += static_cast<streamsize>(fill);
+        
+        if(!sink->write(buffer, fill)) {
+            break;
+        }
+    }
+    
+    if(!sink->close()) {
+        ofLogError("ofxHTTPStreamUtils::copyToFile") << sink->getError();
+        return -1;
+    }
+    
+    return total;
+}
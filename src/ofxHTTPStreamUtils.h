@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "ofxHTTPFileSink.h"
 #include "ofxHTTPResponseStream.h"
 
 class ofxHTTPStreamUtils {
@@ -38,4 +39,15 @@ public:
     static streamsize copyTo(ofxHTTPResponseStream* responseStream, ostream& ostr, size_t bufferSize = 8192);
     static streamsize copyTo(istream& istr, ostream& ostr, size_t bufferSize = 8192);
     
+    // writes through an ofxHTTPFileSink, so reading the stream and writing
+    // the file overlap.  Returns -1 if the file could not be written.
+    static streamsize copyToFile(ofxHTTPResponseStream* responseStream,
+                                 const string& path,
+                                 size_t bufferSize = 1024 * 1024,
+                                 const ofxHTTPFileSink::Settings& settings = ofxHTTPFileSink::Settings());
+    static streamsize copyToFile(istream& istr,
+                                 const string& path,
+                                 size_t bufferSize = 1024 * 1024,
+                                 const ofxHTTPFileSink::Settings& settings = ofxHTTPFileSink::Settings());
+    
 };
@@ -0,0 +1,222 @@
+#include "ofxHTTPTimerWheel.h"
+
+//------------------------------------------------------------------------------
+ofxHTTPTimerWheel::ofxHTTPTimerWheel(const Timespan& _resolution) :
+resolution(_resolution),
+currentTick(0),
+nextTimerId(1),
+stopEvent(false),
+bRunning(false)
+{
+    if(resolution.totalMicroseconds() <= 0) {
+        resolution = Timespan(100 * Timespan::MILLISECONDS);
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPTimerWheel::~ofxHTTPTimerWheel() {
+    stop();
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPTimerWheel::TimerId ofxHTTPTimerWheel::schedule(ofxBaseHTTPTimerListener* listener, const Timespan& delay) {
+    Poco::Mutex::ScopedLock lock(mutex);
+
+    TimerId timerId = nextTimerId++;
+
+    Timer& timer = timers[timerId];
+    timer.listener   = listener;
+    timer.expiryTick = toTick(delay);
+    place(timerId, timer);
+
+    return timerId;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPTimerWheel::reschedule(TimerId timerId, const Timespan& delay) {
+    Poco::Mutex::ScopedLock lock(mutex);
+
+    map<TimerId, Timer>::iterator iter = timers.find(timerId);
+
+    if(iter == timers.end()) {
+        return false;
+    }
+
+    unplace((*iter).second);
+    (*iter).second.expiryTick = toTick(delay);
+    place(timerId, (*iter).second);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPTimerWheel::cancel(TimerId timerId) {
+    Poco::Mutex::ScopedLock lock(mutex);
+
+    map<TimerId, Timer>::iterator iter = timers.find(timerId);
+
+    if(iter == timers.end()) {
+        return false;
+    }
+
+    unplace((*iter).second);
+    timers.erase(iter);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ofxHTTPTimerWheel::isScheduled(TimerId timerId) {
+    Poco::Mutex::ScopedLock lock(mutex);
+    return timers.find(timerId) != timers.end();
+}
+
+//------------------------------------------------------------------------------
+size_t ofxHTTPTimerWheel::getNumTimers() {
+    Poco::Mutex::ScopedLock lock(mutex);
+    return timers.size();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPTimerWheel::advance(const Timestamp& now) {
+    Poco::Mutex::ScopedLock lock(mutex);
+
+    Timestamp::TimeDiff elapsed = now - startTime;
+
+    if(elapsed < 0) return;
+
+    unsigned long long targetTick = static_cast<unsigned long long>(elapsed / resolution.totalMicroseconds());
+
+    while(currentTick < targetTick) {
+        ++currentTick;
+
+        // when a level wraps around, the next level's current slot is
+        // redistributed into the lower levels.
+        for(int level = 1; level < NUM_LEVELS; ++level) {
+            unsigned long long levelMask = (1ULL << (SLOT_BITS * level)) - 1;
+            if((currentTick & levelMask) == 0) {
+                cascade(level);
+            } else {
+                break;
+            }
+        }
+
+        list<TimerId>& slot = slots[0][currentTick & SLOT_MASK];
+
+        // take all due timers out of the wheel before calling any listeners,
+        // so listeners are free to schedule new ones.
+        vector<std::pair<TimerId, ofxBaseHTTPTimerListener*> > due;
+
+        while(!slot.empty()) {
+            TimerId timerId = slot.front();
+            slot.pop_front();
+
+            map<TimerId, Timer>::iterator iter = timers.find(timerId);
+            if(iter != timers.end()) {
+                due.push_back(std::make_pair(timerId, (*iter).second.listener));
+                timers.erase(iter);
+            }
+        }
+
+        for(size_t i = 0; i < due.size(); ++i) {
+            if(due[i].second != NULL) {
+                due[i].second->timerExpired(due[i].first);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+Poco::Mutex& ofxHTTPTimerWheel::getMutex() {
+    return mutex;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPTimerWheel::start() {
+    Poco::Mutex::ScopedLock lock(mutex);
+    if(bRunning) return;
+    bRunning = true;
+    stopEvent.reset();
+    thread.setName("ofxHTTPTimerWheel");
+    thread.start(*this);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPTimerWheel::stop() {
+    {
+        Poco::Mutex::ScopedLock lock(mutex);
+        if(!bRunning) return;
+        bRunning = false;
+    }
+    stopEvent.set();
+    thread.join();
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPTimerWheel::run() {
+    long waitMilliseconds = static_cast<long>(resolution.totalMilliseconds());
+    if(waitMilliseconds < 1) waitMilliseconds = 1;
+
+    while(!stopEvent.tryWait(waitMilliseconds)) {
+        advance();
+    }
+}
+
+//------------------------------------------------------------------------------
+unsigned long long ofxHTTPTimerWheel::toTick(const Timespan& delay) const {
+    Timespan::TimeDiff micros = delay.totalMicroseconds();
+
+    // round up, and never fire in the current tick
+    unsigned long long ticks = 1;
+    if(micros > 0) {
+        ticks = static_cast<unsigned long long>((micros + resolution.totalMicroseconds() - 1) / resolution.totalMicroseconds());
+        if(ticks == 0) ticks = 1;
+    }
+
+    unsigned long long maxTicks = (1ULL << (SLOT_BITS * NUM_LEVELS)) - 1;
+    if(ticks > maxTicks) ticks = maxTicks;
+
+    return currentTick + ticks;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPTimerWheel::place(TimerId timerId, Timer& timer) {
+    unsigned long long delta = timer.expiryTick > currentTick ? timer.expiryTick - currentTick : 0;
+
+    int level = 0;
+    while(level < NUM_LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    // timers that are already due go in the current slot, which is
+    // processed right after cascading.
+    unsigned long long tick = delta == 0 ? currentTick : timer.expiryTick;
+
+    timer.level = level;
+    timer.slot  = static_cast<int>((tick >> (SLOT_BITS * level)) & SLOT_MASK);
+
+    list<TimerId>& slot = slots[timer.level][timer.slot];
+    timer.position = slot.insert(slot.end(), timerId);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPTimerWheel::unplace(Timer& timer) {
+    slots[timer.level][timer.slot].erase(timer.position);
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPTimerWheel::cascade(int level) {
+    int index = static_cast<int>((currentTick >> (SLOT_BITS * level)) & SLOT_MASK);
+
+    list<TimerId> pending;
+    pending.swap(slots[level][index]);
+
+    list<TimerId>::iterator iter = pending.begin();
+    while(iter != pending.end()) {
+        map<TimerId, Timer>::iterator timerIter = timers.find(*iter);
+        if(timerIter != timers.end()) {
+            place(*iter, (*timerIter).second);
+        }
+        ++iter;
+    }
+}
@@ -0,0 +1,135 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "Poco/Event.h"
+#include "Poco/Mutex.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+
+using std::list;
+using std::map;
+using std::vector;
+
+using Poco::Runnable;
+using Poco::Thread;
+using Poco::Timespan;
+using Poco::Timestamp;
+
+class ofxBaseHTTPTimerListener {
+public:
+    ofxBaseHTTPTimerListener() { }
+    virtual ~ofxBaseHTTPTimerListener() { }
+
+    // Called from the wheel's thread with the wheel locked.  The wheel lock
+    // is recursive, so listeners may schedule or cancel timers from here.
+    virtual void timerExpired(unsigned long long timerId) = 0;
+};
+
+// A hierarchical timing wheel.  Placing a timer in its slot and taking it
+// out again is O(1), and finding a timer by id is O(log n), so scheduling,
+// rescheduling and cancelling are O(log n) in the number of pending timers.
+// Firing due timers costs nothing for the ones that aren't, which makes it
+// suitable for per-connection and per-session deadlines that are touched
+// constantly.
+class ofxHTTPTimerWheel : public Runnable {
+public:
+    typedef unsigned long long TimerId;
+
+    enum {
+        SLOT_BITS  = 6,
+        NUM_SLOTS  = 1 << SLOT_BITS,
+        SLOT_MASK  = NUM_SLOTS - 1,
+        NUM_LEVELS = 4
+    };
+
+    // with the default 100 ms resolution, the wheel spans about 19 days.
+    // longer delays are clamped to the span of the wheel.
+    ofxHTTPTimerWheel(const Timespan& _resolution = Timespan(100 * Timespan::MILLISECONDS));
+    virtual ~ofxHTTPTimerWheel();
+
+    // returns an id that is never 0
+    TimerId schedule(ofxBaseHTTPTimerListener* listener, const Timespan& delay);
+
+    // returns false if the timer already fired or was cancelled
+    bool reschedule(TimerId timerId, const Timespan& delay);
+
+    // returns false if the timer already fired or was cancelled.
+    // once cancel returns, the timer's listener will not be called.
+    bool cancel(TimerId timerId);
+
+    bool isScheduled(TimerId timerId);
+    size_t getNumTimers();
+
+    // fires all timers that are due at now.  called by the wheel's thread,
+    // but can be called directly if the wheel isn't started.
+    void advance(const Timestamp& now = Timestamp());
+
+    // listeners that keep their own state in step with their timers can
+    // hold this lock to exclude the wheel's thread while updating it.
+    Poco::Mutex& getMutex();
+
+    void start();
+    void stop();
+
+    void run();
+
+protected:
+    struct Timer {
+        ofxBaseHTTPTimerListener* listener;
+        unsigned long long expiryTick;
+        int level;
+        int slot;
+        list<TimerId>::iterator position;
+    };
+
+    // all calls are expected to hold the mutex
+    unsigned long long toTick(const Timespan& delay) const;
+    void place(TimerId timerId, Timer& timer);
+    void unplace(Timer& timer);
+    void cascade(int level);
+
+    Timespan resolution;
+    Timestamp startTime;
+    unsigned long long currentTick;
+
+    TimerId nextTimerId;
+
+    map<TimerId, Timer> timers;
+    list<TimerId> slots[NUM_LEVELS][NUM_SLOTS];
+
+    Poco::Mutex mutex; // recursive, so listeners can call back in
+
+    Thread thread;
+    Poco::Event stopEvent;
+    bool bRunning;
+
+};
@@ -0,0 +1,215 @@
+#include "ofxHTTPUpstream.h"
+
+#include "Poco/Exception.h"
+
+#include "ofLog.h"
+
+#include "ofxHTTPUtils.h"
+#include "ofxUnixSocket.h"
+
+#ifdef SSL_ENABLED
+#include "Poco/Net/HTTPSClientSession.h"
+
+using Poco::Net::HTTPSClientSession;
+#endif
+
+//------------------------------------------------------------------------------
+ofxHTTPUpstream::Settings::Settings() {
+    uri                = "http://127.0.0.1:8081";
+    unixSocketPath     = "";
+    maxIdleConnections = 16;
+    maxConnections     = 0;
+    idleTimeout        = Timespan(30, 0); // 30 seconds
+    timeout            = Timespan(30, 0); // 30 seconds
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPUpstream::Metrics::Metrics() :
+numRequests(0),
+numFailures(0),
+numConnectionsOpened(0),
+numConnectionsReused(0),
+numBytesSent(0),
+numBytesReceived(0),
+numActiveConnections(0),
+numIdleConnections(0)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPUpstream::ofxHTTPUpstream(const Settings& _settings) :
+settings(_settings),
+uri(_settings.uri)
+{ }
+
+//------------------------------------------------------------------------------
+ofxHTTPUpstream::~ofxHTTPUpstream() {
+    ofScopedLock lock(mutex);
+    for(size_t i = 0; i < idle.size(); ++i) {
+        delete idle[i].session;
+    }
+    idle.clear();
+}
+
+//------------------------------------------------------------------------------
+HTTPClientSession* ofxHTTPUpstream::acquire(bool& bReused) {
+    vector<HTTPClientSession*> expired;
+    HTTPClientSession* session = NULL;
+    
+    {
+        ofScopedLock lock(mutex);
+        
+        // the most recently used are at the back, so anything too old
+        // to trust is at the front
+        size_t numExpired = 0;
+        while(numExpired < idle.size() && idle[numExpired].since.isElapsed(settings.idleTimeout.totalMicroseconds())) {
+            expired.push_back(idle[numExpired].session);
+            ++numExpired;
+        }
+        idle.erase(idle.begin(), idle.begin() + numExpired);
+        
+        if(!idle.empty()) {
+            session = idle.back().session;
+            idle.pop_back();
+            ++metrics.numConnectionsReused;
+            bReused = true;
+        } else if(settings.maxConnections == 0 || metrics.numActiveConnections < settings.maxConnections) {
+            bReused = false;
+        } else {
+            metrics.numIdleConnections = idle.size();
+            return NULL; // full, and nothing to delete either
+        }
+        
+        ++metrics.numActiveConnections;
+        metrics.numIdleConnections = idle.size();
+    }
+    
+    // closing sockets can block, so not while holding the lock
+    for(size_t i = 0; i < expired.size(); ++i) {
+        delete expired[i];
+    }
+    
+    if(session != NULL) {
+        return session;
+    }
+    
+    try {
+        session = createSession();
+    } catch(const Poco::Exception& exc) {
+        ofLogError("ofxHTTPUpstream::acquire") << "Unable to connect to " << settings.uri << ": " << exc.displayText();
+        ofScopedLock lock(mutex);
+        --metrics.numActiveConnections;
+        return NULL;
+    }
+    
+    ofScopedLock lock(mutex);
+    ++metrics.numConnectionsOpened;
+    return session;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPUpstream::release(HTTPClientSession* session, bool bReusable) {
+    if(session == NULL) {
+        return;
+    }
+    
+    {
+        ofScopedLock lock(mutex);
+        
+        --metrics.numActiveConnections;
+        
+        if(bReusable && settings.maxIdleConnections > 0) {
+            if(idle.size() >= settings.maxIdleConnections) {
+                // make room by dropping the one idle the longest
+                HTTPClientSession* oldest = idle.front().session;
+                idle.erase(idle.begin());
+                IdleConnection connection;
+                connection.session = session;
+                idle.push_back(connection);
+                metrics.numIdleConnections = idle.size();
+                session = oldest;
+            } else {
+                IdleConnection connection;
+                connection.session = session;
+                idle.push_back(connection);
+                metrics.numIdleConnections = idle.size();
+                return;
+            }
+        }
+    }
+    
+    delete session;
+}
+
+//------------------------------------------------------------------------------
+void ofxHTTPUpstream::requestFinished(bool bSuccess,
+                                      const Timespan& timeToFirstByte,
+                                      UInt64 bytesSent,
+                                      UInt64 bytesReceived) {
+    ofScopedLock lock(mutex);
+    ++metrics.numRequests;
+    if(!bSuccess) {
+        ++metrics.numFailures;
+    }
+    metrics.totalTimeToFirstByte += timeToFirstByte;
+    metrics.numBytesSent         += bytesSent;
+    metrics.numBytesReceived     += bytesReceived;
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPUpstream::Metrics ofxHTTPUpstream::getMetrics() const {
+    ofScopedLock lock(mutex);
+    return metrics;
+}
+
+//------------------------------------------------------------------------------
+const URI& ofxHTTPUpstream::getURI() const {
+    return uri;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPUpstream::getBasePath() const {
+    string path = uri.getPath();
+    while(!path.empty() && path[path.size() - 1] == '/') {
+        path.erase(path.size() - 1);
+    }
+    return path;
+}
+
+//------------------------------------------------------------------------------
+string ofxHTTPUpstream::getHostHeader() const {
+    if(uri.getPort() == URI::getWellKnownPort(uri.getScheme())) {
+        return uri.getHost();
+    }
+    return uri.getHost() + ":" + ofToString(uri.getPort());
+}
+
+//------------------------------------------------------------------------------
+ofxHTTPUpstream::Ptr ofxHTTPUpstream::Instance(const Settings& settings) {
+    return Ptr(new ofxHTTPUpstream(settings));
+}
+
+//------------------------------------------------------------------------------
+HTTPClientSession* ofxHTTPUpstream::createSession() {
+    HTTPClientSession* session = NULL;
+    
+    if(!settings.unixSocketPath.empty()) {
+        // can't reconnect on its own, so the pool must retire it first
+        session = new HTTPClientSession(ofxUnixSocket::connect(settings.unixSocketPath));
+        session->setKeepAliveTimeout(settings.idleTimeout + settings.idleTimeout);
+    } else if(uri.getScheme() == "https") {
+#ifdef SSL_ENABLED
+        session = new HTTPSClientSession(uri.getHost(), uri.getPort());
+#else
+        throw Poco::NotImplementedException("https upstreams require SSL_ENABLED", settings.uri);
+#endif
+        session->setKeepAliveTimeout(settings.idleTimeout);
+    } else {
+        session = new HTTPClientSession(uri.getHost(), uri.getPort());
+        session->setKeepAliveTimeout(settings.idleTimeout);
+    }
+    
+    session->setKeepAlive(true);
+    session->setTimeout(settings.timeout);
+    
+    return session;
+}
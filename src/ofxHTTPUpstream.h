@@ -0,0 +1,130 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Types.h"
+#include "Poco/URI.h"
+#include "Poco/Net/HTTPClientSession.h"
+
+#include "ofTypes.h"
+
+using std::string;
+using std::vector;
+
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::UInt64;
+using Poco::URI;
+using Poco::Net::HTTPClientSession;
+
+// A server that requests are forwarded to, with a pool of keep-alive
+// connections to it.
+//
+// Connections are handed out most recently used first, so the ones kept
+// warm are reused and the rest age out after idleTimeout.  Every
+// connection is opened with the same timeout, which Poco applies to
+// connecting, sending and receiving alike.
+class ofxHTTPUpstream {
+public:
+    typedef ofPtr<ofxHTTPUpstream> Ptr;
+    
+    struct Settings;
+    struct Metrics;
+    
+    ofxHTTPUpstream(const Settings& _settings);
+    virtual ~ofxHTTPUpstream();
+    
+    // NULL if maxConnections are already in use.  bReused is true for a
+    // connection that has carried requests before, which the upstream
+    // may have closed in the meantime.
+    HTTPClientSession* acquire(bool& bReused);
+    
+    // bReusable is false if the exchange failed or did not finish, or
+    // the upstream asked to close the connection.
+    void release(HTTPClientSession* session, bool bReusable);
+    
+    // called by the proxy once per forwarded request
+    void requestFinished(bool bSuccess,
+                         const Timespan& timeToFirstByte,
+                         UInt64 bytesSent,
+                         UInt64 bytesReceived);
+    
+    Metrics getMetrics() const;
+    
+    // the scheme, host and port of the upstream's URI, plus its path
+    // without a trailing slash
+    const URI& getURI() const;
+    string getBasePath() const;
+    string getHostHeader() const;
+    
+    struct Settings {
+        string uri;              // e.g. http://127.0.0.1:9000/render
+        string unixSocketPath;   // if set, connect here instead of the uri's host
+        
+        size_t maxIdleConnections;
+        size_t maxConnections;   // 0 is unlimited
+        Timespan idleTimeout;
+        Timespan timeout;
+        
+        Settings();
+    };
+    
+    struct Metrics {
+        UInt64 numRequests;
+        UInt64 numFailures;
+        UInt64 numConnectionsOpened;
+        UInt64 numConnectionsReused;
+        UInt64 numBytesSent;
+        UInt64 numBytesReceived;
+        Timespan totalTimeToFirstByte;
+        size_t numActiveConnections;
+        size_t numIdleConnections;
+        
+        Metrics();
+    };
+    
+    static Ptr Instance(const Settings& settings);
+    
+protected:
+    struct IdleConnection {
+        HTTPClientSession* session;
+        Timestamp since;
+    };
+    
+    HTTPClientSession* createSession();
+    
+    Settings settings;
+    URI uri;
+    
+    mutable ofMutex mutex;
+    vector<IdleConnection> idle; // most recently released last
+    Metrics metrics;
+    
+};
@@ -1,5 +1,22 @@
 #include "ofxHTTPUtils.h"
 
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+
+#include "Poco/Exception.h"
+#include "Poco/Path.h"
+#include "Poco/Net/SocketDefs.h"
+#include "Poco/Net/SocketImpl.h"
+
+#ifdef TARGET_WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 //------------------------------------------------------------------------------
 NameValueCollection ofGetQueryMap(const URI& uri) {
     NameValueCollection nvc;
@@ -29,6 +46,45 @@ NameValueCollection ofGetQueryMap(const URI& uri) {
     return nvc;
 }
 
+//------------------------------------------------------------------------------
+string ofCreateUniqueFile(const string& folder, const string& fileName) {
+    Poco::Path path(Poco::Path::forDirectory(folder), fileName);
+    
+    string baseName  = path.getBaseName();
+    string extension = path.getExtension();
+    
+    int suffix = 1;
+    
+    while(true) {
+        string target = path.toString();
+        
+#ifdef TARGET_WIN32
+        int fd = ::_open(target.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL, _S_IREAD | _S_IWRITE);
+#else
+        int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+#endif
+        
+        if(fd >= 0) {
+#ifdef TARGET_WIN32
+            ::_close(fd);
+#else
+            ::close(fd);
+#endif
+            return target;
+        }
+        
+        if(errno != EEXIST) {
+            throw Poco::FileException("Unable to create " + target + ": " + strerror(errno));
+        }
+        
+        string uniqueName = baseName + "-" + ofToString(suffix++);
+        if(!extension.empty()) {
+            uniqueName += "." + extension;
+        }
+        path.setFileName(uniqueName);
+    }
+}
+
 //------------------------------------------------------------------------------
 void ofDumpRequestHeaders(const ofxHTTPServerExchange& exchange, ofLogLevel logLevel) {
     if(logLevel >= ofGetLogLevel()) {
@@ -53,4 +109,37 @@ void ofDumpReponseHeaders(const ofxHTTPServerExchange& exchange, ofLogLevel logL
         }
         ofLog(logLevel) << "End ofDumpReponseHeaders =================" << endl;
     }
+}
+
+//------------------------------------------------------------------------------
+int ofSendSome(StreamSocket& socket, const char* data, size_t length) {
+#ifdef SSL_ENABLED
+    if(socket.secure()) {
+        // the ssl layer returns a negative count when it would block
+        try {
+            int n = socket.sendBytes(data, static_cast<int>(length));
+            return n < 0 ? 0 : n;
+        } catch(const Poco::TimeoutException&) {
+            return 0;
+        }
+    }
+#endif
+    
+#ifdef TARGET_WIN32
+    int n = ::send(socket.impl()->sockfd(), data, static_cast<int>(length), 0);
+    if(n < 0 && WSAGetLastError() == WSAEWOULDBLOCK) {
+        return 0;
+    }
+#else
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL; // elsewhere Poco sets SO_NOSIGPIPE
+#endif
+    ssize_t n = ::send(socket.impl()->sockfd(), data, length, flags);
+    if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return 0;
+    }
+#endif
+    
+    return n < 0 ? -1 : static_cast<int>(n);
 }
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include "Poco/URI.h"
 #include "Poco/StringTokenizer.h"
 #include "Poco/Net/NameValueCollection.h"
+#include "Poco/Net/StreamSocket.h"
 
 #include "ofUtils.h"
 #include "ofTypes.h"
@@ -44,8 +45,21 @@ using std::vector;
 using Poco::StringTokenizer;
 using Poco::URI;
 using Poco::Net::NameValueCollection;
+using Poco::Net::StreamSocket;
 
 NameValueCollection ofGetQueryMap(const URI& uri);
 
+// creates an empty file in folder named fileName, or name-1.ext,
+// name-2.ext ... if that is taken, and returns its path.  The name is
+// claimed by creating the file exclusively, so concurrent callers never
+// get the same one; the caller then renames or copies over it.  Throws a
+// Poco::FileException if no file can be created.
+string ofCreateUniqueFile(const string& folder, const string& fileName);
+
+// writes what a socket takes without blocking.  Returns the bytes sent,
+// 0 if the socket is full or -1 on an error.  The socket must be
+// non-blocking.
+int ofSendSome(StreamSocket& socket, const char* data, size_t length);
+
 void ofDumpRequestHeaders(const ofxHTTPServerExchange& exchange, ofLogLevel logLevel = OF_LOG_VERBOSE);
 void ofDumpReponseHeaders(const ofxHTTPServerExchange& exchange, ofLogLevel logLevel = OF_LOG_VERBOSE);
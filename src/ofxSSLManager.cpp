@@ -0,0 +1,248 @@
+#include "ofxSSLManager.h"
+
+#ifdef SSL_ENABLED
+
+#include <cstring>
+
+#include <openssl/rand.h>
+
+//------------------------------------------------------------------------------
+ofxSSLSessionTicketKeys::ofxSSLSessionTicketKeys(const Timespan& _rotationInterval,
+                                                 const Timespan& _keyLifetime) :
+rotationInterval(_rotationInterval),
+keyLifetime(_keyLifetime)
+{
+    ofScopedLock lock(mutex);
+    rotateWithExistingLock();
+}
+
+//------------------------------------------------------------------------------
+ofxSSLSessionTicketKeys::~ofxSSLSessionTicketKeys() {
+    ofScopedLock lock(mutex);
+    // don't leave key material lying around in freed memory
+    vector<Key>::iterator iter = keys.begin();
+    while(iter != keys.end()) {
+        OPENSSL_cleanse(&(*iter), sizeof(Key));
+        ++iter;
+    }
+    keys.clear();
+}
+
+//------------------------------------------------------------------------------
+void ofxSSLSessionTicketKeys::rotate() {
+    ofScopedLock lock(mutex);
+    rotateWithExistingLock();
+}
+
+//------------------------------------------------------------------------------
+size_t ofxSSLSessionTicketKeys::getNumKeys() {
+    ofScopedLock lock(mutex);
+    return keys.size();
+}
+
+//------------------------------------------------------------------------------
+void ofxSSLSessionTicketKeys::rotateWithExistingLock() {
+    Key key;
+
+    if(RAND_bytes(key.name, KEY_NAME_SIZE) != 1 ||
+       RAND_bytes(key.aesKey, AES_KEY_SIZE) != 1 ||
+       RAND_bytes(key.hmacKey, HMAC_KEY_SIZE) != 1) {
+        ofLogError("ofxSSLSessionTicketKeys::rotate") << "Unable to generate session ticket key.  Keeping existing keys.";
+        return;
+    }
+
+    key.created.update();
+    keys.insert(keys.begin(), key);
+
+    expireWithExistingLock();
+}
+
+//------------------------------------------------------------------------------
+void ofxSSLSessionTicketKeys::expireWithExistingLock() {
+    // never expire the current key
+    while(keys.size() > 1 && keys.back().created.isElapsed(keyLifetime.totalMicroseconds())) {
+        OPENSSL_cleanse(&keys.back(), sizeof(Key));
+        keys.pop_back();
+    }
+}
+
+//------------------------------------------------------------------------------
+int ofxSSLSessionTicketKeys::encryptTicket(unsigned char keyName[16],
+                                           unsigned char iv[EVP_MAX_IV_LENGTH],
+                                           EVP_CIPHER_CTX* cipherContext,
+                                           HMAC_CTX* hmacContext) {
+    ofScopedLock lock(mutex);
+
+    if(keys.empty() || keys.front().created.isElapsed(rotationInterval.totalMicroseconds())) {
+        rotateWithExistingLock();
+    }
+
+    if(keys.empty()) {
+        return -1; // no keys, no ticket
+    }
+
+    if(RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1) {
+        return -1;
+    }
+
+    const Key& key = keys.front();
+
+    memcpy(keyName, key.name, KEY_NAME_SIZE);
+    EVP_EncryptInit_ex(cipherContext, EVP_aes_256_cbc(), NULL, key.aesKey, iv);
+    HMAC_Init_ex(hmacContext, key.hmacKey, HMAC_KEY_SIZE, EVP_sha256(), NULL);
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+int ofxSSLSessionTicketKeys::decryptTicket(unsigned char keyName[16],
+                                           unsigned char iv[EVP_MAX_IV_LENGTH],
+                                           EVP_CIPHER_CTX* cipherContext,
+                                           HMAC_CTX* hmacContext) {
+    ofScopedLock lock(mutex);
+
+    expireWithExistingLock();
+
+    for(size_t i = 0; i < keys.size(); ++i) {
+        const Key& key = keys[i];
+        if(memcmp(keyName, key.name, KEY_NAME_SIZE) == 0) {
+            HMAC_Init_ex(hmacContext, key.hmacKey, HMAC_KEY_SIZE, EVP_sha256(), NULL);
+            EVP_DecryptInit_ex(cipherContext, EVP_aes_256_cbc(), NULL, key.aesKey, iv);
+            // 2 asks OpenSSL to resume the session, but issue a new ticket
+            // encrypted with the current key.
+            return (i == 0) ? 1 : 2;
+        }
+    }
+
+    return 0; // unknown key, fall back to a full handshake
+}
+
+//------------------------------------------------------------------------------
+int ofxSSLSessionTicketKeys::ticketKeyCallback(SSL* ssl,
+                                               unsigned char keyName[16],
+                                               unsigned char iv[EVP_MAX_IV_LENGTH],
+                                               EVP_CIPHER_CTX* cipherContext,
+                                               HMAC_CTX* hmacContext,
+                                               int encrypt) {
+    SSL_CTX* sslContext = SSL_get_SSL_CTX(ssl);
+
+    ofxSSLSessionTicketKeys* ticketKeys = static_cast<ofxSSLSessionTicketKeys*>(SSL_CTX_get_ex_data(sslContext, getExDataIndex()));
+
+    if(ticketKeys == NULL) {
+        return encrypt ? -1 : 0;
+    } else if(encrypt) {
+        return ticketKeys->encryptTicket(keyName, iv, cipherContext, hmacContext);
+    } else {
+        return ticketKeys->decryptTicket(keyName, iv, cipherContext, hmacContext);
+    }
+}
+
+//------------------------------------------------------------------------------
+int ofxSSLSessionTicketKeys::getExDataIndex() {
+    static ofMutex indexMutex;
+    static int index = -1;
+
+    ofScopedLock lock(indexMutex);
+    if(index < 0) {
+        index = SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+    }
+    return index;
+}
+
+//------------------------------------------------------------------------------
+ofxSSLManager::Settings::Settings() {
+    privateKeyFile    = "ssl/server.key";
+    certificateFile   = "ssl/server.crt";
+    caLocation        = "";
+    verificationMode  = Context::VERIFY_RELAXED;
+    verificationDepth = 9;
+    bLoadDefaultCAs   = false;
+    cipherList        = "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH";
+
+    bRequireTLSv1     = false;
+
+    bCacheSessions    = true;
+    sessionIdContext  = ""; // empty, will be auto generated
+    sessionCacheSize  = 1024 * 20; // the OpenSSL default
+    sessionTimeout    = Timespan(5 * Timespan::MINUTES);
+
+    bUseSessionTickets = true;
+    sessionTicketKeyRotationInterval = Timespan(Timespan::HOURS);
+    sessionTicketKeyLifetime         = Timespan(12 * Timespan::HOURS);
+}
+
+//------------------------------------------------------------------------------
+ofxSSLManager::ofxSSLManager(const Settings& _settings) :
+settings(_settings)
+{
+    Context::Usage usage = settings.bRequireTLSv1 ? Context::TLSV1_SERVER_USE : Context::SERVER_USE;
+
+    context = new Context(usage,
+                          ofToDataPath(settings.privateKeyFile, true),
+                          ofToDataPath(settings.certificateFile, true),
+                          settings.caLocation,
+                          settings.verificationMode,
+                          settings.verificationDepth,
+                          settings.bLoadDefaultCAs,
+                          settings.cipherList); // will throw exceptions
+
+    if(settings.bCacheSessions) {
+        // the session id context must be the same for all contexts sharing a
+        // session cache, and it's required when client verification is used.
+        string sessionIdContext = settings.sessionIdContext;
+        if(sessionIdContext.empty()) {
+            sessionIdContext = "ofxHTTPServer:" + settings.certificateFile;
+        }
+
+        context->enableSessionCache(true, sessionIdContext);
+        context->setSessionCacheSize(settings.sessionCacheSize);
+        context->setSessionTimeout(static_cast<long>(settings.sessionTimeout.totalSeconds()));
+    } else {
+        context->enableSessionCache(false);
+    }
+
+    SSL_CTX* sslContext = context->sslContext();
+
+    if(settings.bUseSessionTickets) {
+        ticketKeys = ofPtr<ofxSSLSessionTicketKeys>(new ofxSSLSessionTicketKeys(settings.sessionTicketKeyRotationInterval,
+                                                                                settings.sessionTicketKeyLifetime));
+        SSL_CTX_set_ex_data(sslContext, ofxSSLSessionTicketKeys::getExDataIndex(), ticketKeys.get());
+        SSL_CTX_set_tlsext_ticket_key_cb(sslContext, &ofxSSLSessionTicketKeys::ticketKeyCallback);
+        SSL_CTX_clear_options(sslContext, SSL_OP_NO_TICKET);
+    } else {
+        SSL_CTX_set_options(sslContext, SSL_OP_NO_TICKET);
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxSSLManager::~ofxSSLManager() {
+    if(!context.isNull()) {
+        // the context may outlive us if a connection still holds it
+        SSL_CTX_set_ex_data(context->sslContext(), ofxSSLSessionTicketKeys::getExDataIndex(), NULL);
+    }
+}
+
+//------------------------------------------------------------------------------
+Context::Ptr ofxSSLManager::getContext() {
+    return context;
+}
+
+//------------------------------------------------------------------------------
+ofxSSLManager::Settings ofxSSLManager::getSettings() const {
+    return settings;
+}
+
+//------------------------------------------------------------------------------
+void ofxSSLManager::flushSessions() {
+    context->flushSessionCache();
+    if(ticketKeys != NULL) {
+        ticketKeys->rotate();
+    }
+}
+
+//------------------------------------------------------------------------------
+ofxSSLManager::Ptr ofxSSLManager::Instance(const Settings& settings) {
+    return Ptr(new ofxSSLManager(settings));
+}
+
+#endif
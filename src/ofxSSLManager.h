@@ -24,79 +24,146 @@
 
 #pragma once
 
-#include "Poco/Net.h"
-//#include "Poco/SingletonHolder.h"
+#include "ofxHTTPConstants.h"
 
-using Poco::Net;
-//using Poco::SingletonHolder;
+#ifdef SSL_ENABLED
 
+#include <string>
+#include <vector>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/ssl.h>
+
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/Context.h"
+
+#include "ofLog.h"
+#include "ofTypes.h"
+#include "ofUtils.h"
+
+using std::string;
+using std::vector;
+
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::Net::Context;
+
+// A set of stateless session ticket keys (RFC 5077).  New tickets are always
+// encrypted with the newest key.  Older keys are kept around for decryption
+// until they expire, and clients presenting a ticket encrypted with an old
+// key are issued a fresh ticket so they migrate to the current key.
+class ofxSSLSessionTicketKeys {
+public:
+    enum {
+        KEY_NAME_SIZE = 16,
+        AES_KEY_SIZE  = 32,
+        HMAC_KEY_SIZE = 32
+    };
+
+    ofxSSLSessionTicketKeys(const Timespan& _rotationInterval,
+                            const Timespan& _keyLifetime);
+
+    virtual ~ofxSSLSessionTicketKeys();
+
+    // rotates the current key immediately
+    void rotate();
+
+    size_t getNumKeys();
+
+    // the callback registered with SSL_CTX_set_tlsext_ticket_key_cb
+    static int ticketKeyCallback(SSL* ssl,
+                                 unsigned char keyName[16],
+                                 unsigned char iv[EVP_MAX_IV_LENGTH],
+                                 EVP_CIPHER_CTX* cipherContext,
+                                 HMAC_CTX* hmacContext,
+                                 int encrypt);
+
+    static int getExDataIndex();
+
+protected:
+    struct Key {
+        unsigned char name[KEY_NAME_SIZE];
+        unsigned char aesKey[AES_KEY_SIZE];
+        unsigned char hmacKey[HMAC_KEY_SIZE];
+        Timestamp created;
+    };
+
+    // all calls are expected to hold the mutex
+    void rotateWithExistingLock();
+    void expireWithExistingLock();
+
+    int encryptTicket(unsigned char keyName[16],
+                      unsigned char iv[EVP_MAX_IV_LENGTH],
+                      EVP_CIPHER_CTX* cipherContext,
+                      HMAC_CTX* hmacContext);
+
+    int decryptTicket(unsigned char keyName[16],
+                      unsigned char iv[EVP_MAX_IV_LENGTH],
+                      EVP_CIPHER_CTX* cipherContext,
+                      HMAC_CTX* hmacContext);
+
+    Timespan rotationInterval;
+    Timespan keyLifetime;
+
+    vector<Key> keys; // newest key is always at the front
+
+    ofMutex mutex;
+
+};
+
+// Builds and owns the server-side TLS context for a listener.
 class ofxSSLManager {
 public:
     struct Settings;
-    
-    ofxSSLManager() {
-//		Net::initializeSSL();
-//        
-//        Poco::Path mycert( Poco::Util::ServerApplication::instance().config().getString(“application.dir”) );
-//        
-//        
-//        
-//        mycert.append(“mycert.pem”);
-//        Poco::SharedPtr pConsoleHandler = new KeyConsoleHandler(true);
-//        Poco::SharedPtr pCertHandler = new AcceptCertificateHandler(true);
-//        SSLManager::instance().initializeServer(pConsoleHandler, pCertHandler, NULL);
-//        Context::Ptr pContext = new Context(Context::SERVER_USE, mycert.toString(), mycert.toString(), “”, Context::VERIFY_RELAXED, 9, false, “ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH”);
-//        SSLManager::instance().initializeServer(pConsoleHandler, pCertHandler, pContext);
-
-        
-	}
-	
-	~ofxSSLManager() {
-        Net::uninitializeSSL();
-    }
-    
-//    static ofxSSLManager& instance()
-//    {
-//        static SingletonHolder<ofxSSLManager> sh;
-//        return *sh.get();
-//    }
-    
+
+    typedef ofPtr<ofxSSLManager> Ptr;
+
+    ofxSSLManager(const Settings& _settings);
+    virtual ~ofxSSLManager();
+
+    Context::Ptr getContext();
+
+    Settings getSettings() const;
+
+    // drops all cached sessions and rotates the ticket key
+    void flushSessions();
+
+    static Ptr Instance(const Settings& settings);
+
     struct Settings {
-        string privateKeyFile;
-        string certificateFile;
+        string privateKeyFile;   // relative paths are resolved with ofToDataPath
+        string certificateFile;  // relative paths are resolved with ofToDataPath
         string caLocation;
-        VerificationMode verificationMode;
+        Context::VerificationMode verificationMode;
         int verificationDepth;
         bool bLoadDefaultCAs;
         string cipherList;
-        
-//		const std::string& privateKeyFile,
-//		const std::string& certificateFile,
-//		const std::string& caLocation,
-//		VerificationMode verificationMode = VERIFY_RELAXED,
-//		int verificationDepth = 9,
-//		bool loadDefaultCAs = false,
-//		const std::string& cipherList = "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
 
-        bool bCacheSessions;
-        string sessionIdContext;
-        int sessionCacheSize;
         bool bRequireTLSv1;
-        
-//        openSSL.server.privateKeyPassphraseHandler.name = KeyFileHandler
-//        openSSL.server.privateKeyPassphraseHandler.options.password = secret
-//        openSSL.server.invalidCertificateHandler.name = AcceptCertificateHandler
-//        openSSL.server.extendedVerification = false
-//        openSSL.server.cacheSessions = true
-//        openSSL.server.sessionIdContext = ${application.name}
-//        openSSL.server.sessionCacheSize = 100
-//        openSSL.server.requireTLSv1 = false
-
-        
-        
+
+        // server-side session id cache
+        bool bCacheSessions;
+        string sessionIdContext; // empty, will be auto generated
+        size_t sessionCacheSize; // 0 is unlimited
+        Timespan sessionTimeout;
+
+        // stateless session tickets (RFC 5077)
+        bool bUseSessionTickets;
+        Timespan sessionTicketKeyRotationInterval;
+        Timespan sessionTicketKeyLifetime; // how long old keys may still decrypt
+
         Settings();
     };
-    
-    
+
+protected:
+    Settings settings;
+
+    Context::Ptr context;
+
+    ofPtr<ofxSSLSessionTicketKeys> ticketKeys;
+
 };
 
+#endif
@@ -0,0 +1,298 @@
+#include "ofxUnixSocket.h"
+
+#ifndef TARGET_WIN32
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+    //--------------------------------------------------------------------------
+    socklen_t makeUnixAddress(const string& path, struct sockaddr_un& address) {
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if(path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw Poco::InvalidArgumentException("Invalid unix socket path", path);
+        }
+
+        if(ofxUnixSocket::isAbstractPath(path)) {
+#ifdef TARGET_LINUX
+            // abstract names start with a NUL byte and are not NUL terminated
+            address.sun_path[0] = '\0';
+            memcpy(address.sun_path + 1, path.data() + 1, path.size() - 1);
+            return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + path.size());
+#else
+            throw Poco::NotImplementedException("Abstract unix sockets are only available on Linux", path);
+#endif
+        } else {
+            memcpy(address.sun_path, path.data(), path.size());
+            return static_cast<socklen_t>(sizeof(address));
+        }
+    }
+
+}
+
+//------------------------------------------------------------------------------
+ofxUnixStreamSocketImpl::ofxUnixStreamSocketImpl(poco_socket_t sockfd, const string& _path) :
+StreamSocketImpl(sockfd),
+path(_path),
+peerCredentials(ofxUnixSocket::readPeerCredentials(sockfd))
+{ }
+
+//------------------------------------------------------------------------------
+ofxUnixStreamSocketImpl::~ofxUnixStreamSocketImpl() { }
+
+//------------------------------------------------------------------------------
+SocketAddress ofxUnixStreamSocketImpl::address() {
+    return SocketAddress("127.0.0.1", 0);
+}
+
+//------------------------------------------------------------------------------
+SocketAddress ofxUnixStreamSocketImpl::peerAddress() {
+    return SocketAddress("127.0.0.1", 0);
+}
+
+//------------------------------------------------------------------------------
+void ofxUnixStreamSocketImpl::setNoDelay(bool flag) { }
+
+//------------------------------------------------------------------------------
+bool ofxUnixStreamSocketImpl::getNoDelay() { return true; }
+
+//------------------------------------------------------------------------------
+string ofxUnixStreamSocketImpl::getPath() const {
+    return path;
+}
+
+//------------------------------------------------------------------------------
+ofxUnixPeerCredentials ofxUnixStreamSocketImpl::getPeerCredentials() const {
+    return peerCredentials;
+}
+
+//------------------------------------------------------------------------------
+ofxUnixServerSocketImpl::ofxUnixServerSocketImpl(const string& _path,
+                                                 int backlog,
+                                                 int permissions,
+                                                 const ofxUnixPeerFilter& _filter) :
+path(_path),
+filter(_filter),
+bUnlinkOnClose(true)
+{
+    struct sockaddr_un address;
+    socklen_t addressLength = makeUnixAddress(path, address);
+
+    poco_socket_t sockfd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(sockfd < 0) {
+        error(errno, path);
+    }
+
+    reset(sockfd); // we own it now, and close() will release it
+
+    if(!ofxUnixSocket::isAbstractPath(path)) {
+        // replace a stale socket file left behind by a previous run, but
+        // never the path of a server that is still accepting
+        struct stat info;
+        if(::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+            poco_socket_t probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+            if(probe < 0) {
+                error(errno, path);
+            }
+
+            int result;
+            do {
+                result = ::connect(probe, reinterpret_cast<struct sockaddr*>(&address), addressLength);
+            } while(result != 0 && errno == EINTR);
+
+            int probeError = result == 0 ? 0 : errno;
+
+            ::close(probe);
+
+            if(result == 0) {
+                error(EADDRINUSE, path);
+            }
+
+            if(probeError == ECONNREFUSED) {
+                ::unlink(path.c_str());
+            }
+        }
+    }
+
+    if(::bind(sockfd, reinterpret_cast<struct sockaddr*>(&address), addressLength) != 0) {
+        error(errno, path);
+    }
+
+    if(!ofxUnixSocket::isAbstractPath(path) && permissions > 0) {
+        ::chmod(path.c_str(), static_cast<mode_t>(permissions));
+    }
+
+    listen(backlog);
+}
+
+//------------------------------------------------------------------------------
+ofxUnixServerSocketImpl::ofxUnixServerSocketImpl(poco_socket_t sockfd,
+                                                 const string& _path,
+                                                 const ofxUnixPeerFilter& _filter) :
+ofxHTTPServerSocketImpl(sockfd),
+path(_path),
+filter(_filter),
+bUnlinkOnClose(true)
+{ }
+
+//------------------------------------------------------------------------------
+ofxUnixServerSocketImpl::~ofxUnixServerSocketImpl() {
+    close();
+}
+
+//------------------------------------------------------------------------------
+StreamSocketImpl* ofxUnixServerSocketImpl::acceptConnection(SocketAddress& clientAddr) {
+    poco_socket_t sockfd;
+
+    do {
+        sockfd = ::accept(this->sockfd(), NULL, NULL);
+    } while(sockfd < 0 && errno == EINTR);
+
+    if(sockfd < 0) {
+        error(errno);
+    }
+
+    StreamSocketImpl* pImpl = new ofxUnixStreamSocketImpl(sockfd, path);
+
+    if(!filter.isAllowed(static_cast<ofxUnixStreamSocketImpl*>(pImpl)->getPeerCredentials())) {
+        pImpl->release(); // closes the connection
+        throw Poco::Net::NetException("Unix socket peer rejected by credential filter", path);
+    }
+
+    clientAddr = pImpl->peerAddress();
+
+    return pImpl;
+}
+
+//------------------------------------------------------------------------------
+SocketAddress ofxUnixServerSocketImpl::address() {
+    return SocketAddress("127.0.0.1", 0);
+}
+
+//------------------------------------------------------------------------------
+SocketAddress ofxUnixServerSocketImpl::peerAddress() {
+    return SocketAddress("127.0.0.1", 0);
+}
+
+//------------------------------------------------------------------------------
+void ofxUnixServerSocketImpl::close() {
+    if(initialized() && bUnlinkOnClose && !ofxUnixSocket::isAbstractPath(path)) {
+        ::unlink(path.c_str());
+    }
+    ofxHTTPServerSocketImpl::close();
+}
+
+//------------------------------------------------------------------------------
+void ofxUnixServerSocketImpl::setUnlinkOnClose(bool _bUnlinkOnClose) {
+    bUnlinkOnClose = _bUnlinkOnClose;
+}
+
+//------------------------------------------------------------------------------
+string ofxUnixServerSocketImpl::getPath() const {
+    return path;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+ServerSocket ofxUnixSocket::listen(const string& path,
+                                   int backlog,
+                                   int permissions,
+                                   const ofxUnixPeerFilter& filter) {
+#ifndef TARGET_WIN32
+    return ofxAdoptedServerSocket(new ofxUnixServerSocketImpl(path, backlog, permissions, filter));
+#else
+    throw Poco::NotImplementedException("Unix sockets are not available on this platform", path);
+#endif
+}
+
+//------------------------------------------------------------------------------
+ServerSocket ofxUnixSocket::adopt(poco_socket_t sockfd,
+                                  const string& path,
+                                  const ofxUnixPeerFilter& filter) {
+#ifndef TARGET_WIN32
+    return ofxAdoptedServerSocket(new ofxUnixServerSocketImpl(sockfd, path, filter));
+#else
+    throw Poco::NotImplementedException("Unix sockets are not available on this platform", path);
+#endif
+}
+
+//------------------------------------------------------------------------------
+StreamSocket ofxUnixSocket::connect(const string& path) {
+#ifndef TARGET_WIN32
+    struct sockaddr_un address;
+    socklen_t addressLength = makeUnixAddress(path, address);
+
+    poco_socket_t sockfd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(sockfd < 0) {
+        throw Poco::Net::NetException("Unable to create unix socket", path, errno);
+    }
+
+    int result;
+
+    do {
+        result = ::connect(sockfd, reinterpret_cast<struct sockaddr*>(&address), addressLength);
+    } while(result != 0 && errno == EINTR);
+
+    if(result != 0) {
+        int err = errno;
+        ::close(sockfd);
+        throw Poco::Net::ConnectionRefusedException(path + ": " + strerror(err), err);
+    }
+
+    return StreamSocket(new ofxUnixStreamSocketImpl(sockfd, path));
+#else
+    throw Poco::NotImplementedException("Unix sockets are not available on this platform", path);
+#endif
+}
+
+//------------------------------------------------------------------------------
+bool ofxUnixSocket::getPeerCredentials(const StreamSocket& socket, ofxUnixPeerCredentials& credentials) {
+#ifndef TARGET_WIN32
+    ofxUnixStreamSocketImpl* pImpl = dynamic_cast<ofxUnixStreamSocketImpl*>(socket.impl());
+    if(pImpl != NULL) {
+        credentials = pImpl->getPeerCredentials();
+        return true;
+    }
+#endif
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool ofxUnixSocket::isAbstractPath(const string& path) {
+    return !path.empty() && path[0] == '@';
+}
+
+//------------------------------------------------------------------------------
+ofxUnixPeerCredentials ofxUnixSocket::readPeerCredentials(poco_socket_t sockfd) {
+    ofxUnixPeerCredentials credentials;
+#if defined(TARGET_LINUX)
+    struct ucred peer;
+    socklen_t length = sizeof(peer);
+    if(::getsockopt(sockfd, SOL_SOCKET, SO_PEERCRED, &peer, &length) == 0) {
+        credentials.pid = peer.pid;
+        credentials.uid = peer.uid;
+        credentials.gid = peer.gid;
+    }
+#elif !defined(TARGET_WIN32)
+    uid_t uid;
+    gid_t gid;
+    if(::getpeereid(sockfd, &uid, &gid) == 0) {
+        credentials.uid = uid;
+        credentials.gid = gid;
+    }
+#endif
+    return credentials;
+}
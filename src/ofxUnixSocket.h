@@ -0,0 +1,173 @@
+/*==============================================================================
+ 
+ Copyright (c) 2013 - Christopher Baker <http://christopherbaker.net>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ==============================================================================*/
+
+#pragma once
+
+#include <set>
+#include <string>
+
+#include "Poco/Exception.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/ServerSocketImpl.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/StreamSocketImpl.h"
+
+#include "ofConstants.h"
+
+#include "ofxHTTPServerSocketImpl.h"
+
+using std::set;
+using std::string;
+
+using Poco::Net::ServerSocket;
+using Poco::Net::ServerSocketImpl;
+using Poco::Net::SocketAddress;
+using Poco::Net::StreamSocket;
+using Poco::Net::StreamSocketImpl;
+
+// Unix domain sockets for local reverse proxies and sidecars.
+// A path beginning with '@' names a socket in the Linux abstract namespace.
+
+class ofxUnixPeerCredentials {
+public:
+    ofxUnixPeerCredentials() : pid(-1), uid(-1), gid(-1) { }
+
+    bool isValid() const { return uid >= 0; }
+
+    long long pid; // -1 if the platform does not report it
+    long long uid;
+    long long gid;
+};
+
+// Access rules applied to every connection accepted by a unix listener.
+// Empty sets allow everyone.
+class ofxUnixPeerFilter {
+public:
+    bool isAllowed(const ofxUnixPeerCredentials& credentials) const {
+        if(allowedUIDs.empty() && allowedGIDs.empty()) return true;
+        if(!credentials.isValid()) return false;
+        return allowedUIDs.find(credentials.uid) != allowedUIDs.end() ||
+               allowedGIDs.find(credentials.gid) != allowedGIDs.end();
+    }
+
+    set<long long> allowedUIDs;
+    set<long long> allowedGIDs;
+};
+
+#ifndef TARGET_WIN32
+
+// A connected unix stream socket.  Poco's SocketAddress can't represent
+// AF_UNIX addresses, so local and peer addresses report the loopback address.
+class ofxUnixStreamSocketImpl : public StreamSocketImpl {
+public:
+    ofxUnixStreamSocketImpl(poco_socket_t sockfd, const string& _path);
+
+    SocketAddress address();
+    SocketAddress peerAddress();
+
+    // TCP options don't apply to unix sockets
+    void setNoDelay(bool flag);
+    bool getNoDelay();
+
+    string getPath() const;
+    ofxUnixPeerCredentials getPeerCredentials() const;
+
+protected:
+    virtual ~ofxUnixStreamSocketImpl();
+
+    string path;
+    ofxUnixPeerCredentials peerCredentials;
+
+};
+
+// A listening unix stream socket.
+class ofxUnixServerSocketImpl : public ofxHTTPServerSocketImpl {
+public:
+    ofxUnixServerSocketImpl(const string& _path,
+                            int backlog,
+                            int permissions,
+                            const ofxUnixPeerFilter& _filter);
+
+    // adopts a listening descriptor bound to path by another process
+    ofxUnixServerSocketImpl(poco_socket_t sockfd,
+                            const string& _path,
+                            const ofxUnixPeerFilter& _filter);
+
+    StreamSocketImpl* acceptConnection(SocketAddress& clientAddr);
+
+    SocketAddress address();
+    SocketAddress peerAddress();
+
+    // removes the socket file unless it was handed to another process
+    void close();
+
+    void setUnlinkOnClose(bool _bUnlinkOnClose);
+
+    string getPath() const;
+
+protected:
+    virtual ~ofxUnixServerSocketImpl();
+
+    string path;
+    ofxUnixPeerFilter filter;
+    bool bUnlinkOnClose;
+
+};
+
+#endif
+
+class ofxUnixSocket {
+public:
+    // creates a bound and listening socket.  Stale filesystem sockets at
+    // path are replaced, a path something still accepts on fails with
+    // EADDRINUSE.  Permissions are ignored for abstract sockets.
+    static ServerSocket listen(const string& path,
+                               int backlog = 64,
+                               int permissions = 0660,
+                               const ofxUnixPeerFilter& filter = ofxUnixPeerFilter());
+
+    // adopts a listening descriptor inherited from another process
+    static ServerSocket adopt(poco_socket_t sockfd,
+                              const string& path,
+                              const ofxUnixPeerFilter& filter = ofxUnixPeerFilter());
+
+    // connects to a listening socket at path
+    static StreamSocket connect(const string& path);
+
+    // returns true if socket is a unix socket and fills in its peer credentials
+    static bool getPeerCredentials(const StreamSocket& socket, ofxUnixPeerCredentials& credentials);
+
+    static bool isAbstractPath(const string& path);
+
+    static ofxUnixPeerCredentials readPeerCredentials(poco_socket_t sockfd);
+
+};
+
+// Exposes the protected ServerSocket constructor that adopts an implementation.
+class ofxAdoptedServerSocket : public ServerSocket {
+public:
+    ofxAdoptedServerSocket(Poco::Net::SocketImpl* pImpl) : ServerSocket(pImpl, true) { }
+};